@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// microbenchmarks of the geometric kernels in the inner loops of the filters
+
+#include "SyntheticLocations.hpp"
+#include "db/PopulationDensityReader.hpp"
+#include "geo/GeographicPosition.hpp"
+#include "geo/GeometricHelpers.hpp"
+#include "topo/base_topo/BetaSkeletonFilter.hpp"
+#include "util/PopulationDensityLineCalculator.hpp"
+#include "util/Util.hpp"
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace {
+
+const size_t SAMPLES = 1024;
+
+std::vector<GeographicPosition> positions(size_t n) {
+    Locations_Ptr locations = Synthetic::locations(n);
+    std::vector<GeographicPosition> result;
+    for (GeographicNode_Ptr& node : *locations)
+        result.push_back(GeographicPosition(node->lat(), node->lon()));
+    return result;
+}
+
+}  // namespace
+
+static void BM_SphericalDist(benchmark::State& state) {
+    std::vector<GeographicPosition> p = positions(SAMPLES + 1);
+
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(GeometricHelpers::sphericalDist(p[i], p[i + 1]));
+        i = (i + 1) % SAMPLES;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SphericalDist);
+
+static void BM_SphericalDistCached(benchmark::State& state) {
+    std::vector<GeographicPosition> p = positions(SAMPLES + 1);
+    std::vector<GeometricHelpers::CachedPosition> cached;
+    for (GeographicPosition& position : p)
+        cached.push_back(GeometricHelpers::cachedPosition(position));
+
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(GeometricHelpers::sphericalDist(cached[i], cached[i + 1]));
+        i = (i + 1) % SAMPLES;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SphericalDistCached);
+
+static void BM_SphericalAngle(benchmark::State& state) {
+    std::vector<GeographicPosition> p = positions(SAMPLES + 1);
+    std::vector<GeometricHelpers::UnitVector> u;
+    for (GeographicPosition& position : p)
+        u.push_back(GeometricHelpers::unitVector(position));
+
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(GeometricHelpers::sphericalAngle(u[i], u[i + 1]));
+        i = (i + 1) % SAMPLES;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SphericalAngle);
+
+static void BM_MidPointCoordinates(benchmark::State& state) {
+    std::vector<GeographicPosition> p = positions(SAMPLES + 1);
+
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(GeometricHelpers::getMidPointCoordinates(p[i], p[i + 1]));
+        i = (i + 1) % SAMPLES;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MidPointCoordinates);
+
+static void BM_Haversine(benchmark::State& state) {
+    std::vector<double> angles(SAMPLES);
+    std::mt19937 rng(5489);
+    std::uniform_real_distribution<double> angle(0.0, M_PI);
+    for (double& a : angles)
+        a = angle(rng);
+
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Util::ihs(Util::hs(angles[i])));
+        i = (i + 1) % SAMPLES;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Haversine);
+
+static void BM_TestTheta(benchmark::State& state) {
+    Locations_Ptr nodes = Synthetic::locations(SAMPLES + 2);
+    // angle of the default maxBeta
+    const double theta = asin(1.0 / 1.2);
+
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(
+            BetaSkeletonFilter::testTheta((*nodes)[i], (*nodes)[i + 1], (*nodes)[i + 2], theta));
+        i = (i + 1) % SAMPLES;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TestTheta);
+
+// fails unless angleBelow agrees with testTheta, both round differently, so angles within 1e-9 of theta may differ
+static void BM_AngleBelow(benchmark::State& state) {
+    Locations_Ptr nodes = Synthetic::locations(SAMPLES + 2);
+    const double theta = asin(1.0 / 1.2);
+    const double cosTheta = cos(theta);
+    std::vector<GeometricHelpers::UnitVector> u;
+    for (GeographicNode_Ptr& node : *nodes) {
+        GeographicPosition position(node->lat(), node->lon());
+        u.push_back(GeometricHelpers::unitVector(position));
+    }
+
+    for (size_t i = 0; i < SAMPLES; ++i) {
+        GeographicNode_Ptr &p = (*nodes)[i], &r = (*nodes)[i + 1], &q = (*nodes)[i + 2];
+        double a = GeometricHelpers::sphericalDist(p, r);
+        double b = GeometricHelpers::sphericalDist(q, r);
+        double c = GeometricHelpers::sphericalDist(p, q);
+        double C = Util::ihs((Util::hs(c) - Util::hs(a - b)) / (sin(a) * sin(b)));
+        if (!std::isnan(C) && std::fabs(C - theta) >= 1e-9 &&
+            GeometricHelpers::angleBelow(u[i], u[i + 1], u[i + 2], cosTheta) !=
+                BetaSkeletonFilter::testTheta(p, r, q, theta)) {
+            state.SkipWithError("angleBelow differs from testTheta");
+            return;
+        }
+    }
+
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(GeometricHelpers::angleBelow(u[i], u[i + 1], u[i + 2], cosTheta));
+        i = (i + 1) % SAMPLES;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_AngleBelow);
+
+// line lengths in km given by the argument
+static void BM_DensityLineBetween(benchmark::State& state) {
+    static PopulationDensityReader_Ptr reader(new PopulationDensityReader);
+    PopulationDensityLineCalculator calculator(reader);
+
+    // start points from the synthetic cities, end points at the given distance towards the east
+    std::vector<GeographicPosition> from = positions(SAMPLES);
+    std::vector<GeographicPosition> to;
+    double km = static_cast<double>(state.range(0));
+    for (GeographicPosition& p : from) {
+        double dLon = GeometricHelpers::rad2deg(km / GeometricHelpers::EARTH_RADIUS_KM) /
+                      std::max(0.1, cos(GeometricHelpers::deg2rad(p.lat())));
+        to.push_back(GeographicPosition(p.lat(), std::min(179.9, p.lon() + dLon)));
+    }
+
+    size_t i = 0;
+    for (auto _ : state) {
+        DensityVector_Ptr line = calculator.getDensityLineBetween(from[i], to[i]);
+        benchmark::DoNotOptimize(line->data());
+        i = (i + 1) % SAMPLES;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_DensityLineBetween)->Arg(100)->Arg(1000)->Arg(5000);
@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// macrobenchmarks of the pipeline stages on synthetic cities, the argument is the number of cities
+
+#include "SyntheticLocations.hpp"
+#include "config/Config.hpp"
+#include "geo/GeometricHelpers.hpp"
+#include "topo/FailureAnalysis.hpp"
+#include "topo/FrozenTopology.hpp"
+#include "topo/base_topo/DelaunayGraphCreator.hpp"
+#include "topo/base_topo/OPTICSFilter.hpp"
+#include "topo/base_topo/PopulationDensityFilter.hpp"
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <random>
+#include <vector>
+
+static void pipelineSizes(benchmark::internal::Benchmark* b) {
+    b->Arg(1000)->Arg(10000)->Arg(100000)->Unit(benchmark::kMillisecond);
+}
+
+static void BM_OPTICSFilter(benchmark::State& state) {
+    Locations_Ptr cities = Synthetic::locations(state.range(0));
+
+    // same parameters as the neighbour clustering in topoGen
+    std::unique_ptr<Config> config(new Config);
+    unsigned int minPts = config->get<unsigned int>("neighbourCluster.minPts");
+    double eps = config->get<double>("neighbourCluster.maxClusterDistance") / GeometricHelpers::EARTH_RADIUS_KM;
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        Locations_Ptr locations = Synthetic::copy(*cities);
+        state.ResumeTiming();
+
+        OPTICSFilter optics(locations, eps, minPts, 0.8 * eps);
+        optics.filter("run1");
+        benchmark::DoNotOptimize(locations->size());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_OPTICSFilter)->Apply(pipelineSizes);
+
+static void BM_DelaunayGraphCreator(benchmark::State& state) {
+    Locations_Ptr cities = Synthetic::locations(state.range(0));
+
+    for (auto _ : state) {
+        DelaunayGraphCreator creator(*cities, Config_Ptr(new Config));
+        creator.create();
+        benchmark::DoNotOptimize(creator.getTopology().get());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_DelaunayGraphCreator)->Apply(pipelineSizes);
+
+// both length filter modes run on a fresh triangulation, which is built outside of the timing
+static void BM_PopulationDensityFilter(benchmark::State& state) {
+    Locations_Ptr cities = Synthetic::locations(state.range(0));
+    InternetUsageStatistics_Ptr inetStat = Synthetic::internetUsage();
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        DelaunayGraphCreator creator(*cities, Config_Ptr(new Config));
+        creator.create();
+        PopulationDensityFilter filter(creator.getTopology(), inetStat, Config_Ptr(new Config));
+        state.ResumeTiming();
+
+        filter.filter();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_PopulationDensityFilter)->Apply(pipelineSizes);
+
+static void BM_PopulationDensityFilterByLength(benchmark::State& state) {
+    Locations_Ptr cities = Synthetic::locations(state.range(0));
+    InternetUsageStatistics_Ptr inetStat = Synthetic::internetUsage();
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        DelaunayGraphCreator creator(*cities, Config_Ptr(new Config));
+        creator.create();
+        PopulationDensityFilter filter(creator.getTopology(), inetStat, Config_Ptr(new Config));
+        state.ResumeTiming();
+
+        filter.filterByLength();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_PopulationDensityFilterByLength)->Apply(pipelineSizes);
+
+// single and double edge failures on the length filtered triangulation. Fails unless the bridge forest answers like
+// the count over the hit components, then measures the forest answers.
+static void BM_FailureAnalysis(benchmark::State& state) {
+    Locations_Ptr cities = Synthetic::locations(state.range(0));
+    DelaunayGraphCreator creator(*cities, Config_Ptr(new Config));
+    creator.create();
+    PopulationDensityFilter filter(creator.getTopology(), Synthetic::internetUsage(), Config_Ptr(new Config));
+    filter.filterByLength();
+    FrozenTopology_Ptr topo = creator.getTopology()->freeze();
+    FailureAnalysis analysis(topo);
+
+    std::vector<FailureAnalysis::Scenario> scenarios;
+    std::mt19937 rng(5489);
+    std::uniform_int_distribution<unsigned> edge(0, topo->edgeCount() - 1);
+    for (unsigned e = 0; e < topo->edgeCount(); ++e) {
+        scenarios.push_back(FailureAnalysis::Scenario{"", {e}});
+        scenarios.push_back(FailureAnalysis::Scenario{"", {e, edge(rng)}});
+    }
+
+    for (const FailureAnalysis::Scenario& scenario : scenarios) {
+        FailureAnalysis::Result result = analysis.analyze(scenario, false);
+        FailureAnalysis::Result reference = analysis.analyze(scenario, false, false);
+        if (result.components != reference.components || result.disconnectedPairs != reference.disconnectedPairs) {
+            state.SkipWithError("the bridge forest differs from the count over the hit components");
+            return;
+        }
+    }
+
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(analysis.analyze(scenarios[i], false).components);
+        i = (i + 1) % scenarios.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FailureAnalysis)->Arg(1000);
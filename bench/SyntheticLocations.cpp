@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "SyntheticLocations.hpp"
+#include "config/PredefinedValues.hpp"
+#include "geo/CityNode.hpp"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <sstream>
+#include <string>
+
+namespace {
+
+struct CountryCenter {
+    const char* country;
+    const char* continent;
+    double lat;
+    double lon;
+    double spread;  /// < standard deviation in degrees
+};
+
+const CountryCenter CENTERS[] = {{"United States", "NA", 39.0, -98.0, 8.0},
+                                 {"India", "AS", 22.0, 79.0, 5.0},
+                                 {"Brazil", "SA", -12.0, -51.0, 6.0},
+                                 {"Russia", "EU", 56.0, 38.0, 6.0},
+                                 {"China", "AS", 33.0, 110.0, 6.0},
+                                 {"Germany", "EU", 51.0, 10.0, 2.0},
+                                 {"Japan", "AS", 36.0, 138.0, 2.0},
+                                 {"United Kingdom", "EU", 53.0, -2.0, 1.5},
+                                 {"France", "EU", 47.0, 2.0, 2.0},
+                                 {"Mexico", "NA", 22.0, -101.0, 4.0}};
+
+}  // namespace
+
+Locations_Ptr Synthetic::locations(size_t n, unsigned int seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<size_t> center(0, sizeof(CENTERS) / sizeof(CENTERS[0]) - 1);
+    std::normal_distribution<double> offset(0.0, 1.0);
+    std::uniform_real_distribution<double> size(0.0, 5.0);
+
+    Locations_Ptr result(new Locations);
+    result->reserve(n);
+
+    for (size_t i = 0; i < n; ++i) {
+        const CountryCenter& c = CENTERS[center(rng)];
+        double lat = std::max(-89.9, std::min(89.9, c.lat + c.spread * offset(rng)));
+        double lon = c.lon + c.spread * offset(rng);
+        if (lon < -180.0)
+            lon += 360.0;
+        else if (lon >= 180.0)
+            lon -= 360.0;
+
+        std::stringstream name;
+        name << "city" << i;
+        double population = 20000.0 * exp(size(rng));
+
+        result->push_back(GeographicNode_Ptr(
+            new CityNode(static_cast<int>(i), name.str(), lat, lon, population, c.country, c.continent)));
+    }
+
+    return result;
+}
+
+Locations_Ptr Synthetic::copy(const Locations& locations) {
+    Locations_Ptr result(new Locations);
+    result->reserve(locations.size());
+
+    for (const GeographicNode_Ptr& node : locations)
+        result->push_back(GeographicNode_Ptr(new CityNode(*static_cast<CityNode*>(node.get()))));
+
+    return result;
+}
+
+InternetUsageStatistics_Ptr Synthetic::internetUsage(void) {
+    static InternetUsageStatistics_Ptr inetStat(new InternetUsageStatistics(PredefinedValues::dbFilePath()));
+    return inetStat;
+}
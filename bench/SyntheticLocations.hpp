@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SYNTHETICLOCATIONS_HPP
+#define SYNTHETICLOCATIONS_HPP
+
+#include "db/InternetUsageStatistics.hpp"
+#include "geo/GeographicNode.hpp"
+#include <cstddef>
+
+namespace Synthetic {
+
+// n cities clustered around the centers of a few populous countries, with ids 0 to n-1 like after the import
+// stages of topoGen. The same n and seed always give the same cities.
+Locations_Ptr locations(size_t n, unsigned int seed = 5489);
+
+// deep copy, for benchmarks of filters that change their input
+Locations_Ptr copy(const Locations& locations);
+
+// one instance for all benchmarks, reading the statistics is slow compared to the kernels
+InternetUsageStatistics_Ptr internetUsage(void);
+
+}  // namespace Synthetic
+
+#endif  // SYNTHETICLOCATIONS_HPP
@@ -0,0 +1,40 @@
+# - Try to find zstd
+# Once done this will define
+#
+#  ZSTD_FOUND - system has zstd
+#  ZSTD_INCLUDE_DIRS - the zstd include directory
+#  ZSTD_LIBRARIES - Link these to use zstd
+#
+
+find_package(PkgConfig QUIET)
+if (PKG_CONFIG_FOUND)
+  pkg_check_modules(_ZSTD QUIET libzstd)
+endif (PKG_CONFIG_FOUND)
+
+find_path(ZSTD_INCLUDE_DIR
+  NAMES
+    zstd.h
+  PATHS
+    ${_ZSTD_INCLUDEDIR}
+    /usr/include
+    /usr/local/include
+)
+
+find_library(ZSTD_LIBRARY
+  NAMES
+    zstd
+  PATHS
+    ${_ZSTD_LIBDIR}
+    /usr/lib
+    /usr/local/lib
+)
+
+include(FindPackageHandleStandardArgs)
+find_package_handle_standard_args(Zstd DEFAULT_MSG ZSTD_LIBRARY ZSTD_INCLUDE_DIR)
+
+if (ZSTD_FOUND)
+  set(ZSTD_INCLUDE_DIRS ${ZSTD_INCLUDE_DIR})
+  set(ZSTD_LIBRARIES ${ZSTD_LIBRARY})
+endif (ZSTD_FOUND)
+
+mark_as_advanced(ZSTD_INCLUDE_DIR ZSTD_LIBRARY)
@@ -0,0 +1,352 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// performance regression runs of the whole pipeline, see cases.json and README.md
+
+#include "config/Config.hpp"
+#include "output/WriteBuffer.hpp"
+#include "topo/Pipeline.hpp"
+#include "util/Profiler.hpp"
+#include <algorithm>
+#include <boost/log/core.hpp>
+#include <boost/log/expressions.hpp>
+#include <boost/log/trivial.hpp>
+#include <boost/program_options.hpp>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <json/json.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+
+namespace po = boost::program_options;
+
+namespace {
+
+// the outputs of every case, hashed to detect changes of the generated topology
+const char* const OUTPUTS[] = {"nodes.txt", "edges.txt", "graph.json", "graph.bin"};
+
+struct Tolerance {
+    double time;         /// < relative slowdown of a stage
+    double timeSlack;    /// < seconds, for stages too short to time reliably
+    double memory;       /// < relative growth of the peak resident memory
+    double memorySlack;  /// < MB
+};
+
+// a stage that ran more than once in a topology, e.g. output, is summed up
+struct StageResult {
+    double wallSeconds;
+    double peakMB;
+};
+
+struct CaseResult {
+    std::vector<std::string> stageOrder;
+    std::map<std::string, StageResult> stages;
+    std::map<std::string, std::string> hashes;
+
+    CaseResult() : stageOrder(), stages(), hashes() {}
+};
+
+Json::Value readJSON(const std::string& filename) {
+    std::ifstream in(filename.c_str());
+    Json::Value root;
+    if (!in.good())
+        return root;
+
+    Json::CharReaderBuilder builder;
+    std::string errors;
+    if (!Json::parseFromStream(builder, in, &root, &errors)) {
+        BOOST_LOG_TRIVIAL(error) << "parsing " << filename << " failed: " << errors;
+        exit(EXIT_FAILURE);
+    }
+    return root;
+}
+
+void writeJSON(const std::string& filename, const Json::Value& root) {
+    std::ofstream out(filename.c_str());
+    if (!out.good()) {
+        BOOST_LOG_TRIVIAL(error) << "could not write " << filename;
+        exit(EXIT_FAILURE);
+    }
+    Json::StyledWriter writer;
+    out << writer.write(root);
+}
+
+// FNV-1a of the file contents as hex, empty if the file is missing
+std::string hashFile(const std::string& filename) {
+    std::ifstream in(filename.c_str(), std::ios::binary);
+    if (!in.good())
+        return "";
+
+    uint64_t hash = 14695981039346656037ull;
+    std::vector<char> buffer(1 << 16);
+    while (in) {
+        in.read(buffer.data(), buffer.size());
+        for (std::streamsize i = 0; i < in.gcount(); ++i) {
+            hash ^= static_cast<unsigned char>(buffer[i]);
+            hash *= 1099511628211ull;
+        }
+    }
+
+    char hex[17];
+    snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(hash));
+    return hex;
+}
+
+// one topology for the case on a pipeline of its own, so that no repetition finds the tables imported by the one
+// before. Its stages are the ones the profiler recorded during the run.
+CaseResult runOnce(Config_Ptr config, const std::string& seed, const std::string& prefix) {
+    Pipeline::Outputs outputs;
+    outputs.graph = true;
+    outputs.json = true;
+    outputs.binary = true;
+
+    size_t first = Profiler::stages().size();
+    {
+        Pipeline pipeline(config, outputs);
+        pipeline.generate(seed, prefix);
+    }
+    Profiler::finish();
+
+    CaseResult result;
+    std::vector<Profiler::Stage> stages = Profiler::stages();
+    for (size_t i = first; i < stages.size(); ++i) {
+        const Profiler::Stage& st = stages[i];
+        auto entry = result.stages.find(st.name);
+        if (entry == result.stages.end()) {
+            result.stageOrder.push_back(st.name);
+            result.stages[st.name] = StageResult{st.wallSeconds, st.peakRSSKB / 1024.0};
+        } else {
+            entry->second.wallSeconds += st.wallSeconds;
+            entry->second.peakMB = std::max(entry->second.peakMB, st.peakRSSKB / 1024.0);
+        }
+    }
+
+    std::string suffix = Compression::fromConfig().suffix();
+    for (const char* output : OUTPUTS)
+        result.hashes[output] = hashFile(prefix + output + suffix);
+    return result;
+}
+
+// the fastest of the repetitions per stage, the outputs have to be the same in all of them
+CaseResult runCase(const Config& base, const Json::Value& testCase, const std::string& outDir, unsigned repeat) {
+    const std::string name = testCase["name"].asString();
+    Config_Ptr config = std::make_shared<Config>(base, testCase["config"]);
+
+    // the thread pool and the output settings are read from the default config
+    Config::setDefault(*config);
+
+    CaseResult best;
+    for (unsigned r = 0; r < repeat; ++r) {
+        CaseResult result = runOnce(config, testCase["seed"].asString(), outDir + "/" + name + "_");
+        if (r == 0) {
+            best = result;
+            continue;
+        }
+
+        if (result.hashes != best.hashes)
+            BOOST_LOG_TRIVIAL(error) << name << ": the outputs differ between repetitions";
+        for (auto& entry : best.stages) {
+            auto other = result.stages.find(entry.first);
+            if (other == result.stages.end())
+                continue;
+            entry.second.wallSeconds = std::min(entry.second.wallSeconds, other->second.wallSeconds);
+            entry.second.peakMB = std::min(entry.second.peakMB, other->second.peakMB);
+        }
+    }
+    return best;
+}
+
+Json::Value toJSON(const CaseResult& result) {
+    Json::Value entry;
+    Json::Value stages(Json::arrayValue);
+    double totalSeconds = 0.0;
+    double peakMB = 0.0;
+    for (const std::string& name : result.stageOrder) {
+        const StageResult& st = result.stages.at(name);
+        Json::Value stage;
+        stage["name"] = name;
+        stage["wallSeconds"] = st.wallSeconds;
+        stage["peakMB"] = st.peakMB;
+        stages.append(stage);
+        totalSeconds += st.wallSeconds;
+        peakMB = std::max(peakMB, st.peakMB);
+    }
+    entry["stages"] = stages;
+    entry["totalSeconds"] = totalSeconds;
+    entry["peakMB"] = peakMB;
+    for (const auto& hash : result.hashes)
+        entry["outputs"][hash.first] = hash.second;
+    return entry;
+}
+
+// logs the comparison of a case with its baseline, returns the number of regressions
+unsigned compare(const std::string& name, const Json::Value& measured, const Json::Value& baseline,
+                 const Tolerance& tolerance) {
+    unsigned failures = 0;
+    char line[256];
+
+    for (const std::string& output : baseline["outputs"].getMemberNames()) {
+        const std::string expected = baseline["outputs"][output].asString();
+        const std::string actual = measured["outputs"].get(output, "").asString();
+        if (expected != actual) {
+            BOOST_LOG_TRIVIAL(error) << name << ": " << output << " changed, hash " << actual << " instead of "
+                                     << expected;
+            ++failures;
+        }
+    }
+
+    // the committed baselines only hold the hashes, the timings are those of one machine
+    if (!baseline.isMember("stages")) {
+        BOOST_LOG_TRIVIAL(info) << name << ": no stage timings in the baseline, make perf_baseline records them";
+        return failures;
+    }
+
+    std::map<std::string, const Json::Value*> baseStages;
+    for (const Json::Value& stage : baseline["stages"])
+        baseStages[stage["name"].asString()] = &stage;
+
+    snprintf(line, sizeof(line), "%-16s %-20s %10s %10s %7s %10s %10s %7s", "case", "stage", "base[s]", "now[s]",
+             "ratio", "base[MB]", "now[MB]", "");
+    BOOST_LOG_TRIVIAL(info) << line;
+    for (const Json::Value& stage : measured["stages"]) {
+        auto base = baseStages.find(stage["name"].asString());
+        if (base == baseStages.end()) {
+            BOOST_LOG_TRIVIAL(warning) << name << ": no baseline of stage " << stage["name"].asString();
+            continue;
+        }
+
+        double baseSeconds = (*base->second)["wallSeconds"].asDouble();
+        double seconds = stage["wallSeconds"].asDouble();
+        double baseMB = (*base->second)["peakMB"].asDouble();
+        double mb = stage["peakMB"].asDouble();
+        bool slower = seconds > baseSeconds * (1.0 + tolerance.time) + tolerance.timeSlack;
+        bool larger = mb > baseMB * (1.0 + tolerance.memory) + tolerance.memorySlack;
+
+        snprintf(line, sizeof(line), "%-16s %-20s %10.3f %10.3f %7.2f %10.1f %10.1f %7s", name.c_str(),
+                 stage["name"].asCString(), baseSeconds, seconds, baseSeconds > 0.0 ? seconds / baseSeconds : 0.0,
+                 baseMB, mb, slower ? "SLOWER" : (larger ? "MEMORY" : ""));
+        if (slower || larger) {
+            BOOST_LOG_TRIVIAL(error) << line;
+            ++failures;
+        } else
+            BOOST_LOG_TRIVIAL(info) << line;
+    }
+    return failures;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::string casesFile;
+    std::string baselinesFile;
+    std::string outDir;
+    std::string only;
+    unsigned repeat = 1;
+    bool update = false;
+
+    po::options_description desc("topoGen_perf");
+    desc.add_options()("help", "produce help message")(
+        "cases", po::value<std::string>(&casesFile)->default_value("perf/cases.json"), "pinned configurations")(
+        "baselines", po::value<std::string>(&baselinesFile)->default_value("perf/baselines.json"), "stored results")(
+        "out", po::value<std::string>(&outDir)->default_value("perf_output"), "directory of the outputs")(
+        "only", po::value<std::string>(&only)->default_value(""), "run only the case of this name")(
+        "repeat", po::value<unsigned>(&repeat)->default_value(3), "runs per case, the fastest counts")(
+        "update", po::value<bool>(&update)->zero_tokens(), "store the results as the new baselines");
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+    if (vm.count("help")) {
+        std::cout << desc << std::endl;
+        return EXIT_SUCCESS;
+    }
+    repeat = std::max(repeat, 1u);
+
+    // the pipeline logs every stage at info level
+    boost::log::core::get()->set_filter(boost::log::trivial::severity >= boost::log::trivial::info);
+
+    Json::Value cases = readJSON(casesFile);
+    if (cases.isNull()) {
+        BOOST_LOG_TRIVIAL(error) << "no cases in " << casesFile;
+        return EXIT_FAILURE;
+    }
+    Json::Value baselines = readJSON(baselinesFile);
+
+    const Json::Value& tol = cases["tolerance"];
+    Tolerance tolerance{tol.get("time", 0.25).asDouble(), tol.get("timeSlackSeconds", 0.05).asDouble(),
+                        tol.get("memory", 0.15).asDouble(), tol.get("memorySlackMB", 4.0).asDouble()};
+
+    if (mkdir(outDir.c_str(), 0755) != 0 && errno != EEXIST) {
+        BOOST_LOG_TRIVIAL(error) << "could not create " << outDir;
+        return EXIT_FAILURE;
+    }
+
+    Config base(Config(), cases["config"]);
+    Json::Value results;
+    unsigned failures = 0;
+    for (const Json::Value& testCase : cases["cases"]) {
+        const std::string name = testCase["name"].asString();
+        if (!only.empty() && name != only)
+            continue;
+
+        Json::Value measured = toJSON(runCase(base, testCase, outDir, repeat));
+        results["cases"][name] = measured;
+
+        const Json::Value& baseline = baselines["cases"][name];
+        if (update)
+            continue;
+        if (baseline.isNull()) {
+            BOOST_LOG_TRIVIAL(error) << name << ": no baseline in " << baselinesFile << ", run with --update";
+            ++failures;
+            continue;
+        }
+        failures += compare(name, measured, baseline, tolerance);
+    }
+
+    writeJSON(outDir + "/perf_results.json", results);
+    if (update) {
+        // keep the baselines of the cases that did not run
+        for (const std::string& name : results["cases"].getMemberNames())
+            baselines["cases"][name] = results["cases"][name];
+        writeJSON(baselinesFile, baselines);
+        BOOST_LOG_TRIVIAL(info) << "stored the baselines in " << baselinesFile;
+        return EXIT_SUCCESS;
+    }
+
+    if (failures > 0) {
+        BOOST_LOG_TRIVIAL(error) << failures << " performance or output regressions";
+        return EXIT_FAILURE;
+    }
+    BOOST_LOG_TRIVIAL(info) << "no regressions";
+    return EXIT_SUCCESS;
+}
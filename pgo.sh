@@ -0,0 +1,31 @@
+#!/bin/sh
+#
+# profile guided Release build in build-pgo/: build instrumented, train on a reference run, rebuild with the profiles
+#
+# usage: ./pgo.sh [topoGen arguments of the training run, default --seed run1 --json --graph --kml]
+#
+
+set -e
+
+SOURCE_DIR=$(cd "$(dirname "$0")" && pwd)
+BUILD_DIR=${SOURCE_DIR}/build-pgo
+PROFILE_DIR=${BUILD_DIR}/pgo
+TRAIN_ARGS=${*:-"--seed run1 --json --graph --kml"}
+
+rm -rf "${PROFILE_DIR}"
+mkdir -p "${BUILD_DIR}/train"
+
+# profiles are matched by object file path, so both builds have to use the same build directory
+cd "${BUILD_DIR}"
+cmake "${SOURCE_DIR}" -DCMAKE_BUILD_TYPE=Release -DPGO=generate -DPGO_PROFILE_DIR="${PROFILE_DIR}"
+cmake --build . --clean-first
+
+cd "${BUILD_DIR}/train"
+"${BUILD_DIR}/bin/topoGen" ${TRAIN_ARGS}
+
+cd "${BUILD_DIR}"
+cmake "${SOURCE_DIR}" -DPGO=use
+cmake --build . --clean-first
+cd "${SOURCE_DIR}"
+
+echo "profile guided build: ${BUILD_DIR}/bin/topoGen"
@@ -28,6 +28,38 @@
  */
 
 #include "CMDArgs.hpp"
+#include <cassert>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+// expands run1..run500 to run1, run2, ..., run500, the number keeps the width of the first seed (run001..run100)
+void appendSeeds(const std::string& item, std::vector<std::string>& seeds) {
+    size_t dots = item.find("..");
+    if (dots == std::string::npos) {
+        seeds.push_back(item);
+        return;
+    }
+
+    std::string first = item.substr(0, dots);
+    std::string last = item.substr(dots + 2);
+    size_t digits = first.find_last_not_of("0123456789") + 1;
+    std::string prefix = first.substr(0, digits);
+    assert(digits < first.size() && last.compare(0, digits, prefix) == 0 && last.size() > digits);
+
+    unsigned long from = std::stoul(first.substr(digits));
+    unsigned long to = std::stoul(last.substr(digits));
+    size_t width = first.size() - digits;
+    for (unsigned long i = from; i <= to; ++i) {
+        std::string number = std::to_string(i);
+        if (number.size() < width)
+            number.insert(0, width - number.size(), '0');
+        seeds.push_back(prefix + number);
+    }
+}
+
+}  // namespace
 
 CMDArgs::CMDArgs(int argc, char** argv)
     : _desc("Allowed options"),
@@ -35,14 +67,36 @@ CMDArgs::CMDArgs(int argc, char** argv)
       kmlOutput(false),
       graphOutput(false),
       jsonOutput(false),
+      binaryOutput(false),
+      landmarkOutput(false),
+      metisOutput(false),
+      metricsOutput(false),
+      failuresOutput(false),
       seed(),
+      seedList(),
+      seedFile(),
       simNodesJSONPath(),
-      jsonOutFile() {
+      jsonOutFile(),
+      profileOutFile(),
+      traceOutFile(),
+      serveSocketPath(),
+      sweepFile() {
     _desc.add_options()("help", "produce help message")("kml", po::value<bool>(&kmlOutput)->zero_tokens())(
         "json", po::value<bool>(&jsonOutput)->zero_tokens())("graph", po::value<bool>(&graphOutput)->zero_tokens())(
+        "binary", po::value<bool>(&binaryOutput)->zero_tokens())(
+        "landmarks", po::value<bool>(&landmarkOutput)->zero_tokens())(
+        "metis", po::value<bool>(&metisOutput)->zero_tokens())(
+        "metrics", po::value<bool>(&metricsOutput)->zero_tokens())(
+        "failures", po::value<bool>(&failuresOutput)->zero_tokens())(
         "seed", po::value<std::string>(&seed)->default_value("run1"))(
+        "seeds", po::value<std::string>(&seedList)->default_value(""))(
+        "seedFile", po::value<std::string>(&seedFile)->default_value(""))(
         "jsonOutputFile", po::value<std::string>(&jsonOutFile)->default_value("graph.json"))(
-        "simNodes", po::value<std::string>(&simNodesJSONPath)->default_value(""));
+        "simNodes", po::value<std::string>(&simNodesJSONPath)->default_value(""))(
+        "profile", po::value<std::string>(&profileOutFile)->implicit_value("profile.json"))(
+        "trace", po::value<std::string>(&traceOutFile)->implicit_value("trace.json"))(
+        "serve", po::value<std::string>(&serveSocketPath)->implicit_value("topoGen.sock"))(
+        "sweep", po::value<std::string>(&sweepFile)->default_value(""));
 
     po::store(po::parse_command_line(argc, argv, _desc), _vm);
     po::notify(_vm);
@@ -60,10 +114,52 @@ bool CMDArgs::jsonOutputEnabled() {
     return jsonOutput;
 }
 
+bool CMDArgs::binaryOutputEnabled() {
+    return binaryOutput;
+}
+
+bool CMDArgs::landmarkOutputEnabled() {
+    return landmarkOutput;
+}
+
+bool CMDArgs::metisOutputEnabled() {
+    return metisOutput;
+}
+
+bool CMDArgs::metricsOutputEnabled() {
+    return metricsOutput;
+}
+
+bool CMDArgs::failuresOutputEnabled() {
+    return failuresOutput;
+}
+
 std::string CMDArgs::getSeed() {
     return seed;
 }
 
+std::vector<std::string> CMDArgs::getSeeds() {
+    std::vector<std::string> seeds;
+
+    // comma separated seeds and ranges
+    std::stringstream list(seedList);
+    std::string item;
+    while (std::getline(list, item, ','))
+        if (!item.empty())
+            appendSeeds(item, seeds);
+
+    // one seed or range per line
+    if (seedFile.length() > 0) {
+        std::ifstream file(seedFile.c_str());
+        assert(file.good());
+        while (std::getline(file, item))
+            if (!item.empty())
+                appendSeeds(item, seeds);
+    }
+
+    return seeds;
+}
+
 std::string CMDArgs::simNodesJSONFile() {
     return simNodesJSONPath;
 }
@@ -71,3 +167,19 @@ std::string CMDArgs::simNodesJSONFile() {
 std::string CMDArgs::jsonOutputFile() {
     return jsonOutFile;
 }
+
+std::string CMDArgs::profileOutputFile() {
+    return profileOutFile;
+}
+
+std::string CMDArgs::traceOutputFile() {
+    return traceOutFile;
+}
+
+std::string CMDArgs::serveSocket() {
+    return serveSocketPath;
+}
+
+std::string CMDArgs::sweepParameterFile() {
+    return sweepFile;
+}
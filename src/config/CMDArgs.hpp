@@ -33,6 +33,7 @@
 #include <boost/program_options.hpp>
 #include <string>
 #include <memory>
+#include <vector>
 
 namespace po = boost::program_options;
 
@@ -46,12 +47,35 @@ class CMDArgs {
 
     bool jsonOutputEnabled();
 
+    bool binaryOutputEnabled();
+
+    bool landmarkOutputEnabled();
+
+    bool metisOutputEnabled();
+    bool metricsOutputEnabled();
+    bool failuresOutputEnabled();
+
     std::string getSeed();
 
+    // seeds of a batch run from --seeds and --seedFile, empty for a single run with --seed
+    std::vector<std::string> getSeeds();
+
     std::string simNodesJSONFile();
 
     std::string jsonOutputFile();
 
+    // empty unless --profile was given
+    std::string profileOutputFile();
+
+    // Chrome trace event file of the TRACE_SCOPE spans, empty unless --trace was given
+    std::string traceOutputFile();
+
+    // unix socket of the generation server, empty unless --serve was given
+    std::string serveSocket();
+
+    // parameter grid of a sweep, see ParameterSweep, empty without --sweep
+    std::string sweepParameterFile();
+
    protected:
    private:
     po::options_description _desc;
@@ -59,9 +83,20 @@ class CMDArgs {
     bool kmlOutput;
     bool graphOutput;
     bool jsonOutput;
+    bool binaryOutput;
+    bool landmarkOutput;
+    bool metisOutput;
+    bool metricsOutput;
+    bool failuresOutput;
     std::string seed;
+    std::string seedList;
+    std::string seedFile;
     std::string simNodesJSONPath;
     std::string jsonOutFile;
+    std::string profileOutFile;
+    std::string traceOutFile;
+    std::string serveSocketPath;
+    std::string sweepFile;
 };
 
 typedef std::shared_ptr<CMDArgs> CMDArgs_Ptr;
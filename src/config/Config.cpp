@@ -31,77 +31,134 @@
 
 #include "PredefinedValues.hpp"
 #include <fstream>
-#include <sstream>
 #include <string>
-#include <utility>
 
-Config::Config() : _config() {
-    std::ifstream configFile(PredefinedValues::configfile());
-    configFile >> _config;
+namespace {
+
+void merge(Json::Value& value, const Json::Value& overrides) {
+    if (!value.isObject() || !overrides.isObject()) {
+        value = overrides;
+        return;
+    }
+    for (const std::string& name : overrides.getMemberNames())
+        merge(value[name], overrides[name]);
 }
 
-Config::Config(std::string fileName) : _config() {
+// path of the first value of overrides that value does not have or has with another type, empty if all match
+std::string mismatch(const Json::Value& value, const Json::Value& overrides, const std::string& path) {
+    if (value.isObject()) {
+        if (!overrides.isObject())
+            return path;
+        for (const std::string& name : overrides.getMemberNames()) {
+            std::string member = path.empty() ? name : path + "." + name;
+            if (!value.isMember(name))
+                return member;
+            std::string found = mismatch(value[name], overrides[name], member);
+            if (!found.empty())
+                return found;
+        }
+        return "";
+    }
+
+    bool same;
+    switch (value.type()) {
+        case Json::intValue:
+        case Json::uintValue:
+            // integral numbers like 1.0 are ints for jsoncpp
+            same = overrides.isInt();
+            break;
+        case Json::realValue:
+            same = overrides.type() == Json::realValue || overrides.type() == Json::intValue ||
+                   overrides.type() == Json::uintValue;
+            break;
+        default:
+            same = overrides.type() == value.type();
+    }
+    return same ? "" : path;
+}
+
+}  // namespace
+
+Config::Config() : _root(defaultRoot()), _node(_root.get()) {
+}
+
+Config::Config(std::string fileName) : _root(parse(fileName)), _node(_root.get()) {
+}
+
+Config::Config(const Config& base, const Json::Value& overrides) : _root(), _node(nullptr) {
+    std::shared_ptr<Json::Value> root(new Json::Value(*base._node));
+    merge(*root, overrides);
+    _root = root;
+    _node = _root.get();
+}
+
+Config::Config(std::shared_ptr<const Json::Value> root, const Json::Value* node) : _root(root), _node(node) {
+}
+
+void Config::setDefault(const Config& config) {
+    defaultRoot() = std::make_shared<const Json::Value>(*config._node);
+}
+
+std::shared_ptr<const Json::Value>& Config::defaultRoot(void) {
+    // function local, so the first use from any thread parses it
+    static std::shared_ptr<const Json::Value> root(parse(PredefinedValues::configfile()));
+    return root;
+}
+
+std::shared_ptr<const Json::Value> Config::parse(const std::string& fileName) {
+    std::shared_ptr<Json::Value> root(new Json::Value);
     std::ifstream configFile(fileName);
-    configFile >> _config;
+    configFile >> *root;
+    return root;
+}
+
+Config_Ptr Config::subConfig(std::string propertyName) const {
+    return Config_Ptr(new Config(_root, &getSubValue(propertyName)));
 }
 
-Config_Ptr Config::subConfig(std::string propertyName) {
-    return Config_Ptr(new Config(getSubValue(propertyName)));
+const Json::Value& Config::getSubValue(const std::string& propertyName) const {
+    const Json::Value* node = _node;
+
+    size_t begin = 0;
+    for (;;) {
+        size_t end = propertyName.find('.', begin);
+        node = &(*node)[propertyName.substr(begin, end - begin)];
+        if (end == std::string::npos)
+            return *node;
+        begin = end + 1;
+    }
 }
 
-Config::Config(Json::Value node) : _config(node) {
+std::string Config::mismatch(const Json::Value& overrides) const {
+    return ::mismatch(*_node, overrides, "");
 }
 
-Json::Value Config::getSubValue(std::string propertyName) {
-    std::pair<Json::Value, std::string> node = getSubNode(propertyName);
-    Json::Value& nd = node.first;
-    std::string& key = node.second;
-    return nd[key];
+std::string Config::serialize(std::string propertyName) const {
+    Json::FastWriter writer;
+    return writer.write(getSubValue(propertyName));
 }
 
 template <>
-std::string Config::get<std::string>(std::string propertyName) {
+std::string Config::get<std::string>(const std::string& propertyName) const {
     return getSubValue(propertyName).asString();
 }
 
 template <>
-double Config::get<double>(std::string propertyName) {
+double Config::get<double>(const std::string& propertyName) const {
     return getSubValue(propertyName).asDouble();
 }
 
 template <>
-int Config::get<int>(std::string propertyName) {
+int Config::get<int>(const std::string& propertyName) const {
     return getSubValue(propertyName).asInt();
 }
 
 template <>
-bool Config::get<bool>(std::string propertyName) {
+bool Config::get<bool>(const std::string& propertyName) const {
     return getSubValue(propertyName).asBool();
 }
 
 template <>
-unsigned int Config::get<unsigned int>(std::string propertyName) {
+unsigned int Config::get<unsigned int>(const std::string& propertyName) const {
     return static_cast<unsigned int>(getSubValue(propertyName).asInt());
 }
-
-std::pair<Json::Value, std::string> Config::getSubNode(std::string propertyName) {
-    Json::Value node = _config;
-
-    std::vector<std::string> splittedNames(splitPropertyNameBy(propertyName));
-    for (size_t i = 0; i < splittedNames.size() - 1; ++i) {
-        node = node[splittedNames[i]];
-    }
-
-    return std::make_pair(node, splittedNames[splittedNames.size() - 1]);
-}
-
-std::vector<std::string> Config::splitPropertyNameBy(std::string propertyName, char delimiter) {
-    std::vector<std::string> vec;
-
-    std::istringstream tokens(propertyName);
-    std::string currentToken;
-    while (std::getline(tokens, currentToken, delimiter))
-        vec.push_back(currentToken);
-
-    return vec;
-}
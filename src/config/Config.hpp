@@ -33,32 +33,52 @@
 #include <iostream>
 #include <memory>
 #include <string>
-#include <vector>
 
 #include <json/json.h>
 
 class Config;
 typedef std::shared_ptr<Config> Config_Ptr;
 
+// Immutable view of a parsed configuration. The configuration file is parsed once per process, copies and
+// subconfigs share the parsed tree and properties are looked up in place.
 class Config {
    public:
+    // the default config, the config file unless setDefault replaced it
     Config();
     Config(std::string fileName);
 
-    Config_Ptr subConfig(std::string propertyName);
+    // base with the values of overrides, objects are merged member by member, all other values replace the value at
+    // the same path
+    Config(const Config& base, const Json::Value& overrides);
+
+    // the property of overrides that this config does not have or has with a value of another type, empty if every
+    // value of overrides replaces one of the same type
+    std::string mismatch(const Json::Value& overrides) const;
+
+    // makes config the default of this process, e.g. for the settings that the thread pool and the outputs read from
+    // the default config. Not thread safe, no pipeline may run meanwhile.
+    static void setDefault(const Config& config);
+
+    Config_Ptr subConfig(std::string propertyName) const;
 
     template <class T>
-    T get(std::string);
+    T get(const std::string& propertyName) const;
+
+    // compact JSON text of a value or subtree, equal subtrees give equal strings
+    std::string serialize(std::string propertyName) const;
 
    protected:
-    Config(Json::Value node);
-    std::pair<Json::Value, std::string> getSubNode(std::string propertyName);
-    std::vector<std::string> splitPropertyNameBy(std::string propertyName, char delimiter = '.');
+    Config(std::shared_ptr<const Json::Value> root, const Json::Value* node);
 
-    Json::Value getSubValue(std::string propertyName);
+    // a null value for missing properties
+    const Json::Value& getSubValue(const std::string& propertyName) const;
 
    private:
-    Json::Value _config;
+    static std::shared_ptr<const Json::Value>& defaultRoot(void);
+    static std::shared_ptr<const Json::Value> parse(const std::string& fileName);
+
+    std::shared_ptr<const Json::Value> _root;  /// < owns _node
+    const Json::Value* _node;
 };
 
 #endif
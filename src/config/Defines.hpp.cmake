@@ -12,4 +12,11 @@
 // configfile
 #cmakedefine CONFIGFILE "@CONFIGFILE@"
 
+// optional libraries
+#cmakedefine HAVE_ZLIB
+#cmakedefine HAVE_ZSTD
+
+// TRACE_SCOPE spans, see util/Trace.hpp
+#cmakedefine TOPOGEN_TRACE
+
 #endif // TOPOGENCONFIG_HPP
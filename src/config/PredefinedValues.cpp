@@ -60,6 +60,14 @@ std::string PredefinedValues::dbFilePath(void) {
     return dir_dataroot() + "/topoGen.db";
 }
 
+std::string PredefinedValues::dbSnapshotFilePath(void) {
+    return dir_dataroot() + "/topoGen.snapshot";
+}
+
 std::string PredefinedValues::popDensityFilePath(void) {
     return dir_dataroot() + "/popdensity.bin";
 }
+
+std::string PredefinedValues::popDensityTilesFilePath(void) {
+    return dir_dataroot() + "/popdensity.tiles";
+}
@@ -47,9 +47,11 @@ std::string dir_include(void);
 
 // db
 std::string dbFilePath(void);
+std::string dbSnapshotFilePath(void);
 
 // population density
 std::string popDensityFilePath(void);
+std::string popDensityTilesFilePath(void);
 
 // config
 std::string configfile(void);
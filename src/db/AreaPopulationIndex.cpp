@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "AreaPopulationIndex.hpp"
+
+#include <algorithm>
+#include <boost/log/trivial.hpp>
+#include <cassert>
+#include <cmath>
+
+AreaPopulationIndex::AreaPopulationIndex(std::string dbPath) : _buckets(ROWS * COLS) {
+    // zero population never contributes to an area, so those rows are not loaded
+    std::string queryString(
+        " SELECT geo.Latitude AS Latitude,"
+        "        geo.Longitude AS Longitude,"
+        "        geo.population AS Population,"
+        "        ci.country AS Country"
+        " FROM geoname as geo, countryinfo as ci"
+        " WHERE geo.population > 0"
+        "   AND geo.country_code = ci.iso");
+
+    if (!prepare(dbPath, queryString)) {
+        BOOST_LOG_TRIVIAL(error) << "Database query failed in AreaPopulationIndex";
+    }
+
+    size_t loaded = 0;
+    while (step() == SQLITE_ROW) {
+        double latitude(sqlite3_column_double(_stmt, 0));
+        double longitude(sqlite3_column_double(_stmt, 1));
+        double population(sqlite3_column_double(_stmt, 2));
+        std::string country(reinterpret_cast<const char*>(sqlite3_column_text(_stmt, 3)));
+
+        _buckets[rowOf(latitude) * COLS + colOf(longitude)].push_back(
+            PopulatedPosition(population, latitude, longitude, country));
+        ++loaded;
+    }
+
+    // same order as the ORDER BY of SQLiteAreaPopulationReader
+    for (auto& bucket : _buckets) {
+        std::stable_sort(bucket.begin(), bucket.end(), [](const PopulatedPosition& a, const PopulatedPosition& b) {
+            return a._population > b._population;
+        });
+    }
+
+    BOOST_LOG_TRIVIAL(info) << "AreaPopulationIndex: loaded " << loaded << " populated positions";
+}
+
+int AreaPopulationIndex::rowOf(double lat) {
+    return std::min(ROWS - 1, std::max(0, static_cast<int>(floor(lat + 90.0))));
+}
+
+int AreaPopulationIndex::colOf(double lon) {
+    return std::min(COLS - 1, std::max(0, static_cast<int>(floor(lon + 180.0))));
+}
+
+AreaPopulationIndexReader_Ptr AreaPopulationIndex::query(double lat, double lon, double length) {
+    return AreaPopulationIndexReader_Ptr(new AreaPopulationIndexReader(*this, lat, lon, length));
+}
+
+AreaPopulationIndexReader::AreaPopulationIndexReader(AreaPopulationIndex& index, double lat, double lon, double length)
+    : _index(index),
+      _minLat(lat - (length / 2)),
+      _maxLat(lat + (length / 2)),
+      _minLon(lon - (length / 2)),
+      _maxLon(lon + (length / 2)),
+      _firstCol(AreaPopulationIndex::colOf(_minLon)),
+      _lastRow(AreaPopulationIndex::rowOf(_maxLat)),
+      _lastCol(AreaPopulationIndex::colOf(_maxLon)),
+      _row(AreaPopulationIndex::rowOf(_minLat)),
+      _col(_firstCol),
+      _pos(0) {
+    _rowAvailable = true;
+    advance();
+}
+
+// move to the next position inside the bounding box, starting at the current one
+void AreaPopulationIndexReader::advance() {
+    while (_row <= _lastRow) {
+        const std::vector<PopulatedPosition>& bucket = _index._buckets[_row * AreaPopulationIndex::COLS + _col];
+
+        for (; _pos < bucket.size(); ++_pos) {
+            const PopulatedPosition& pp = bucket[_pos];
+            if (pp._lat >= _minLat && pp._lat <= _maxLat && pp._lon >= _minLon && pp._lon <= _maxLon)
+                return;
+        }
+
+        _pos = 0;
+        if (++_col > _lastCol) {
+            _col = _firstCol;
+            ++_row;
+        }
+    }
+
+    _rowAvailable = false;
+}
+
+PopulatedPosition AreaPopulationIndexReader::getNext() {
+    assert(_rowAvailable);
+
+    PopulatedPosition pp = _index._buckets[_row * AreaPopulationIndex::COLS + _col][_pos];
+    ++_pos;
+    advance();
+    return pp;
+}
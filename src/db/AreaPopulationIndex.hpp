@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef AREAPOPULATIONINDEX_HPP
+#define AREAPOPULATIONINDEX_HPP
+
+#include "geo/PopulatedPosition.hpp"
+#include "ResultIterator.hpp"
+#include "SQLiteReader.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+
+class AreaPopulationIndex;
+typedef std::shared_ptr<AreaPopulationIndex> AreaPopulationIndex_Ptr;
+
+class AreaPopulationIndexReader;
+typedef std::shared_ptr<AreaPopulationIndexReader> AreaPopulationIndexReader_Ptr;
+
+// all populated geonames, loaded once into a 1x1 degree bucket grid
+class AreaPopulationIndex : public SQLiteReader {
+   public:
+    AreaPopulationIndex(std::string dbPath);
+
+    // same bounding box as SQLiteAreaPopulationReader, without the database round trip
+    AreaPopulationIndexReader_Ptr query(double lat, double lon, double length);
+
+   private:
+    friend class AreaPopulationIndexReader;
+
+    static constexpr int ROWS = 180;
+    static constexpr int COLS = 360;
+
+    static int rowOf(double lat);
+    static int colOf(double lon);
+
+    // buckets in row-major order, each sorted by descending population
+    std::vector<std::vector<PopulatedPosition>> _buckets;
+};
+
+// iterates the populated positions of one bounding box query
+class AreaPopulationIndexReader : public ResultIterator<PopulatedPosition> {
+   public:
+    // latitude and longitude of midpoint!
+    AreaPopulationIndexReader(AreaPopulationIndex& index, double lat, double lon, double length);
+
+    PopulatedPosition getNext();
+
+   private:
+    void advance();
+
+    AreaPopulationIndex& _index;
+    double _minLat;
+    double _maxLat;
+    double _minLon;
+    double _maxLon;
+    int _firstCol;
+    int _lastRow;
+    int _lastCol;
+    int _row;
+    int _col;
+    size_t _pos;
+};
+
+#endif
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Database.hpp"
+
+#include <boost/log/trivial.hpp>
+#include <cassert>
+#include <map>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+namespace {
+// connections and released statements of one thread
+struct ThreadConnections {
+    std::map<std::string, sqlite3*> connections;
+    std::map<std::pair<sqlite3*, std::string>, std::vector<sqlite3_stmt*>> statements;
+
+    ~ThreadConnections() {
+        for (auto& cached : statements)
+            for (sqlite3_stmt* stmt : cached.second)
+                sqlite3_finalize(stmt);
+        for (auto& connection : connections)
+            sqlite3_close(connection.second);
+    }
+};
+
+thread_local ThreadConnections threadConnections;
+}  // namespace
+
+const long long Database::MMAP_SIZE;
+const int Database::CACHE_SIZE_KIB;
+
+sqlite3* Database::connection(const std::string& path) {
+    auto found = threadConnections.connections.find(path);
+    if (found != threadConnections.connections.end())
+        return found->second;
+
+    // the threads never share a connection, so SQLite does not need to serialize them
+    sqlite3* db = nullptr;
+    int retval = sqlite3_open_v2(path.c_str(), &db, SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX, nullptr);
+    if (retval != SQLITE_OK) {
+        BOOST_LOG_TRIVIAL(error) << "Database connection to " << path << " failed: " << sqlite3_errmsg(db);
+    }
+    assert(retval == SQLITE_OK);
+
+    std::stringstream pragmas;
+    pragmas << "PRAGMA mmap_size = " << MMAP_SIZE << "; PRAGMA cache_size = -" << CACHE_SIZE_KIB << ";";
+    retval = sqlite3_exec(db, pragmas.str().c_str(), nullptr, nullptr, nullptr);
+    assert(retval == SQLITE_OK);
+
+    BOOST_LOG_TRIVIAL(info) << "SQLite connection to " << path << " established read-only";
+    threadConnections.connections.insert(std::make_pair(path, db));
+    return db;
+}
+
+sqlite3_stmt* Database::acquire(const std::string& path, const std::string& query) {
+    sqlite3* db = connection(path);
+
+    std::vector<sqlite3_stmt*>& released = threadConnections.statements[std::make_pair(db, query)];
+    if (!released.empty()) {
+        sqlite3_stmt* stmt = released.back();
+        released.pop_back();
+        return stmt;
+    }
+
+    sqlite3_stmt* stmt = nullptr;
+    int retval = sqlite3_prepare_v2(db, query.c_str(), query.length(), &stmt, nullptr);
+    if (retval != SQLITE_OK) {
+        BOOST_LOG_TRIVIAL(error) << "Preparing query failed: " << sqlite3_errmsg(db);
+        sqlite3_finalize(stmt);
+        return nullptr;
+    }
+    return stmt;
+}
+
+void Database::release(sqlite3_stmt* stmt) {
+    if (stmt == nullptr)
+        return;
+
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+    threadConnections.statements[std::make_pair(sqlite3_db_handle(stmt), std::string(sqlite3_sql(stmt)))].push_back(
+        stmt);
+}
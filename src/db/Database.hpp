@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DATABASE_HPP
+#define DATABASE_HPP
+
+#include <sqlite3.h>
+#include <string>
+
+// shared access to the SQLite databases: every thread owns one read-only connection per database file and a cache of
+// prepared statements on it. Connections and statements must only be used on the thread that acquired them, they are
+// closed when the thread ends.
+class Database {
+   public:
+    // connection of the calling thread, opened on first use
+    static sqlite3* connection(const std::string& path);
+
+    // prepared statement for query on the connection of the calling thread, reused from the cache when an earlier
+    // one was released. Returns nullptr if the query does not compile.
+    static sqlite3_stmt* acquire(const std::string& path, const std::string& query);
+
+    // resets the statement, clears its bindings and returns it to the cache, nullptr is ignored
+    static void release(sqlite3_stmt* stmt);
+
+   private:
+    Database() = delete;
+
+    static const long long MMAP_SIZE = 256LL << 20;  /// < bytes of the database file mapped into memory
+    static const int CACHE_SIZE_KIB = 64 << 10;      /// < page cache per connection
+};
+
+#endif  // DATABASE_HPP
@@ -0,0 +1,410 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "DatabaseSnapshot.hpp"
+
+#include "db/LandingPointReader.hpp"
+#include "db/SQLiteLocationReader.hpp"
+#include <boost/log/trivial.hpp>
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <map>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+constexpr uint32_t DatabaseSnapshot::VERSION;
+
+namespace {
+
+const char MAGIC[8] = {'t', 'o', 'p', 'o', 'G', 'e', 'n', 'S'};
+
+// sections are appended to one buffer and written at once
+struct Buffer {
+    std::vector<char> bytes;
+
+    template <typename T>
+    void put(const std::vector<T>& values) {
+        const char* begin = reinterpret_cast<const char*>(values.data());
+        bytes.insert(bytes.end(), begin, begin + values.size() * sizeof(T));
+    }
+
+    // starts a section and returns its offset
+    uint64_t section(void) {
+        bytes.resize((bytes.size() + 7) / 8 * 8, 0);
+        return bytes.size();
+    }
+
+    // offsets of the names followed by their bytes
+    void putNames(const std::vector<std::string>& names) {
+        std::vector<uint32_t> offsets(1, 0);
+        std::string chars;
+        for (const std::string& name : names) {
+            chars += name;
+            offsets.push_back(chars.size());
+        }
+        put(offsets);
+        bytes.insert(bytes.end(), chars.begin(), chars.end());
+    }
+};
+
+// walks the columns of a mapped section in the order they were put
+struct Section {
+    const char* pos;
+
+    template <typename T>
+    const T* take(size_t count) {
+        const T* values = reinterpret_cast<const T*>(pos);
+        pos += count * sizeof(T);
+        return values;
+    }
+};
+
+// checks that the columns of a section put in this order end inside the mapped file
+struct Extent {
+    const char* data;
+    uint64_t size;
+    uint64_t pos;
+    bool valid;
+
+    Extent(const char* data, uint64_t size, uint64_t offset)
+        : data(data), size(size), pos(offset), valid(offset <= size && offset % 8 == 0) {}
+
+    template <typename T>
+    void take(uint64_t count) {
+        if (valid && count > (size - pos) / sizeof(T))
+            valid = false;
+        if (valid)
+            pos += count * sizeof(T);
+    }
+
+    // the name offsets have to ascend, the last one is the length of the bytes
+    void takeNames(uint64_t count) {
+        uint64_t start = pos;
+        take<uint32_t>(count + 1);
+        if (!valid)
+            return;
+        const uint32_t* offsets = reinterpret_cast<const uint32_t*>(data + start);
+        valid = offsets[0] == 0 && std::is_sorted(offsets, offsets + count + 1);
+        take<char>(offsets[count]);
+    }
+};
+
+bool databaseState(const std::string& dbPath, uint64_t& size, int64_t& modified) {
+    struct stat st;
+    if (stat(dbPath.c_str(), &st) != 0)
+        return false;
+    size = st.st_size;
+    modified = st.st_mtime;
+    return true;
+}
+
+}  // namespace
+
+bool DatabaseSnapshot::write(const std::string& dbPath, const std::string& filename, int populationThreshold) {
+    SnapshotHeader header = SnapshotHeader();
+    std::copy(MAGIC, MAGIC + sizeof(MAGIC), header.magic);
+    header.version = VERSION;
+    header.populationThreshold = populationThreshold;
+    if (!databaseState(dbPath, header.dbSize, header.dbModified)) {
+        BOOST_LOG_TRIVIAL(error) << "could not find " << dbPath;
+        return false;
+    }
+
+    Buffer buffer;
+    buffer.bytes.resize(sizeof(SnapshotHeader));
+
+    // country and continent names are stored once
+    std::vector<std::string> strings;
+    std::map<std::string, uint32_t> stringIndex;
+    auto intern = [&strings, &stringIndex](const std::string& str) -> uint32_t {
+        auto inserted = stringIndex.insert(std::make_pair(str, strings.size()));
+        if (inserted.second)
+            strings.push_back(str);
+        return inserted.first->second;
+    };
+
+    {
+        std::vector<double> latitude, longitude, population;
+        std::vector<uint32_t> country, continent;
+        std::vector<std::string> names;
+        SQLiteLocationReader reader(dbPath, populationThreshold);
+        while (reader.hasNext()) {
+            CityNode city = reader.getNext();
+            latitude.push_back(city.lat());
+            longitude.push_back(city.lon());
+            population.push_back(city.population());
+            country.push_back(intern(city.country()));
+            continent.push_back(intern(city.continent()));
+            names.push_back(city.name());
+        }
+        header.cities = names.size();
+        header.cityOffset = buffer.section();
+        buffer.put(latitude);
+        buffer.put(longitude);
+        buffer.put(population);
+        buffer.put(country);
+        buffer.put(continent);
+        buffer.putNames(names);
+    }
+
+    header.strings = strings.size();
+    header.stringOffset = buffer.section();
+    buffer.putNames(strings);
+
+    {
+        std::vector<double> latitude, longitude;
+        std::vector<int32_t> id;
+        std::vector<std::string> names;
+        LandingPointReader reader(dbPath);
+        while (reader.hasNext()) {
+            SeaCableLandingPoint landingPoint = reader.getNext();
+            latitude.push_back(landingPoint.lat());
+            longitude.push_back(landingPoint.lon());
+            id.push_back(landingPoint.id());
+            names.push_back(landingPoint.name());
+        }
+        header.landingPoints = names.size();
+        header.landingPointOffset = buffer.section();
+        buffer.put(latitude);
+        buffer.put(longitude);
+        buffer.put(id);
+        buffer.putNames(names);
+    }
+
+    {
+        std::vector<double> lat1, lon1, lat2, lon2;
+        std::vector<int32_t> linkId;
+        SubmarineCable reader(dbPath);
+        while (reader.hasNext()) {
+            SubmarineCableEdge edge = reader.getNext();
+            lat1.push_back(edge.coord1.first);
+            lon1.push_back(edge.coord1.second);
+            lat2.push_back(edge.coord2.first);
+            lon2.push_back(edge.coord2.second);
+            linkId.push_back(edge.linkID);
+        }
+        header.segments = linkId.size();
+        header.segmentOffset = buffer.section();
+        buffer.put(lat1);
+        buffer.put(lon1);
+        buffer.put(lat2);
+        buffer.put(lon2);
+        buffer.put(linkId);
+
+        // segments grouped by link, a stable sort keeps the table order inside a link
+        std::vector<uint32_t> segment(linkId.size());
+        for (uint32_t i = 0; i < segment.size(); ++i)
+            segment[i] = i;
+        std::stable_sort(segment.begin(), segment.end(),
+                         [&linkId](uint32_t a, uint32_t b) { return linkId[a] < linkId[b]; });
+
+        std::vector<int32_t> links;
+        std::vector<uint32_t> first;
+        for (uint32_t i = 0; i < segment.size(); ++i) {
+            if (links.empty() || links.back() != linkId[segment[i]]) {
+                links.push_back(linkId[segment[i]]);
+                first.push_back(i);
+            }
+        }
+        first.push_back(segment.size());
+
+        header.links = links.size();
+        header.linkOffset = buffer.section();
+        buffer.put(links);
+        buffer.put(first);
+        buffer.put(segment);
+    }
+
+    std::memcpy(buffer.bytes.data(), &header, sizeof(header));
+
+    FILE* file = fopen(filename.c_str(), "wb");
+    if (!file) {
+        BOOST_LOG_TRIVIAL(error) << "could not open " << filename;
+        return false;
+    }
+    bool written = fwrite(buffer.bytes.data(), 1, buffer.bytes.size(), file) == buffer.bytes.size();
+    written = fclose(file) == 0 && written;
+    if (!written)
+        BOOST_LOG_TRIVIAL(error) << "could not write " << filename;
+    else
+        BOOST_LOG_TRIVIAL(info) << "packed " << header.cities << " cities, " << header.landingPoints
+                                << " landing points and " << header.segments << " cable segments of " << header.links
+                                << " links into " << filename;
+    return written;
+}
+
+bool DatabaseSnapshot::validExtents(const char* data, size_t size, const SnapshotHeader& header) {
+    Extent cities(data, size, header.cityOffset);
+    cities.take<double>(3 * uint64_t(header.cities));
+    cities.take<uint32_t>(2 * uint64_t(header.cities));
+    cities.takeNames(header.cities);
+
+    Extent strings(data, size, header.stringOffset);
+    strings.takeNames(header.strings);
+
+    Extent landingPoints(data, size, header.landingPointOffset);
+    landingPoints.take<double>(2 * uint64_t(header.landingPoints));
+    landingPoints.take<int32_t>(header.landingPoints);
+    landingPoints.takeNames(header.landingPoints);
+
+    Extent segments(data, size, header.segmentOffset);
+    segments.take<double>(4 * uint64_t(header.segments));
+    segments.take<int32_t>(header.segments);
+
+    Extent links(data, size, header.linkOffset);
+    links.take<int32_t>(header.links);
+    links.take<uint32_t>(uint64_t(header.links) + 1);
+    links.take<uint32_t>(header.segments);
+
+    return cities.valid && strings.valid && landingPoints.valid && segments.valid && links.valid;
+}
+
+DatabaseSnapshot_Ptr DatabaseSnapshot::open(const std::string& filename, const std::string& dbPath) {
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd == -1)
+        return DatabaseSnapshot_Ptr();
+
+    struct stat st;
+    int retval = fstat(fd, &st);
+    size_t size = retval == 0 ? st.st_size : 0;
+    void* data = size >= sizeof(SnapshotHeader) ? mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (data == MAP_FAILED) {
+        BOOST_LOG_TRIVIAL(warning) << "could not map database snapshot " << filename;
+        return DatabaseSnapshot_Ptr();
+    }
+
+    DatabaseSnapshot_Ptr snapshot(new DatabaseSnapshot(static_cast<const char*>(data), size));
+    const SnapshotHeader& header = snapshot->header();
+    if (!std::equal(MAGIC, MAGIC + sizeof(MAGIC), header.magic) || header.version != VERSION) {
+        BOOST_LOG_TRIVIAL(warning) << filename << " is no database snapshot of version " << VERSION;
+        return DatabaseSnapshot_Ptr();
+    }
+    if (!validExtents(static_cast<const char*>(data), size, header)) {
+        BOOST_LOG_TRIVIAL(warning) << "database snapshot " << filename << " is truncated";
+        return DatabaseSnapshot_Ptr();
+    }
+
+    uint64_t dbSize = 0;
+    int64_t dbModified = 0;
+    if (databaseState(dbPath, dbSize, dbModified) && (dbSize != header.dbSize || dbModified != header.dbModified)) {
+        BOOST_LOG_TRIVIAL(warning) << "database snapshot " << filename << " is older than " << dbPath
+                                   << ", run topoGen-pack again";
+        return DatabaseSnapshot_Ptr();
+    }
+
+    BOOST_LOG_TRIVIAL(info) << "mapped database snapshot " << filename;
+    return snapshot;
+}
+
+DatabaseSnapshot::DatabaseSnapshot(const char* data, size_t size)
+    : _data(data), _size(size), _header(reinterpret_cast<const SnapshotHeader*>(data)) {
+}
+
+DatabaseSnapshot::~DatabaseSnapshot() {
+    munmap(const_cast<char*>(_data), _size);
+}
+
+std::string DatabaseSnapshot::name(const char* section, uint32_t count, uint32_t index) {
+    const uint32_t* offsets = reinterpret_cast<const uint32_t*>(section);
+    const char* chars = section + (count + 1) * sizeof(uint32_t);
+    return std::string(chars + offsets[index], offsets[index + 1] - offsets[index]);
+}
+
+bool DatabaseSnapshot::readCities(int populationThreshold, std::vector<CityNode>& cities) const {
+    if (populationThreshold < _header->populationThreshold)
+        return false;
+
+    uint32_t n = _header->cities;
+    Section section = {_data + _header->cityOffset};
+    const double* latitude = section.take<double>(n);
+    const double* longitude = section.take<double>(n);
+    const double* population = section.take<double>(n);
+    const uint32_t* country = section.take<uint32_t>(n);
+    const uint32_t* continent = section.take<uint32_t>(n);
+    const char* names = section.pos;
+
+    const char* strings = _data + _header->stringOffset;
+    std::vector<std::string> countries(_header->strings);
+    for (uint32_t i = 0; i < _header->strings; ++i)
+        countries[i] = name(strings, _header->strings, i);
+
+    for (uint32_t i = 0; i < n; ++i) {
+        if (population[i] < populationThreshold)
+            continue;
+        cities.push_back(CityNode(0, name(names, n, i), latitude[i], longitude[i], population[i],
+                                  countries[country[i]], countries[continent[i]]));
+    }
+    return true;
+}
+
+void DatabaseSnapshot::readLandingPoints(std::vector<SeaCableLandingPoint>& landingPoints) const {
+    uint32_t n = _header->landingPoints;
+    Section section = {_data + _header->landingPointOffset};
+    const double* latitude = section.take<double>(n);
+    const double* longitude = section.take<double>(n);
+    const int32_t* id = section.take<int32_t>(n);
+    const char* names = section.pos;
+
+    for (uint32_t i = 0; i < n; ++i)
+        landingPoints.push_back(SeaCableLandingPoint(id[i], latitude[i], longitude[i], name(names, n, i)));
+}
+
+void DatabaseSnapshot::readSubmarineCableEdges(std::vector<SubmarineCableEdge>& edges) const {
+    uint32_t n = _header->segments;
+    Section section = {_data + _header->segmentOffset};
+    const double* lat1 = section.take<double>(n);
+    const double* lon1 = section.take<double>(n);
+    const double* lat2 = section.take<double>(n);
+    const double* lon2 = section.take<double>(n);
+    const int32_t* linkId = section.take<int32_t>(n);
+
+    for (uint32_t i = 0; i < n; ++i)
+        edges.push_back(
+            SubmarineCableEdge(std::make_pair(lat1[i], lon1[i]), std::make_pair(lat2[i], lon2[i]), linkId[i]));
+}
+
+int DatabaseSnapshot::linkId(uint32_t link) const {
+    assert(link < _header->links);
+    Section section = {_data + _header->linkOffset};
+    return section.take<int32_t>(_header->links)[link];
+}
+
+void DatabaseSnapshot::linkSegments(uint32_t link, std::vector<uint32_t>& segments) const {
+    assert(link < _header->links);
+    Section section = {_data + _header->linkOffset};
+    section.take<int32_t>(_header->links);
+    const uint32_t* first = section.take<uint32_t>(_header->links + 1);
+    const uint32_t* segment = section.take<uint32_t>(_header->segments);
+    segments.assign(segment + first[link], segment + first[link + 1]);
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DATABASESNAPSHOT_HPP
+#define DATABASESNAPSHOT_HPP
+
+#include "db/SubmarineCable.hpp"
+#include "geo/CityNode.hpp"
+#include "geo/SeaCableLandingPoint.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class DatabaseSnapshot;
+typedef std::shared_ptr<DatabaseSnapshot> DatabaseSnapshot_Ptr;
+
+// Columnar copy of the tables ImportedData reads from topoGen.db, written by topoGen-pack and mapped instead of
+// querying the database. Every section starts at its offset in the header, aligned to 8 bytes, all values in host
+// byte order:
+//   cities in table order: double latitude[n], longitude[n], population[n],
+//     uint32 country[n], continent[n] (indices into strings), uint32 nameOffset[n + 1], name bytes
+//   strings: uint32 offset[n + 1], bytes
+//   landing points in table order: double latitude[n], longitude[n], int32 id[n], uint32 nameOffset[n + 1], bytes
+//   cable segments in table order: double lat1[n], lon1[n], lat2[n], lon2[n], int32 linkId[n]
+//   links in ascending id order: int32 linkId[n], uint32 first[n + 1], uint32 segment[segments], the segments of
+//     link k in table order are segment[first[k]] up to segment[first[k + 1]]
+class DatabaseSnapshot {
+   public:
+    static constexpr uint32_t VERSION = 1;
+
+    struct SnapshotHeader {
+        char magic[8];
+        uint32_t version;
+        int32_t populationThreshold;  /// < smaller cities are not in the snapshot
+        uint64_t dbSize;              /// < size and modification time of the packed database
+        int64_t dbModified;
+        uint32_t cities;
+        uint32_t strings;
+        uint32_t landingPoints;
+        uint32_t segments;
+        uint32_t links;
+        uint32_t reserved;
+        uint64_t cityOffset;
+        uint64_t stringOffset;
+        uint64_t landingPointOffset;
+        uint64_t segmentOffset;
+        uint64_t linkOffset;
+    };
+    static_assert(sizeof(SnapshotHeader) == 96, "unexpected padding in SnapshotHeader");
+
+    // packs the tables of dbPath with the cities of at least populationThreshold, false if it can not be written
+    static bool write(const std::string& dbPath, const std::string& filename, int populationThreshold);
+
+    // maps filename if it is a snapshot of dbPath in its current state, nullptr otherwise
+    static DatabaseSnapshot_Ptr open(const std::string& filename, const std::string& dbPath);
+
+    ~DatabaseSnapshot();
+
+    const SnapshotHeader& header(void) const { return *_header; }
+
+    // cities of at least populationThreshold, false if the snapshot was packed with a larger threshold
+    bool readCities(int populationThreshold, std::vector<CityNode>& cities) const;
+    void readLandingPoints(std::vector<SeaCableLandingPoint>& landingPoints) const;
+    void readSubmarineCableEdges(std::vector<SubmarineCableEdge>& edges) const;
+
+    // positions in the submarine cable edges of link, for links < header().links
+    int linkId(uint32_t link) const;
+    void linkSegments(uint32_t link, std::vector<uint32_t>& segments) const;
+
+   private:
+    DatabaseSnapshot(const char* data, size_t size);
+
+    // true if every section of header lies inside the size bytes at data
+    static bool validExtents(const char* data, size_t size, const SnapshotHeader& header);
+
+    // entry index of a section of names, given its number of entries
+    static std::string name(const char* section, uint32_t count, uint32_t index);
+
+    const char* _data;
+    size_t _size;
+    const SnapshotHeader* _header;
+
+    DatabaseSnapshot(const DatabaseSnapshot&) = delete;
+    DatabaseSnapshot& operator=(const DatabaseSnapshot&) = delete;
+};
+
+#endif  // DATABASESNAPSHOT_HPP
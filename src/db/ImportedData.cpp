@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ImportedData.hpp"
+#include "config/Config.hpp"
+#include "config/PredefinedValues.hpp"
+#include "db/LandingPointReader.hpp"
+#include "db/SQLiteLocationReader.hpp"
+#include "util/BoundedQueue.hpp"
+#include "util/ThreadPool.hpp"
+#include <boost/log/trivial.hpp>
+#include <algorithm>
+#include <thread>
+#include <unordered_map>
+
+ImportedData::ImportedData(std::string dbPath, const GeoRegion& region)
+    : _dbFilename(dbPath),
+      _region(region),
+      _snapshotOpened(),
+      _snapshot(),
+      _citiesRead(),
+      _citiesByCountry(),
+      _landingPointsRead(),
+      _landingPoints(),
+      _cableEdgesRead(),
+      _cableEdges(),
+      _cables() {
+}
+
+DatabaseSnapshot_Ptr ImportedData::snapshot(void) {
+    std::call_once(_snapshotOpened,
+                   [this]() { _snapshot = DatabaseSnapshot::open(PredefinedValues::dbSnapshotFilePath(), _dbFilename); });
+    return _snapshot;
+}
+
+const std::vector<std::vector<CityNode>>& ImportedData::citiesByCountry(void) {
+    std::call_once(_citiesRead, [this]() {
+        Config_Ptr config(new Config);
+        Config_Ptr cityFilterConfig(config->subConfig("cityfilter"));
+        int populationThreshold = cityFilterConfig->get<int>("citysizethreshold");
+
+        auto addCity = [this](CityNode& next) {
+            if (next.countryId() >= _citiesByCountry.size())
+                _citiesByCountry.resize(next.countryId() + 1);
+            _citiesByCountry[next.countryId()].push_back(next);
+        };
+
+        std::vector<CityNode> cities;
+        if (snapshot() && snapshot()->readCities(populationThreshold, cities)) {
+            for (CityNode& city : cities)
+                if (_region.contains(city.lat(), city.lon()))
+                    addCity(city);
+        } else {
+            auto addBatch = [&addCity](CityColumns& columns) {
+                for (size_t i = 0; i < columns.size(); ++i) {
+                    CityNode next(0, columns.name[i], columns.latitude[i], columns.longitude[i],
+                                  columns.population[i], columns.countryId[i], columns.continentId[i]);
+                    addCity(next);
+                }
+            };
+
+            const size_t BATCH_SIZE = 4096;
+            const size_t QUEUED_BATCHES = 4;
+            if (ThreadPool::fromConfig()->size() > 1) {
+                // a reader thread steps through the query while this thread groups the batches it read
+                BoundedQueue<CityColumns> batches(QUEUED_BATCHES);
+                std::thread producer([this, populationThreshold, BATCH_SIZE, &batches]() {
+                    SQLiteLocationReader reader(_dbFilename, populationThreshold, _region);
+                    CityColumns columns;
+                    columns.reserve(BATCH_SIZE);
+                    while (reader.readBatch(columns, BATCH_SIZE) > 0) {
+                        batches.push(std::move(columns));
+                        columns = CityColumns();
+                        columns.reserve(BATCH_SIZE);
+                    }
+                    batches.close();
+                });
+
+                CityColumns columns;
+                while (batches.pop(columns))
+                    addBatch(columns);
+                producer.join();
+            } else {
+                SQLiteLocationReader reader(_dbFilename, populationThreshold, _region);
+                CityColumns columns;
+                columns.reserve(BATCH_SIZE);
+                while (reader.readBatch(columns, BATCH_SIZE) > 0) {
+                    addBatch(columns);
+                    columns.clear();
+                }
+            }
+        }
+
+        // the rows come in table order, the cities of a country are sampled by name
+        for (std::vector<CityNode>& country : _citiesByCountry)
+            std::stable_sort(country.begin(), country.end());
+    });
+
+    return _citiesByCountry;
+}
+
+const std::vector<SeaCableLandingPoint>& ImportedData::landingPoints(void) {
+    std::call_once(_landingPointsRead, [this]() {
+        if (snapshot()) {
+            snapshot()->readLandingPoints(_landingPoints);
+            _landingPoints.erase(std::remove_if(_landingPoints.begin(), _landingPoints.end(),
+                                                [this](SeaCableLandingPoint& landingPoint) {
+                                                    return !_region.contains(landingPoint.lat(), landingPoint.lon());
+                                                }),
+                                 _landingPoints.end());
+            return;
+        }
+
+        std::unique_ptr<LandingPointReader> lpr(new LandingPointReader(_dbFilename, _region));
+        while (lpr->hasNext())
+            _landingPoints.push_back(lpr->getNext());
+    });
+
+    return _landingPoints;
+}
+
+const std::vector<SubmarineCableEdge>& ImportedData::submarineCableEdges(void) {
+    std::call_once(_cableEdgesRead, [this]() {
+        if (snapshot()) {
+            snapshot()->readSubmarineCableEdges(_cableEdges);
+            _cableEdges.erase(std::remove_if(_cableEdges.begin(), _cableEdges.end(),
+                                             [this](SubmarineCableEdge& edge) {
+                                                 return !_region.clip(edge.coord1, edge.coord2);
+                                             }),
+                              _cableEdges.end());
+        } else {
+            std::unique_ptr<SubmarineCable> sc(new SubmarineCable(_dbFilename, _region));
+            while (sc->hasNext())
+                _cableEdges.push_back(sc->getNext());
+        }
+
+        // the table lists the segments of a cable together, grouping keeps their order and only moves stray ones
+        std::unordered_map<int, size_t> cableOf;
+        std::vector<size_t> cable;
+        cable.reserve(_cableEdges.size());
+        for (const SubmarineCableEdge& edge : _cableEdges)
+            cable.push_back(cableOf.insert(std::make_pair(edge.linkID, cableOf.size())).first->second);
+
+        std::vector<size_t> order(_cableEdges.size());
+        for (size_t i = 0; i < order.size(); ++i)
+            order[i] = i;
+        std::stable_sort(order.begin(), order.end(), [&cable](size_t a, size_t b) { return cable[a] < cable[b]; });
+
+        std::vector<SubmarineCableEdge> grouped;
+        grouped.reserve(_cableEdges.size());
+        for (size_t i : order) {
+            if (_cables.empty() || _cables.back().linkID != _cableEdges[i].linkID)
+                _cables.push_back(SubmarineCableSegments{_cableEdges[i].linkID, grouped.size(), grouped.size()});
+            grouped.push_back(_cableEdges[i]);
+            ++_cables.back().end;
+        }
+        _cableEdges.swap(grouped);
+    });
+
+    return _cableEdges;
+}
+
+const std::vector<SubmarineCableSegments>& ImportedData::submarineCables(void) {
+    submarineCableEdges();
+    return _cables;
+}
+
+void ImportedData::load(void) {
+    citiesByCountry();
+    landingPoints();
+    submarineCableEdges();
+
+    BOOST_LOG_TRIVIAL(info) << "ImportedData: loaded " << _landingPoints.size() << " landing points and "
+                            << _cableEdges.size() << " submarine cable edges of " << _cables.size() << " cables";
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef IMPORTEDDATA_HPP
+#define IMPORTEDDATA_HPP
+
+#include "db/DatabaseSnapshot.hpp"
+#include "db/SubmarineCable.hpp"
+#include "geo/CityNode.hpp"
+#include "geo/GeoRegion.hpp"
+#include "geo/SeaCableLandingPoint.hpp"
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class ImportedData;
+typedef std::shared_ptr<ImportedData> ImportedData_Ptr;
+
+// Seed independent database content of the import stages. Each table is read on first use, so one instance can be
+// shared by all runs of a batch. The tables come from the snapshot of topoGen-pack if there is a current one. Only
+// the content inside region is kept, cable segments leaving it are clipped to its border.
+class ImportedData {
+   public:
+    ImportedData(std::string dbPath, const GeoRegion& region = GeoRegion());
+
+    // cities above cityfilter.citysizethreshold grouped by interned country id, ordered by name
+    const std::vector<std::vector<CityNode>>& citiesByCountry(void);
+
+    const std::vector<SeaCableLandingPoint>& landingPoints(void);
+
+    // the segments of each cable one after another, the cables in the order they first appear in the table
+    const std::vector<SubmarineCableEdge>& submarineCableEdges(void);
+
+    // the cables in submarineCableEdges
+    const std::vector<SubmarineCableSegments>& submarineCables(void);
+
+    // reads all tables at once
+    void load(void);
+
+   private:
+    // nullptr without a usable snapshot
+    DatabaseSnapshot_Ptr snapshot(void);
+
+    std::string _dbFilename;
+    GeoRegion _region;
+
+    std::once_flag _snapshotOpened;
+    DatabaseSnapshot_Ptr _snapshot;
+
+    std::once_flag _citiesRead;
+    std::vector<std::vector<CityNode>> _citiesByCountry;
+
+    std::once_flag _landingPointsRead;
+    std::vector<SeaCableLandingPoint> _landingPoints;
+
+    std::once_flag _cableEdgesRead;
+    std::vector<SubmarineCableEdge> _cableEdges;
+    std::vector<SubmarineCableSegments> _cables;
+};
+
+#endif  // IMPORTEDDATA_HPP
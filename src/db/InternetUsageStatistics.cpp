@@ -29,21 +29,22 @@
 
 #include "InternetUsageStatistics.hpp"
 
+#include "util/StringInterner.hpp"
 #include <boost/log/trivial.hpp>
 #include <cassert>
+#include <iomanip>
 #include <iostream>
+#include <limits>
 #include <sstream>
 
-InternetUsageStatistics::InternetUsageStatistics(std::string dbPath) {
-    int retval = sqlite3_open(dbPath.c_str(), &_sqliteDB);
-
-    // If connection failed, handle returns NULL
-    if (retval != SQLITE_OK) {
-        BOOST_LOG_TRIVIAL(error) << "Database connection failed in InternetUsageStatistics!";
-    }
-    assert(retval == SQLITE_OK);
-    BOOST_LOG_TRIVIAL(info) << "SQLite connection to " << dbPath
-                            << " successfully established in InternetUsageStatistics!";
+InternetUsageStatistics::InternetUsageStatistics(std::string dbPath) : _percentByCountry() {
+    std::vector<std::string> countryNames;
+    std::string countryQueryString(" SELECT DISTINCT country FROM rel_country_to_un");
+    sqlite3_stmt* countryStmt = Database::acquire(dbPath, countryQueryString);
+    assert(countryStmt);
+    while (step(countryStmt) == SQLITE_ROW)
+        countryNames.push_back(reinterpret_cast<const char*>(sqlite3_column_text(countryStmt, 0)));
+    Database::release(countryStmt);
 
     std::string queryString(
         " SELECT value FROM unbroadbandstats as un,"
@@ -53,17 +54,49 @@ InternetUsageStatistics::InternetUsageStatistics(std::string dbPath) {
         " GROUP BY un.country_or_area"
         " HAVING max(year)");
 
-    assert(sqlite3_prepare_v2(_sqliteDB, queryString.c_str(), queryString.size(), &_stmt, NULL) == SQLITE_OK);
+    if (!prepare(dbPath, queryString)) {
+        BOOST_LOG_TRIVIAL(error) << "Database query failed in InternetUsageStatistics!";
+    }
+    assert(_stmt);
+
+    // run the per country query once for every known country, keeps the row selection of the original lookup
+    StringInterner& countries = Interned::countries();
+    for (std::string& countryName : countryNames) {
+        unsigned id = countries.intern(countryName);
+        if (id >= _percentByCountry.size())
+            _percentByCountry.resize(id + 1, 0.0);
+
+        int retval = sqlite3_bind_text(_stmt, 1, countryName.c_str(), countryName.size(), NULL);
+        assert(retval == SQLITE_OK);
+        if (step() == SQLITE_ROW)
+            _percentByCountry[id] = sqlite3_column_double(_stmt, 0);
+        sqlite3_reset(_stmt);
+    }
+
+    BOOST_LOG_TRIVIAL(info) << "InternetUsageStatistics: loaded statistics for " << countryNames.size()
+                            << " countries";
 }
 
 // returns percent of population with Internet access in this country
 // 0.0 if not found
-double InternetUsageStatistics::operator[](std::string& countryName) {
-    assert(sqlite3_bind_text(_stmt, 1, countryName.c_str(), countryName.size(), NULL) == SQLITE_OK);
-    int retval = sqlite3_step(_stmt);
-    double result = 0.0;
-    if (retval == SQLITE_ROW)
-        result = sqlite3_column_double(_stmt, 0);
-    sqlite3_reset(_stmt);
-    return result;
+double InternetUsageStatistics::operator[](unsigned countryId) const {
+    if (countryId >= _percentByCountry.size())
+        return 0.0;
+    return _percentByCountry[countryId];
+}
+
+double InternetUsageStatistics::operator[](const std::string& countryName) const {
+    unsigned id;
+    if (!Interned::countries().find(countryName, id))
+        return 0.0;
+    return (*this)[id];
+}
+
+std::string InternetUsageStatistics::serialize(void) const {
+    std::stringstream ss;
+    ss << std::setprecision(std::numeric_limits<double>::max_digits10);
+    for (unsigned id : Interned::countries().sortedIds())
+        if (id < _percentByCountry.size())
+            ss << Interned::countries().str(id) << "=" << _percentByCountry[id] << ";";
+    return ss.str();
 }
@@ -31,15 +31,28 @@
 #define INTERNETUSAGESTATISTICS_HPP
 
 #include "SQLiteReader.hpp"
+#include <memory>
 #include <string>
+#include <vector>
 
+class InternetUsageStatistics;
+typedef std::shared_ptr<InternetUsageStatistics> InternetUsageStatistics_Ptr;
+
+// all statistics are read once on construction, lookups do not touch the database
 class InternetUsageStatistics : public SQLiteReader {
    public:
     InternetUsageStatistics(std::string dbPath);
 
-    double operator[](std::string& countryName);
+    // countryId as given by Interned::countries()
+    double operator[](unsigned countryId) const;
+    double operator[](const std::string& countryName) const;
+
+    // all statistics as text in country name order, e.g. for cache keys
+    std::string serialize(void) const;
 
    private:
+    // percent of population with Internet access, indexed by interned country id
+    std::vector<double> _percentByCountry;
 };
 
 #endif
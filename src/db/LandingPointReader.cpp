@@ -33,19 +33,17 @@
 #include <cassert>
 #include <iostream>
 
-LandingPointReader::LandingPointReader(std::string dbName) {
-    int retval = sqlite3_open(dbName.c_str(), &_sqliteDB);
-
-    // If connection failed, handle returns NULL
-    if (retval) {
-        BOOST_LOG_TRIVIAL(error) << "Database connection failed in LandingPointReader!";
-    }
-    BOOST_LOG_TRIVIAL(info) << "SQLite connection to " << dbName << " successfully established in LandingPointReader!";
-
+LandingPointReader::LandingPointReader(std::string dbName, const GeoRegion& region) : _dbName(dbName) {
     std::string queryString("SELECT id, latitude, longitude, name, country from landingpoints");
+    if (!region.isGlobal())
+        queryString += " WHERE " + regionCondition(region, "latitude", "longitude");
 
-    sqlite3_prepare_v2(_sqliteDB, queryString.c_str(), queryString.length(), &_stmt, NULL);
-    retval = sqlite3_step(_stmt);
+    if (!prepare(dbName, queryString)) {
+        BOOST_LOG_TRIVIAL(error) << "Database query failed in LandingPointReader!";
+    }
+    if (!region.isGlobal())
+        bindRegion(region, 1);
+    int retval = step();
     _rowAvailable = false;
     if (retval == SQLITE_ROW)
         _rowAvailable = true;
@@ -62,7 +60,7 @@ SeaCableLandingPoint LandingPointReader::getNext() {
 
     SeaCableLandingPoint landpoint(id, lat, lon, name);
 
-    int retval = sqlite3_step(_stmt);
+    int retval = step();
     if (retval == SQLITE_ROW)
         _rowAvailable = true;
     else
@@ -72,21 +70,22 @@ SeaCableLandingPoint LandingPointReader::getNext() {
 }
 
 std::string LandingPointReader::getContinentLandingPoint(std::string name) {
-    sqlite3_stmt* stmt;
-
-    std::string queryString =
+    static const std::string queryString =
         "SELECT continent from countryinfo as ci, rel_landingpoint_to_countryinfo as lp where lp.country_landing = ? "
         "AND lp.country_countryinfo = ci.country";
 
-    sqlite3_prepare_v2(_sqliteDB, queryString.c_str(), queryString.length(), &stmt, NULL);
+    // prepared once per thread, later calls take it from the statement cache
+    sqlite3_stmt* stmt = Database::acquire(_dbName, queryString);
+    assert(stmt);
 
-    assert(sqlite3_bind_text(stmt, 1, name.c_str(), name.size(), NULL) == SQLITE_OK);
-    int retval = sqlite3_step(stmt);
+    int retval = sqlite3_bind_text(stmt, 1, name.c_str(), name.size(), NULL);
+    assert(retval == SQLITE_OK);
+    retval = step(stmt);
     std::string result;
     if (retval == SQLITE_ROW)
         result = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
 
-    sqlite3_finalize(stmt);
+    Database::release(stmt);
 
     return result;
 }
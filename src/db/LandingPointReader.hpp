@@ -37,11 +37,14 @@
 
 class LandingPointReader : public SQLiteReader, public ResultIterator<SeaCableLandingPoint> {
    public:
-    LandingPointReader(std::string dbName);
+    // only the landing points inside region are read
+    LandingPointReader(std::string dbName, const GeoRegion& region = GeoRegion());
     SeaCableLandingPoint getNext();
 
    private:
     std::string getContinentLandingPoint(std::string name);
+
+    std::string _dbName;
 };
 
 #endif
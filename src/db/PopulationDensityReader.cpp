@@ -29,8 +29,10 @@
 
 #include "PopulationDensityReader.hpp"
 
+#include "config/Config.hpp"
 #include "config/PredefinedValues.hpp"
 #include "util/Util.hpp"
+#include <boost/log/trivial.hpp>
 #include <cassert>
 #include <cmath>
 #include <cstdint>
@@ -45,16 +47,107 @@
 #include <unistd.h>
 
 PopulationDensityReader::PopulationDensityReader(void)
-    : _file(open(PredefinedValues::popDensityFilePath().c_str(), O_RDONLY)), _header(), _data(nullptr) {
+    : _file(-1),
+      _header(),
+      _data(nullptr),
+      _raster(nullptr),
+      _tileData(nullptr),
+      _tileDataSize(0),
+      _levels() {
+    std::unique_ptr<Config> config(new Config);
+    open(config->get<bool>("populationDensity.tiled"));
+}
+
+PopulationDensityReader::PopulationDensityReader(bool tiled)
+    : _file(-1),
+      _header(),
+      _data(nullptr),
+      _raster(nullptr),
+      _tileData(nullptr),
+      _tileDataSize(0),
+      _levels() {
+    open(tiled);
+}
+
+void PopulationDensityReader::open(bool tiled) {
+    if (tiled && openTiles())
+        return;
+    if (tiled)
+        BOOST_LOG_TRIVIAL(warning) << "no valid " << PredefinedValues::popDensityTilesFilePath()
+                                   << ", reading the flat population density raster, see topoGen-tiles";
+
+    _file = ::open(PredefinedValues::popDensityFilePath().c_str(), O_RDONLY);
     assert(_file != -1);
     parseHeader();
     readData();
+
+    _raster = _data + sizeof(FileHeader) / sizeof(double);
+    _levels.push_back(Level{_header.nrows, _header.ncols, 0, _header.cellsize, nullptr});
+}
+
+bool PopulationDensityReader::openTiles(void) {
+    using namespace PopulationDensityTiles;
+
+    int fd = ::open(PredefinedValues::popDensityTilesFilePath().c_str(), O_RDONLY);
+    if (fd == -1)
+        return false;
+
+    struct stat st;
+    const size_t headerSize = sizeof(TilesHeader) + MAX_LEVELS * sizeof(LevelHeader);
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < headerSize) {
+        ::close(fd);
+        return false;
+    }
+
+    void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED)
+        return false;
+    _tileData = static_cast<const char*>(data);
+    _tileDataSize = st.st_size;
+
+    const TilesHeader& tiles = *reinterpret_cast<const TilesHeader*>(_tileData);
+    const LevelHeader* levels = reinterpret_cast<const LevelHeader*>(_tileData + sizeof(TilesHeader));
+    bool valid = memcmp(tiles.magic, MAGIC, sizeof(MAGIC)) == 0 && tiles.version == VERSION &&
+                 tiles.tileSize == TILE_SIZE && tiles.levels > 0 && tiles.levels <= MAX_LEVELS;
+    for (uint32_t k = 0; valid && k < tiles.levels; ++k) {
+        uint64_t size = uint64_t(levels[k].tileRows) * levels[k].tileCols * TILE_SIZE * TILE_SIZE * sizeof(float);
+        valid = levels[k].offset + size <= _tileDataSize;
+    }
+    if (!valid) {
+        munmap(const_cast<char*>(_tileData), _tileDataSize);
+        _tileData = nullptr;
+        _tileDataSize = 0;
+        return false;
+    }
+
+    // the header of level 0 keeps the corners and cells of popdensity.bin
+    _header.ncols = levels[0].ncols;
+    _header.nrows = levels[0].nrows;
+    _header.xllcorner = tiles.xllcorner;
+    _header.yllcorner = tiles.yllcorner;
+    _header.cellsize = tiles.cellsize;
+    _header.NODATA_value = tiles.nodata;
+
+    for (uint32_t k = 0; k < tiles.levels; ++k) {
+        const LevelHeader& level = levels[k];
+        _levels.push_back(Level{static_cast<int>(level.nrows), static_cast<int>(level.ncols),
+                                static_cast<int>(level.tileCols), level.cellsize,
+                                reinterpret_cast<const float*>(_tileData + level.offset)});
+    }
+
+    BOOST_LOG_TRIVIAL(info) << "population density from " << tiles.levels << " tiled levels";
+    return true;
 }
 
 double PopulationDensityReader::cellsize(void) {
     return _header.cellsize;
 }
 
+const FileHeader& PopulationDensityReader::header(void) {
+    return _header;
+}
+
 CellPosition PopulationDensityReader::getRasterPosition(double lat, double lon) {
     CellPosition result;
 
@@ -72,8 +165,7 @@ double PopulationDensityReader::valueAt(double lat, double lon) {
     if (row == -1)  // out of bounds
         return _header.NODATA_value;
 
-    int offset = sizeof(FileHeader) / sizeof(double);
-    return _data[offset + row * _header.ncols + col];
+    return cell(row, col);
 }
 
 double PopulationDensityReader::valueAt(int row, int col) {
@@ -82,14 +174,17 @@ double PopulationDensityReader::valueAt(int row, int col) {
     if (col < 0 || _header.ncols <= col)  // out of bounds
         return _header.NODATA_value;
 
-    int offset = sizeof(FileHeader) / sizeof(double);
-    return _data[offset + row * _header.ncols + col];
+    return cell(row, col);
 }
 
 PopulationDensityReader::~PopulationDensityReader(void) {
-    munmap(_data, getDataSize());
+    if (_tileData)
+        munmap(const_cast<char*>(_tileData), _tileDataSize);
+    if (_data)
+        munmap(_data, getDataSize() + sizeof(FileHeader));
     _data = nullptr;
-    close(_file);
+    if (_file != -1)
+        close(_file);
 }
 
 void PopulationDensityReader::parseHeader(void) {
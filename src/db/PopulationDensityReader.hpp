@@ -30,7 +30,11 @@
 #ifndef POPULATIONDENSITYREADER_HPP
 #define POPULATIONDENSITYREADER_HPP
 
+#include "PopulationDensityTiles.hpp"
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <string>
 #include <vector>
 
 class PopulationDensityReader;
@@ -51,15 +55,47 @@ struct FileHeader {
 
 class PopulationDensityReader {
    public:
+    // tiled as configured in populationDensity.tiled
     PopulationDensityReader();
+
+    // tiled reads popdensity.tiles (see PopulationDensityTiles.hpp) and falls back to popdensity.bin without it
+    PopulationDensityReader(bool tiled);
+
     double valueAt(double lat, double lon);
     double valueAt(int x, int y);
     double cellsize(void);
     ~PopulationDensityReader();
     CellPosition getRasterPosition(double lat, double lon);
+    const FileHeader& header(void);
+
+    // level 0 has the cells of popdensity.bin, every further level of a tiled reader half its rows and columns
+    unsigned levels(void) const { return _levels.size(); }
+    double cellsize(unsigned level) const { return _levels[level].cellsize; }
+
+    // cell of a level, row 0 is the northernmost. The cell of level 0 at (row, col) lies in (row >> level,
+    // col >> level).
+    double cell(int row, int col, unsigned level = 0) const {
+        const Level& l = _levels[level];
+        if (!l.tiles)
+            return _raster[static_cast<size_t>(row) * l.ncols + col];
+
+        using PopulationDensityTiles::TILE_SIZE;
+        size_t tile = static_cast<size_t>(row / TILE_SIZE) * l.tileCols + col / TILE_SIZE;
+        return l.tiles[tile * TILE_SIZE * TILE_SIZE + (row % TILE_SIZE) * TILE_SIZE + col % TILE_SIZE];
+    }
 
    protected:
    private:
+    struct Level {
+        int nrows;
+        int ncols;
+        int tileCols;
+        double cellsize;
+        const float* tiles;  /// < nullptr for the raster of popdensity.bin
+    };
+
+    void open(bool tiled);
+    bool openTiles(void);
     void parseHeader();
     void readData();
     size_t getDataSize();
@@ -69,6 +105,11 @@ class PopulationDensityReader {
     FileHeader _header;
 
     double* _data;
+    const double* _raster;  /// < past the header of _data
+
+    const char* _tileData;
+    size_t _tileDataSize;
+    std::vector<Level> _levels;
 
     PopulationDensityReader(const PopulationDensityReader&) = delete;
     PopulationDensityReader& operator=(const PopulationDensityReader&) = delete;
@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "PopulationDensityTiles.hpp"
+
+#include "PopulationDensityReader.hpp"
+#include <boost/log/trivial.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+namespace PopulationDensityTiles {
+
+namespace {
+
+uint32_t tilesFor(uint32_t cells) {
+    return (cells + TILE_SIZE - 1) / TILE_SIZE;
+}
+
+// row-major grid of one level
+struct Grid {
+    uint32_t nrows;
+    uint32_t ncols;
+    std::vector<float> values;
+};
+
+// mean of the valid cells below each cell of the next level
+Grid downsample(const Grid& grid, float nodata) {
+    Grid next;
+    next.nrows = (grid.nrows + 1) / 2;
+    next.ncols = (grid.ncols + 1) / 2;
+    next.values.assign(static_cast<size_t>(next.nrows) * next.ncols, nodata);
+
+    for (uint32_t row = 0; row < next.nrows; ++row) {
+        for (uint32_t col = 0; col < next.ncols; ++col) {
+            double sum = 0.0;
+            int valid = 0;
+            for (uint32_t r = 2 * row; r < std::min(grid.nrows, 2 * row + 2); ++r) {
+                for (uint32_t c = 2 * col; c < std::min(grid.ncols, 2 * col + 2); ++c) {
+                    float value = grid.values[static_cast<size_t>(r) * grid.ncols + c];
+                    if (value >= 0.0f) {
+                        sum += value;
+                        ++valid;
+                    }
+                }
+            }
+            if (valid > 0)
+                next.values[static_cast<size_t>(row) * next.ncols + col] = static_cast<float>(sum / valid);
+        }
+    }
+    return next;
+}
+
+bool writeTiles(FILE* file, const Grid& grid, float nodata) {
+    std::vector<float> tile(TILE_SIZE * TILE_SIZE);
+    for (uint32_t tileRow = 0; tileRow < tilesFor(grid.nrows); ++tileRow) {
+        for (uint32_t tileCol = 0; tileCol < tilesFor(grid.ncols); ++tileCol) {
+            std::fill(tile.begin(), tile.end(), nodata);
+            for (uint32_t r = 0; r < TILE_SIZE && tileRow * TILE_SIZE + r < grid.nrows; ++r) {
+                size_t row = tileRow * TILE_SIZE + r;
+                for (uint32_t c = 0; c < TILE_SIZE && tileCol * TILE_SIZE + c < grid.ncols; ++c)
+                    tile[r * TILE_SIZE + c] = grid.values[row * grid.ncols + tileCol * TILE_SIZE + c];
+            }
+            if (fwrite(tile.data(), sizeof(float), tile.size(), file) != tile.size())
+                return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+bool write(PopulationDensityReader& reader, const std::string& filename) {
+    const FileHeader& header = reader.header();
+    const float nodata = header.NODATA_value;
+
+    Grid grid;
+    grid.nrows = header.nrows;
+    grid.ncols = header.ncols;
+    grid.values.resize(static_cast<size_t>(grid.nrows) * grid.ncols);
+    for (uint32_t row = 0; row < grid.nrows; ++row) {
+        for (uint32_t col = 0; col < grid.ncols; ++col)
+            grid.values[static_cast<size_t>(row) * grid.ncols + col] = reader.cell(row, col);
+    }
+
+    // levels down to the one that fits into a single tile
+    TilesHeader tilesHeader = TilesHeader();
+    std::copy(MAGIC, MAGIC + sizeof(MAGIC), tilesHeader.magic);
+    tilesHeader.version = VERSION;
+    tilesHeader.tileSize = TILE_SIZE;
+    tilesHeader.xllcorner = header.xllcorner;
+    tilesHeader.yllcorner = header.yllcorner;
+    tilesHeader.cellsize = header.cellsize;
+    tilesHeader.nodata = header.NODATA_value;
+
+    std::vector<LevelHeader> levels;
+    uint64_t offset = sizeof(TilesHeader) + MAX_LEVELS * sizeof(LevelHeader);
+    uint32_t nrows = grid.nrows;
+    uint32_t ncols = grid.ncols;
+    double cellsize = header.cellsize;
+    while (levels.size() < MAX_LEVELS) {
+        LevelHeader level = LevelHeader();
+        level.nrows = nrows;
+        level.ncols = ncols;
+        level.tileRows = tilesFor(nrows);
+        level.tileCols = tilesFor(ncols);
+        level.cellsize = cellsize;
+        level.offset = offset;
+        levels.push_back(level);
+
+        offset += uint64_t(level.tileRows) * level.tileCols * TILE_SIZE * TILE_SIZE * sizeof(float);
+        if (nrows <= TILE_SIZE && ncols <= TILE_SIZE)
+            break;
+        nrows = (nrows + 1) / 2;
+        ncols = (ncols + 1) / 2;
+        cellsize *= 2.0;
+    }
+    tilesHeader.levels = levels.size();
+    levels.resize(MAX_LEVELS, LevelHeader());
+
+    FILE* file = fopen(filename.c_str(), "wb");
+    if (!file) {
+        BOOST_LOG_TRIVIAL(error) << "could not open " << filename;
+        return false;
+    }
+
+    bool written = fwrite(&tilesHeader, sizeof(tilesHeader), 1, file) == 1 &&
+                   fwrite(levels.data(), sizeof(LevelHeader), levels.size(), file) == levels.size();
+    for (uint32_t level = 0; written && level < tilesHeader.levels; ++level) {
+        written = writeTiles(file, grid, nodata);
+        BOOST_LOG_TRIVIAL(info) << "level " << level << ": " << grid.nrows << " x " << grid.ncols << " cells";
+        if (level + 1 < tilesHeader.levels)
+            grid = downsample(grid, nodata);
+    }
+
+    written = fclose(file) == 0 && written;
+    if (!written)
+        BOOST_LOG_TRIVIAL(error) << "could not write " << filename;
+    return written;
+}
+
+}  // namespace PopulationDensityTiles
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef POPULATIONDENSITYTILES_HPP
+#define POPULATIONDENSITYTILES_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+class PopulationDensityReader;
+
+// Tiled copy of popdensity.bin with a resolution pyramid, written by topoGen-tiles and read by
+// PopulationDensityReader. Level 0 has the cells of the raster, every further level halves rows and columns and holds
+// the mean of the valid cells below it. All values are float32 in host byte order:
+//   TilesHeader
+//   LevelHeader[levels]
+//   per level, at its offset: tileRows * tileCols tiles of TILE_SIZE * TILE_SIZE values, tiles and the values in a
+//   tile row by row from the north, cells outside the raster hold nodata
+namespace PopulationDensityTiles {
+
+const char MAGIC[8] = {'t', 'o', 'p', 'o', 'G', 'e', 'n', 'T'};
+const uint32_t VERSION = 1;
+const uint32_t TILE_SIZE = 256;
+const uint32_t MAX_LEVELS = 8;
+
+struct TilesHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t levels;
+    uint32_t tileSize;
+    uint32_t reserved;
+    double xllcorner;
+    double yllcorner;
+    double cellsize;  /// < of level 0
+    double nodata;
+};
+
+struct LevelHeader {
+    uint32_t nrows;
+    uint32_t ncols;
+    uint32_t tileRows;
+    uint32_t tileCols;
+    double cellsize;
+    uint64_t offset;
+};
+
+static_assert(sizeof(TilesHeader) == 56, "unexpected padding in TilesHeader");
+static_assert(sizeof(LevelHeader) == 32, "unexpected padding in LevelHeader");
+
+// converts the raster of a flat reader, false if the file can not be written
+bool write(PopulationDensityReader& reader, const std::string& filename);
+
+}  // namespace PopulationDensityTiles
+
+#endif  // POPULATIONDENSITYTILES_HPP
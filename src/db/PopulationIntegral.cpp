@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "PopulationIntegral.hpp"
+
+#include "geo/GeometricHelpers.hpp"
+#include <boost/log/trivial.hpp>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+PopulationIntegral::PopulationIntegral(PopulationDensityReader& reader, unsigned factor)
+    : _nrows(0), _ncols(0), _cellsize(0.0), _minLat(0.0), _minLon(0.0), _global(false), _table() {
+    using namespace GeometricHelpers;
+    assert(factor > 0);
+    const FileHeader& header = reader.header();
+
+    _nrows = (header.nrows + factor - 1) / factor;
+    _ncols = (header.ncols + factor - 1) / factor;
+    _cellsize = header.cellsize * factor;
+    _minLat = header.yllcorner;
+    _minLon = header.xllcorner;
+    _global = fabs(header.cellsize * header.ncols - 360.0) < 1e-6;
+
+    // people per block, the raster holds people per square km and its rows start in the north
+    std::vector<double> people(static_cast<size_t>(_nrows) * _ncols, 0.0);
+    const double cellKM = sphericalDistToKM(deg2rad(header.cellsize));
+    for (int row = 0; row < header.nrows; ++row) {
+        double lat = header.yllcorner + (header.nrows - row - 0.5) * header.cellsize;
+        double area = cellKM * cellKM * cos(deg2rad(lat));
+        double* block = &people[static_cast<size_t>((header.nrows - 1 - row) / factor) * _ncols];
+        for (int col = 0; col < header.ncols; ++col) {
+            double density = reader.cell(row, col);
+            if (density > 0.0)
+                block[col / factor] += density * area;
+        }
+    }
+
+    _table.assign(static_cast<size_t>(_nrows + 1) * (_ncols + 1), 0.0);
+    for (int row = 0; row < _nrows; ++row) {
+        double rowSum = 0.0;
+        for (int col = 0; col < _ncols; ++col) {
+            rowSum += people[static_cast<size_t>(row) * _ncols + col];
+            _table[static_cast<size_t>(row + 1) * (_ncols + 1) + col + 1] =
+                _table[static_cast<size_t>(row) * (_ncols + 1) + col + 1] + rowSum;
+        }
+    }
+
+    BOOST_LOG_TRIVIAL(info) << "population integral of " << _nrows << " x " << _ncols << " cells, "
+                            << _table.back() << " people";
+}
+
+double PopulationIntegral::cellsize(void) const {
+    return _cellsize;
+}
+
+double PopulationIntegral::sum(int row0, int row1, int col0, int col1) const {
+    row0 = std::max(row0, 0);
+    row1 = std::min(row1, _nrows - 1);
+    col0 = std::max(col0, 0);
+    col1 = std::min(col1, _ncols - 1);
+    if (row0 > row1 || col0 > col1)
+        return 0.0;
+
+    const size_t stride = _ncols + 1;
+    return _table[(row1 + 1) * stride + col1 + 1] - _table[row0 * stride + col1 + 1] -
+           _table[(row1 + 1) * stride + col0] + _table[row0 * stride + col0];
+}
+
+double PopulationIntegral::rowLat(int row) const {
+    return _minLat + (row + 0.5) * _cellsize;
+}
+
+double PopulationIntegral::span(int row0, int row1, double minLon, double maxLon) const {
+    if (maxLon < minLon)
+        return 0.0;
+    if (_global && maxLon - minLon >= 360.0)
+        return sum(row0, row1, 0, _ncols - 1);
+
+    // first and last column with its center inside
+    int col0 = static_cast<int>(ceil((minLon - _minLon) / _cellsize - 0.5));
+    int col1 = static_cast<int>(floor((maxLon - _minLon) / _cellsize - 0.5));
+    if (!_global)
+        return sum(row0, row1, col0, col1);
+
+    // wrap into [0, _ncols), a span crossing the date line is split
+    int shift = static_cast<int>(floor(static_cast<double>(col0) / _ncols)) * _ncols;
+    col0 -= shift;
+    col1 -= shift;
+    if (col1 < _ncols)
+        return sum(row0, row1, col0, col1);
+    return sum(row0, row1, col0, _ncols - 1) + sum(row0, row1, 0, col1 - _ncols);
+}
+
+double PopulationIntegral::box(double minLat, double maxLat, double minLon, double maxLon) const {
+    int row0 = static_cast<int>(ceil((minLat - _minLat) / _cellsize - 0.5));
+    int row1 = static_cast<int>(floor((maxLat - _minLat) / _cellsize - 0.5));
+    return span(row0, row1, minLon, maxLon);
+}
+
+double PopulationIntegral::cap(GeographicPosition& center, double radius) const {
+    using namespace GeometricHelpers;
+    double lat0 = deg2rad(center.lat());
+    double radiusDeg = rad2deg(radius);
+
+    int row0 = static_cast<int>(ceil((center.lat() - radiusDeg - _minLat) / _cellsize - 0.5));
+    int row1 = static_cast<int>(floor((center.lat() + radiusDeg - _minLat) / _cellsize - 0.5));
+
+    // cos(radius) = sin(lat) sin(lat0) + cos(lat) cos(lat0) cos(dLon) on the boundary
+    double people = 0.0;
+    for (int row = std::max(row0, 0); row <= std::min(row1, _nrows - 1); ++row) {
+        double lat = deg2rad(rowLat(row));
+        double denominator = cos(lat) * cos(lat0);
+        double cosDLon = denominator > 0.0 ? (cos(radius) - sin(lat) * sin(lat0)) / denominator : -1.0;
+        if (cosDLon > 1.0)
+            continue;
+
+        double dLon = cosDLon < -1.0 ? 180.0 : rad2deg(acos(cosDLon));
+        people += span(row, row, center.lon() - dLon, center.lon() + dLon);
+    }
+    return people;
+}
+
+double PopulationIntegral::lune(GeographicPosition& p1, GeographicPosition& p2, double beta) const {
+    using namespace GeometricHelpers;
+    assert(beta > 0.0 && beta <= 1.0);
+
+    GeographicPositionTuple mid = getMidPointCoordinates(p1, p2);
+    double scale = cos(deg2rad(mid.first));
+    if (scale < 1e-6)
+        return 0.0;
+
+    // endpoints in degrees around the midpoint, x along the latitude scaled to the distances at the midpoint
+    auto wrap = [](double dLon) { return dLon - 360.0 * floor((dLon + 180.0) / 360.0); };
+    double x1 = wrap(p1.lon() - mid.second) * scale;
+    double y1 = p1.lat() - mid.first;
+    double x2 = wrap(p2.lon() - mid.second) * scale;
+    double y2 = p2.lat() - mid.first;
+    double c = sqrt((x2 - x1) * (x2 - x1) + (y2 - y1) * (y2 - y1));
+    if (c == 0.0)
+        return 0.0;
+
+    // the lune is the intersection of two disks through both endpoints, centered on opposite sides of the chord
+    double r = c / (2.0 * beta);
+    double d = sqrt(std::max(0.0, r * r - 0.25 * c * c));
+    double nx = -(y2 - y1) / c;
+    double ny = (x2 - x1) / c;
+    double cx[2] = {d * nx, -d * nx};
+    double cy[2] = {d * ny, -d * ny};
+
+    double halfHeight = 0.5 * c * fabs(ny) + (r - d) * fabs(nx);
+    int row0 = static_cast<int>(ceil((mid.first - halfHeight - _minLat) / _cellsize - 0.5));
+    int row1 = static_cast<int>(floor((mid.first + halfHeight - _minLat) / _cellsize - 0.5));
+
+    double people = 0.0;
+    for (int row = std::max(row0, 0); row <= std::min(row1, _nrows - 1); ++row) {
+        double y = rowLat(row) - mid.first;
+        double minX = -std::numeric_limits<double>::max();
+        double maxX = std::numeric_limits<double>::max();
+        bool inside = true;
+        for (int k = 0; k < 2 && inside; ++k) {
+            double dy = y - cy[k];
+            inside = fabs(dy) <= r;
+            if (inside) {
+                double dx = sqrt(r * r - dy * dy);
+                minX = std::max(minX, cx[k] - dx);
+                maxX = std::min(maxX, cx[k] + dx);
+            }
+        }
+        if (inside && minX <= maxX)
+            people += span(row, row, mid.second + minX / scale, mid.second + maxX / scale);
+    }
+    return people;
+}
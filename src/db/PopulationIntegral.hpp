@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef POPULATIONINTEGRAL_HPP
+#define POPULATIONINTEGRAL_HPP
+
+#include "db/PopulationDensityReader.hpp"
+#include "geo/GeographicPosition.hpp"
+#include <memory>
+#include <vector>
+
+class PopulationIntegral;
+typedef std::shared_ptr<PopulationIntegral> PopulationIntegral_Ptr;
+
+// summed-area table of the people in the population density raster (density times cell area). Sums over boxes cost
+// four lookups, caps and lunes are sums over one box per row of cells. A cell counts when its center is inside.
+class PopulationIntegral {
+   public:
+    // cells are blocks of factor x factor raster cells
+    PopulationIntegral(PopulationDensityReader& reader, unsigned factor);
+
+    // degrees, longitudes past +-180 wrap around if the raster covers all longitudes
+    double box(double minLat, double maxLat, double minLon, double maxLon) const;
+
+    // radius in radians
+    double cap(GeographicPosition& center, double radius) const;
+
+    // points that see p1 and p2 under an angle of at least pi - asin(beta), beta <= 1, the area of
+    // PopulationDensityFilter. Approximated in an equirectangular projection around the midpoint.
+    double lune(GeographicPosition& p1, GeographicPosition& p2, double beta) const;
+
+    double cellsize(void) const;
+
+   private:
+    // people in rows [row0, row1] and columns [col0, col1] of cells
+    double sum(int row0, int row1, int col0, int col1) const;
+
+    // people in rows [row0, row1] of the cells with centers in [minLon, maxLon]
+    double span(int row0, int row1, double minLon, double maxLon) const;
+
+    double rowLat(int row) const;
+
+    int _nrows;  /// < row 0 is the southernmost
+    int _ncols;
+    double _cellsize;
+    double _minLat;
+    double _minLon;
+    bool _global;  /// < columns cover all longitudes
+
+    // (_nrows + 1) x (_ncols + 1), entry (r, c) holds the people in rows < r and columns < c
+    std::vector<double> _table;
+};
+
+#endif  // POPULATIONINTEGRAL_HPP
@@ -36,16 +36,6 @@
 
 SQLiteAreaPopulationReader::SQLiteAreaPopulationReader(std::string dbPath, double lat, double lon, double length)
     : _lat(lat), _lon(lon), _length(length) {
-    int retval = sqlite3_open(dbPath.c_str(), &_sqliteDB);
-
-    // If connection failed, handle returns NULL
-    if (retval) {
-        BOOST_LOG_TRIVIAL(error) << "Database connection failed in SQLiteAreaPopulationReader";
-    }
-    assert(retval == SQLITE_OK);
-    BOOST_LOG_TRIVIAL(info) << "SQLite connection to " << dbPath
-                            << " successfully established in SQLiteAreaPopulationReader!";
-
     std::string queryString(
         " SELECT geo.Latitude AS Latitude,"
         "        geo.Longitude AS Longitude,"
@@ -59,12 +49,15 @@ SQLiteAreaPopulationReader::SQLiteAreaPopulationReader(std::string dbPath, doubl
         "   AND geo.country_code = ci.iso"
         " ORDER BY Population DESC");
 
-    sqlite3_prepare_v2(_sqliteDB, queryString.c_str(), queryString.length(), &_stmt, NULL);
+    if (!prepare(dbPath, queryString)) {
+        BOOST_LOG_TRIVIAL(error) << "Database query failed in SQLiteAreaPopulationReader";
+    }
+    assert(_stmt);
     sqlite3_bind_double(_stmt, 1, _lat - (length / 2));
     sqlite3_bind_double(_stmt, 2, _lat + (length / 2));
     sqlite3_bind_double(_stmt, 3, _lon - (length / 2));
     sqlite3_bind_double(_stmt, 4, _lon + (length / 2));
-    retval = sqlite3_step(_stmt);
+    int retval = step();
 
     if (retval == SQLITE_ROW) {
         _rowAvailable = true;
@@ -83,7 +76,7 @@ PopulatedPosition SQLiteAreaPopulationReader::getNext() {
 
     PopulatedPosition pp(population, latitude, longitude, country);
 
-    if (sqlite3_step(_stmt) == SQLITE_ROW)
+    if (step() == SQLITE_ROW)
         _rowAvailable = true;
     else {
         _rowAvailable = false;
@@ -29,22 +29,12 @@
 
 #include "SQLiteLocationReader.hpp"
 
+#include "util/StringInterner.hpp"
 #include <boost/log/trivial.hpp>
 #include <cassert>
-#include <iostream>
-#include <sstream>
 
-SQLiteLocationReader::SQLiteLocationReader(std::string dbPath, int populationThreshold)
+SQLiteLocationReader::SQLiteLocationReader(std::string dbPath, int populationThreshold, const GeoRegion& region)
     : _populationThreshold(populationThreshold) {
-    int retval = sqlite3_open(dbPath.c_str(), &_sqliteDB);
-
-    // If connection failed, handle returns NULL
-    if (retval) {
-        BOOST_LOG_TRIVIAL(error) << "Database connection failed for SQLiteLocationReader";
-    }
-    BOOST_LOG_TRIVIAL(info) << "SQLite connection to " << dbPath
-                            << " successfully established in SQLiteLocationReader!";
-
     std::string queryString(
         " SELECT geo.Name AS Name,"
         "        geo.Latitude AS Latitude,"
@@ -54,12 +44,17 @@ SQLiteLocationReader::SQLiteLocationReader(std::string dbPath, int populationThr
         "        ci.continent AS Continent"
         " FROM geoname as geo, countryinfo as ci"
         " WHERE geo.population >= ?"
-        "   AND geo.country_code = ci.iso"
-        " ORDER BY Name");
+        "   AND geo.country_code = ci.iso");
+    if (!region.isGlobal())
+        queryString += " AND " + regionCondition(region, "geo.Latitude", "geo.Longitude");
 
-    sqlite3_prepare_v2(_sqliteDB, queryString.c_str(), queryString.length(), &_stmt, NULL);
+    if (!prepare(dbPath, queryString)) {
+        BOOST_LOG_TRIVIAL(error) << "Database query failed in SQLiteLocationReader";
+    }
     sqlite3_bind_int(_stmt, 1, _populationThreshold);
-    retval = sqlite3_step(_stmt);
+    if (!region.isGlobal())
+        bindRegion(region, 2);
+    int retval = step();
     if (retval == SQLITE_ROW)
         _rowAvailable = true;
     else
@@ -69,29 +64,64 @@ SQLiteLocationReader::SQLiteLocationReader(std::string dbPath, int populationThr
 CityNode SQLiteLocationReader::getNext() {
     assert(_rowAvailable);
 
-    std::stringstream ss;
-    std::string name(reinterpret_cast<const char*>(sqlite3_column_text(_stmt, 0)));
-
-    ss << sqlite3_column_text(_stmt, 1);
-    double latitude;
-    ss >> latitude;
-    ss.str("");
-    ss.clear();
-
-    ss << sqlite3_column_text(_stmt, 2);
-    double longitude;
-    ss >> longitude;
-
+    std::string name(reinterpret_cast<const char*>(sqlite3_column_text(_stmt, 0)), sqlite3_column_bytes(_stmt, 0));
+    double latitude(sqlite3_column_double(_stmt, 1));
+    double longitude(sqlite3_column_double(_stmt, 2));
     double population(sqlite3_column_double(_stmt, 3));
     std::string country(reinterpret_cast<const char*>(sqlite3_column_text(_stmt, 4)));
     std::string continent(reinterpret_cast<const char*>(sqlite3_column_text(_stmt, 5)));
 
     CityNode ci(0, name, latitude, longitude, population, country, continent);
 
-    if (sqlite3_step(_stmt) == SQLITE_ROW)
-        _rowAvailable = true;
-    else {
-        _rowAvailable = false;
-    }
+    _rowAvailable = step() == SQLITE_ROW;
     return ci;
 }
+
+size_t SQLiteLocationReader::readBatch(CityColumns& columns, size_t maxRows) {
+    // consecutive rows mostly share the country, so the last ids are kept to skip the interner
+    std::string lastCountry, lastContinent;
+    unsigned countryId = 0, continentId = 0;
+
+    size_t rows = 0;
+    for (; rows < maxRows && _rowAvailable; ++rows) {
+        const char* country = reinterpret_cast<const char*>(sqlite3_column_text(_stmt, 4));
+        if (rows == 0 || lastCountry != country) {
+            lastCountry = country;
+            countryId = Interned::countries().intern(lastCountry);
+        }
+        const char* continent = reinterpret_cast<const char*>(sqlite3_column_text(_stmt, 5));
+        if (rows == 0 || lastContinent != continent) {
+            lastContinent = continent;
+            continentId = Interned::continents().intern(lastContinent);
+        }
+
+        columns.name.emplace_back(reinterpret_cast<const char*>(sqlite3_column_text(_stmt, 0)),
+                                  sqlite3_column_bytes(_stmt, 0));
+        columns.latitude.push_back(sqlite3_column_double(_stmt, 1));
+        columns.longitude.push_back(sqlite3_column_double(_stmt, 2));
+        columns.population.push_back(sqlite3_column_double(_stmt, 3));
+        columns.countryId.push_back(countryId);
+        columns.continentId.push_back(continentId);
+
+        _rowAvailable = step() == SQLITE_ROW;
+    }
+    return rows;
+}
+
+void CityColumns::clear() {
+    name.clear();
+    latitude.clear();
+    longitude.clear();
+    population.clear();
+    countryId.clear();
+    continentId.clear();
+}
+
+void CityColumns::reserve(size_t rows) {
+    name.reserve(rows);
+    latitude.reserve(rows);
+    longitude.reserve(rows);
+    population.reserve(rows);
+    countryId.reserve(rows);
+    continentId.reserve(rows);
+}
@@ -35,15 +35,35 @@
 #include "SQLiteReader.hpp"
 #include <sqlite3.h>
 #include <string>
+#include <vector>
 
 // http://www.sqlite.org/c3ref/funclist.html
 
+// rows of SQLiteLocationReader column by column, countries and continents as ids in Interned
+struct CityColumns {
+    std::vector<std::string> name;
+    std::vector<double> latitude;
+    std::vector<double> longitude;
+    std::vector<double> population;
+    std::vector<unsigned> countryId;
+    std::vector<unsigned> continentId;
+
+    size_t size() const { return name.size(); }
+    void clear();
+    void reserve(size_t rows);
+};
+
+// cities in table order, callers sort them if they need an order
 class SQLiteLocationReader : public SQLiteReader, public ResultIterator<CityNode> {
    public:
-    SQLiteLocationReader(std::string dbPath, int populationThreshold);
+    // only the cities inside region are read
+    SQLiteLocationReader(std::string dbPath, int populationThreshold, const GeoRegion& region = GeoRegion());
 
     CityNode getNext();
 
+    // appends up to maxRows rows to columns, returns the number of rows read
+    size_t readBatch(CityColumns& columns, size_t maxRows);
+
    private:
     int _populationThreshold;
 };
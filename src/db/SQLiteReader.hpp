@@ -31,17 +31,56 @@
 #define SQLITEREADER_HPP
 
 #include <sqlite3.h>
+#include "Database.hpp"
+#include "geo/GeoRegion.hpp"
+#include "util/Profiler.hpp"
+#include "util/Trace.hpp"
+#include <string>
 
 class SQLiteReader {
    public:
     SQLiteReader() : _sqliteDB(nullptr), _stmt(nullptr) {}
 
-    virtual ~SQLiteReader() {
-        sqlite3_finalize(_stmt);
-        sqlite3_close(_sqliteDB);
-    }
+    // the connection belongs to the thread, only the statement goes back to the cache
+    virtual ~SQLiteReader() { Database::release(_stmt); }
 
    protected:
+    // borrows the connection of this thread to path and a prepared statement for query as _stmt
+    bool prepare(const std::string& path, const std::string& query) {
+        _sqliteDB = Database::connection(path);
+        _stmt = Database::acquire(path, query);
+        return _stmt != nullptr;
+    }
+
+    // sqlite3_step that counts the rows read for the profiler, the trace shows the time spent waiting on SQLite
+    int step(sqlite3_stmt* stmt) {
+        TRACE_SCOPE("sqlite step");
+        int retval = sqlite3_step(stmt);
+        if (retval == SQLITE_ROW)
+            Profiler::count(Profiler::SQLITE_ROWS);
+        return retval;
+    }
+
+    int step() { return step(_stmt); }
+
+    // condition that a latitude and a longitude column lie inside a region, its four parameters are set by bindRegion
+    static std::string regionCondition(const GeoRegion& region, const std::string& latColumn,
+                                       const std::string& lonColumn) {
+        std::string lonCondition = region.minLongitude() <= region.maxLongitude()
+                                       ? lonColumn + " BETWEEN ? AND ?"
+                                       : "(" + lonColumn + " >= ? OR " + lonColumn + " <= ?)";
+        return "(" + latColumn + " BETWEEN ? AND ? AND " + lonCondition + ")";
+    }
+
+    // binds the parameters of a regionCondition starting at index, returns the index after them
+    int bindRegion(const GeoRegion& region, int index) {
+        sqlite3_bind_double(_stmt, index, region.minLatitude());
+        sqlite3_bind_double(_stmt, index + 1, region.maxLatitude());
+        sqlite3_bind_double(_stmt, index + 2, region.minLongitude());
+        sqlite3_bind_double(_stmt, index + 3, region.maxLongitude());
+        return index + 4;
+    }
+
     sqlite3* _sqliteDB;
     sqlite3_stmt* _stmt;
 
@@ -0,0 +1,316 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "SimulationNodeReader.hpp"
+
+#include "output/ReadBuffer.hpp"
+#include <boost/log/trivial.hpp>
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <limits>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char* JSON_DELIMITERS = " \t\r\n,}]";
+static const char* CSV_DELIMITERS = " \t\r\n,";
+
+SimulationNodeReader::SimulationNodeReader(const std::string& filename)
+    : _data(nullptr), _size(0), _pos(0), _csv(false), _firstElement(true), _next(), _mapped(false), _inflated() {
+    // nodes.csv.zst and nodes.csv.gz are CSV as well
+    std::string name = filename;
+    for (const char* suffix : {".zst", ".gz"}) {
+        size_t length = strlen(suffix);
+        if (name.size() > length && name.compare(name.size() - length, length, suffix) == 0)
+            name.resize(name.size() - length);
+    }
+    _csv = name.size() >= 4 && name.compare(name.size() - 4, 4, ".csv") == 0;
+
+    // compressed files are decompressed into memory, plain ones mapped
+    ReadBuffer input(filename);
+    if (input.good() && input.compressed()) {
+        bool read = input.readAll(_inflated);
+        if (!read)
+            BOOST_LOG_TRIVIAL(error) << "could not decompress simulation nodes " << filename;
+        assert(read);
+        _data = _inflated.data();
+        _size = _inflated.size();
+    } else {
+        map(filename);
+    }
+
+    if (!_csv) {
+        bool found = findJSONNodes();
+        if (!found)
+            BOOST_LOG_TRIVIAL(error) << "no nodes array in simulation nodes " << filename;
+        assert(found);
+    }
+    advance();
+}
+
+void SimulationNodeReader::map(const std::string& filename) {
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd == -1)
+        BOOST_LOG_TRIVIAL(error) << "could not open simulation nodes " << filename;
+    assert(fd != -1);
+
+    struct stat st;
+    int retval = fstat(fd, &st);
+    assert(retval == 0);
+    _size = st.st_size;
+
+    // the file is read once from front to back, its pages can be dropped behind the reader
+    if (_size > 0) {
+        void* data = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+        assert(data != MAP_FAILED);
+        madvise(data, _size, MADV_SEQUENTIAL);
+        _data = static_cast<const char*>(data);
+        _mapped = true;
+    }
+    close(fd);
+}
+
+SimulationNodeReader::~SimulationNodeReader() {
+    if (_mapped)
+        munmap(const_cast<char*>(_data), _size);
+}
+
+SimulationNode_Ptr SimulationNodeReader::getNext() {
+    assert(_rowAvailable);
+    SimulationNode_Ptr node = _next;
+    advance();
+    return node;
+}
+
+void SimulationNodeReader::advance(void) {
+    _rowAvailable = _csv ? readCSVNode() : readJSONNode();
+    if (!_rowAvailable)
+        _next.reset();
+}
+
+bool SimulationNodeReader::readCSVNode(void) {
+    while (_pos < _size) {
+        size_t end = _pos;
+        while (end < _size && _data[end] != '\n')
+            ++end;
+
+        size_t line = _pos;
+        skipSpace();
+        bool skip = _pos >= end || _data[_pos] == '#';
+
+        int id = 0;
+        double lat = 0.0;
+        double lon = 0.0;
+        if (!skip) {
+            bool parsed = readInt(id, CSV_DELIMITERS) && consume(',') && readDouble(lat, CSV_DELIMITERS) &&
+                          consume(',') && readDouble(lon, CSV_DELIMITERS) && _pos <= end;
+
+            // the first line may name the columns
+            skip = !parsed && line == 0;
+            if (!parsed && !skip)
+                BOOST_LOG_TRIVIAL(error) << "malformed simulation node at byte " << line;
+            assert(parsed || skip);
+        }
+
+        _pos = end < _size ? end + 1 : end;
+        if (!skip) {
+            _next = SimulationNode_Ptr(new SimulationNode(id, lat, lon));
+            return true;
+        }
+    }
+    return false;
+}
+
+bool SimulationNodeReader::findJSONNodes(void) {
+    // skips all members of the root object up to "nodes"
+    if (!consume('{'))
+        return false;
+
+    std::string key;
+    while (readString(key) && consume(':')) {
+        if (key == "nodes")
+            return consume('[');
+        if (!skipValue() || !consume(','))
+            return false;
+    }
+    return false;
+}
+
+bool SimulationNodeReader::readJSONNode(void) {
+    if (consume(']'))
+        return false;
+    if (!_firstElement) {
+        bool comma = consume(',');
+        assert(comma);
+    }
+    _firstElement = false;
+
+    bool parsed = consume('{');
+    int id = 0;
+    double lat = 0.0;
+    double lon = 0.0;
+    std::string key;
+    if (parsed && !consume('}')) {
+        do {
+            parsed = readString(key) && consume(':');
+            if (!parsed)
+                break;
+
+            if (key == "id")
+                parsed = readInt(id, JSON_DELIMITERS);
+            else if (key == "latitude")
+                parsed = readDouble(lat, JSON_DELIMITERS);
+            else if (key == "longitude")
+                parsed = readDouble(lon, JSON_DELIMITERS);
+            else
+                parsed = skipValue();
+        } while (parsed && consume(','));
+        parsed = parsed && consume('}');
+    }
+
+    if (!parsed)
+        BOOST_LOG_TRIVIAL(error) << "malformed simulation node at byte " << _pos;
+    assert(parsed);
+
+    _next = SimulationNode_Ptr(new SimulationNode(id, lat, lon));
+    return true;
+}
+
+void SimulationNodeReader::skipSpace(void) {
+    while (_pos < _size && (_data[_pos] == ' ' || _data[_pos] == '\t' || _data[_pos] == '\r' || _data[_pos] == '\n'))
+        ++_pos;
+}
+
+bool SimulationNodeReader::consume(char c) {
+    skipSpace();
+    if (_pos < _size && _data[_pos] == c) {
+        ++_pos;
+        return true;
+    }
+    return false;
+}
+
+// keys of the simulation nodes have no escapes, escaped characters are kept as they are
+bool SimulationNodeReader::readString(std::string& str) {
+    if (!consume('"'))
+        return false;
+
+    size_t begin = _pos;
+    while (_pos < _size && _data[_pos] != '"') {
+        if (_data[_pos] == '\\')
+            ++_pos;
+        ++_pos;
+    }
+    if (_pos >= _size)
+        return false;
+
+    str.assign(_data + begin, _pos - begin);
+    ++_pos;
+    return true;
+}
+
+bool SimulationNodeReader::skipValue(void) {
+    skipSpace();
+    if (_pos >= _size)
+        return false;
+
+    std::string str;
+    if (_data[_pos] == '"')
+        return readString(str);
+
+    if (_data[_pos] != '{' && _data[_pos] != '[') {
+        // number, true, false or null
+        size_t begin = _pos;
+        while (_pos < _size && !strchr(JSON_DELIMITERS, _data[_pos]))
+            ++_pos;
+        return _pos > begin;
+    }
+
+    // nested object or array, brackets inside strings do not count
+    int depth = 0;
+    while (_pos < _size) {
+        char c = _data[_pos];
+        if (c == '"') {
+            if (!readString(str))
+                return false;
+            continue;
+        }
+        ++_pos;
+        if (c == '{' || c == '[')
+            ++depth;
+        else if ((c == '}' || c == ']') && --depth == 0)
+            return true;
+    }
+    return false;
+}
+
+// copies the token up to the next delimiter, the mapped file is not zero terminated
+bool SimulationNodeReader::readToken(char* buffer, size_t size, const char* delimiters) {
+    skipSpace();
+    size_t length = 0;
+    while (_pos < _size && !strchr(delimiters, _data[_pos])) {
+        if (length + 1 >= size)
+            return false;
+        buffer[length++] = _data[_pos++];
+    }
+    buffer[length] = '\0';
+    return length > 0;
+}
+
+bool SimulationNodeReader::readInt(int& value, const char* delimiters) {
+    char buffer[32];
+    if (!readToken(buffer, sizeof(buffer), delimiters))
+        return false;
+
+    char* end;
+    value = static_cast<int>(strtol(buffer, &end, 10));
+    if (*end == '\0')
+        return true;
+
+    // integral numbers like 1.0 or 1e3, as Json::Value::asInt takes them
+    double number = strtod(buffer, &end);
+    if (*end != '\0' || number != std::floor(number) || number < std::numeric_limits<int>::min() ||
+        number > std::numeric_limits<int>::max())
+        return false;
+    value = static_cast<int>(number);
+    return true;
+}
+
+bool SimulationNodeReader::readDouble(double& value, const char* delimiters) {
+    char buffer[64];
+    if (!readToken(buffer, sizeof(buffer), delimiters))
+        return false;
+
+    char* end;
+    value = strtod(buffer, &end);
+    return *end == '\0';
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SIMULATIONNODEREADER_HPP
+#define SIMULATIONNODEREADER_HPP
+
+#include "geo/SimulationNode.hpp"
+#include "ResultIterator.hpp"
+#include <string>
+#include <vector>
+
+// reads simulation nodes from a mapped file without building a document. Files ending with .csv hold one
+// "id,latitude,longitude" line per node (an optional header line and lines starting with # are skipped), all other
+// files are JSON of the form {"nodes": [{"id": 1, "latitude": 52.5, "longitude": 13.4}, ...]}. Files compressed with
+// zstd or gzip (e.g. nodes.csv.zst) are decompressed into memory instead.
+class SimulationNodeReader : public ResultIterator<SimulationNode_Ptr> {
+   public:
+    SimulationNodeReader(const std::string& filename);
+    ~SimulationNodeReader();
+
+    SimulationNode_Ptr getNext();
+
+   private:
+    void map(const std::string& filename);
+    void advance(void);
+    bool readCSVNode(void);
+    bool readJSONNode(void);
+    bool findJSONNodes(void);
+
+    // JSON scanning helpers, false on malformed input
+    void skipSpace(void);
+    bool consume(char c);
+    bool readString(std::string& str);
+    bool skipValue(void);
+    bool readToken(char* buffer, size_t size, const char* delimiters);
+    bool readInt(int& value, const char* delimiters);
+    bool readDouble(double& value, const char* delimiters);
+
+    const char* _data;
+    size_t _size;
+    size_t _pos;
+    bool _csv;
+    bool _firstElement;  /// < no comma before the next JSON array element
+    SimulationNode_Ptr _next;
+    bool _mapped;                 /// < _data is mapped, otherwise it points into _inflated
+    std::vector<char> _inflated;  /// < contents of a compressed file
+
+    SimulationNodeReader(const SimulationNodeReader&) = delete;
+    SimulationNodeReader& operator=(const SimulationNodeReader&) = delete;
+};
+
+#endif  // SIMULATIONNODEREADER_HPP
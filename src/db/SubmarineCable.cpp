@@ -30,20 +30,21 @@
 #include "SubmarineCable.hpp"
 
 #include <boost/log/trivial.hpp>
+#include <cassert>
 #include <iostream>
 
-SubmarineCable::SubmarineCable(std::string dbPath) {
-    int retval = sqlite3_open(dbPath.c_str(), &_sqliteDB);
-
-    // If connection failed, handle returns NULL
-    if (retval) {
-        BOOST_LOG_TRIVIAL(error) << "Database connection failed in SubmarineCable!";
-    }
-
+SubmarineCable::SubmarineCable(std::string dbPath, const GeoRegion& region) : _region(region) {
     std::string queryString = "SELECT lat1, lon1, lat2, lon2, link_id FROM submarinecable_edges";
-    sqlite3_prepare_v2(_sqliteDB, queryString.c_str(), queryString.length(), &_stmt, NULL);
+    if (!region.isGlobal())
+        queryString += " WHERE " + regionCondition(region, "lat1", "lon1") + " OR " +
+                       regionCondition(region, "lat2", "lon2");
+    if (!prepare(dbPath, queryString)) {
+        BOOST_LOG_TRIVIAL(error) << "Database query failed in SubmarineCable!";
+    }
+    if (!region.isGlobal())
+        bindRegion(region, bindRegion(region, 1));
 
-    retval = sqlite3_step(_stmt);
+    int retval = step();
     if (retval == SQLITE_ROW)
         _rowAvailable = true;
     else
@@ -57,13 +58,15 @@ SubmarineCableEdge SubmarineCable::getNext() {
     double lon2 = sqlite3_column_double(_stmt, 3);
     int linkID = sqlite3_column_int(_stmt, 4);
 
-    int retval = sqlite3_step(_stmt);
+    int retval = step();
     if (retval == SQLITE_ROW)
         _rowAvailable = true;
     else
         _rowAvailable = false;
 
     SubmarineCableEdge edge(std::make_pair(lat1, lon1), std::make_pair(lat2, lon2), linkID);
+    bool inside = _region.clip(edge.coord1, edge.coord2);
+    assert(inside);
 
     return edge;
 }
@@ -44,10 +44,21 @@ struct SubmarineCableEdge {
     SubmarineCableEdge(GeographicPositionTuple c1, GeographicPositionTuple c2, int lID) : coord1(c1), coord2(c2), linkID(lID) {}
 };
 
+// the segments of one cable, positions [begin, end) in a vector of segments grouped by cable
+struct SubmarineCableSegments {
+    int linkID;
+    size_t begin;
+    size_t end;
+};
+
 class SubmarineCable : public SQLiteReader, public ResultIterator<SubmarineCableEdge> {
    public:
-    SubmarineCable(std::string dbPath);
+    // the segments with an end inside region, clipped to it
+    SubmarineCable(std::string dbPath, const GeoRegion& region = GeoRegion());
     SubmarineCableEdge getNext();
+
+   private:
+    GeoRegion _region;
 };
 
 #endif
@@ -28,6 +28,18 @@
  */
 
 #include "CityNode.hpp"
+#include "util/StringInterner.hpp"
+
+const GeographicNode::Kind CityNode::KIND;
+
+CityNode::CityNode()
+    : GeographicNode(KIND),
+      _name(),
+      _population(),
+      _countryId(Interned::countries().intern("")),
+      _continentId(Interned::continents().intern("")),
+      _seacableLandingPoint() {
+}
 
 CityNode::CityNode(int id,
                    std::string name,
@@ -36,11 +48,26 @@ CityNode::CityNode(int id,
                    double population,
                    std::string country,
                    std::string continent)
-    : GeographicNode(id, lat, lon),
+    : GeographicNode(id, lat, lon, KIND),
+      _name(name),
+      _population(population),
+      _countryId(Interned::countries().intern(country)),
+      _continentId(Interned::continents().intern(continent)),
+      _seacableLandingPoint(false) {
+}
+
+CityNode::CityNode(int id,
+                   const std::string& name,
+                   double lat,
+                   double lon,
+                   double population,
+                   unsigned countryId,
+                   unsigned continentId)
+    : GeographicNode(id, lat, lon, KIND),
       _name(name),
       _population(population),
-      _country(country),
-      _continent(continent),
+      _countryId(countryId),
+      _continentId(continentId),
       _seacableLandingPoint(false) {
 }
 
@@ -49,11 +76,11 @@ std::string CityNode::name(void) {
 }
 
 CityNode::CityNode(const CityNode& other)
-    : GeographicNode(other._id, other._latitude, other._longitude),
+    : GeographicNode(other._id, other._latitude, other._longitude, KIND),
       _name(other._name),
       _population(other._population),
-      _country(other._country),
-      _continent(other._continent),
+      _countryId(other._countryId),
+      _continentId(other._continentId),
       _seacableLandingPoint(other._seacableLandingPoint) {
 }
 
@@ -63,8 +90,8 @@ CityNode& CityNode::operator=(const CityNode& other) {
     this->_latitude = other._latitude;
     this->_longitude = other._longitude;
     this->_population = other._population;
-    this->_country = other._country;
-    this->_continent = other._continent;
+    this->_countryId = other._countryId;
+    this->_continentId = other._continentId;
     this->_seacableLandingPoint = other._seacableLandingPoint;
     return *this;
 }
@@ -73,12 +100,20 @@ double CityNode::population() {
     return _population;
 }
 
-std::string CityNode::country() {
-    return _country;
+const std::string& CityNode::country() {
+    return Interned::countries().str(_countryId);
+}
+
+const std::string& CityNode::continent() {
+    return Interned::continents().str(_continentId);
+}
+
+unsigned CityNode::countryId() {
+    return _countryId;
 }
 
-std::string CityNode::continent() {
-    return _continent;
+unsigned CityNode::continentId() {
+    return _continentId;
 }
 
 bool CityNode::operator<(const CityNode& other) const {
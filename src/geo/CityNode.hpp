@@ -36,7 +36,9 @@
 
 class CityNode : public GeographicNode {
    public:
-    CityNode() : _name(), _population(), _country(), _continent(), _seacableLandingPoint() {}
+    static const Kind KIND = CITY_NODE;
+
+    CityNode();
     CityNode(int id,
              std::string name,
              double lat,
@@ -44,12 +46,24 @@ class CityNode : public GeographicNode {
              double population = 0.0,
              std::string country = "",
              std::string continent = "");
+    // country and continent as ids in Interned::countries() and Interned::continents()
+    CityNode(int id,
+             const std::string& name,
+             double lat,
+             double lon,
+             double population,
+             unsigned countryId,
+             unsigned continentId);
     CityNode(const CityNode& other);
     CityNode& operator=(const CityNode& other);
     std::string name();
     double population();
-    std::string country();
-    std::string continent();
+    const std::string& country();
+    const std::string& continent();
+
+    // ids in Interned::countries() and Interned::continents()
+    unsigned countryId();
+    unsigned continentId();
     bool isSeaCableLandingPoint();
     void setSeaCableLandingPoint();
     bool operator<(const CityNode& other) const;
@@ -57,8 +71,8 @@ class CityNode : public GeographicNode {
    private:
     std::string _name;
     double _population;
-    std::string _country;
-    std::string _continent;
+    unsigned _countryId;
+    unsigned _continentId;
     bool _seacableLandingPoint;
 };
 
@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "GeoRegion.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+GeoRegion::GeoRegion()
+    : _global(true),
+      _minLatitude(-90.0),
+      _maxLatitude(90.0),
+      _minLongitude(-180.0),
+      _maxLongitude(180.0),
+      _width(360.0) {
+}
+
+GeoRegion::GeoRegion(double minLatitude, double maxLatitude, double minLongitude, double maxLongitude)
+    : _global(false),
+      _minLatitude(minLatitude),
+      _maxLatitude(maxLatitude),
+      _minLongitude(minLongitude),
+      _maxLongitude(maxLongitude),
+      _width(0.0) {
+    assert(minLatitude <= maxLatitude);
+    _width = relativeLongitude(maxLongitude);
+    if (minLongitude < maxLongitude && _width == 0.0)
+        _width = 360.0;
+}
+
+GeoRegion GeoRegion::fromConfig(Config_Ptr config) {
+    if (!config->get<bool>("region.enable"))
+        return GeoRegion();
+
+    return GeoRegion(config->get<double>("region.minLatitude"), config->get<double>("region.maxLatitude"),
+                     config->get<double>("region.minLongitude"), config->get<double>("region.maxLongitude"));
+}
+
+double GeoRegion::relativeLongitude(double lon) const {
+    double rel = fmod(lon - _minLongitude, 360.0);
+    return rel < 0.0 ? rel + 360.0 : rel;
+}
+
+// the same comparisons as SQLiteReader::regionCondition
+bool GeoRegion::contains(double lat, double lon) const {
+    if (_global)
+        return true;
+    if (lat < _minLatitude || lat > _maxLatitude)
+        return false;
+    if (_minLongitude <= _maxLongitude)
+        return lon >= _minLongitude && lon <= _maxLongitude;
+    return lon >= _minLongitude || lon <= _maxLongitude;
+}
+
+bool GeoRegion::clip(GeographicPositionTuple& coord1, GeographicPositionTuple& coord2) const {
+    bool inside1 = contains(coord1);
+    bool inside2 = contains(coord2);
+    if (inside1 && inside2)
+        return true;
+    if (!inside1 && !inside2)
+        return false;
+    if (!inside1)
+        std::swap(coord1, coord2);
+
+    // the segment takes the shorter way around, it leaves the box at the first border it crosses
+    double dLat = coord2.first - coord1.first;
+    double dLon = fmod(coord2.second - coord1.second + 540.0, 360.0) - 180.0;
+    double t = 1.0;
+    if (dLat > 0.0)
+        t = std::min(t, (_maxLatitude - coord1.first) / dLat);
+    else if (dLat < 0.0)
+        t = std::min(t, (_minLatitude - coord1.first) / dLat);
+    double rel = std::min(relativeLongitude(coord1.second), _width);
+    if (dLon > 0.0)
+        t = std::min(t, (_width - rel) / dLon);
+    else if (dLon < 0.0)
+        t = std::min(t, -rel / dLon);
+
+    double lon = coord1.second + t * dLon;
+    if (lon > 180.0)
+        lon -= 360.0;
+    else if (lon < -180.0)
+        lon += 360.0;
+    GeographicPositionTuple border(coord1.first + t * dLat, lon);
+
+    coord2 = border;
+    if (!inside1)
+        std::swap(coord1, coord2);
+    return true;
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef GEOREGION_HPP
+#define GEOREGION_HPP
+
+#include "config/Config.hpp"
+#include "GeographicPosition.hpp"
+#include <string>
+
+// Latitude and longitude box the import is restricted to. A box with minLongitude > maxLongitude crosses the
+// antimeridian. The default region is the whole world.
+class GeoRegion {
+   public:
+    GeoRegion();
+    GeoRegion(double minLatitude, double maxLatitude, double minLongitude, double maxLongitude);
+
+    // the region section of the configuration, the whole world unless region.enable is set
+    static GeoRegion fromConfig(Config_Ptr config);
+
+    bool isGlobal(void) const { return _global; }
+
+    bool contains(double lat, double lon) const;
+    bool contains(const GeographicPositionTuple& coord) const { return contains(coord.first, coord.second); }
+
+    // moves the outer end of a segment with one end inside to the border, false if both ends are outside
+    bool clip(GeographicPositionTuple& coord1, GeographicPositionTuple& coord2) const;
+
+    double minLatitude(void) const { return _minLatitude; }
+    double maxLatitude(void) const { return _maxLatitude; }
+    double minLongitude(void) const { return _minLongitude; }
+    double maxLongitude(void) const { return _maxLongitude; }
+
+   private:
+    // longitude east of _minLongitude in [0, 360)
+    double relativeLongitude(double lon) const;
+
+    bool _global;
+    double _minLatitude;
+    double _maxLatitude;
+    double _minLongitude;
+    double _maxLongitude;
+    double _width;  /// < of the longitude range in degrees
+};
+
+#endif  // GEOREGION_HPP
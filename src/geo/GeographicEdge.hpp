@@ -30,16 +30,38 @@
 #ifndef GEOGRAPHICEDGE_HPP
 #define GEOGRAPHICEDGE_HPP
 
+#include <cstdint>
 #include <memory>
 
 class GeographicEdge {
    public:
+    // concrete class of an edge, fixed by its constructor. NO_EDGE stands for an empty pointer, see edgeKind.
+    enum Kind : uint8_t { NO_EDGE, GEOGRAPHIC_EDGE, TRIANGULATION_EDGE, SEACABLE_EDGE, SIMULATION_EDGE };
+    static constexpr Kind KIND = GEOGRAPHIC_EDGE;
+
+    GeographicEdge() : _kind(GEOGRAPHIC_EDGE) {}
     virtual ~GeographicEdge() {}
 
+    Kind kind() const { return _kind; }
+
    protected:
+    GeographicEdge(Kind kind) : _kind(kind) {}
+
    private:
+    Kind _kind;
 };
 
 typedef std::shared_ptr<GeographicEdge> GeographicEdge_Ptr;
 
+// edges added without geometry, e.g. by the beta skeleton filter, have no edge object
+inline GeographicEdge::Kind edgeKind(const GeographicEdge_Ptr& edge) {
+    return edge ? edge->kind() : GeographicEdge::NO_EDGE;
+}
+
+// replaces dynamic_cast for the edge classes: edge as T if it was constructed as T, nullptr otherwise
+template <typename T>
+T* edgeCast(GeographicEdge* edge) {
+    return edge && edge->kind() == T::KIND ? static_cast<T*>(edge) : nullptr;
+}
+
 #endif  // GEOGRAPHICEDGE_HPP
@@ -30,14 +30,25 @@
 #include "GeographicNode.hpp"
 #include "topo/base_topo/BaseTopology.hpp"
 
-GeographicNode::GeographicNode() : _id(-1) {
+const GeographicNode::Kind GeographicNode::KIND;
+
+GeographicNode::GeographicNode() : _id(-1), _kind(GEOGRAPHIC_NODE) {
+}
+
+GeographicNode::GeographicNode(Kind kind) : _id(-1), _kind(kind) {
+}
+
+GeographicNode::GeographicNode(int id, double lat, double lon)
+    : GeographicPosition(lat, lon), _id(id), _kind(GEOGRAPHIC_NODE) {
 }
 
-GeographicNode::GeographicNode(int id, double lat, double lon) : GeographicPosition(lat, lon), _id(id) {
+GeographicNode::GeographicNode(int id, double lat, double lon, Kind kind)
+    : GeographicPosition(lat, lon), _id(id), _kind(kind) {
 }
 
+// a copy through the base class is a plain node
 GeographicNode::GeographicNode(const GeographicNode& other)
-    : GeographicPosition(other._latitude, other._longitude), _id(other._id) {
+    : GeographicPosition(other._latitude, other._longitude), _id(other._id), _kind(GEOGRAPHIC_NODE) {
 }
 
 GeographicNode& GeographicNode::operator=(const GeographicNode& other) {
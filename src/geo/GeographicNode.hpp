@@ -31,11 +31,16 @@
 #define GEOGRAPHICNODE_HPP
 
 #include "GeographicPosition.hpp"
+#include <cstdint>
 #include <vector>
 #include <memory>
 
 class GeographicNode : public GeographicPosition {
    public:
+    // concrete class of a node, fixed by its constructor, so that classifying a node is a single load
+    enum Kind : uint8_t { GEOGRAPHIC_NODE = 1, CITY_NODE, SEACABLE_LANDINGPOINT, SEACABLE_NODE, SIMULATION_NODE };
+    static const Kind KIND = GEOGRAPHIC_NODE;
+
     GeographicNode();
     GeographicNode(const GeographicNode& other);
     GeographicNode(int id, double lat, double lon);
@@ -44,14 +49,28 @@ class GeographicNode : public GeographicPosition {
     virtual int id();
     virtual void setId(int i);
 
+    Kind kind() const { return _kind; }
+
     // for usage as map key
     virtual bool operator<(const GeographicNode& other) const;
     virtual ~GeographicNode() {}
 
    protected:
+    GeographicNode(Kind kind);
+    GeographicNode(int id, double lat, double lon, Kind kind);
+
     int _id;
+
+   private:
+    Kind _kind;
 };
 
+// replaces dynamic_cast for the node classes: node as T if it was constructed as T, nullptr otherwise
+template <typename T>
+T* nodeCast(GeographicNode* node) {
+    return node && node->kind() == T::KIND ? static_cast<T*>(node) : nullptr;
+}
+
 typedef std::shared_ptr<GeographicNode> GeographicNode_Ptr;
 typedef std::vector<GeographicNode_Ptr> Locations;
 typedef std::shared_ptr<Locations> Locations_Ptr;
@@ -29,26 +29,41 @@
 
 #include "GeometricHelpers.hpp"
 
+#include "util/Profiler.hpp"
 #include <algorithm>
 #include <cmath>
 
-double GeometricHelpers::deg2rad(double deg) {
-    return deg * GeometricHelpers::DEG_TO_RAD;
-}
+namespace {
 
 // http://blog.julien.cayzac.name/2008/10/arc-and-distance-between-two-points-on.html
 // use the law of haversines for numerical stability
-double GeometricHelpers::sphericalDist(GeographicPosition& from, GeographicPosition& to) {
-    double latitudeArc = (from.lat() - to.lat()) * GeometricHelpers::DEG_TO_RAD;
-    double longitudeArc = (from.lon() - to.lon()) * GeometricHelpers::DEG_TO_RAD;
+inline double haversine(double lat1, double lon1, double cosLat1, double lat2, double lon2, double cosLat2) {
+    Profiler::count(Profiler::DISTANCE_EVALUATIONS);
+    double latitudeArc = (lat1 - lat2) * GeometricHelpers::DEG_TO_RAD;
+    double longitudeArc = (lon1 - lon2) * GeometricHelpers::DEG_TO_RAD;
     double latitudeH = sin(latitudeArc * 0.5);
     latitudeH *= latitudeH;
     double lontitudeH = sin(longitudeArc * 0.5);
     lontitudeH *= lontitudeH;
-    double tmp = cos(from.lat() * GeometricHelpers::DEG_TO_RAD) * cos(to.lat() * GeometricHelpers::DEG_TO_RAD);
+    double tmp = cosLat1 * cosLat2;
     return 2.0 * asin(sqrt(latitudeH + tmp * lontitudeH));
 }
 
+}  // namespace
+
+double GeometricHelpers::deg2rad(double deg) {
+    return deg * GeometricHelpers::DEG_TO_RAD;
+}
+
+double GeometricHelpers::sphericalDist(GeographicPosition& from, GeographicPosition& to) {
+    return haversine(from.lat(), from.lon(), cos(from.lat() * DEG_TO_RAD), to.lat(), to.lon(),
+                     cos(to.lat() * DEG_TO_RAD));
+}
+
+double GeometricHelpers::sphericalDist(const CachedPosition& from, const CachedPosition& to) {
+    return haversine(from.lat, from.lon, from.cosLat, to.lat, to.lon, to.cosLat);
+}
+
 double GeometricHelpers::sphericalDist(GeographicNode_Ptr& from, GeographicNode_Ptr& to) {
     GeographicPosition p1(from->lat(), from->lon());
     GeographicPosition p2(to->lat(), to->lon());
@@ -86,3 +101,52 @@ double GeometricHelpers::rad2deg(double rad) {
 double GeometricHelpers::sphericalDistToKM(double dist) {
     return dist * GeometricHelpers::EARTH_RADIUS_KM;
 }
+
+GeometricHelpers::UnitVector GeometricHelpers::unitVector(GeographicPosition& position) {
+    double lat = position.lat() * DEG_TO_RAD;
+    double lon = position.lon() * DEG_TO_RAD;
+    double cosLat = cos(lat);
+    return UnitVector{cosLat * cos(lon), cosLat * sin(lon), sin(lat)};
+}
+
+GeometricHelpers::CachedPosition GeometricHelpers::cachedPosition(double lat, double lon) {
+    double latRad = lat * DEG_TO_RAD;
+    double lonRad = lon * DEG_TO_RAD;
+    double cosLat = cos(latRad);
+    return CachedPosition{lat, lon, cosLat, UnitVector{cosLat * cos(lonRad), cosLat * sin(lonRad), sin(latRad)}};
+}
+
+GeometricHelpers::CachedPosition GeometricHelpers::cachedPosition(GeographicPosition& position) {
+    return cachedPosition(position.lat(), position.lon());
+}
+
+double GeometricHelpers::sphericalAngle(const UnitVector& from, const UnitVector& to) {
+    Profiler::count(Profiler::DISTANCE_EVALUATIONS);
+    double cx = from.y * to.z - from.z * to.y;
+    double cy = from.z * to.x - from.x * to.z;
+    double cz = from.x * to.y - from.y * to.x;
+    return atan2(sqrt(cx * cx + cy * cy + cz * cz), from.x * to.x + from.y * to.y + from.z * to.z);
+}
+
+double GeometricHelpers::chordSquared(double distance) {
+    if (distance >= M_PI)
+        return 4.0;
+    double chord = 2.0 * sin(0.5 * distance);
+    return chord * chord;
+}
+
+void GeometricHelpers::chordSquared(double qx,
+                                    double qy,
+                                    double qz,
+                                    const double* x,
+                                    const double* y,
+                                    const double* z,
+                                    size_t n,
+                                    double* out) {
+    for (size_t i = 0; i < n; ++i) {
+        double dx = x[i] - qx;
+        double dy = y[i] - qy;
+        double dz = z[i] - qz;
+        out[i] = dx * dx + dy * dy + dz * dz;
+    }
+}
@@ -32,6 +32,7 @@
 
 #include "GeographicNode.hpp"
 #include "GeographicPosition.hpp"
+#include <cstddef>
 #include <utility>
 #include <cmath>
 
@@ -47,6 +48,69 @@ double sphericalDist(GeographicNode_Ptr& from, GeographicNode_Ptr& to);
 double sphericalDist(GeographicPosition& from, GeographicPosition& to);
 double sphericalDistToKM(double dist);
 
+// squared chord lengths between the unit vector q and n unit vectors given as separate coordinate arrays.
+// The chord grows monotonically with the spherical distance and needs no trigonometry, so this loop vectorizes.
+void chordSquared(double qx, double qy, double qz, const double* x, const double* y, const double* z, size_t n, double* out);
+
+struct UnitVector {
+    double x;
+    double y;
+    double z;
+};
+
+UnitVector unitVector(GeographicPosition& position);
+
+// the trigonometry of a position computed once, for positions that take part in many distance or angle evaluations.
+// lat and lon stay in degrees, so sphericalDist of two cached positions is bit for bit the one of the positions.
+struct CachedPosition {
+    double lat;
+    double lon;
+    double cosLat;
+    UnitVector unit;
+};
+
+CachedPosition cachedPosition(GeographicPosition& position);
+CachedPosition cachedPosition(double lat, double lon);
+
+// the haversine formula of sphericalDist without the cosines of the latitudes
+double sphericalDist(const CachedPosition& from, const CachedPosition& to);
+
+// spherical distance from the dot and the cross product of the unit vectors, one atan2 and accurate at all
+// distances, but it rounds differently from sphericalDist
+double sphericalAngle(const UnitVector& from, const UnitVector& to);
+
+// squared chord between two unit vectors, it grows with the spherical distance: comparing it with the chordSquared
+// of a threshold distance tests pairs against the threshold without trigonometry
+inline double chordSquared(const UnitVector& from, const UnitVector& to) {
+    double dx = from.x - to.x;
+    double dy = from.y - to.y;
+    double dz = from.z - to.z;
+    return dx * dx + dy * dy + dz * dz;
+}
+
+double chordSquared(double distance);
+
+// true if the angle at r between the great circle arcs to p and q is smaller than the angle with cosine cosTheta,
+// same result as BetaSkeletonFilter::testTheta up to rounding. With u = r x p and w = r x q, u.w is
+// |u| |w| cos(angle), so the test needs multiplications and one square root instead of ten trigonometric calls.
+// Inline, it is the innermost kernel of the beta skeleton. withoutAngle is the result for r on p or q.
+inline bool angleBelow(const UnitVector& p, const UnitVector& r, const UnitVector& q, double cosTheta,
+                       bool withoutAngle = true) {
+    double ux = r.y * p.z - r.z * p.y;
+    double uy = r.z * p.x - r.x * p.z;
+    double uz = r.x * p.y - r.y * p.x;
+    double wx = r.y * q.z - r.z * q.y;
+    double wy = r.z * q.x - r.x * q.z;
+    double wz = r.x * q.y - r.y * q.x;
+
+    double sines = sqrt((ux * ux + uy * uy + uz * uz) * (wx * wx + wy * wy + wz * wz));
+    // no angle: testTheta gets NaN and passes the node, the lune test of the length filter counts the position
+    if (sines == 0.0)
+        return withoutAngle;
+
+    return ux * wx + uy * wy + uz * wz > cosTheta * sines;
+}
+
 GeographicPositionTuple getMidPointCoordinates(GeographicNode_Ptr& n1, GeographicNode_Ptr& n2);
 GeographicPositionTuple getMidPointCoordinates(GeographicPosition& n1, GeographicPosition& n2);
 };
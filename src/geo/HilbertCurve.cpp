@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "HilbertCurve.hpp"
+#include "GeometricHelpers.hpp"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+namespace {
+// equal angle mapping of a face coordinate in [-1, 1], cells near the face edges are not smaller than in the center
+uint32_t quantize(double t) {
+    const uint32_t cells = 1u << HilbertCurve::ORDER;
+    double s = 0.5 * (4.0 / M_PI * atan(t) + 1.0);
+    return std::min(cells - 1, static_cast<uint32_t>(s * cells));
+}
+
+uint64_t curvePosition(uint32_t x, uint32_t y) {
+    const uint32_t n = 1u << HilbertCurve::ORDER;
+    uint64_t d = 0;
+    for (uint32_t s = n / 2; s > 0; s /= 2) {
+        uint32_t rx = (x & s) > 0;
+        uint32_t ry = (y & s) > 0;
+        d += static_cast<uint64_t>(s) * s * ((3 * rx) ^ ry);
+
+        // rotate the quadrant
+        if (ry == 0) {
+            if (rx == 1) {
+                x = n - 1 - x;
+                y = n - 1 - y;
+            }
+            std::swap(x, y);
+        }
+    }
+    return d;
+}
+}  // namespace
+
+uint64_t HilbertCurve::key(double lat, double lon) {
+    double phi = lat * GeometricHelpers::DEG_TO_RAD;
+    double lambda = lon * GeometricHelpers::DEG_TO_RAD;
+    double p[3] = {cos(phi) * cos(lambda), cos(phi) * sin(lambda), sin(phi)};
+
+    // the face is given by the axis of the largest component and its sign
+    int axis = 0;
+    for (int k = 1; k < 3; ++k)
+        if (fabs(p[k]) > fabs(p[axis]))
+            axis = k;
+    uint64_t face = 2 * axis + (p[axis] < 0.0 ? 1 : 0);
+
+    double u = p[(axis + 1) % 3] / fabs(p[axis]);
+    double v = p[(axis + 2) % 3] / fabs(p[axis]);
+    return (face << (2 * ORDER)) | curvePosition(quantize(u), quantize(v));
+}
+
+void HilbertCurve::sort(Locations& locations) {
+    std::vector<std::pair<uint64_t, size_t>> keys;
+    keys.reserve(locations.size());
+    for (size_t i = 0; i < locations.size(); ++i)
+        keys.push_back(std::make_pair(key(locations[i]->lat(), locations[i]->lon()), i));
+    std::sort(keys.begin(), keys.end());
+
+    Locations sorted;
+    sorted.reserve(locations.size());
+    for (auto& k : keys)
+        sorted.push_back(locations[k.second]);
+    locations.swap(sorted);
+}
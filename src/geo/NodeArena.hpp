@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef NODEARENA_HPP
+#define NODEARENA_HPP
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// bump allocator for the nodes of one topology. make places each node and its shared_ptr control block in large
+// chunks instead of two heap allocations per node. Freed nodes are not reused, the chunks are released when the arena
+// and the last node made by it are gone. Nodes may be released on any thread, make is not thread safe.
+class NodeArena {
+   public:
+    NodeArena(size_t chunkSize = 1 << 16) : _state(new State(chunkSize)) {}
+
+    template <typename T, typename... Args>
+    std::shared_ptr<T> make(Args&&... args) {
+        return std::allocate_shared<T>(Allocator<T>(_state), std::forward<Args>(args)...);
+    }
+
+   private:
+    struct State {
+        size_t chunkSize;
+        char* current;  /// < chunk allocations are taken from
+        size_t used;
+        std::vector<std::unique_ptr<char[]>> chunks;
+
+        State(size_t size) : chunkSize(size), current(nullptr), used(size), chunks() {}
+
+        void* allocate(size_t bytes) {
+            const size_t ALIGNMENT = alignof(std::max_align_t);
+            bytes = (bytes + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+            if (bytes > chunkSize) {
+                chunks.emplace_back(new char[bytes]);
+                return chunks.back().get();
+            }
+            if (used + bytes > chunkSize) {
+                chunks.emplace_back(new char[chunkSize]);
+                current = chunks.back().get();
+                used = 0;
+            }
+            void* p = current + used;
+            used += bytes;
+            return p;
+        }
+    };
+    typedef std::shared_ptr<State> State_Ptr;
+
+    template <typename T>
+    struct Allocator {
+        typedef T value_type;
+
+        State_Ptr state;
+
+        Allocator(const State_Ptr& s) : state(s) {}
+        template <typename U>
+        Allocator(const Allocator<U>& other) : state(other.state) {}
+
+        T* allocate(size_t n) { return static_cast<T*>(state->allocate(n * sizeof(T))); }
+        void deallocate(T*, size_t) {}
+
+        template <typename U>
+        bool operator==(const Allocator<U>& other) const {
+            return state == other.state;
+        }
+        template <typename U>
+        bool operator!=(const Allocator<U>& other) const {
+            return state != other.state;
+        }
+    };
+
+    State_Ptr _state;
+};
+
+#endif  // NODEARENA_HPP
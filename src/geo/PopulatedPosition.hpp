@@ -30,6 +30,8 @@
 #ifndef POPULATEDPOSITION_HPP
 #define POPULATEDPOSITION_HPP
 
+#include <string>
+
 struct PopulatedPosition {
     double _population;
     double _lat;
@@ -34,6 +34,10 @@
 
 class SeaCableEdge : public GeographicEdge {
    public:
+    static constexpr Kind KIND = SEACABLE_EDGE;
+
+    SeaCableEdge() : GeographicEdge(KIND) {}
+
    protected:
    private:
 };
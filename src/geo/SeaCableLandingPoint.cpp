@@ -29,15 +29,17 @@
 
 #include "SeaCableLandingPoint.hpp"
 
-SeaCableLandingPoint::SeaCableLandingPoint() : _name() {
+const GeographicNode::Kind SeaCableLandingPoint::KIND;
+
+SeaCableLandingPoint::SeaCableLandingPoint() : GeographicNode(KIND), _name() {
 }
 
 SeaCableLandingPoint::SeaCableLandingPoint(const SeaCableLandingPoint& other)
-    : GeographicNode(other._id, other._latitude, other._longitude), _name(other._name) {
+    : GeographicNode(other._id, other._latitude, other._longitude, KIND), _name(other._name) {
 }
 
 SeaCableLandingPoint::SeaCableLandingPoint(int id, double lat, double lon, std::string name)
-    : GeographicNode(id, lat, lon), _name(name) {
+    : GeographicNode(id, lat, lon, KIND), _name(name) {
 }
 
 SeaCableLandingPoint& SeaCableLandingPoint::operator=(const SeaCableLandingPoint& other) {
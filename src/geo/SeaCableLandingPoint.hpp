@@ -35,6 +35,8 @@
 
 class SeaCableLandingPoint : public GeographicNode {
    public:
+    static const Kind KIND = SEACABLE_LANDINGPOINT;
+
     SeaCableLandingPoint();
     SeaCableLandingPoint(const SeaCableLandingPoint& other);
     SeaCableLandingPoint(int id, double lat, double lon, std::string name);
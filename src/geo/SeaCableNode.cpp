@@ -29,13 +29,16 @@
 
 #include "SeaCableNode.hpp"
 
-SeaCableNode::SeaCableNode() {
+const GeographicNode::Kind SeaCableNode::KIND;
+
+SeaCableNode::SeaCableNode() : GeographicNode(KIND) {
 }
 
-SeaCableNode::SeaCableNode(const SeaCableNode& other) : GeographicNode(other._id, other._latitude, other._longitude) {
+SeaCableNode::SeaCableNode(const SeaCableNode& other)
+    : GeographicNode(other._id, other._latitude, other._longitude, KIND) {
 }
 
-SeaCableNode::SeaCableNode(int id, double lat, double lon) : GeographicNode(id, lat, lon) {
+SeaCableNode::SeaCableNode(int id, double lat, double lon) : GeographicNode(id, lat, lon, KIND) {
 }
 
 SeaCableNode& SeaCableNode::operator=(const SeaCableNode& other) {
@@ -34,6 +34,8 @@
 
 class SeaCableNode : public GeographicNode {
    public:
+    static const Kind KIND = SEACABLE_NODE;
+
     SeaCableNode();
     SeaCableNode(const SeaCableNode& other);
     SeaCableNode(int id, double lat, double lon);
@@ -35,6 +35,10 @@
 
 class SimulationEdge : public GeographicEdge {
    public:
+    static constexpr Kind KIND = SIMULATION_EDGE;
+
+    SimulationEdge() : GeographicEdge(KIND) {}
+
    protected:
    private:
 };
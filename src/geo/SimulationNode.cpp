@@ -30,14 +30,16 @@
 #include "SimulationNode.hpp"
 #include "topo/base_topo/BaseTopology.hpp"
 
-SimulationNode::SimulationNode() : _outerID(-1) {
+const GeographicNode::Kind SimulationNode::KIND;
+
+SimulationNode::SimulationNode() : GeographicNode(KIND), _outerID(-1) {
 }
 
-SimulationNode::SimulationNode(int id, double lat, double lon) : GeographicNode(id, lat, lon), _outerID(id) {
+SimulationNode::SimulationNode(int id, double lat, double lon) : GeographicNode(id, lat, lon, KIND), _outerID(id) {
 }
 
 SimulationNode::SimulationNode(const SimulationNode& other)
-    : GeographicNode(other._id, other._latitude, other._longitude), _outerID(other._outerID) {
+    : GeographicNode(other._id, other._latitude, other._longitude, KIND), _outerID(other._outerID) {
 }
 
 SimulationNode& SimulationNode::operator=(const SimulationNode& other) {
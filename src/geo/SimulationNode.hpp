@@ -36,6 +36,8 @@
 
 class SimulationNode : public GeographicNode {
    public:
+    static const Kind KIND = SIMULATION_NODE;
+
     SimulationNode();
     SimulationNode(const SimulationNode& other);
     SimulationNode(int id, double lat, double lon);
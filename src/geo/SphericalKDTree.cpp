@@ -0,0 +1,265 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "SphericalKDTree.hpp"
+#include "GeometricHelpers.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// guards the chord pruning against rounding in the haversine formula
+static constexpr double CHORD_SLACK = 1e-9;
+
+SphericalKDTree::SphericalKDTree() : _positions(), _nodes(), _root(-1) {
+}
+
+SphericalKDTree::SphericalKDTree(Locations& locations) : _positions(), _nodes(), _root(-1) {
+    _positions.reserve(locations.size());
+
+    std::vector<unsigned int> order;
+    order.reserve(locations.size());
+
+    for (GeographicNode_Ptr& node : locations) {
+        order.push_back(_positions.size());
+        _positions.push_back(GeometricHelpers::cachedPosition(node->lat(), node->lon()));
+    }
+
+    if (!order.empty())
+        _root = build(order, 0, order.size());
+}
+
+SphericalKDTree::SphericalKDTree(std::vector<GeographicPosition>& positions)
+    : _positions(), _nodes(), _root(-1) {
+    _positions.reserve(positions.size());
+
+    std::vector<unsigned int> order;
+    order.reserve(positions.size());
+
+    for (GeographicPosition& position : positions) {
+        order.push_back(_positions.size());
+        _positions.push_back(GeometricHelpers::cachedPosition(position));
+    }
+
+    if (!order.empty())
+        _root = build(order, 0, order.size());
+}
+
+size_t SphericalKDTree::size(void) {
+    return _positions.size();
+}
+
+double SphericalKDTree::coordinate(const CachedPosition& p, int axis) {
+    switch (axis) {
+        case 0:
+            return p.unit.x;
+        case 1:
+            return p.unit.y;
+        default:
+            return p.unit.z;
+    }
+}
+
+// length of the chord spanning a great circle arc
+double SphericalKDTree::toChord(double angle) {
+    if (angle >= M_PI)
+        return 2.0 + CHORD_SLACK;
+    return 2.0 * sin(0.5 * angle) + CHORD_SLACK;
+}
+
+// axis of largest extent
+int SphericalKDTree::chooseAxis(std::vector<unsigned int>& order, unsigned int begin, unsigned int end) {
+    double minC[3] = {2.0, 2.0, 2.0};
+    double maxC[3] = {-2.0, -2.0, -2.0};
+    for (unsigned int i = begin; i < end; ++i) {
+        for (int axis = 0; axis < 3; ++axis) {
+            double c = coordinate(_positions[order[i]], axis);
+            minC[axis] = std::min(minC[axis], c);
+            maxC[axis] = std::max(maxC[axis], c);
+        }
+    }
+
+    int axis = 0;
+    for (int a = 1; a < 3; ++a) {
+        if (maxC[a] - minC[a] > maxC[axis] - minC[axis])
+            axis = a;
+    }
+    return axis;
+}
+
+// moves the median to mid, smaller coordinates before and larger ones after it, returns the median coordinate
+double SphericalKDTree::partition(std::vector<unsigned int>& order,
+                                  unsigned int begin,
+                                  unsigned int mid,
+                                  unsigned int end,
+                                  int axis) {
+    std::nth_element(order.begin() + begin, order.begin() + mid, order.begin() + end,
+                     [this, axis](unsigned int a, unsigned int b) {
+                         return coordinate(_positions[a], axis) < coordinate(_positions[b], axis);
+                     });
+    return coordinate(_positions[order[mid]], axis);
+}
+
+// left subtrees hold coordinates <= split, right subtrees coordinates >= split
+int SphericalKDTree::build(std::vector<unsigned int>& order, unsigned int begin, unsigned int end) {
+    KDNode node;
+    node.left = -1;
+    node.right = -1;
+    node.axis = -1;
+    node.split = 0.0;
+
+    if (end - begin > LEAF_SIZE) {
+        int axis = chooseAxis(order, begin, end);
+
+        unsigned int mid = begin + (end - begin) / 2;
+        node.axis = axis;
+        node.split = partition(order, begin, mid, end, axis);
+        node.left = build(order, begin, mid);
+        node.right = build(order, mid, end);
+    } else {
+        node.items.assign(order.begin() + begin, order.begin() + end);
+    }
+
+    _nodes.push_back(node);
+    return _nodes.size() - 1;
+}
+
+void SphericalKDTree::splitLeaf(int nodeIndex) {
+    std::vector<unsigned int> items;
+    items.swap(_nodes[nodeIndex].items);
+
+    int axis = chooseAxis(items, 0, items.size());
+    unsigned int mid = items.size() / 2;
+    double split = partition(items, 0, mid, items.size(), axis);
+    int left = build(items, 0, mid);
+    int right = build(items, mid, items.size());
+
+    KDNode& node = _nodes[nodeIndex];
+    node.axis = axis;
+    node.split = split;
+    node.left = left;
+    node.right = right;
+}
+
+unsigned int SphericalKDTree::insert(GeographicPosition& position) {
+    unsigned int index = _positions.size();
+    _positions.push_back(GeometricHelpers::cachedPosition(position));
+    const CachedPosition& p = _positions.back();
+
+    if (_root == -1) {
+        std::vector<unsigned int> order(1, index);
+        _root = build(order, 0, 1);
+        return index;
+    }
+
+    int nodeIndex = _root;
+    while (_nodes[nodeIndex].axis != -1) {
+        const KDNode& node = _nodes[nodeIndex];
+        nodeIndex = coordinate(p, node.axis) <= node.split ? node.left : node.right;
+    }
+
+    _nodes[nodeIndex].items.push_back(index);
+    if (_nodes[nodeIndex].items.size() > 2 * LEAF_SIZE)
+        splitLeaf(nodeIndex);
+
+    return index;
+}
+
+void SphericalKDTree::radiusSearch(GeographicPosition& center, double radius, std::vector<Neighbor>& result) {
+    result.clear();
+    if (_root == -1)
+        return;
+
+    CachedPosition query = GeometricHelpers::cachedPosition(center);
+    radiusSearch(_root, query, toChord(radius), radius, result);
+
+    std::sort(result.begin(), result.end(), [](const Neighbor& a, const Neighbor& b) { return a.index < b.index; });
+}
+
+void SphericalKDTree::radiusSearch(int nodeIndex,
+                                   const CachedPosition& query,
+                                   double chord,
+                                   double radius,
+                                   std::vector<Neighbor>& result) {
+    const KDNode& node = _nodes[nodeIndex];
+
+    if (node.axis == -1) {
+        double chordSquared = chord * chord;
+        for (unsigned int index : node.items) {
+            const CachedPosition& p = _positions[index];
+            if (GeometricHelpers::chordSquared(p.unit, query.unit) > chordSquared)
+                continue;
+
+            double dist = GeometricHelpers::sphericalDist(query, p);
+            if (dist <= radius)
+                result.push_back(Neighbor(index, dist));
+        }
+        return;
+    }
+
+    double delta = coordinate(query, node.axis) - node.split;
+    if (delta <= chord)
+        radiusSearch(node.left, query, chord, radius, result);
+    if (-delta <= chord)
+        radiusSearch(node.right, query, chord, radius, result);
+}
+
+SphericalKDTree::Neighbor SphericalKDTree::nearest(GeographicPosition& position) {
+    Neighbor best(std::numeric_limits<unsigned int>::max(), std::numeric_limits<double>::max());
+    if (_root == -1)
+        return best;
+
+    CachedPosition query = GeometricHelpers::cachedPosition(position);
+    double bestChord = toChord(M_PI);
+    nearest(_root, query, best, bestChord);
+    return best;
+}
+
+void SphericalKDTree::nearest(int nodeIndex, const CachedPosition& query, Neighbor& best, double& bestChord) {
+    const KDNode& node = _nodes[nodeIndex];
+
+    if (node.axis == -1) {
+        for (unsigned int index : node.items) {
+            double dist = GeometricHelpers::sphericalDist(query, _positions[index]);
+            if (dist < best.distance || (dist == best.distance && index < best.index)) {
+                best = Neighbor(index, dist);
+                bestChord = toChord(dist);
+            }
+        }
+        return;
+    }
+
+    // descend into the near side first, visit the far side only if it may hold an equally close point
+    double delta = coordinate(query, node.axis) - node.split;
+    int nearChild = delta <= 0.0 ? node.left : node.right;
+    int farChild = delta <= 0.0 ? node.right : node.left;
+
+    nearest(nearChild, query, best, bestChord);
+    if (fabs(delta) <= bestChord)
+        nearest(farChild, query, best, bestChord);
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SPHERICALKDTREE_HPP
+#define SPHERICALKDTREE_HPP
+
+#include "GeographicNode.hpp"
+#include "GeographicPosition.hpp"
+#include "GeometricHelpers.hpp"
+#include <memory>
+#include <vector>
+
+class SphericalKDTree;
+typedef std::shared_ptr<SphericalKDTree> SphericalKDTree_Ptr;
+
+// 3D k-d tree over the unit vectors of geographic positions. The tree prunes
+// with chord distances, but all reported distances are computed with
+// GeometricHelpers::sphericalDist, so query results are identical to a linear
+// scan over the same positions.
+class SphericalKDTree {
+   public:
+    struct Neighbor {
+        unsigned int index;  /// < position in insertion order
+        double distance;     /// < spherical distance in radians
+
+        Neighbor(unsigned int i, double d) : index(i), distance(d) {}
+    };
+
+    SphericalKDTree();
+    SphericalKDTree(Locations& locations);
+    SphericalKDTree(std::vector<GeographicPosition>& positions);
+
+    // appends a position, returns its index
+    unsigned int insert(GeographicPosition& position);
+
+    // neighbors within radius (radians), sorted by index
+    void radiusSearch(GeographicPosition& center, double radius, std::vector<Neighbor>& result);
+
+    // nearest position, ties are resolved towards the smaller index like a linear scan
+    Neighbor nearest(GeographicPosition& position);
+
+    size_t size(void);
+
+    // the position of an index with its trigonometry, for callers that measure between indexed positions
+    const GeometricHelpers::CachedPosition& position(unsigned int index) const { return _positions[index]; }
+
+   protected:
+   private:
+    typedef GeometricHelpers::CachedPosition CachedPosition;
+
+    struct KDNode {
+        int left;
+        int right;
+        int axis;  /// < -1 for leaves
+        double split;
+        std::vector<unsigned int> items;
+    };
+
+    static constexpr unsigned int LEAF_SIZE = 8;
+
+    static double coordinate(const CachedPosition& p, int axis);
+    static double toChord(double angle);
+
+    double partition(std::vector<unsigned int>& order, unsigned int begin, unsigned int mid, unsigned int end, int axis);
+    int build(std::vector<unsigned int>& order, unsigned int begin, unsigned int end);
+    int chooseAxis(std::vector<unsigned int>& order, unsigned int begin, unsigned int end);
+    void splitLeaf(int node);
+    void radiusSearch(int node, const CachedPosition& query, double chord, double radius, std::vector<Neighbor>& result);
+    void nearest(int node, const CachedPosition& query, Neighbor& best, double& bestChord);
+
+    // with the unit vectors the tree is built on
+    std::vector<CachedPosition> _positions;
+    std::vector<KDNode> _nodes;
+    int _root;
+};
+
+#endif  // SPHERICALKDTREE_HPP
@@ -34,8 +34,19 @@
 
 class TriangulationEdge : public GeographicEdge {
    public:
+    static constexpr Kind KIND = TRIANGULATION_EDGE;
+    static constexpr int NO_VERTEX = -1;
+
+    TriangulationEdge() : GeographicEdge(KIND), _opposite{NO_VERTEX, NO_VERTEX} {}
+    TriangulationEdge(int first, int second) : GeographicEdge(KIND), _opposite{first, second} {}
+
+    // graph node ids of the third vertices of the two triangles at this edge, NO_VERTEX if unknown
+    int opposite(int k) const { return _opposite[k]; }
+    bool hasOpposite() const { return _opposite[0] != NO_VERTEX && _opposite[1] != NO_VERTEX; }
+
    protected:
    private:
+    int _opposite[2];
 };
 
 #endif  // TRIANGULATIONEDGE_HPP
@@ -0,0 +1,439 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef BINARYGRAPH_HPP
+#define BINARYGRAPH_HPP
+
+// Layout of the files written by BinaryOutput and a reader that maps them read-only. This header only needs the C++
+// and POSIX headers, simulators can copy it without the rest of topoGen.
+//
+// All values are in host byte order, every section starts at a multiple of 8 bytes:
+//   BinaryGraphHeader
+//   BinaryGraphNode[numNodes]           valid nodes in graph order, edges refer to their index
+//   uint32_t[numNodes + 1]              CSR offsets into the adjacency
+//   BinaryGraphAdjacency[2 * numEdges]  both directions of every edge, by source node
+//   BinaryGraphEdge[numEdges]           in the order of the JSON output
+//   char[stringsSize]                   zero terminated names
+//
+// LandmarkOutput writes ALT landmarks for the nodes of such a file:
+//   BinaryLandmarkHeader
+//   uint32_t[numLandmarks]              node indices of the landmarks
+//   double[numLandmarks * numNodes]     km from each landmark to all nodes, landmark by landmark, infinity if
+//                                       unreachable
+// AltQuery answers point-to-point queries on both files with A*. Compressed files (graph.bin.zst with
+// output.compression) can not be mapped, ReadBuffer::readAll decompresses them for assign.
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+namespace BinaryGraph {
+
+const char MAGIC[8] = {'t', 'o', 'p', 'o', 'G', 'e', 'n', 'B'};
+const uint32_t VERSION = 1;
+
+const char LANDMARK_MAGIC[8] = {'t', 'o', 'p', 'o', 'G', 'e', 'n', 'L'};
+const uint32_t LANDMARK_VERSION = 1;
+
+const uint32_t NO_NODE = std::numeric_limits<uint32_t>::max();
+
+enum NodeType : uint8_t { GEOGRAPHIC_NODE, CITY_NODE, SEACABLE_LANDINGPOINT, SEACABLE_WAYPOINT, SIMULATION_NODE };
+
+// same types as the JSON output
+enum EdgeType : uint8_t { NORMAL_EDGE, SEACABLE_EDGE, SIMULATION_EDGE };
+
+struct BinaryGraphHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t numNodes;
+    uint32_t numEdges;
+    uint32_t reserved;
+    uint64_t nodesOffset;
+    uint64_t offsetsOffset;
+    uint64_t adjacencyOffset;
+    uint64_t edgesOffset;
+    uint64_t stringsOffset;
+    uint64_t stringsSize;
+};
+
+struct BinaryGraphNode {
+    int32_t id;       /// < graph id, or the id of a simulation node
+    int32_t outerId;  /// < -1 unless type is SIMULATION_NODE
+    double lat;
+    double lon;
+    uint32_t nameOffset;  /// < into the string pool
+    uint8_t type;         /// < NodeType
+    uint8_t padding[3];
+};
+
+struct BinaryGraphAdjacency {
+    uint32_t target;  /// < node index
+    uint32_t edge;    /// < edge index
+};
+
+struct BinaryGraphEdge {
+    uint32_t u;  /// < node index
+    uint32_t v;  /// < node index
+    double distance;  /// < km
+    uint8_t type;     /// < EdgeType
+    uint8_t padding[7];
+};
+
+struct BinaryLandmarkHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t numNodes;
+    uint32_t numLandmarks;
+    uint32_t reserved;
+    double earthRadiusKm;  /// < turns great circle distances into the km of the edges
+    uint64_t landmarksOffset;
+    uint64_t distancesOffset;
+};
+
+static_assert(sizeof(BinaryGraphHeader) == 72, "unexpected padding in BinaryGraphHeader");
+static_assert(sizeof(BinaryGraphNode) == 32, "unexpected padding in BinaryGraphNode");
+static_assert(sizeof(BinaryGraphAdjacency) == 8, "unexpected padding in BinaryGraphAdjacency");
+static_assert(sizeof(BinaryGraphEdge) == 24, "unexpected padding in BinaryGraphEdge");
+static_assert(sizeof(BinaryLandmarkHeader) == 48, "unexpected padding in BinaryLandmarkHeader");
+
+inline uint64_t align8(uint64_t offset) {
+    return (offset + 7) & ~uint64_t(7);
+}
+
+// maps filename read-only, false if it can not be mapped or is smaller than minSize
+inline bool mapFile(const std::string& filename, size_t minSize, const char*& data, size_t& size) {
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < minSize) {
+        ::close(fd);
+        return false;
+    }
+
+    void* mapped = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED)
+        return false;
+
+    data = static_cast<const char*>(mapped);
+    size = st.st_size;
+    return true;
+}
+
+inline void unmapFile(const char*& data, size_t& size) {
+    if (data)
+        munmap(const_cast<char*>(data), size);
+    data = nullptr;
+    size = 0;
+}
+
+// read-only view of a mapped file, all pointers stay valid until the view is destroyed
+class MappedGraph {
+   public:
+    MappedGraph() : _data(nullptr), _size(0), _owned() {}
+    ~MappedGraph() { close(); }
+
+    // false if the file can not be mapped or is no topoGen graph of this version
+    bool open(const std::string& filename) {
+        close();
+        if (!mapFile(filename, sizeof(BinaryGraphHeader), _data, _size))
+            return false;
+
+        if (!valid()) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    // the contents of a graph file in memory instead of the mapped file, false as open
+    bool assign(std::vector<char> contents) {
+        close();
+        _owned.swap(contents);
+        _data = _owned.data();
+        _size = _owned.size();
+        if (_size < sizeof(BinaryGraphHeader) || !valid()) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close() {
+        if (_owned.empty()) {
+            unmapFile(_data, _size);
+            return;
+        }
+        std::vector<char>().swap(_owned);
+        _data = nullptr;
+        _size = 0;
+    }
+
+    const BinaryGraphHeader& header() const { return *reinterpret_cast<const BinaryGraphHeader*>(_data); }
+
+    uint32_t numNodes() const { return header().numNodes; }
+    uint32_t numEdges() const { return header().numEdges; }
+
+    const BinaryGraphNode* nodes() const { return section<BinaryGraphNode>(header().nodesOffset); }
+    const BinaryGraphEdge* edges() const { return section<BinaryGraphEdge>(header().edgesOffset); }
+
+    // neighbours of node i are [adjacencyBegin(i), adjacencyEnd(i))
+    const BinaryGraphAdjacency* adjacencyBegin(uint32_t i) const {
+        return section<BinaryGraphAdjacency>(header().adjacencyOffset) + offsets()[i];
+    }
+    const BinaryGraphAdjacency* adjacencyEnd(uint32_t i) const {
+        return section<BinaryGraphAdjacency>(header().adjacencyOffset) + offsets()[i + 1];
+    }
+    uint32_t degree(uint32_t i) const { return offsets()[i + 1] - offsets()[i]; }
+
+    const char* name(uint32_t i) const { return _data + header().stringsOffset + nodes()[i].nameOffset; }
+
+   private:
+    template <class T>
+    const T* section(uint64_t offset) const {
+        return reinterpret_cast<const T*>(_data + offset);
+    }
+
+    const uint32_t* offsets() const { return section<uint32_t>(header().offsetsOffset); }
+
+    bool valid() const {
+        const BinaryGraphHeader& h = header();
+        if (memcmp(h.magic, MAGIC, sizeof(MAGIC)) != 0 || h.version != VERSION)
+            return false;
+
+        return h.nodesOffset + uint64_t(h.numNodes) * sizeof(BinaryGraphNode) <= h.offsetsOffset &&
+               h.offsetsOffset + (uint64_t(h.numNodes) + 1) * sizeof(uint32_t) <= h.adjacencyOffset &&
+               h.adjacencyOffset + 2 * uint64_t(h.numEdges) * sizeof(BinaryGraphAdjacency) <= h.edgesOffset &&
+               h.edgesOffset + uint64_t(h.numEdges) * sizeof(BinaryGraphEdge) <= h.stringsOffset &&
+               h.stringsOffset + h.stringsSize <= _size;
+    }
+
+    const char* _data;
+    size_t _size;
+    std::vector<char> _owned;  /// < contents given to assign
+
+    MappedGraph(const MappedGraph&);
+    MappedGraph& operator=(const MappedGraph&);
+};
+
+// read-only view of a mapped landmark file
+class MappedLandmarks {
+   public:
+    MappedLandmarks() : _data(nullptr), _size(0), _owned() {}
+    ~MappedLandmarks() { close(); }
+
+    // false if the file can not be mapped, is no landmark file of this version or belongs to another graph
+    bool open(const std::string& filename, const MappedGraph& graph) {
+        close();
+        if (!mapFile(filename, sizeof(BinaryLandmarkHeader), _data, _size))
+            return false;
+
+        if (!valid() || header().numNodes != graph.numNodes()) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    // the contents of a landmark file in memory instead of the mapped file, false as open
+    bool assign(std::vector<char> contents, const MappedGraph& graph) {
+        close();
+        _owned.swap(contents);
+        _data = _owned.data();
+        _size = _owned.size();
+        if (_size < sizeof(BinaryLandmarkHeader) || !valid() || header().numNodes != graph.numNodes()) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close() {
+        if (_owned.empty()) {
+            unmapFile(_data, _size);
+            return;
+        }
+        std::vector<char>().swap(_owned);
+        _data = nullptr;
+        _size = 0;
+    }
+
+    const BinaryLandmarkHeader& header() const { return *reinterpret_cast<const BinaryLandmarkHeader*>(_data); }
+
+    uint32_t numLandmarks() const { return header().numLandmarks; }
+    uint32_t landmark(uint32_t k) const { return landmarks()[k]; }
+
+    // km from landmark k to node i
+    double distance(uint32_t k, uint32_t i) const { return distances()[uint64_t(k) * header().numNodes + i]; }
+
+    // lower bound of the km between nodes s and t from the triangle inequality, infinity if they are not connected
+    double lowerBound(uint32_t s, uint32_t t) const {
+        double bound = 0.0;
+        for (uint32_t k = 0; k < numLandmarks(); ++k) {
+            double ds = distance(k, s);
+            double dt = distance(k, t);
+            if (std::isinf(ds) != std::isinf(dt))
+                return std::numeric_limits<double>::infinity();
+            if (!std::isinf(ds))
+                bound = std::max(bound, std::fabs(ds - dt));
+        }
+        return bound;
+    }
+
+   private:
+    const uint32_t* landmarks() const { return reinterpret_cast<const uint32_t*>(_data + header().landmarksOffset); }
+    const double* distances() const { return reinterpret_cast<const double*>(_data + header().distancesOffset); }
+
+    bool valid() const {
+        const BinaryLandmarkHeader& h = header();
+        if (memcmp(h.magic, LANDMARK_MAGIC, sizeof(LANDMARK_MAGIC)) != 0 || h.version != LANDMARK_VERSION)
+            return false;
+
+        return h.landmarksOffset + uint64_t(h.numLandmarks) * sizeof(uint32_t) <= h.distancesOffset &&
+               h.distancesOffset + uint64_t(h.numLandmarks) * h.numNodes * sizeof(double) <= _size;
+    }
+
+    const char* _data;
+    size_t _size;
+    std::vector<char> _owned;
+
+    MappedLandmarks(const MappedLandmarks&);
+    MappedLandmarks& operator=(const MappedLandmarks&);
+};
+
+// A* on a mapped graph, guided by the landmarks and the great circle distance. Keeps its buffers between queries, one
+// instance per thread.
+class AltQuery {
+   public:
+    AltQuery(const MappedGraph& graph, const MappedLandmarks& landmarks)
+        : _graph(graph), _landmarks(landmarks), _dist(), _pred(), _visited() {}
+
+    // km from node s to node t, path holds the node indices from s to t. Negative if t is not reachable.
+    double shortestPath(uint32_t s, uint32_t t, std::vector<uint32_t>& path) {
+        const double inf = std::numeric_limits<double>::infinity();
+        path.clear();
+        if (std::isinf(bound(s, t)))
+            return -1.0;
+
+        if (_dist.size() != _graph.numNodes()) {
+            _dist.assign(_graph.numNodes(), inf);
+            _pred.assign(_graph.numNodes(), NO_NODE);
+        }
+
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+
+        setDist(s, 0.0, NO_NODE);
+        queue.push(Entry{bound(s, t), 0.0, s});
+        while (!queue.empty()) {
+            Entry top = queue.top();
+            queue.pop();
+            uint32_t i = top.node;
+            if (i == t)
+                break;
+            if (top.dist > _dist[i])
+                continue;  // < outdated entry
+
+            for (const BinaryGraphAdjacency* a = _graph.adjacencyBegin(i); a != _graph.adjacencyEnd(i); ++a) {
+                double next = top.dist + _graph.edges()[a->edge].distance;
+                if (next < _dist[a->target]) {
+                    setDist(a->target, next, i);
+                    queue.push(Entry{next + bound(a->target, t), next, a->target});
+                }
+            }
+        }
+
+        double result = _dist[t];
+        if (!std::isinf(result)) {
+            for (uint32_t i = t; i != NO_NODE; i = _pred[i])
+                path.push_back(i);
+            std::reverse(path.begin(), path.end());
+        }
+
+        // only the touched entries are reset
+        for (uint32_t i : _visited) {
+            _dist[i] = inf;
+            _pred[i] = NO_NODE;
+        }
+        _visited.clear();
+
+        return std::isinf(result) ? -1.0 : result;
+    }
+
+   private:
+    struct Entry {
+        double key;   /// < distance plus bound
+        double dist;  /// < distance when queued
+        uint32_t node;
+
+        bool operator>(const Entry& other) const { return key > other.key; }
+    };
+
+    void setDist(uint32_t i, double d, uint32_t pred) {
+        if (std::isinf(_dist[i]))
+            _visited.push_back(i);
+        _dist[i] = d;
+        _pred[i] = pred;
+    }
+
+    // the great circle is shorter than any path, shrunk a little against rounding
+    double bound(uint32_t i, uint32_t t) const {
+        const BinaryGraphNode& a = _graph.nodes()[i];
+        const BinaryGraphNode& b = _graph.nodes()[t];
+        const double degToRad = M_PI / 180.0;
+        double latH = sin((a.lat - b.lat) * degToRad * 0.5);
+        double lonH = sin((a.lon - b.lon) * degToRad * 0.5);
+        double h = latH * latH + cos(a.lat * degToRad) * cos(b.lat * degToRad) * lonH * lonH;
+        double greatCircle = 2.0 * asin(sqrt(std::min(1.0, h))) * _landmarks.header().earthRadiusKm * (1.0 - 1e-9);
+        return std::max(greatCircle, _landmarks.lowerBound(i, t));
+    }
+
+    const MappedGraph& _graph;
+    const MappedLandmarks& _landmarks;
+    std::vector<double> _dist;
+    std::vector<uint32_t> _pred;
+    std::vector<uint32_t> _visited;
+};
+
+}  // namespace BinaryGraph
+
+#endif  // BINARYGRAPH_HPP
@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "BinaryOutput.hpp"
+
+#include "geo/CityNode.hpp"
+#include "geo/SeaCableEdge.hpp"
+#include "geo/SeaCableLandingPoint.hpp"
+#include "geo/SeaCableNode.hpp"
+#include "geo/SimulationEdge.hpp"
+#include "geo/SimulationNode.hpp"
+#include <cassert>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace BinaryGraph;
+
+namespace {
+
+class StringPool {
+   public:
+    uint32_t add(const std::string& str) {
+        auto it = _offsets.find(str);
+        if (it != _offsets.end())
+            return it->second;
+
+        uint32_t offset = _data.size();
+        _data.insert(_data.end(), str.begin(), str.end());
+        _data.push_back('\0');
+        _offsets[str] = offset;
+        return offset;
+    }
+
+    const std::vector<char>& data() { return _data; }
+
+   private:
+    std::vector<char> _data;
+    std::map<std::string, uint32_t> _offsets;
+};
+
+template <class T>
+void writeSection(WriteBuffer& out, uint64_t& pos, uint64_t offset, const std::vector<T>& values) {
+    static const char zeros[8] = {0};
+    assert(pos <= offset && offset - pos < 8);
+    out.write(zeros, offset - pos);
+    out.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+    pos = offset + values.size() * sizeof(T);
+}
+
+}  // namespace
+
+BinaryOutput::BinaryOutput(TopologyView_Ptr view) : _view(view) {
+}
+
+void BinaryOutput::addTo(ChunkedOutput& output, const std::string& filename) {
+    // the chunks keep the writer alive
+    auto self = shared_from_this();
+    output.addFile(filename);
+    output.addChunk([self](WriteBuffer& out) { self->write(out); });
+}
+
+void BinaryOutput::write(WriteBuffer& out) {
+    StringPool strings;
+    strings.add("");
+
+    // nodes, by index of the view
+    std::vector<BinaryGraphNode> nodes;
+    nodes.reserve(_view->nodes().size());
+    for (const TopologyView::Node& n : _view->nodes()) {
+        GeographicNode* node = n.node.get();
+
+        BinaryGraphNode record = BinaryGraphNode();
+        record.id = n.id;
+        record.outerId = -1;
+        record.lat = node->lat();
+        record.lon = node->lon();
+        record.type = GEOGRAPHIC_NODE;
+
+        switch (node->kind()) {
+            case GeographicNode::CITY_NODE:
+                record.type = CITY_NODE;
+                record.nameOffset = strings.add(static_cast<CityNode*>(node)->name());
+                break;
+            case GeographicNode::SEACABLE_LANDINGPOINT:
+                record.type = SEACABLE_LANDINGPOINT;
+                record.nameOffset = strings.add(static_cast<SeaCableLandingPoint*>(node)->name());
+                break;
+            case GeographicNode::SEACABLE_NODE:
+                record.type = SEACABLE_WAYPOINT;
+                record.nameOffset = strings.add("Seacable Waypoint");
+                break;
+            case GeographicNode::SIMULATION_NODE: {
+                SimulationNode* simNode = static_cast<SimulationNode*>(node);
+                record.type = SIMULATION_NODE;
+                record.id = simNode->id();
+                record.outerId = simNode->outerID();
+                record.nameOffset = strings.add("Simulation Node");
+                break;
+            }
+            default:
+                break;
+        }
+
+        nodes.push_back(record);
+    }
+
+    // edges and node degrees
+    std::vector<BinaryGraphEdge> edges;
+    edges.reserve(_view->edges().size());
+    std::vector<uint32_t> offsets(nodes.size() + 1, 0);
+    for (const TopologyView::Edge& edge : _view->edges()) {
+        BinaryGraphEdge record = BinaryGraphEdge();
+        record.u = edge.uIndex;
+        record.v = edge.vIndex;
+        record.distance = edge.lengthKM;
+
+        switch (edge.kind) {
+            case GeographicEdge::SEACABLE_EDGE:
+                record.type = SEACABLE_EDGE;
+                break;
+            case GeographicEdge::SIMULATION_EDGE:
+                record.type = SIMULATION_EDGE;
+                break;
+            default:
+                record.type = NORMAL_EDGE;
+                break;
+        }
+
+        ++offsets[record.u + 1];
+        ++offsets[record.v + 1];
+        edges.push_back(record);
+    }
+
+    // CSR adjacency, neighbours in edge order
+    for (size_t i = 1; i < offsets.size(); ++i)
+        offsets[i] += offsets[i - 1];
+
+    std::vector<BinaryGraphAdjacency> adjacency(2 * edges.size());
+    std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+    for (uint32_t e = 0; e < edges.size(); ++e) {
+        adjacency[fill[edges[e].u]++] = BinaryGraphAdjacency{edges[e].v, e};
+        adjacency[fill[edges[e].v]++] = BinaryGraphAdjacency{edges[e].u, e};
+    }
+
+    BinaryGraphHeader header = BinaryGraphHeader();
+    std::copy(MAGIC, MAGIC + sizeof(MAGIC), header.magic);
+    header.version = VERSION;
+    header.numNodes = nodes.size();
+    header.numEdges = edges.size();
+    header.nodesOffset = align8(sizeof(BinaryGraphHeader));
+    header.offsetsOffset = align8(header.nodesOffset + nodes.size() * sizeof(BinaryGraphNode));
+    header.adjacencyOffset = align8(header.offsetsOffset + offsets.size() * sizeof(uint32_t));
+    header.edgesOffset = align8(header.adjacencyOffset + adjacency.size() * sizeof(BinaryGraphAdjacency));
+    header.stringsOffset = align8(header.edgesOffset + edges.size() * sizeof(BinaryGraphEdge));
+    header.stringsSize = strings.data().size();
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    uint64_t pos = sizeof(header);
+    writeSection(out, pos, header.nodesOffset, nodes);
+    writeSection(out, pos, header.offsetsOffset, offsets);
+    writeSection(out, pos, header.adjacencyOffset, adjacency);
+    writeSection(out, pos, header.edgesOffset, edges);
+    writeSection(out, pos, header.stringsOffset, strings.data());
+}
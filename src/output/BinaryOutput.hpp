@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef BINARYOUTPUT_HPP
+#define BINARYOUTPUT_HPP
+
+#include "output/BinaryGraph.hpp"
+#include "output/ChunkedOutput.hpp"
+#include "output/TopologyView.hpp"
+#include <memory>
+#include <string>
+
+// writes the nodes and edges of the JSON output in the format of BinaryGraph.hpp
+class BinaryOutput : public std::enable_shared_from_this<BinaryOutput> {
+   public:
+    BinaryOutput(TopologyView_Ptr view);
+
+    // the file is one chunk, its sections refer to each other
+    void addTo(ChunkedOutput& output, const std::string& filename);
+
+   private:
+    void write(WriteBuffer& out);
+
+    TopologyView_Ptr _view;
+
+    BinaryOutput(const BinaryOutput&);
+};
+
+typedef std::shared_ptr<BinaryOutput> BinaryOutput_Ptr;
+
+#endif  // BINARYOUTPUT_HPP
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ChunkedOutput.hpp"
+#include <algorithm>
+#include <boost/log/trivial.hpp>
+#include <cassert>
+#include <memory>
+
+constexpr size_t ChunkedOutput::CHUNK_SIZE;
+constexpr size_t ChunkedOutput::WINDOW_PER_THREAD;
+
+ChunkedOutput::ChunkedOutput(ThreadPool_Ptr pool, size_t window)
+    : _pool(pool),
+      _window(window > 0 ? window : WINDOW_PER_THREAD * pool->size()),
+      _suffix(Compression::fromConfig().suffix()),
+      _files(),
+      _chunks() {
+}
+
+void ChunkedOutput::addFile(const std::string& filename, const std::string& zipEntry, bool compress) {
+    std::string name = compress && zipEntry.empty() ? filename + _suffix : filename;
+    _files.push_back(File{name, zipEntry, std::vector<size_t>()});
+}
+
+void ChunkedOutput::addChunk(const Chunk& chunk) {
+    assert(!_files.empty());
+    _files.back().chunks.push_back(_chunks.size());
+    _chunks.push_back(chunk);
+}
+
+void ChunkedOutput::addRange(size_t count, const RangeChunk& chunk) {
+    for (size_t begin = 0; begin < count; begin += CHUNK_SIZE) {
+        size_t end = std::min(count, begin + CHUNK_SIZE);
+        addChunk([chunk, begin, end](WriteBuffer& out) { chunk(out, begin, end); });
+    }
+}
+
+bool ChunkedOutput::write(void) {
+    bool written = true;
+    for (const File& file : _files) {
+        WriteBuffer out(file.filename, file.zipEntry);
+        for (size_t first = 0; first < file.chunks.size(); first += _window) {
+            size_t count = std::min(_window, file.chunks.size() - first);
+            std::vector<std::unique_ptr<WriteBuffer>> formatted(count);
+            _pool->forEach(count, [&](size_t i) {
+                formatted[i].reset(new WriteBuffer);
+                _chunks[file.chunks[first + i]](*formatted[i]);
+            });
+            for (std::unique_ptr<WriteBuffer>& chunk : formatted)
+                out.append(*chunk);
+        }
+        written = out.close() && written;
+        BOOST_LOG_TRIVIAL(info) << "wrote " << file.filename;
+    }
+
+    _files.clear();
+    _chunks.clear();
+    return written;
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CHUNKEDOUTPUT_HPP
+#define CHUNKEDOUTPUT_HPP
+
+#include "output/WriteBuffer.hpp"
+#include "util/ThreadPool.hpp"
+#include <functional>
+#include <string>
+#include <vector>
+
+// output files made of chunks. write() writes the files one after another, each as the concatenation of its chunks
+// in the order they were added. The chunks are formatted on the pool, one chunk per task, and at most window
+// formatted chunks are held at a time. With output.compression the files are compressed streams and get the suffix
+// of the codec.
+class ChunkedOutput {
+   public:
+    typedef std::function<void(WriteBuffer& out)> Chunk;
+    typedef std::function<void(WriteBuffer& out, size_t begin, size_t end)> RangeChunk;
+
+    // a window of 0 holds WINDOW_PER_THREAD chunks per thread of the pool
+    ChunkedOutput(ThreadPool_Ptr pool, size_t window = 0);
+
+    // following chunks belong to filename, see WriteBuffer for zipEntry. Zip archives and files added with compress
+    // false, e.g. KML that Google Earth reads as it is, are not compressed.
+    void addFile(const std::string& filename, const std::string& zipEntry = "", bool compress = true);
+
+    void addChunk(const Chunk& chunk);
+
+    // chunks for [0, count) in pieces of CHUNK_SIZE elements
+    void addRange(size_t count, const RangeChunk& chunk);
+
+    // false if a file could not be written
+    bool write(void);
+
+   private:
+    struct File {
+        std::string filename;
+        std::string zipEntry;
+        std::vector<size_t> chunks;  /// < into _chunks
+    };
+
+    static constexpr size_t CHUNK_SIZE = 1024;
+    static constexpr size_t WINDOW_PER_THREAD = 4;
+
+    ThreadPool_Ptr _pool;
+    size_t _window;
+    std::string _suffix;  /// < of the compressed files
+    std::vector<File> _files;
+    std::vector<Chunk> _chunks;
+};
+
+#endif  // CHUNKEDOUTPUT_HPP
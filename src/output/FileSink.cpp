@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "FileSink.hpp"
+#include "config/Config.hpp"
+#include <algorithm>
+#include <boost/log/trivial.hpp>
+#include <cassert>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+constexpr size_t FileSink::BLOCK_SIZE;
+
+FileSink::Settings FileSink::Settings::fromConfig(void) {
+    Config config;
+    Settings settings;
+    settings.async = config.get<bool>("output.async");
+    settings.bufferSize = std::max<size_t>(config.get<unsigned int>("output.bufferSize"), BLOCK_SIZE);
+    settings.direct = config.get<bool>("output.direct");
+    return settings;
+}
+
+FileSink::FileSink(const std::string& filename, const Settings& settings)
+    : _fd(-1),
+      _good(false),
+      _async(settings.async),
+      _direct(false),
+      _writer(),
+      _mutex(),
+      _changed(),
+      _pending(),
+      _pendingSize(0),
+      _busy(false),
+      _closing(false),
+      _aligned(nullptr),
+      _alignedSize(0),
+      _alignedUsed(0),
+      _written(0) {
+    const int flags = O_WRONLY | O_CREAT | O_TRUNC;
+#ifdef O_DIRECT
+    if (settings.direct) {
+        _fd = open(filename.c_str(), flags | O_DIRECT, 0666);
+        if (_fd < 0)
+            BOOST_LOG_TRIVIAL(warning) << "no O_DIRECT for " << filename << ": " << strerror(errno);
+    }
+#else
+    if (settings.direct)
+        BOOST_LOG_TRIVIAL(warning) << "no O_DIRECT on this system, writing " << filename << " buffered";
+#endif
+    if (_fd >= 0) {
+        // whole blocks of the buffer size
+        _alignedSize = (settings.bufferSize + BLOCK_SIZE - 1) / BLOCK_SIZE * BLOCK_SIZE;
+        void* aligned = nullptr;
+        if (posix_memalign(&aligned, BLOCK_SIZE, _alignedSize) == 0) {
+            _aligned = static_cast<char*>(aligned);
+            _direct = true;
+        } else {
+            close();
+        }
+    }
+    if (_fd < 0)
+        _fd = open(filename.c_str(), flags, 0666);
+    _good = _fd >= 0;
+    if (!_good) {
+        BOOST_LOG_TRIVIAL(error) << "cannot open " << filename << ": " << strerror(errno);
+        return;
+    }
+
+    if (_async)
+        _writer = std::thread(&FileSink::run, this);
+}
+
+FileSink::~FileSink() {
+    close();
+}
+
+bool FileSink::isOpen(void) const {
+    return _fd >= 0;
+}
+
+void FileSink::submit(std::vector<char>& buffer, size_t size) {
+    assert(size <= buffer.size());
+    if (_fd < 0 || size == 0)
+        return;
+
+    if (!_async) {
+        if (_direct)
+            writeDirect(buffer.data(), size);
+        else
+            writeAll(buffer.data(), size);
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    _changed.wait(lock, [this] { return !_busy; });
+    std::swap(buffer, _pending);
+    if (buffer.size() < _pending.size())
+        buffer.resize(_pending.size());
+    _pendingSize = size;
+    _busy = true;
+    _changed.notify_all();
+}
+
+void FileSink::run(void) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true) {
+        _changed.wait(lock, [this] { return _busy || _closing; });
+        if (!_busy)
+            return;
+
+        // the caller fills the other buffer meanwhile
+        lock.unlock();
+        if (_direct)
+            writeDirect(_pending.data(), _pendingSize);
+        else
+            writeAll(_pending.data(), _pendingSize);
+        lock.lock();
+        _busy = false;
+        _changed.notify_all();
+    }
+}
+
+void FileSink::writeAll(const char* data, size_t size) {
+    while (_good && size > 0) {
+        ssize_t written = write(_fd, data, size);
+#ifdef O_DIRECT
+        // file systems that open with O_DIRECT but do not write with it
+        if (written < 0 && errno == EINVAL && _direct) {
+            BOOST_LOG_TRIVIAL(warning) << "O_DIRECT writes rejected, writing buffered";
+            fcntl(_fd, F_SETFL, fcntl(_fd, F_GETFL) & ~O_DIRECT);
+            continue;
+        }
+#endif
+        if (written < 0 && errno == EINTR)
+            continue;
+        if (written <= 0) {
+            BOOST_LOG_TRIVIAL(error) << "write failed: " << strerror(errno);
+            _good = false;
+            return;
+        }
+        data += written;
+        size -= written;
+        _written += written;
+    }
+}
+
+void FileSink::writeDirect(const char* data, size_t size) {
+    while (size > 0) {
+        size_t piece = std::min(size, _alignedSize - _alignedUsed);
+        memcpy(_aligned + _alignedUsed, data, piece);
+        _alignedUsed += piece;
+        data += piece;
+        size -= piece;
+        if (_alignedUsed == _alignedSize) {
+            writeAll(_aligned, _alignedSize);
+            _alignedUsed = 0;
+        }
+    }
+}
+
+bool FileSink::finishDirect(void) {
+    if (_alignedUsed == 0)
+        return true;
+
+    // the last block padded with zeros, then the file is cut back to the bytes submitted
+    uint64_t size = _written + _alignedUsed;
+    size_t blocks = (_alignedUsed + BLOCK_SIZE - 1) / BLOCK_SIZE * BLOCK_SIZE;
+    memset(_aligned + _alignedUsed, 0, blocks - _alignedUsed);
+    writeAll(_aligned, blocks);
+    _alignedUsed = 0;
+    return _good && ftruncate(_fd, size) == 0;
+}
+
+bool FileSink::close(void) {
+    if (_writer.joinable()) {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _changed.wait(lock, [this] { return !_busy; });
+            _closing = true;
+            _changed.notify_all();
+        }
+        _writer.join();
+    }
+
+    if (_fd >= 0) {
+        if (_direct)
+            _good = finishDirect() && _good;
+        _good = ::close(_fd) == 0 && _good;
+        _fd = -1;
+    }
+    free(_aligned);
+    _aligned = nullptr;
+    return _good;
+}
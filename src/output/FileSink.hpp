@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef FILESINK_HPP
+#define FILESINK_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// destination file of a WriteBuffer. Asynchronously a background thread writes each submitted buffer while the
+// caller fills the next one, so formatting overlaps with the disk. With direct the file is written through O_DIRECT
+// in whole blocks from an aligned copy and cut to its size on close, which bypasses the page cache for large outputs.
+class FileSink {
+   public:
+    // the config values output.async, output.bufferSize and output.direct
+    struct Settings {
+        bool async;
+        size_t bufferSize;  /// < bytes of each buffer of a WriteBuffer
+        bool direct;
+
+        static Settings fromConfig(void);
+    };
+
+    FileSink(const std::string& filename, const Settings& settings);
+    ~FileSink();
+
+    bool isOpen(void) const;
+
+    // writes buffer[0, size). Asynchronously buffer is swapped with the one written before, which has the same size,
+    // and the call only waits for that write to finish.
+    void submit(std::vector<char>& buffer, size_t size);
+
+    // waits for the pending write, false if anything could not be written
+    bool close(void);
+
+   private:
+    void run(void);
+    void writeAll(const char* data, size_t size);
+    void writeDirect(const char* data, size_t size);
+    bool finishDirect(void);
+
+    static constexpr size_t BLOCK_SIZE = 4096;
+
+    int _fd;
+    bool _good;  /// < written by the writer thread while it is busy
+    bool _async;
+    bool _direct;
+
+    // background writer, _pending is written while _busy
+    std::thread _writer;
+    std::mutex _mutex;
+    std::condition_variable _changed;
+    std::vector<char> _pending;
+    size_t _pendingSize;
+    bool _busy;
+    bool _closing;
+
+    // O_DIRECT copy of the next blocks and the bytes written before it
+    char* _aligned;
+    size_t _alignedSize;
+    size_t _alignedUsed;
+    uint64_t _written;
+
+    FileSink(const FileSink&);
+    FileSink& operator=(const FileSink&);
+};
+
+#endif  // FILESINK_HPP
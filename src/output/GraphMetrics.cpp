@@ -0,0 +1,366 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "GraphMetrics.hpp"
+
+#include "geo/CityNode.hpp"
+#include "geo/SeaCableLandingPoint.hpp"
+#include "util/CounterRNG.hpp"
+#include "util/ThreadPool.hpp"
+#include <algorithm>
+#include <bitset>
+#include <cassert>
+#include <numeric>
+
+namespace {
+
+// sources of one bit-parallel BFS
+const size_t BFS_WIDTH = 64;
+
+// sampled sources per betweenness task, the partial sums are added in task order for any thread count
+const size_t SOURCES_PER_TASK = 16;
+
+size_t popcount(uint64_t bits) {
+    return std::bitset<64>(bits).count();
+}
+
+Json::Value counts(const std::vector<uint64_t>& values) {
+    Json::Value array(Json::arrayValue);
+    for (uint64_t value : values)
+        array.append(Json::UInt64(value));
+    return array;
+}
+
+}  // namespace
+
+GraphMetrics::GraphMetrics(TopologyView_Ptr view, const std::string& seed)
+    : _view(view), _seed(seed), _graph(view), _metrics(Json::objectValue) {
+}
+
+void GraphMetrics::compute(size_t sources, size_t betweennessSamples, size_t top) {
+    _metrics = Json::Value(Json::objectValue);
+    _metrics["nodes"] = Json::UInt64(_graph.numNodes());
+    _metrics["edges"] = Json::UInt64(_view->edges().size());
+
+    size_t cities = 0;
+    for (const TopologyView::Node& node : _view->nodes())
+        cities += node.node->kind() == GeographicNode::CITY_NODE;
+    _metrics["cities"] = Json::UInt64(cities);
+    _metrics["degree"] = degrees(top);
+    _metrics["components"] = components();
+    _metrics["paths"] = paths(sources);
+    if (betweennessSamples > 0)
+        _metrics["betweenness"] = betweenness(betweennessSamples, top);
+    _metrics["seacable"] = seacables();
+}
+
+void GraphMetrics::addTo(ChunkedOutput& output, const std::string& filename) {
+    // the chunks keep the metrics alive
+    auto self = shared_from_this();
+    output.addFile(filename);
+    output.addChunk([self](WriteBuffer& out) {
+        Json::StyledWriter writer;
+        out << writer.write(self->_metrics);
+    });
+}
+
+std::vector<unsigned> GraphMetrics::sample(size_t count, uint32_t draw) const {
+    const size_t n = _graph.numNodes();
+    std::vector<unsigned> nodes(n);
+    std::iota(nodes.begin(), nodes.end(), 0);
+    if (count == 0 || count >= n)
+        return nodes;
+
+    // partial Fisher-Yates shuffle, the i-th choice is the i-th number of the stream
+    CounterRNG rng(_seed);
+    for (size_t i = 0; i < count; ++i)
+        std::swap(nodes[i], nodes[i + rng.below(CounterRNG::METRICS_SOURCES, i, n - i, draw)]);
+    nodes.resize(count);
+    std::sort(nodes.begin(), nodes.end());
+    return nodes;
+}
+
+Json::Value GraphMetrics::node(unsigned i) const {
+    const TopologyView::Node& viewNode = _view->nodes()[i];
+    Json::Value entry(Json::objectValue);
+    entry["id"] = viewNode.id;
+    entry["latitude"] = viewNode.node->lat();
+    entry["longitude"] = viewNode.node->lon();
+    if (CityNode* city = nodeCast<CityNode>(viewNode.node.get()))
+        entry["name"] = city->name();
+    else if (SeaCableLandingPoint* landingPoint = nodeCast<SeaCableLandingPoint>(viewNode.node.get()))
+        entry["name"] = landingPoint->name();
+    return entry;
+}
+
+Json::Value GraphMetrics::degrees(size_t top) const {
+    const std::vector<unsigned>& offsets = _graph.offsets();
+    const size_t n = _graph.numNodes();
+
+    std::vector<uint64_t> distribution;
+    for (size_t i = 0; i < n; ++i) {
+        unsigned degree = offsets[i + 1] - offsets[i];
+        if (degree >= distribution.size())
+            distribution.resize(degree + 1, 0);
+        ++distribution[degree];
+    }
+
+    std::vector<unsigned> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&offsets](unsigned a, unsigned b) {
+        return offsets[a + 1] - offsets[a] > offsets[b + 1] - offsets[b];
+    });
+
+    Json::Value highest(Json::arrayValue);
+    for (size_t k = 0; k < std::min(top, n); ++k) {
+        Json::Value entry = node(order[k]);
+        entry["degree"] = offsets[order[k] + 1] - offsets[order[k]];
+        highest.append(entry);
+    }
+
+    Json::Value result(Json::objectValue);
+    result["mean"] = n > 0 ? 2.0 * _graph.numEdges() / n : 0.0;
+    result["max"] = Json::UInt64(distribution.empty() ? 0 : distribution.size() - 1);
+    result["distribution"] = counts(distribution);
+    result["highest"] = highest;
+    return result;
+}
+
+Json::Value GraphMetrics::components(void) const {
+    const std::vector<unsigned>& offsets = _graph.offsets();
+    const std::vector<unsigned>& neighbours = _graph.neighbours();
+    const size_t n = _graph.numNodes();
+
+    std::vector<char> visited(n, false);
+    std::vector<unsigned> queue;
+    size_t count = 0;
+    size_t largest = 0;
+    for (unsigned start = 0; start < n; ++start) {
+        if (visited[start])
+            continue;
+        ++count;
+        visited[start] = true;
+        queue.assign(1, start);
+        for (size_t head = 0; head < queue.size(); ++head)
+            for (unsigned a = offsets[queue[head]]; a < offsets[queue[head] + 1]; ++a)
+                if (!visited[neighbours[a]]) {
+                    visited[neighbours[a]] = true;
+                    queue.push_back(neighbours[a]);
+                }
+        largest = std::max(largest, queue.size());
+    }
+
+    Json::Value result(Json::objectValue);
+    result["count"] = Json::UInt64(count);
+    result["largest"] = Json::UInt64(largest);
+    return result;
+}
+
+Json::Value GraphMetrics::paths(size_t sources) const {
+    const std::vector<unsigned>& offsets = _graph.offsets();
+    const std::vector<unsigned>& neighbours = _graph.neighbours();
+    const size_t n = _graph.numNodes();
+    const std::vector<unsigned> from = sample(sources, 0);
+
+    // bit k of a node stands for source k of the batch: seen by it, reached in the last level, reached next
+    const size_t batches = (from.size() + BFS_WIDTH - 1) / BFS_WIDTH;
+    std::vector<std::vector<uint64_t>> pairs(batches);  /// < source-target pairs by hops
+    ThreadPool_Ptr pool(ThreadPool::fromConfig());
+    pool->forEach(batches, [&](size_t b) {
+        std::vector<uint64_t> seen(n, 0);
+        std::vector<uint64_t> frontier(n, 0);
+        std::vector<uint64_t> next(n, 0);
+
+        size_t first = b * BFS_WIDTH;
+        size_t width = std::min(BFS_WIDTH, from.size() - first);
+        for (size_t k = 0; k < width; ++k) {
+            seen[from[first + k]] |= uint64_t(1) << k;
+            frontier[from[first + k]] |= uint64_t(1) << k;
+        }
+        pairs[b].push_back(width);
+
+        while (true) {
+            for (size_t v = 0; v < n; ++v)
+                if (frontier[v] != 0)
+                    for (unsigned a = offsets[v]; a < offsets[v + 1]; ++a)
+                        next[neighbours[a]] |= frontier[v];
+
+            uint64_t reached = 0;
+            for (size_t v = 0; v < n; ++v) {
+                uint64_t fresh = next[v] & ~seen[v];
+                seen[v] |= fresh;
+                frontier[v] = fresh;
+                next[v] = 0;
+                reached += popcount(fresh);
+            }
+            if (reached == 0)
+                break;
+            pairs[b].push_back(reached);
+        }
+    });
+
+    std::vector<uint64_t> distribution;
+    for (const std::vector<uint64_t>& batch : pairs) {
+        if (batch.size() > distribution.size())
+            distribution.resize(batch.size(), 0);
+        for (size_t hops = 0; hops < batch.size(); ++hops)
+            distribution[hops] += batch[hops];
+    }
+
+    uint64_t reachable = 0;
+    uint64_t hopSum = 0;
+    for (size_t hops = 1; hops < distribution.size(); ++hops) {
+        reachable += distribution[hops];
+        hopSum += hops * distribution[hops];
+    }
+
+    Json::Value result(Json::objectValue);
+    result["sources"] = Json::UInt64(from.size());
+    result["exact"] = from.size() == n;
+    result["diameter"] = Json::UInt64(distribution.empty() ? 0 : distribution.size() - 1);
+    result["averageLength"] = reachable > 0 ? double(hopSum) / reachable : 0.0;
+    result["reachablePairs"] = Json::UInt64(reachable);
+    result["distribution"] = counts(distribution);
+    return result;
+}
+
+Json::Value GraphMetrics::betweenness(size_t samples, size_t top) const {
+    const std::vector<unsigned>& offsets = _graph.offsets();
+    const std::vector<unsigned>& neighbours = _graph.neighbours();
+    const size_t n = _graph.numNodes();
+    const std::vector<unsigned> from = sample(samples, 1);
+
+    const size_t tasks = (from.size() + SOURCES_PER_TASK - 1) / SOURCES_PER_TASK;
+    std::vector<std::vector<double>> partial(tasks);
+    ThreadPool_Ptr pool(ThreadPool::fromConfig());
+    pool->forEach(tasks, [&](size_t t) {
+        std::vector<double>& sum = partial[t];
+        sum.assign(n, 0.0);
+        std::vector<int> distance(n, -1);
+        std::vector<double> paths(n, 0.0);
+        std::vector<double> dependency(n, 0.0);
+        std::vector<unsigned> order;
+
+        size_t end = std::min(from.size(), (t + 1) * SOURCES_PER_TASK);
+        for (size_t s = t * SOURCES_PER_TASK; s < end; ++s) {
+            // shortest path counts in BFS order
+            order.assign(1, from[s]);
+            distance[from[s]] = 0;
+            paths[from[s]] = 1.0;
+            for (size_t head = 0; head < order.size(); ++head) {
+                unsigned v = order[head];
+                for (unsigned a = offsets[v]; a < offsets[v + 1]; ++a) {
+                    unsigned w = neighbours[a];
+                    if (distance[w] < 0) {
+                        distance[w] = distance[v] + 1;
+                        order.push_back(w);
+                    }
+                    if (distance[w] == distance[v] + 1)
+                        paths[w] += paths[v];
+                }
+            }
+
+            // dependencies in reverse BFS order
+            for (size_t k = order.size(); k-- > 1;) {
+                unsigned w = order[k];
+                for (unsigned a = offsets[w]; a < offsets[w + 1]; ++a) {
+                    unsigned v = neighbours[a];
+                    if (distance[v] == distance[w] - 1)
+                        dependency[v] += paths[v] / paths[w] * (1.0 + dependency[w]);
+                }
+                sum[w] += dependency[w];
+            }
+
+            for (unsigned v : order) {
+                distance[v] = -1;
+                paths[v] = 0.0;
+                dependency[v] = 0.0;
+            }
+        }
+    });
+
+    // every pair is counted from both ends when all sources are taken, normalized by the pairs without the node
+    std::vector<double> centrality(n, 0.0);
+    double pairsWithout = n > 2 ? (n - 1.0) * (n - 2.0) / 2.0 : 1.0;
+    double scale = from.empty() ? 0.0 : double(n) / from.size() / 2.0 / pairsWithout;
+    for (const std::vector<double>& sum : partial)
+        for (size_t v = 0; v < n; ++v)
+            centrality[v] += sum[v];
+    for (double& value : centrality)
+        value *= scale;
+
+    std::vector<unsigned> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [&centrality](unsigned a, unsigned b) { return centrality[a] > centrality[b]; });
+
+    Json::Value highest(Json::arrayValue);
+    for (size_t k = 0; k < std::min(top, n); ++k) {
+        Json::Value entry = node(order[k]);
+        entry["betweenness"] = centrality[order[k]];
+        highest.append(entry);
+    }
+
+    Json::Value result(Json::objectValue);
+    result["samples"] = Json::UInt64(from.size());
+    result["mean"] = n > 0 ? std::accumulate(centrality.begin(), centrality.end(), 0.0) / n : 0.0;
+    result["max"] = n > 0 ? centrality[order[0]] : 0.0;
+    result["highest"] = highest;
+    return result;
+}
+
+Json::Value GraphMetrics::seacables(void) const {
+    size_t edges = 0;
+    double length = 0.0;
+    double seacableLength = 0.0;
+    for (const TopologyView::Edge& edge : _view->edges()) {
+        length += edge.length;
+        if (edge.kind == GeographicEdge::SEACABLE_EDGE) {
+            ++edges;
+            seacableLength += edge.length;
+        }
+    }
+
+    size_t landingPoints = 0;
+    size_t waypoints = 0;
+    for (const TopologyView::Node& node : _view->nodes()) {
+        if (node.node->kind() == GeographicNode::SEACABLE_LANDINGPOINT)
+            ++landingPoints;
+        else if (node.node->kind() == GeographicNode::SEACABLE_NODE)
+            ++waypoints;
+    }
+
+    Json::Value result(Json::objectValue);
+    result["edges"] = Json::UInt64(edges);
+    result["edgeShare"] = _view->edges().empty() ? 0.0 : double(edges) / _view->edges().size();
+    result["lengthShare"] = length > 0.0 ? seacableLength / length : 0.0;
+    result["landingPoints"] = Json::UInt64(landingPoints);
+    result["waypoints"] = Json::UInt64(waypoints);
+    return result;
+}
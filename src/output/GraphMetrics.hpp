@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef GRAPHMETRICS_HPP
+#define GRAPHMETRICS_HPP
+
+#include "output/ChunkedOutput.hpp"
+#include "output/GraphPartition.hpp"
+#include "output/TopologyView.hpp"
+#include <json/json.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+class GraphMetrics;
+typedef std::shared_ptr<GraphMetrics> GraphMetrics_Ptr;
+
+// quality metrics of a topology on the graph of its view, with parallel edges merged: node kinds, degrees,
+// components, hop distances, betweenness and the share of the submarine cables. The hop distances come from a
+// bit-parallel BFS of 64 sources at a time, the betweenness from Brandes' algorithm on sampled sources, both on the
+// thread pool. The samples are drawn from the seed, so a run writes the same metrics for any thread count.
+class GraphMetrics : public std::enable_shared_from_this<GraphMetrics> {
+   public:
+    GraphMetrics(TopologyView_Ptr view, const std::string& seed);
+
+    // sources 0 measures the paths from every node, the diameter is exact then and a lower bound otherwise.
+    // betweennessSamples 0 skips the betweenness.
+    void compute(size_t sources, size_t betweennessSamples, size_t top);
+
+    const Json::Value& metrics(void) const { return _metrics; }
+
+    void addTo(ChunkedOutput& output, const std::string& filename);
+
+   private:
+    // count nodes of [0, n) without repetition, all of them in order if count is 0 or at least n
+    std::vector<unsigned> sample(size_t count, uint32_t draw) const;
+
+    Json::Value degrees(size_t top) const;
+    Json::Value components(void) const;
+    Json::Value paths(size_t sources) const;
+    Json::Value betweenness(size_t samples, size_t top) const;
+    Json::Value seacables(void) const;
+
+    // node entry of the top lists
+    Json::Value node(unsigned i) const;
+
+    TopologyView_Ptr _view;
+    std::string _seed;
+    GraphPartition _graph;  /// < adjacency in compressed sparse rows
+    Json::Value _metrics;
+};
+
+#endif  // GRAPHMETRICS_HPP
@@ -34,59 +34,57 @@
 #include "geo/SeaCableNode.hpp"
 #include "geo/SeaCableEdge.hpp"
 
-GraphOutput::GraphOutput(BaseTopology_Ptr baseTopo, std::ofstream& nodeFile, std::ofstream& edgeFile)
-    : _baseTopo(baseTopo),
-      _graph(_baseTopo->getGraph()),
-      _nodeToCity(_baseTopo->getNodeMap()),
-      _nodeFile(nodeFile),
-      _edgeFile(edgeFile) {
+GraphOutput::GraphOutput(TopologyView_Ptr view) : _view(view) {
 }
 
-void GraphOutput::writeNodes(void) {
-    for (Graph::NodeIt n(*_graph); n != lemon::INVALID; ++n) {
-        GeographicNode_Ptr node = (*_nodeToCity)[n];
-        if (!node->isValid())
-            continue;
+void GraphOutput::addTo(ChunkedOutput& output, const std::string& nodeFileName, const std::string& edgeFileName) {
+    // the chunks keep the writer alive
+    auto self = shared_from_this();
+    output.addFile(nodeFileName);
+    output.addRange(_view->nodes().size(),
+                    [self](WriteBuffer& out, size_t begin, size_t end) { self->writeNodes(out, begin, end); });
 
-        _nodeFile << _graph->id(n) << "\t";
+    output.addFile(edgeFileName);
+    output.addRange(_view->edges().size(),
+                    [self](WriteBuffer& out, size_t begin, size_t end) { self->writeEdges(out, begin, end); });
+}
 
-        if (dynamic_cast<CityNode*>(node.get()))
-            _nodeFile << dynamic_cast<CityNode*>(node.get())->name();
+void GraphOutput::writeNodes(WriteBuffer& nodeFile, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+        const TopologyView::Node& n = _view->nodes()[i];
+        GeographicNode* node = n.node.get();
 
-        if (dynamic_cast<SeaCableLandingPoint*>(node.get()))
-            _nodeFile << dynamic_cast<SeaCableLandingPoint*>(node.get())->name();
+        nodeFile << n.id << '\t';
 
-        if (dynamic_cast<SeaCableNode*>(node.get()))
-            _nodeFile << "Seacable Waypoint";
+        switch (node->kind()) {
+            case GeographicNode::CITY_NODE:
+                nodeFile << static_cast<CityNode*>(node)->name();
+                break;
+            case GeographicNode::SEACABLE_LANDINGPOINT:
+                nodeFile << static_cast<SeaCableLandingPoint*>(node)->name();
+                break;
+            case GeographicNode::SEACABLE_NODE:
+                nodeFile << "Seacable Waypoint";
+                break;
+            default:
+                break;
+        }
 
-        _nodeFile << "\t" << (*_nodeToCity)[n]->lat() << "\t" << (*_nodeToCity)[n]->lon() << std::endl;
+        nodeFile << '\t' << Shortest(node->lat()) << '\t' << Shortest(node->lon()) << '\n';
     }
 }
 
-void GraphOutput::writeEdges(void) {
-    // write out edges
-
-    auto _nodeInfos = _baseTopo->getNodeMap();
-    for (Graph::EdgeIt edge(*_graph); edge != lemon::INVALID; ++edge) {
-        GeographicNode_Ptr n1 = (*_nodeInfos)[_graph->u(edge)];
-        GeographicNode_Ptr n2 = (*_nodeInfos)[_graph->v(edge)];
-        if (!n1->isValid() || !n2->isValid())
-            continue;
-
-        bool seacable = false;
-        EdgeMap_Ptr edgeMap = _baseTopo->getEdgeMap();
-        GeographicEdge_Ptr edge_Ptr = (*edgeMap)[edge];
+void GraphOutput::writeEdges(WriteBuffer& edgeFile, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+        const TopologyView::Edge& edge = _view->edges()[i];
 
-        if (dynamic_cast<SeaCableEdge*>(edge_Ptr.get()))
-            seacable = true;
+        edgeFile << edge.u << '\t' << edge.v;
 
-        _edgeFile << _graph->id(_graph->u(Graph::Edge(edge))) << "\t" << _graph->id(_graph->v(Graph::Edge(edge)));
-
-        if (seacable)
-            _edgeFile << "\tseacable";
+        if (edge.kind == GeographicEdge::SEACABLE_EDGE)
+            edgeFile << "\tseacable";
         else
-            _edgeFile << "\tnormal";
+            edgeFile << "\tnormal";
 
-        _edgeFile << std::endl;
+        edgeFile << '\n';
     }
-}
\ No newline at end of file
+}
@@ -30,25 +30,25 @@
 #ifndef GRAPHOUTPUT_HPP
 #define GRAPHOUTPUT_HPP
 
-#include "geo/CityNode.hpp"
-#include "topo/base_topo/BaseTopology.hpp"
-#include "topo/Graph.hpp"
-#include <fstream>
+#include "output/ChunkedOutput.hpp"
+#include "output/TopologyView.hpp"
+#include <memory>
+#include <string>
 
-class GraphOutput {
+class GraphOutput : public std::enable_shared_from_this<GraphOutput> {
    public:
-    GraphOutput(BaseTopology_Ptr baseTopo, std::ofstream& nodeFile, std::ofstream& edgeFile);
+    GraphOutput(TopologyView_Ptr view);
 
-    void writeNodes(void);
-
-    void writeEdges(void);
+    void addTo(ChunkedOutput& output, const std::string& nodeFileName, const std::string& edgeFileName);
 
    private:
-    BaseTopology_Ptr _baseTopo;
-    Graph_Ptr _graph;
-    NodeMap_Ptr _nodeToCity;
-    std::ofstream& _nodeFile;
-    std::ofstream& _edgeFile;
+    void writeNodes(WriteBuffer& nodeFile, size_t begin, size_t end);
+
+    void writeEdges(WriteBuffer& edgeFile, size_t begin, size_t end);
+
+    TopologyView_Ptr _view;
 };
 
+typedef std::shared_ptr<GraphOutput> GraphOutput_Ptr;
+
 #endif
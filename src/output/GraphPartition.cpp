@@ -0,0 +1,239 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "GraphPartition.hpp"
+
+#include "geo/GeometricHelpers.hpp"
+#include <boost/log/trivial.hpp>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <utility>
+
+namespace {
+
+// passes of border node moves, each one lowers the cut weight or ends the refinement
+const unsigned MAX_REFINE_PASSES = 16;
+
+// power iterations for the principal axis of the node positions
+const unsigned AXIS_ITERATIONS = 32;
+
+}  // namespace
+
+GraphPartition::GraphPartition(TopologyView_Ptr view) : _offsets(), _neighbours(), _weights(), _parts(), _xyz() {
+    const size_t numNodes = view->nodes().size();
+
+    std::vector<unsigned> offsets(numNodes + 1, 0);
+    for (const TopologyView::Edge& edge : view->edges()) {
+        ++offsets[edge.uIndex + 1];
+        ++offsets[edge.vIndex + 1];
+    }
+    for (size_t i = 1; i < offsets.size(); ++i)
+        offsets[i] += offsets[i - 1];
+
+    std::vector<std::pair<unsigned, int>> adjacency(offsets.back());
+    std::vector<unsigned> fill(offsets.begin(), offsets.end() - 1);
+    for (const TopologyView::Edge& edge : view->edges()) {
+        int w = weight(edge.lengthKM);
+        adjacency[fill[edge.uIndex]++] = std::make_pair(edge.vIndex, w);
+        adjacency[fill[edge.vIndex]++] = std::make_pair(edge.uIndex, w);
+    }
+
+    // sorted neighbours, parallel edges merged
+    _offsets.reserve(numNodes + 1);
+    _offsets.push_back(0);
+    _neighbours.reserve(adjacency.size());
+    _weights.reserve(adjacency.size());
+    for (size_t i = 0; i < numNodes; ++i) {
+        std::sort(adjacency.begin() + offsets[i], adjacency.begin() + offsets[i + 1]);
+        for (unsigned a = offsets[i]; a < offsets[i + 1]; ++a) {
+            if (_neighbours.size() > _offsets.back() && _neighbours.back() == adjacency[a].first)
+                _weights.back() += adjacency[a].second;
+            else if (adjacency[a].first != i) {
+                _neighbours.push_back(adjacency[a].first);
+                _weights.push_back(adjacency[a].second);
+            }
+        }
+        _offsets.push_back(_neighbours.size());
+    }
+
+    // unit vectors for the inertial bisection
+    _xyz.reserve(3 * numNodes);
+    for (const TopologyView::Node& n : view->nodes()) {
+        double lat = n.node->lat() * M_PI / 180.0;
+        double lon = n.node->lon() * M_PI / 180.0;
+        _xyz.push_back(cos(lat) * cos(lon));
+        _xyz.push_back(cos(lat) * sin(lon));
+        _xyz.push_back(sin(lat));
+    }
+}
+
+int GraphPartition::weight(double lengthKM) {
+    const double HALF_CIRCUMFERENCE_KM = M_PI * GeometricHelpers::EARTH_RADIUS_KM;
+    return std::max(1, static_cast<int>(std::lround(HALF_CIRCUMFERENCE_KM / std::max(lengthKM, 1.0))));
+}
+
+void GraphPartition::partition(unsigned parts, double imbalance) {
+    assert(parts > 0);
+    std::vector<unsigned> nodes(numNodes());
+    for (unsigned i = 0; i < nodes.size(); ++i)
+        nodes[i] = i;
+
+    _parts.assign(numNodes(), 0);
+    bisect(nodes.begin(), nodes.end(), 0, parts);
+    int64_t bisected = cutWeight();
+    size_t moved = refine(parts, imbalance);
+
+    BOOST_LOG_TRIVIAL(info) << "partitioned " << numNodes() << " nodes into " << parts << " parts, " << cutEdges()
+                            << " of " << numEdges() << " edges cut, cut weight " << bisected << " after bisection, "
+                            << cutWeight() << " after moving " << moved << " nodes";
+}
+
+// splits the nodes along the principal axis of their positions, the halves get node counts in proportion to their
+// number of parts
+void GraphPartition::bisect(std::vector<unsigned>::iterator begin,
+                            std::vector<unsigned>::iterator end,
+                            unsigned firstPart,
+                            unsigned parts) {
+    size_t count = end - begin;
+    if (parts == 1 || count <= 1) {
+        for (auto it = begin; it != end; ++it)
+            _parts[*it] = firstPart;
+        return;
+    }
+
+    double mean[3] = {0.0, 0.0, 0.0};
+    for (auto it = begin; it != end; ++it)
+        for (int d = 0; d < 3; ++d)
+            mean[d] += _xyz[3 * *it + d] / count;
+
+    double covariance[3][3] = {{0.0, 0.0, 0.0}, {0.0, 0.0, 0.0}, {0.0, 0.0, 0.0}};
+    for (auto it = begin; it != end; ++it)
+        for (int r = 0; r < 3; ++r)
+            for (int c = 0; c < 3; ++c)
+                covariance[r][c] += (_xyz[3 * *it + r] - mean[r]) * (_xyz[3 * *it + c] - mean[c]);
+
+    double axis[3] = {1.0, 1.0, 1.0};
+    for (unsigned iteration = 0; iteration < AXIS_ITERATIONS; ++iteration) {
+        double next[3] = {0.0, 0.0, 0.0};
+        for (int r = 0; r < 3; ++r)
+            for (int c = 0; c < 3; ++c)
+                next[r] += covariance[r][c] * axis[c];
+        double norm = sqrt(next[0] * next[0] + next[1] * next[1] + next[2] * next[2]);
+        if (norm == 0.0)
+            break;  // < all nodes in one place
+        for (int d = 0; d < 3; ++d)
+            axis[d] = next[d] / norm;
+    }
+
+    auto projection = [&](unsigned i) {
+        return _xyz[3 * i] * axis[0] + _xyz[3 * i + 1] * axis[1] + _xyz[3 * i + 2] * axis[2];
+    };
+
+    // ties by node index, the same nodes are split off for any input order
+    unsigned firstParts = parts / 2;
+    auto middle = begin + count * firstParts / parts;
+    std::nth_element(begin, middle, end, [&](unsigned a, unsigned b) {
+        double pa = projection(a);
+        double pb = projection(b);
+        return pa < pb || (pa == pb && a < b);
+    });
+
+    bisect(begin, middle, firstPart, firstParts);
+    bisect(middle, end, firstPart + firstParts, parts - firstParts);
+}
+
+// moves border nodes to the neighbouring part they have the most edge weight to, returns the number of moves
+size_t GraphPartition::refine(unsigned parts, double imbalance) {
+    double average = static_cast<double>(numNodes()) / parts;
+    size_t maxSize = std::max<size_t>(std::ceil(average), std::floor(average * (1.0 + imbalance)));
+    size_t minSize = std::min<size_t>(std::floor(average), std::ceil(average * (1.0 - imbalance)));
+
+    std::vector<size_t> sizes(parts, 0);
+    for (unsigned part : _parts)
+        ++sizes[part];
+
+    std::vector<int64_t> connection(parts, 0);
+    std::vector<unsigned> touched;
+    size_t moved = 0;
+    for (unsigned pass = 0; pass < MAX_REFINE_PASSES; ++pass) {
+        size_t movedInPass = 0;
+        for (unsigned i = 0; i < numNodes(); ++i) {
+            unsigned own = _parts[i];
+            touched.clear();
+            for (unsigned a = _offsets[i]; a < _offsets[i + 1]; ++a) {
+                unsigned part = _parts[_neighbours[a]];
+                if (connection[part] == 0)
+                    touched.push_back(part);
+                connection[part] += _weights[a];
+            }
+
+            unsigned best = own;
+            int64_t bestGain = 0;
+            for (unsigned part : touched) {
+                int64_t gain = connection[part] - connection[own];
+                if (part != own && gain > bestGain && sizes[part] < maxSize && sizes[own] > minSize) {
+                    best = part;
+                    bestGain = gain;
+                }
+            }
+            for (unsigned part : touched)
+                connection[part] = 0;
+
+            if (best != own) {
+                --sizes[own];
+                ++sizes[best];
+                _parts[i] = best;
+                ++movedInPass;
+            }
+        }
+        moved += movedInPass;
+        if (movedInPass == 0)
+            break;
+    }
+    return moved;
+}
+
+int64_t GraphPartition::cutWeight(void) const {
+    int64_t cut = 0;
+    for (unsigned i = 0; i < numNodes(); ++i)
+        for (unsigned a = _offsets[i]; a < _offsets[i + 1]; ++a)
+            if (_neighbours[a] > i && _parts[_neighbours[a]] != _parts[i])
+                cut += _weights[a];
+    return cut;
+}
+
+size_t GraphPartition::cutEdges(void) const {
+    size_t cut = 0;
+    for (unsigned i = 0; i < numNodes(); ++i)
+        for (unsigned a = _offsets[i]; a < _offsets[i + 1]; ++a)
+            if (_neighbours[a] > i && _parts[_neighbours[a]] != _parts[i])
+                ++cut;
+    return cut;
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef GRAPHPARTITION_HPP
+#define GRAPHPARTITION_HPP
+
+#include "output/TopologyView.hpp"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class GraphPartition;
+typedef std::shared_ptr<GraphPartition> GraphPartition_Ptr;
+
+// The nodes of a view as an undirected graph in compressed sparse rows, for partitioner tools and the built-in k-way
+// partition. Parallel edges are merged into one with the summed weight. Short edges get high weights, so that
+// partitions cut the long links, which leave distributed simulators the largest lookahead.
+class GraphPartition {
+   public:
+    GraphPartition(TopologyView_Ptr view);
+
+    // integer weight of an edge of lengthKM, at least 1 for the longest edges on earth
+    static int weight(double lengthKM);
+
+    size_t numNodes(void) const { return _offsets.size() - 1; }
+    size_t numEdges(void) const { return _neighbours.size() / 2; }
+
+    // neighbours of node i (view index) are _neighbours[offsets()[i]] up to _neighbours[offsets()[i + 1]], ascending
+    const std::vector<unsigned>& offsets(void) const { return _offsets; }
+    const std::vector<unsigned>& neighbours(void) const { return _neighbours; }
+    const std::vector<int>& weights(void) const { return _weights; }
+
+    // geography-aware k-way partition: inertial bisection of the node positions on the unit sphere into parts of
+    // balanced node counts, then greedy moves of border nodes that lower the cut weight and keep every part within
+    // imbalance of the average node count
+    void partition(unsigned parts, double imbalance);
+
+    // part of each node, empty before partition
+    const std::vector<unsigned>& parts(void) const { return _parts; }
+
+    // summed weight and number of the edges between different parts
+    int64_t cutWeight(void) const;
+    size_t cutEdges(void) const;
+
+   private:
+    void bisect(std::vector<unsigned>::iterator begin,
+                std::vector<unsigned>::iterator end,
+                unsigned firstPart,
+                unsigned parts);
+    size_t refine(unsigned parts, double imbalance);
+
+    std::vector<unsigned> _offsets;
+    std::vector<unsigned> _neighbours;
+    std::vector<int> _weights;
+    std::vector<unsigned> _parts;
+
+    std::vector<double> _xyz;  /// < unit vector of each node
+};
+
+#endif  // GRAPHPARTITION_HPP
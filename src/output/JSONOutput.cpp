@@ -31,116 +31,176 @@
 
 #include "geo/CityNode.hpp"
 #include "geo/GeographicNode.hpp"
-#include "geo/GeometricHelpers.hpp"
 #include "geo/SeaCableEdge.hpp"
 #include "geo/SeaCableLandingPoint.hpp"
 #include "geo/SeaCableNode.hpp"
 #include "geo/SimulationNode.hpp"
 #include "geo/SimulationEdge.hpp"
-#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
 
-JSONOutput::JSONOutput(BaseTopology_Ptr baseTopo)
-    : _baseTopo(baseTopo), _graph(_baseTopo->getGraph()), _nodeToCity(_baseTopo->getNodeMap()), _json() {
+namespace {
+
+typedef std::vector<std::pair<const char*, std::string>> Members;
+
+// layout of Json::FastWriter or Json::StyledWriter (pretty) for arrays of flat objects below a root object
+void openArray(WriteBuffer& out, const char* name, bool first, bool pretty) {
+    if (!first)
+        out << ',';
+    out << (pretty ? "\n   " : "") << Json::valueToQuotedString(name) << (pretty ? " : [" : ":[");
 }
 
-JSONOutput::~JSONOutput() {
+void closeArray(WriteBuffer& out, bool pretty) {
+    out << (pretty ? "\n   ]" : "]");
 }
 
-void JSONOutput::createJSON(void) {
-    for (Graph::NodeIt n(*_graph); n != lemon::INVALID; ++n) {
-        GeographicNode_Ptr node = (*_nodeToCity)[n];
-        if (!node->isValid())
-            continue;
+// members in the sorted order of a Json::Value
+void element(WriteBuffer& out, const Members& members, bool first, bool pretty) {
+    if (!first)
+        out << ',';
+
+    out << (pretty ? "\n      {" : "{");
+    for (size_t i = 0; i < members.size(); ++i) {
+        if (i > 0)
+            out << ',';
+        out << (pretty ? "\n         " : "") << Json::valueToQuotedString(members[i].first) << (pretty ? " : " : ":")
+            << members[i].second;
+    }
+    out << (pretty ? "\n      }" : "}");
+}
 
-        Json::Value nodeJSON;
-        nodeJSON["id"] = _graph->id(n);
+std::string intValue(int value) {
+    return Json::valueToString(static_cast<Json::LargestInt>(value));
+}
 
-        if (dynamic_cast<CityNode*>(node.get())) {
-            nodeJSON["type"] = "City";
-            nodeJSON["name"] = dynamic_cast<CityNode*>(node.get())->name();
-        }
+std::string doubleValue(double value) {
+    return Json::valueToString(value);
+}
 
-        if (dynamic_cast<SeaCableLandingPoint*>(node.get())) {
-            nodeJSON["type"] = "Seacable Landing Point";
-            nodeJSON["name"] = dynamic_cast<SeaCableLandingPoint*>(node.get())->name();
-        }
+std::string stringValue(const std::string& value) {
+    return Json::valueToQuotedString(value.c_str());
+}
 
-        if (dynamic_cast<SeaCableNode*>(node.get())) {
-            nodeJSON["type"] = "Seacable Waypoint";
-            nodeJSON["name"] = "Seacable Waypoint";
-        }
+}  // namespace
 
-        if (dynamic_cast<SimulationNode*>(node.get())) {
-            auto simNode = dynamic_cast<SimulationNode*>(node.get());
-            nodeJSON["type"] = "Simulation Node";
-            nodeJSON["name"] = "Simulation Node";
-            nodeJSON["id"] = simNode->id();
-            nodeJSON["outer_id"] = simNode->outerID();
-        }
+JSONOutput::JSONOutput(TopologyView_Ptr view) : _view(view) {
+}
 
-        nodeJSON["latitude"] = (*_nodeToCity)[n]->lat();
-        nodeJSON["longitude"] = (*_nodeToCity)[n]->lon();
-        _json["nodes"].append(nodeJSON);
-    }
+JSONOutput::~JSONOutput() {
+}
 
-    // write out edges
+void JSONOutput::addTo(ChunkedOutput& output, const std::string& filename, bool pretty) {
+    // the chunks keep the writer alive
+    auto self = shared_from_this();
+    size_t numEdges = _view->edges().size();
+    size_t numNodes = _view->nodes().size();
 
-    auto _nodeInfos = _baseTopo->getNodeMap();
-    for (Graph::EdgeIt edge(*_graph); edge != lemon::INVALID; ++edge) {
-        GeographicNode_Ptr n1 = (*_nodeInfos)[_graph->u(edge)];
-        GeographicNode_Ptr n2 = (*_nodeInfos)[_graph->v(edge)];
-        if (!n1->isValid() || !n2->isValid())
-            continue;
+    output.addFile(filename);
 
-        Json::Value edgeJSON;
+    // a root without members is null, keys without elements are missing
+    if (numEdges == 0 && numNodes == 0) {
+        output.addChunk([](WriteBuffer& out) { out << "null\n"; });
+        return;
+    }
 
-        enum EdgeType { NORMAL_EDGE, SEACABLE_EDGE, SIMULATION_EDGE, UNDEFINED_EDGE };
+    // keys of the root are sorted, edges come first
+    output.addChunk([](WriteBuffer& out) { out << '{'; });
 
-        EdgeType edgeType = EdgeType::UNDEFINED_EDGE;
+    if (numEdges > 0) {
+        output.addChunk([pretty](WriteBuffer& out) { openArray(out, "edges", true, pretty); });
+        output.addRange(numEdges, [self, pretty](WriteBuffer& out, size_t begin, size_t end) {
+            self->writeEdges(out, begin, end, pretty);
+        });
+        output.addChunk([pretty](WriteBuffer& out) { closeArray(out, pretty); });
+    }
 
-        EdgeMap_Ptr edgeMap = _baseTopo->getEdgeMap();
-        GeographicEdge_Ptr edge_Ptr = (*edgeMap)[edge];
+    if (numNodes > 0) {
+        bool first = numEdges == 0;
+        output.addChunk([first, pretty](WriteBuffer& out) { openArray(out, "nodes", first, pretty); });
+        output.addRange(numNodes, [self, pretty](WriteBuffer& out, size_t begin, size_t end) {
+            self->writeNodes(out, begin, end, pretty);
+        });
+        output.addChunk([pretty](WriteBuffer& out) { closeArray(out, pretty); });
+    }
 
-        if (dynamic_cast<SeaCableEdge*>(edge_Ptr.get())) {
-            edgeType = EdgeType::SEACABLE_EDGE;
-        } else if (dynamic_cast<SimulationEdge*>(edge_Ptr.get())) {
-            edgeType = EdgeType::SIMULATION_EDGE;
-        } else {
-            edgeType = EdgeType::NORMAL_EDGE;
-        }
+    output.addChunk([pretty](WriteBuffer& out) { out << (pretty ? "\n}\n" : "}\n"); });
+}
 
-        edgeJSON["u"] = _graph->id(_graph->u(Graph::Edge(edge)));
-        edgeJSON["v"] = _graph->id(_graph->v(Graph::Edge(edge)));
+void JSONOutput::writeEdges(WriteBuffer& out, size_t begin, size_t end, bool pretty) {
+    Members members;
+    for (size_t i = begin; i < end; ++i) {
+        const TopologyView::Edge& edge = _view->edges()[i];
 
-        switch (edgeType) {
-            case EdgeType::NORMAL_EDGE:
-                edgeJSON["type"] = "normal";
-                break;
-            case EdgeType::SEACABLE_EDGE:
-                edgeJSON["type"] = "seacable";
+        const char* edgeType = "normal";
+        switch (edge.kind) {
+            case GeographicEdge::SEACABLE_EDGE:
+                edgeType = "seacable";
                 break;
-            case EdgeType::SIMULATION_EDGE:
-                edgeJSON["type"] = "simulation";
+            case GeographicEdge::SIMULATION_EDGE:
+                edgeType = "simulation";
                 break;
-            case EdgeType::UNDEFINED_EDGE:
-                edgeJSON["type"] = "undefined";
+            default:
                 break;
         }
 
-        edgeJSON["distance"] = GeometricHelpers::sphericalDistToKM(GeometricHelpers::sphericalDist(n1, n2));
-
-        _json["edges"].append(edgeJSON);
+        members.clear();
+        members.emplace_back("distance", doubleValue(edge.lengthKM));
+        members.emplace_back("type", stringValue(edgeType));
+        members.emplace_back("u", intValue(edge.u));
+        members.emplace_back("v", intValue(edge.v));
+        element(out, members, i == 0, pretty);
     }
 }
 
-void JSONOutput::writePretty(const char* filename) {
-    Json::StyledWriter writer;
-    std::ofstream graph(filename);
-    graph << writer.write(_json);
-}
+void JSONOutput::writeNodes(WriteBuffer& out, size_t begin, size_t end, bool pretty) {
+    Members members;
+    for (size_t i = begin; i < end; ++i) {
+        const TopologyView::Node& n = _view->nodes()[i];
+        GeographicNode* node = n.node.get();
+
+        int id = n.id;
+        const char* type = nullptr;
+        std::string name;
+        bool hasOuterId = false;
+        int outerId = 0;
+
+        switch (node->kind()) {
+            case GeographicNode::CITY_NODE:
+                type = "City";
+                name = static_cast<CityNode*>(node)->name();
+                break;
+            case GeographicNode::SEACABLE_LANDINGPOINT:
+                type = "Seacable Landing Point";
+                name = static_cast<SeaCableLandingPoint*>(node)->name();
+                break;
+            case GeographicNode::SEACABLE_NODE:
+                type = "Seacable Waypoint";
+                name = "Seacable Waypoint";
+                break;
+            case GeographicNode::SIMULATION_NODE: {
+                auto simNode = static_cast<SimulationNode*>(node);
+                type = "Simulation Node";
+                name = "Simulation Node";
+                id = simNode->id();
+                hasOuterId = true;
+                outerId = simNode->outerID();
+                break;
+            }
+            default:
+                break;
+        }
 
-void JSONOutput::write(const char* filename) {
-    Json::FastWriter writer;
-    std::ofstream graph(filename);
-    graph << writer.write(_json);
+        members.clear();
+        members.emplace_back("id", intValue(id));
+        members.emplace_back("latitude", doubleValue(node->lat()));
+        members.emplace_back("longitude", doubleValue(node->lon()));
+        if (type)
+            members.emplace_back("name", stringValue(name));
+        if (hasOuterId)
+            members.emplace_back("outer_id", intValue(outerId));
+        if (type)
+            members.emplace_back("type", stringValue(type));
+        element(out, members, i == 0, pretty);
+    }
 }
@@ -30,31 +30,30 @@
 #ifndef JSONOUTPUT_HPP
 #define JSONOUTPUT_HPP
 
-#include "topo/base_topo/BaseTopology.hpp"
-#include <lemon/list_graph.h>
+#include "output/ChunkedOutput.hpp"
+#include "output/TopologyView.hpp"
 #include <json/json.h>
+#include <memory>
+#include <string>
 
-class JSONOutput {
+class JSONOutput : public std::enable_shared_from_this<JSONOutput> {
    public:
-    JSONOutput(BaseTopology_Ptr baseTopo);
+    JSONOutput(TopologyView_Ptr view);
     virtual ~JSONOutput();
 
-    void createJSON(void);
-
-    void writePretty(const char* filename);
-
-    void write(const char* filename);
+    // nodes and edges are formatted in chunks, the file is identical to a Json::Value written by
+    // Json::StyledWriter (pretty) or Json::FastWriter
+    void addTo(ChunkedOutput& output, const std::string& filename, bool pretty);
 
    private:
-    BaseTopology_Ptr _baseTopo;
-
-    Graph_Ptr _graph;
+    void writeEdges(WriteBuffer& out, size_t begin, size_t end, bool pretty);
+    void writeNodes(WriteBuffer& out, size_t begin, size_t end, bool pretty);
 
-    NodeMap_Ptr _nodeToCity;
-
-    Json::Value _json;
+    TopologyView_Ptr _view;
 
     JSONOutput(const JSONOutput&);
 };
 
+typedef std::shared_ptr<JSONOutput> JSONOutput_Ptr;
+
 #endif
@@ -37,21 +37,19 @@
 #include <cassert>
 #include <regex.h>
 #include <regex>
-#include <fstream>
-#include <algorithm>
-#include <iterator>
-
-KMLWriter::KMLWriter(BaseTopology_Ptr baseTopo)
-    : _baseTopo(baseTopo),
-      _graph(_baseTopo->getGraph()),
-      _nodeInfos(_baseTopo->getNodeMap()),
+#include <sstream>
+
+KMLWriter::KMLWriter(TopologyView_Ptr view)
+    : _view(view),
       _pincolor(),
       _edgecolor(),
       _seacableColor(),
       _seacablePinColor(),
-      _kmlOut(),
       _drawLocationPins(true),
-      _drawSeacablePins(true) {
+      _drawSeacablePins(true),
+      _tileFeatures(0),
+      _maxLevel(0),
+      _layers() {
     setEdgeColor("ffffff", 1.0);
     setPinColor("ffffff", 1.0);
 }
@@ -59,185 +57,195 @@ KMLWriter::KMLWriter(BaseTopology_Ptr baseTopo)
 KMLWriter::~KMLWriter() {
 }
 
-void KMLWriter::write(const char* filename) {
-    std::ofstream kmlFile(filename);
-    std::copy(std::istreambuf_iterator<char>(_kmlOut), std::istreambuf_iterator<char>(),
-              std::ostreambuf_iterator<char>(kmlFile));
-    kmlFile.close();
+void KMLWriter::setRegions(size_t tileFeatures, int maxLevel) {
+    assert(tileFeatures > 0);
+    assert(maxLevel >= 0);
+    _tileFeatures = tileFeatures;
+    _maxLevel = maxLevel;
 }
 
-void KMLWriter::createKML() {
-    _kmlOut << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+void KMLWriter::addTo(ChunkedOutput& output, const std::string& filename) {
+    // the chunks keep the writer alive
+    auto self = shared_from_this();
+    // a KMZ is a zip archive with the document as doc.kml
+    bool kmz = filename.size() > 4 && filename.compare(filename.size() - 4, 4, ".kmz") == 0;
+    if (_tileFeatures > 0) {
+        addRegions(output, filename, kmz);
+        return;
+    }
+
+    output.addFile(filename, kmz ? "doc.kml" : "", false);
+
+    size_t numNodes = _view->nodes().size();
+    output.addChunk([self](WriteBuffer& out) { self->writeHeader(out); });
+    output.addRange(numNodes,
+                    [self](WriteBuffer& out, size_t begin, size_t end) { self->writeCircles(out, begin, end); });
+    output.addRange(_view->edges().size(),
+                    [self](WriteBuffer& out, size_t begin, size_t end) { self->writeEdges(out, begin, end); });
+    output.addRange(numNodes,
+                    [self](WriteBuffer& out, size_t begin, size_t end) { self->writePins(out, begin, end); });
+    output.addChunk([](WriteBuffer& out) {
+        out << "</Document>\n";
+        out << "</kml>\n";
+    });
+}
 
-    _kmlOut << "<kml xmlns=\"http://www.opengis.net/kml/2.2\">\n";
+void KMLWriter::writeHeader(WriteBuffer& kmlOut) {
+    kmlOut << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
 
-    _kmlOut << "<Document>\n";
+    kmlOut << "<kml xmlns=\"http://www.opengis.net/kml/2.2\">\n";
+
+    kmlOut << "<Document>\n";
 
     {
         // style section
-        _kmlOut << "<Style id=\"styleDefault\">\n";
+        kmlOut << "<Style id=\"styleDefault\">\n";
 
         {
             // set iconstyle
-            _kmlOut << "<IconStyle>\n";
-            _kmlOut << "<color>" << _pincolor << "</color>";
-            _kmlOut << "</IconStyle>\n";
+            kmlOut << "<IconStyle>\n";
+            kmlOut << "<color>" << _pincolor << "</color>";
+            kmlOut << "</IconStyle>\n";
         }
 
         {
             // set linestyle
-            _kmlOut << "<LineStyle>\n";
-            _kmlOut << "<color>" << _edgecolor << "</color>\n";
-            _kmlOut << "<colorMode>normal</colorMode>\n";
-            _kmlOut << "<width>2</width>\n";
-            _kmlOut << "</LineStyle>\n";
+            kmlOut << "<LineStyle>\n";
+            kmlOut << "<color>" << _edgecolor << "</color>\n";
+            kmlOut << "<colorMode>normal</colorMode>\n";
+            kmlOut << "<width>2</width>\n";
+            kmlOut << "</LineStyle>\n";
         }
 
         {
             // set polystyle
-            _kmlOut << "<PolyStyle>\n";
-            _kmlOut << "<color>" << _edgecolor << "</color>\n";
-            _kmlOut << "<colorMode>normal</colorMode>\n";
-            _kmlOut << "<fill>1</fill>\n";
-            _kmlOut << "<outline>1</outline>\n";
-            _kmlOut << "</PolyStyle>\n";
+            kmlOut << "<PolyStyle>\n";
+            kmlOut << "<color>" << _edgecolor << "</color>\n";
+            kmlOut << "<colorMode>normal</colorMode>\n";
+            kmlOut << "<fill>1</fill>\n";
+            kmlOut << "<outline>1</outline>\n";
+            kmlOut << "</PolyStyle>\n";
         }
 
-        _kmlOut << "</Style>\n";
+        kmlOut << "</Style>\n";
     }
 
     {
         // style section
-        _kmlOut << "<Style id=\"seacableStyle\">\n";
+        kmlOut << "<Style id=\"seacableStyle\">\n";
 
         {
             // set iconstyle
-            _kmlOut << "<IconStyle>\n";
-            _kmlOut << "<color>" << _seacablePinColor << "</color>";
-            _kmlOut << "</IconStyle>\n";
+            kmlOut << "<IconStyle>\n";
+            kmlOut << "<color>" << _seacablePinColor << "</color>";
+            kmlOut << "</IconStyle>\n";
         }
 
         {
             // set iconstyle
-            _kmlOut << "<LineStyle>\n";
-            _kmlOut << "<color>" << _seacableColor << "</color>\n";
-            _kmlOut << "<colorMode>normal</colorMode>\n";
-            _kmlOut << "<width>2</width>\n";
-            _kmlOut << "</LineStyle>\n";
+            kmlOut << "<LineStyle>\n";
+            kmlOut << "<color>" << _seacableColor << "</color>\n";
+            kmlOut << "<colorMode>normal</colorMode>\n";
+            kmlOut << "<width>2</width>\n";
+            kmlOut << "</LineStyle>\n";
         }
 
-        _kmlOut << "</Style>\n";
+        kmlOut << "</Style>\n";
     }
+}
 
-    using namespace lemon;
+void KMLWriter::writeCircles(WriteBuffer& kmlOut, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+        GeographicNode* place = _view->nodes()[i].node.get();
 
-    for (ListGraph::NodeIt node(*_graph); node != lemon::INVALID; ++node) {
-        GeographicNode_Ptr place = (*_nodeInfos)[node];
-        if (!place->isValid())
+        if (place->kind() != GeographicNode::CITY_NODE)
             continue;
 
-        bool isCityNode = dynamic_cast<CityNode*>(place.get()) != nullptr;
-        if (!isCityNode)
-            continue;
-
-        drawCircleAt(place->lat(), place->lon());
+        drawCircleAt(kmlOut, place->lat(), place->lon());
     }
+}
 
-    // iterate over all edges
-    for (ListGraph::EdgeIt edge(*_graph); edge != lemon::INVALID; ++edge) {
-        GeographicNode_Ptr n1 = (*_nodeInfos)[_graph->u(edge)];
-        GeographicNode_Ptr n2 = (*_nodeInfos)[_graph->v(edge)];
-        if (!n1->isValid() || !n2->isValid())
-            continue;
-
-        _kmlOut << "<Placemark>\n";
-
-        bool seacable = false;
+void KMLWriter::writeEdges(WriteBuffer& kmlOut, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i)
+        writeEdge(kmlOut, _view->edges()[i]);
+}
 
-        EdgeMap_Ptr edgeMap = _baseTopo->getEdgeMap();
-        GeographicEdge_Ptr edge_Ptr = (*edgeMap)[edge];
+void KMLWriter::writeEdge(WriteBuffer& kmlOut, const TopologyView::Edge& edge) {
+    GeographicNode* n1 = _view->u(edge).get();
+    GeographicNode* n2 = _view->v(edge).get();
 
-        if (dynamic_cast<SeaCableEdge*>(edge_Ptr.get()))
-            seacable = true;
+    kmlOut << "<Placemark>\n";
 
-        _kmlOut << "<styleUrl>";
-        if (seacable)
-            _kmlOut << "#seacableStyle";
-        else
-            _kmlOut << "#styleDefault";
-        _kmlOut << "</styleUrl>\n";
+    bool seacable = edge.kind == GeographicEdge::SEACABLE_EDGE;
 
-        _kmlOut << "<LineString>\n";
+    kmlOut << "<styleUrl>";
+    if (seacable)
+        kmlOut << "#seacableStyle";
+    else
+        kmlOut << "#styleDefault";
+    kmlOut << "</styleUrl>\n";
 
-        _kmlOut << "<tessellate>1</tessellate>\n";
-        _kmlOut << "<extrude>1</extrude>\n";
+    kmlOut << "<LineString>\n";
 
-        // insert actual coordinates
-        _kmlOut << "<coordinates>";
-        _kmlOut << n1->lon() << "," << n1->lat() << ",0 ";
-        _kmlOut << n2->lon() << "," << n2->lat() << ",0";
-        _kmlOut << "</coordinates>\n";
-        _kmlOut << "</LineString>\n";
-        _kmlOut << "</Placemark>\n";
-    }
+    kmlOut << "<tessellate>1</tessellate>\n";
+    kmlOut << "<extrude>1</extrude>\n";
 
-    // iterate over all nodes
-    using namespace lemon;
-    for (ListGraph::NodeIt node(*_graph); node != lemon::INVALID; ++node) {
-        GeographicNode_Ptr place = (*_nodeInfos)[node];
-        if (!place->isValid())
-            continue;
+    // insert actual coordinates
+    kmlOut << "<coordinates>";
+    kmlOut << n1->lon() << "," << n1->lat() << ",0 ";
+    kmlOut << n2->lon() << "," << n2->lat() << ",0";
+    kmlOut << "</coordinates>\n";
+    kmlOut << "</LineString>\n";
+    kmlOut << "</Placemark>\n";
+}
 
-        bool isCityNode = dynamic_cast<CityNode*>(place.get()) != nullptr;
-        bool isSeaCableLandingPoint = dynamic_cast<SeaCableLandingPoint*>(place.get()) != nullptr;
+void KMLWriter::writePins(WriteBuffer& kmlOut, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i)
+        writePin(kmlOut, _view->nodes()[i].node.get());
+}
 
-        if (isCityNode && !_drawLocationPins)
-            continue;
+void KMLWriter::writePin(WriteBuffer& kmlOut, GeographicNode* place) {
+    bool isCityNode = place->kind() == GeographicNode::CITY_NODE;
+    bool isSeaCableLandingPoint = place->kind() == GeographicNode::SEACABLE_LANDINGPOINT;
 
-        if (isSeaCableLandingPoint && !_drawSeacablePins)
-            continue;
+    if (isCityNode && !_drawLocationPins)
+        return;
 
-        if (isCityNode || isSeaCableLandingPoint) {
-            _kmlOut << "<Placemark>\n";
+    if (isSeaCableLandingPoint && !_drawSeacablePins)
+        return;
 
-            _kmlOut << "<name>";
+    if (isCityNode || isSeaCableLandingPoint) {
+        kmlOut << "<Placemark>\n";
 
-            if (dynamic_cast<CityNode*>(place.get()) != nullptr) {
-                auto* cityPlace = dynamic_cast<CityNode*>(place.get());
-                _kmlOut << cityPlace->name();
-            }
+        kmlOut << "<name>";
 
-            if (dynamic_cast<SeaCableLandingPoint*>(place.get()) != nullptr) {
-                auto* cityPlace = dynamic_cast<SeaCableLandingPoint*>(place.get());
-                _kmlOut << cityPlace->name();
-            }
+        if (isCityNode)
+            kmlOut << static_cast<CityNode*>(place)->name();
+        else
+            kmlOut << static_cast<SeaCableLandingPoint*>(place)->name();
 
-            _kmlOut << "</name>\n";
+        kmlOut << "</name>\n";
 
-            _kmlOut << "<styleUrl>";
+        kmlOut << "<styleUrl>";
 
-            if (dynamic_cast<SeaCableNode*>(place.get()))
-                _kmlOut << "#seacableStyle";
-            else
-                _kmlOut << "#styleDefault";
+        if (place->kind() == GeographicNode::SEACABLE_NODE)
+            kmlOut << "#seacableStyle";
+        else
+            kmlOut << "#styleDefault";
 
-            _kmlOut << "</styleUrl>\n";
+        kmlOut << "</styleUrl>\n";
 
-            _kmlOut << "<Point>\n";
+        kmlOut << "<Point>\n";
 
-            // insert actual coordinates
-            _kmlOut << "<coordinates>";
-            _kmlOut << place->lon() << "," << place->lat() << ",0";
-            _kmlOut << "</coordinates>\n";
+        // insert actual coordinates
+        kmlOut << "<coordinates>";
+        kmlOut << place->lon() << "," << place->lat() << ",0";
+        kmlOut << "</coordinates>\n";
 
-            _kmlOut << "</Point>\n";
+        kmlOut << "</Point>\n";
 
-            _kmlOut << "</Placemark>\n";
-        }
+        kmlOut << "</Placemark>\n";
     }
-
-    _kmlOut << "</Document>\n";
-    _kmlOut << "</kml>\n";
 }
 
 const std::string KMLWriter::intToHex(int i) {
@@ -30,13 +30,15 @@
 #ifndef KMLWRITER_HPP
 #define KMLWRITER_HPP
 
-#include "topo/base_topo/BaseTopology.hpp"
-#include <lemon/list_graph.h>
-#include <sstream>
+#include "output/ChunkedOutput.hpp"
+#include "output/TopologyView.hpp"
+#include <memory>
+#include <string>
+#include <vector>
 
-class KMLWriter {
+class KMLWriter : public std::enable_shared_from_this<KMLWriter> {
    public:
-    KMLWriter(BaseTopology_Ptr baseTopo);
+    KMLWriter(TopologyView_Ptr view);
     virtual ~KMLWriter();
 
     void setEdgeColor(std::string hex, double alpha);
@@ -50,31 +52,78 @@ class KMLWriter {
     void disableSeacablePins();
     void disableLocationsPins();
 
-    void createKML(void);
+    // splits the document into a quadtree of tiles per layer, seacable and terrestrial. A tile holds the longest
+    // of its edges and cities up to tileFeatures and the rest below it, down to maxLevel. Level 0 is written into
+    // the document, the other levels into files below <document name>_tiles that Google Earth only loads once the
+    // region of the tile is large enough on screen. All tile files are written with the document, there is nothing
+    // that could format a tile once Google Earth asks for it.
+    void setRegions(size_t tileFeatures, int maxLevel);
 
-    void write(const char* filename);
+    // writes a KMZ archive if filename ends with .kmz, with regions every tile as one
+    void addTo(ChunkedOutput& output, const std::string& filename);
 
    private:
-    BaseTopology_Ptr _baseTopo;
-    Graph_Ptr _graph;
-    NodeMap_Ptr _nodeInfos;
+    // an edge or a node of a layer with its bounding box
+    struct Feature {
+        bool node;
+        unsigned index;  /// < into nodes() or edges() of the view
+        double length;   /// < radians, the longest come first
+        double west;
+        double east;
+        double south;
+        double north;
+    };
+
+    // 2^level x 2^level tiles, x from the antimeridian eastwards, y from the south pole northwards
+    struct Tile {
+        int level;
+        int x;
+        int y;
+        std::vector<unsigned> nodes;
+        std::vector<unsigned> edges;
+        std::vector<size_t> children;  /// < into the tiles of the layer
+    };
+
+    struct Layer {
+        std::string name;
+        std::vector<Tile> tiles;  /// < level 0 first
+    };
+
+    TopologyView_Ptr _view;
     std::string _pincolor;
     std::string _edgecolor;
     std::string _seacableColor;
     std::string _seacablePinColor;
 
-    std::stringstream _kmlOut;
-
     bool _drawLocationPins;
     bool _drawSeacablePins;
 
+    size_t _tileFeatures;  /// < 0 without regions
+    int _maxLevel;
+    std::vector<Layer> _layers;
+
     const std::string intToHex(int i);
     std::string alphaToHex(double alpha);
     std::string hexToKML(std::string hex);
 
-    void drawCircleAt(double lat, double lon);
+    void writeHeader(WriteBuffer& kmlOut);
+    void writeCircles(WriteBuffer& kmlOut, size_t begin, size_t end);
+    void writeEdges(WriteBuffer& kmlOut, size_t begin, size_t end);
+    void writeEdge(WriteBuffer& kmlOut, const TopologyView::Edge& edge);
+    void writePins(WriteBuffer& kmlOut, size_t begin, size_t end);
+    void writePin(WriteBuffer& kmlOut, GeographicNode* place);
+    void drawCircleAt(WriteBuffer& kmlOut, double lat, double lon);
+
+    // KMLWriterRegions.cpp
+    void addRegions(ChunkedOutput& output, const std::string& filename, bool kmz);
+    void buildLayer(Layer& layer, std::vector<Feature>& features);
+    void splitTile(Layer& layer, size_t tile, std::vector<Feature>& features);
+    void writeTile(WriteBuffer& kmlOut, const Layer& layer, const Tile& tile, const std::string& path,
+                   const std::string& extension);
 
     KMLWriter(const KMLWriter&);
 };
 
+typedef std::shared_ptr<KMLWriter> KMLWriter_Ptr;
+
 #endif
@@ -28,62 +28,74 @@
 */
 
 #include "KMLWriter.hpp"
-#include "geo/GeographicPosition.hpp"
 #include "geo/GeometricHelpers.hpp"
-#include "topo/base_topo/CGALPrimitives.hpp"
 #include <vector>
 #include <cmath>
-#include <ostream>
 
-typedef std::vector<GeographicPositionTuple> GeographicPositionVector;
+namespace {
 
-static void kmlDrawCircle(double latitude, double longitude, int segments, std::ostream& kmlOut);
+// Lat/lon given radial and distance (http://williams.best.vwh.net/avform.htm#LL, Matlab names this reckon) for all
+// points of a circle. The circle only depends on the latitude of its center, the longitude is an offset, so the
+// terms of the range and the azimuths are computed once for all circles.
+class CircleTemplate {
+   public:
+    CircleTemplate(double rangeInDegrees, int segments) {
+        double range = rangeInDegrees * GeometricHelpers::DEG_TO_RAD;
+        _sinRange = sin(range);
+        _cosRange = cos(range);
+        for (int i = 0; i < segments; ++i) {
+            double azimuth = 2.0 * M_PI / segments * i;
+            _sinAzimuth.push_back(sin(azimuth));
+            _cosAzimuth.push_back(cos(azimuth));
+        }
+    }
 
-void KMLWriter::drawCircleAt(double latitude, double longitude) {
-    _kmlOut << "<Placemark>\n";
+    // lon,lat lines of the circle, closed by the first point again
+    void draw(double latitude, double longitude, WriteBuffer& kmlOut) const {
+        latitude = latitude * GeometricHelpers::DEG_TO_RAD;
+        longitude = longitude * GeometricHelpers::DEG_TO_RAD;
+        double sinLatitude = sin(latitude);
+        double cosLatitude = cos(latitude);
 
-    _kmlOut << "<styleUrl>"
-            << "#styleDefault"
-            << "</styleUrl>\n";
-    int segments = 50;
-    kmlDrawCircle(latitude, longitude, segments, _kmlOut);
+        for (size_t i = 0; i <= _sinAzimuth.size(); ++i) {
+            size_t a = i % _sinAzimuth.size();
+            double lat = asin(sinLatitude * _cosRange + cosLatitude * _sinRange * _cosAzimuth[a]);
+            double dlon = atan2(_sinAzimuth[a] * _sinRange * cosLatitude, _cosRange - sinLatitude * sin(lat));
+            double lon = fmod(longitude - dlon + M_PI, 2.0 * M_PI) - M_PI;
 
-    _kmlOut << "</Placemark>\n";
-}
+            kmlOut << lon * GeometricHelpers::RAD_TO_DEG << "," << lat * GeometricHelpers::RAD_TO_DEG << "\n";
+        }
+    }
 
-// http://williams.best.vwh.net/avform.htm#LL: Lat/lon given radial and distance,
-// Matlab names this reckon
-static GeographicPositionTuple reckon(double latitude, double longitude, double range, double azimuth) {
-    latitude = latitude * GeometricHelpers::DEG_TO_RAD;
-    longitude = longitude * GeometricHelpers::DEG_TO_RAD;
-    range = range * GeometricHelpers::DEG_TO_RAD;
-    azimuth = azimuth;
+   private:
+    double _sinRange;
+    double _cosRange;
+    std::vector<double> _sinAzimuth;
+    std::vector<double> _cosAzimuth;
+};
 
-    double lat = asin(sin(latitude) * cos(range) + cos(latitude) * sin(range) * cos(azimuth));
-    double dlon = atan2(sin(azimuth) * sin(range) * cos(latitude), cos(range) - sin(latitude) * sin(lat));
-    double lon = fmod(longitude - dlon + M_PI, 2.0 * M_PI) - M_PI;
+}  // namespace
 
-    return std::make_pair(lat * GeometricHelpers::RAD_TO_DEG, lon * GeometricHelpers::RAD_TO_DEG);
-}
+void KMLWriter::drawCircleAt(WriteBuffer& kmlOut, double latitude, double longitude) {
+    static const CircleTemplate circle(0.1875, 50);
+
+    kmlOut << "<Placemark>\n";
+
+    kmlOut << "<styleUrl>"
+           << "#styleDefault"
+           << "</styleUrl>\n";
 
-static void kmlDrawCircle(double latitude, double longitude, int segments, std::ostream& kmlOut) {
     kmlOut << "<Polygon>\n"
            << "<outerBoundaryIs>\n"
            << "<LinearRing>\n"
            << "<coordinates>\n";
 
-    double rangeInDegrees = 0.1875;
-
-    for (int i = 0; i < segments; ++i) {
-        auto pos = reckon(latitude, longitude, rangeInDegrees, 2.0 * M_PI / segments * i);
-        kmlOut << pos.second << "," << pos.first << "\n";
-    }
-
-    auto pos = reckon(latitude, longitude, rangeInDegrees, 0.0);
-    kmlOut << pos.second << "," << pos.first << "\n";
+    circle.draw(latitude, longitude, kmlOut);
 
     kmlOut << "</coordinates>\n"
            << "</LinearRing>\n"
            << "</outerBoundaryIs>\n"
            << "</Polygon>\n";
+
+    kmlOut << "</Placemark>\n";
 }
@@ -0,0 +1,231 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "KMLWriter.hpp"
+#include "geo/GeometricHelpers.hpp"
+#include <boost/log/trivial.hpp>
+#include <sys/stat.h>
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cmath>
+#include <sstream>
+
+namespace {
+
+// Google Earth shows a tile once its region covers this many pixels
+constexpr int LOD_PIXELS = 128;
+
+// diameter of the circle around a city, see KMLWriterCircle.cpp
+constexpr double CIRCLE_LENGTH = 2.0 * 0.1875 * GeometricHelpers::DEG_TO_RAD;
+
+void tileBox(int level, int x, int y, double& west, double& east, double& south, double& north) {
+    double width = 360.0 / (1 << level);
+    double height = 180.0 / (1 << level);
+    west = -180.0 + x * width;
+    east = west + width;
+    south = -90.0 + y * height;
+    north = south + height;
+}
+
+void writeRegion(WriteBuffer& kmlOut, int level, int x, int y) {
+    double west, east, south, north;
+    tileBox(level, x, y, west, east, south, north);
+
+    kmlOut << "<Region>\n";
+    kmlOut << "<LatLonAltBox>";
+    kmlOut << "<north>" << north << "</north><south>" << south << "</south>";
+    kmlOut << "<east>" << east << "</east><west>" << west << "</west>";
+    kmlOut << "</LatLonAltBox>\n";
+    kmlOut << "<Lod><minLodPixels>" << LOD_PIXELS << "</minLodPixels><maxLodPixels>-1</maxLodPixels></Lod>\n";
+    kmlOut << "</Region>\n";
+}
+
+}  // namespace
+
+void KMLWriter::addRegions(ChunkedOutput& output, const std::string& filename, bool kmz) {
+    auto self = shared_from_this();
+    std::string extension = kmz ? ".kmz" : ".kml";
+    std::string zipEntry = kmz ? "doc.kml" : "";
+
+    // the tiles lie next to the document, its links are relative to it. Links in a KMZ start inside the archive.
+    bool hasExtension = filename.size() > 4 && (filename.compare(filename.size() - 4, 4, ".kml") == 0 || kmz);
+    std::string directory = filename.substr(0, hasExtension ? filename.size() - 4 : filename.size()) + "_tiles";
+    size_t slash = directory.rfind('/');
+    std::string up = kmz ? "../" : "";
+    std::string linkDirectory = up + (slash == std::string::npos ? directory : directory.substr(slash + 1)) + "/";
+    if (mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST)
+        BOOST_LOG_TRIVIAL(warning) << "KMLWriter: cannot create " << directory;
+
+    enum { SEACABLE, TERRESTRIAL };
+    std::vector<Feature> features[2];
+    for (unsigned i = 0; i < _view->nodes().size(); ++i) {
+        GeographicNode* place = _view->nodes()[i].node.get();
+        Feature feature{true, i, 0.0, place->lon(), place->lon(), place->lat(), place->lat()};
+        if (place->kind() == GeographicNode::CITY_NODE) {
+            feature.length = CIRCLE_LENGTH;
+            features[TERRESTRIAL].push_back(feature);
+        } else if (place->kind() == GeographicNode::SEACABLE_LANDINGPOINT && _drawSeacablePins) {
+            features[SEACABLE].push_back(feature);
+        }
+    }
+    for (unsigned i = 0; i < _view->edges().size(); ++i) {
+        const TopologyView::Edge& edge = _view->edges()[i];
+        GeographicNode* n1 = _view->u(edge).get();
+        GeographicNode* n2 = _view->v(edge).get();
+        Feature feature{false,
+                        i,
+                        edge.length,
+                        std::min(n1->lon(), n2->lon()),
+                        std::max(n1->lon(), n2->lon()),
+                        std::min(n1->lat(), n2->lat()),
+                        std::max(n1->lat(), n2->lat())};
+        // across the antimeridian, only level 0 holds the edge
+        if (feature.east - feature.west > 180.0) {
+            feature.west = -180.0;
+            feature.east = 180.0;
+        }
+        bool seacable = edge.kind == GeographicEdge::SEACABLE_EDGE;
+        features[seacable ? SEACABLE : TERRESTRIAL].push_back(feature);
+    }
+
+    _layers.assign(2, Layer());
+    _layers[SEACABLE].name = "seacable";
+    _layers[TERRESTRIAL].name = "terrestrial";
+    for (int layer : {SEACABLE, TERRESTRIAL})
+        buildLayer(_layers[layer], features[layer]);
+
+    // level 0 of every layer in a folder of the document
+    output.addFile(filename, zipEntry, false);
+    output.addChunk([self](WriteBuffer& out) { self->writeHeader(out); });
+    for (size_t l = 0; l < _layers.size(); ++l) {
+        output.addChunk([self, l, linkDirectory, extension](WriteBuffer& out) {
+            const Layer& layer = self->_layers[l];
+            out << "<Folder>\n";
+            out << "<name>" << layer.name << "</name>\n";
+            self->writeTile(out, layer, layer.tiles[0], linkDirectory, extension);
+            out << "</Folder>\n";
+        });
+    }
+    output.addChunk([](WriteBuffer& out) {
+        out << "</Document>\n";
+        out << "</kml>\n";
+    });
+
+    // one chunk per tile, so that the tiles are formatted in parallel
+    for (size_t l = 0; l < _layers.size(); ++l) {
+        const Layer& layer = _layers[l];
+        for (size_t t = 1; t < layer.tiles.size(); ++t) {
+            const Tile& tile = layer.tiles[t];
+            std::stringstream name;
+            name << directory << "/" << layer.name << "_" << tile.level << "_" << tile.x << "_" << tile.y
+                 << extension;
+            output.addFile(name.str(), zipEntry, false);
+            output.addChunk([self, l, t, up, extension](WriteBuffer& out) {
+                const Layer& layer = self->_layers[l];
+                const Tile& tile = layer.tiles[t];
+                self->writeHeader(out);
+                writeRegion(out, tile.level, tile.x, tile.y);
+                self->writeTile(out, layer, tile, up, extension);
+                out << "</Document>\n";
+                out << "</kml>\n";
+            });
+        }
+    }
+
+    size_t tiles = _layers[SEACABLE].tiles.size() + _layers[TERRESTRIAL].tiles.size();
+    BOOST_LOG_TRIVIAL(info) << "KMLWriter: " << tiles << " tiles in " << directory;
+}
+
+void KMLWriter::buildLayer(Layer& layer, std::vector<Feature>& features) {
+    std::stable_sort(features.begin(), features.end(),
+                     [](const Feature& a, const Feature& b) { return a.length > b.length; });
+    layer.tiles.push_back(Tile{0, 0, 0, {}, {}, {}});
+    splitTile(layer, 0, features);
+}
+
+void KMLWriter::splitTile(Layer& layer, size_t tile, std::vector<Feature>& features) {
+    int level = layer.tiles[tile].level;
+    int x = layer.tiles[tile].x;
+    int y = layer.tiles[tile].y;
+    double west, east, south, north;
+    tileBox(level, x, y, west, east, south, north);
+    double centerLon = (west + east) / 2.0;
+    double centerLat = (south + north) / 2.0;
+
+    // the longest features stay, and those that do not fit into one quarter of the tile
+    std::vector<Feature> below[4];
+    size_t kept = 0;
+    for (const Feature& feature : features) {
+        int cx = feature.west < centerLon ? 0 : 1;
+        int cy = feature.south < centerLat ? 0 : 1;
+        bool fits = (cx == 1 || feature.east <= centerLon) && (cy == 1 || feature.north <= centerLat);
+        if (level < _maxLevel && fits && kept >= _tileFeatures) {
+            below[2 * cy + cx].push_back(feature);
+            continue;
+        }
+        ++kept;
+        if (feature.node)
+            layer.tiles[tile].nodes.push_back(feature.index);
+        else
+            layer.tiles[tile].edges.push_back(feature.index);
+    }
+    features.clear();
+
+    for (int child = 0; child < 4; ++child) {
+        if (below[child].empty())
+            continue;
+        size_t index = layer.tiles.size();
+        layer.tiles.push_back(Tile{level + 1, 2 * x + child % 2, 2 * y + child / 2, {}, {}, {}});
+        layer.tiles[tile].children.push_back(index);
+        splitTile(layer, index, below[child]);
+    }
+}
+
+void KMLWriter::writeTile(WriteBuffer& kmlOut, const Layer& layer, const Tile& tile, const std::string& path,
+                          const std::string& extension) {
+    for (size_t child : tile.children) {
+        const Tile& below = layer.tiles[child];
+        kmlOut << "<NetworkLink>\n";
+        writeRegion(kmlOut, below.level, below.x, below.y);
+        kmlOut << "<Link><href>" << path << layer.name << "_" << below.level << "_" << below.x << "_" << below.y
+               << extension << "</href><viewRefreshMode>onRegion</viewRefreshMode></Link>\n";
+        kmlOut << "</NetworkLink>\n";
+    }
+
+    for (unsigned node : tile.nodes) {
+        GeographicNode* place = _view->nodes()[node].node.get();
+        if (place->kind() == GeographicNode::CITY_NODE)
+            drawCircleAt(kmlOut, place->lat(), place->lon());
+    }
+    for (unsigned edge : tile.edges)
+        writeEdge(kmlOut, _view->edges()[edge]);
+    for (unsigned node : tile.nodes)
+        writePin(kmlOut, _view->nodes()[node].node.get());
+}
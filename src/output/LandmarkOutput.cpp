@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "LandmarkOutput.hpp"
+
+#include "geo/GeometricHelpers.hpp"
+#include <boost/log/trivial.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace BinaryGraph;
+
+LandmarkOutput::LandmarkOutput(FrozenTopology_Ptr topo, TopologyView_Ptr view, unsigned count)
+    : _topo(topo), _view(view), _count(count), _outside(), _dist(), _pred(), _order() {
+}
+
+void LandmarkOutput::addTo(ChunkedOutput& output, const std::string& filename) {
+    // the chunks keep the writer alive
+    auto self = shared_from_this();
+    output.addFile(filename);
+    output.addChunk([self](WriteBuffer& out) { self->write(out); });
+}
+
+void LandmarkOutput::distances(unsigned source, std::vector<double>& dist) {
+    const std::vector<TopologyView::Node>& nodes = _view->nodes();
+    _topo->shortestPathTree(nodes[source].id, _dist, _pred, _order, FrozenTopology::LENGTH_KM, &_outside);
+
+    dist.resize(nodes.size());
+    for (size_t i = 0; i < nodes.size(); ++i)
+        dist[i] = _dist[nodes[i].id];
+}
+
+void LandmarkOutput::write(WriteBuffer& out) {
+    const size_t numNodes = _view->nodes().size();
+
+    // same km as the edges of the binary graph, so the bounds never exceed its path lengths
+    std::vector<char> inView(_topo->nodes().size(), false);
+    for (const TopologyView::Node& node : _view->nodes())
+        inView[node.id] = true;
+    _outside.assign(_topo->edgeCount(), false);
+    for (unsigned e = 0; e < _topo->edgeCount(); ++e)
+        _outside[e] = !inView[_topo->u(e)] || !inView[_topo->v(e)];
+
+    // farthest point selection: start at the node farthest from node 0, then take the node farthest from all
+    // landmarks chosen so far
+    std::vector<uint32_t> landmarks;
+    std::vector<double> table;  // < landmark by landmark
+    std::vector<double> dist;
+    std::vector<double> minDist(numNodes, std::numeric_limits<double>::infinity());
+    unsigned next = 0;
+    if (numNodes > 0) {
+        distances(0, dist);
+        for (unsigned i = 0; i < numNodes; ++i) {
+            if (!std::isinf(dist[i]) && dist[i] > dist[next])
+                next = i;
+        }
+    }
+
+    while (landmarks.size() < std::min<size_t>(_count, numNodes)) {
+        landmarks.push_back(next);
+        distances(next, dist);
+        table.insert(table.end(), dist.begin(), dist.end());
+
+        for (unsigned i = 0; i < numNodes; ++i) {
+            if (!std::isinf(dist[i]))
+                minDist[i] = std::min(minDist[i], dist[i]);
+            if (!std::isinf(minDist[i]) && minDist[i] > minDist[next])
+                next = i;
+        }
+        if (minDist[next] == 0.0)
+            break;  // < every node is a landmark
+    }
+
+    BOOST_LOG_TRIVIAL(info) << "chose " << landmarks.size() << " landmarks";
+
+    BinaryLandmarkHeader header = BinaryLandmarkHeader();
+    std::copy(LANDMARK_MAGIC, LANDMARK_MAGIC + sizeof(LANDMARK_MAGIC), header.magic);
+    header.version = LANDMARK_VERSION;
+    header.numNodes = numNodes;
+    header.numLandmarks = landmarks.size();
+    header.earthRadiusKm = GeometricHelpers::sphericalDistToKM(1.0);
+    header.landmarksOffset = align8(sizeof(BinaryLandmarkHeader));
+    header.distancesOffset = align8(header.landmarksOffset + landmarks.size() * sizeof(uint32_t));
+
+    static const char zeros[8] = {0};
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(landmarks.data()), landmarks.size() * sizeof(uint32_t));
+    out.write(zeros, header.distancesOffset - header.landmarksOffset - landmarks.size() * sizeof(uint32_t));
+    out.write(reinterpret_cast<const char*>(table.data()), table.size() * sizeof(double));
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LANDMARKOUTPUT_HPP
+#define LANDMARKOUTPUT_HPP
+
+#include "output/BinaryGraph.hpp"
+#include "output/ChunkedOutput.hpp"
+#include "output/TopologyView.hpp"
+#include "topo/FrozenTopology.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+
+// writes ALT landmarks for the binary graph of the same view, see BinaryGraph.hpp for the layout and the query
+class LandmarkOutput : public std::enable_shared_from_this<LandmarkOutput> {
+   public:
+    // view has to be a view of topo
+    LandmarkOutput(FrozenTopology_Ptr topo, TopologyView_Ptr view, unsigned count);
+
+    // the landmarks are chosen while the chunk is formatted
+    void addTo(ChunkedOutput& output, const std::string& filename);
+
+   private:
+    void write(WriteBuffer& out);
+
+    // km from node index source to all nodes, along the edges of the binary graph
+    void distances(unsigned source, std::vector<double>& dist);
+
+    FrozenTopology_Ptr _topo;
+    TopologyView_Ptr _view;
+    unsigned _count;
+
+    // edges of the topology with an end outside the view, by edge index
+    std::vector<char> _outside;
+
+    // scratch of distances, by node id
+    std::vector<double> _dist;
+    std::vector<unsigned> _pred;
+    std::vector<unsigned> _order;
+
+    LandmarkOutput(const LandmarkOutput&);
+};
+
+typedef std::shared_ptr<LandmarkOutput> LandmarkOutput_Ptr;
+
+#endif  // LANDMARKOUTPUT_HPP
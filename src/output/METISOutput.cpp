@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "METISOutput.hpp"
+#include <cassert>
+
+METISOutput::METISOutput(GraphPartition_Ptr graph) : _graph(graph) {
+}
+
+void METISOutput::addTo(ChunkedOutput& output, const std::string& graphFileName, const std::string& edgeListFileName) {
+    // the chunks keep the writer alive
+    auto self = shared_from_this();
+    output.addFile(graphFileName);
+    output.addChunk([self](WriteBuffer& out) {
+        out << static_cast<int>(self->_graph->numNodes()) << ' ' << static_cast<int>(self->_graph->numEdges())
+            << " 001\n";
+    });
+    output.addRange(_graph->numNodes(),
+                    [self](WriteBuffer& out, size_t begin, size_t end) { self->writeAdjacency(out, begin, end); });
+
+    output.addFile(edgeListFileName);
+    output.addRange(_graph->numNodes(),
+                    [self](WriteBuffer& out, size_t begin, size_t end) { self->writeEdgeList(out, begin, end); });
+}
+
+void METISOutput::addPartitionTo(ChunkedOutput& output, const std::string& partitionFileName) {
+    assert(_graph->parts().size() == _graph->numNodes());
+    auto self = shared_from_this();
+    output.addFile(partitionFileName);
+    output.addRange(_graph->numNodes(),
+                    [self](WriteBuffer& out, size_t begin, size_t end) { self->writeParts(out, begin, end); });
+}
+
+void METISOutput::writeAdjacency(WriteBuffer& out, size_t begin, size_t end) {
+    const std::vector<unsigned>& offsets = _graph->offsets();
+    const std::vector<unsigned>& neighbours = _graph->neighbours();
+    const std::vector<int>& weights = _graph->weights();
+
+    for (size_t i = begin; i < end; ++i) {
+        for (unsigned a = offsets[i]; a < offsets[i + 1]; ++a) {
+            if (a > offsets[i])
+                out << ' ';
+            out << static_cast<int>(neighbours[a] + 1) << ' ' << weights[a];
+        }
+        out << '\n';
+    }
+}
+
+void METISOutput::writeEdgeList(WriteBuffer& out, size_t begin, size_t end) {
+    const std::vector<unsigned>& offsets = _graph->offsets();
+    const std::vector<unsigned>& neighbours = _graph->neighbours();
+    const std::vector<int>& weights = _graph->weights();
+
+    for (size_t i = begin; i < end; ++i)
+        for (unsigned a = offsets[i]; a < offsets[i + 1]; ++a)
+            if (neighbours[a] > i)
+                out << static_cast<int>(i) << ' ' << static_cast<int>(neighbours[a]) << ' ' << weights[a] << '\n';
+}
+
+void METISOutput::writeParts(WriteBuffer& out, size_t begin, size_t end) {
+    const std::vector<unsigned>& parts = _graph->parts();
+    for (size_t i = begin; i < end; ++i)
+        out << static_cast<int>(parts[i]) << '\n';
+}
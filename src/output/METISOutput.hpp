@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef METISOUTPUT_HPP
+#define METISOUTPUT_HPP
+
+#include "output/ChunkedOutput.hpp"
+#include "output/GraphPartition.hpp"
+#include <memory>
+#include <string>
+
+// Writes the weighted graph of a GraphPartition for partitioner tools. Node i of the files is node i of the view.
+//   METIS graph file: header "n m 001", then one line per node with its neighbours (from 1) and the edge weights
+//   edge list: one line "u v weight" per edge with u < v (from 0)
+//   partition: the part of each node, one per line, as written by gpmetis
+class METISOutput : public std::enable_shared_from_this<METISOutput> {
+   public:
+    METISOutput(GraphPartition_Ptr graph);
+
+    void addTo(ChunkedOutput& output, const std::string& graphFileName, const std::string& edgeListFileName);
+
+    // only after GraphPartition::partition
+    void addPartitionTo(ChunkedOutput& output, const std::string& partitionFileName);
+
+   private:
+    void writeAdjacency(WriteBuffer& out, size_t begin, size_t end);
+    void writeEdgeList(WriteBuffer& out, size_t begin, size_t end);
+    void writeParts(WriteBuffer& out, size_t begin, size_t end);
+
+    GraphPartition_Ptr _graph;
+};
+
+typedef std::shared_ptr<METISOutput> METISOutput_Ptr;
+
+#endif  // METISOUTPUT_HPP
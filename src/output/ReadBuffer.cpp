@@ -0,0 +1,246 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ReadBuffer.hpp"
+#include "config/Defines.hpp"
+#include <algorithm>
+#include <boost/log/trivial.hpp>
+#include <cassert>
+#include <cstring>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace {
+
+const unsigned char GZIP_MAGIC[] = {0x1f, 0x8b};
+const unsigned char ZSTD_MAGIC[] = {0x28, 0xb5, 0x2f, 0xfd};
+
+}  // namespace
+
+constexpr size_t ReadBuffer::BUFFER_SIZE;
+
+ReadBuffer::ReadBuffer(const std::string& filename)
+    : _file(fopen(filename.c_str(), "rb")),
+      _good(_file != nullptr),
+      _codec(PLAIN),
+      _stream(nullptr),
+      _complete(false),
+      _input(BUFFER_SIZE),
+      _inputPos(0),
+      _inputSize(0) {
+    if (!_good) {
+        BOOST_LOG_TRIVIAL(error) << "cannot open " << filename;
+        return;
+    }
+
+    fill();
+    const unsigned char* head = reinterpret_cast<const unsigned char*>(_input.data());
+    if (_inputSize >= sizeof(ZSTD_MAGIC) && memcmp(head, ZSTD_MAGIC, sizeof(ZSTD_MAGIC)) == 0) {
+#ifdef HAVE_ZSTD
+        _codec = ZSTD;
+        _stream = ZSTD_createDCtx();
+        assert(_stream);
+#else
+        BOOST_LOG_TRIVIAL(error) << "built without zstd, cannot read " << filename;
+        _good = false;
+#endif
+    } else if (_inputSize >= sizeof(GZIP_MAGIC) && memcmp(head, GZIP_MAGIC, sizeof(GZIP_MAGIC)) == 0) {
+#ifdef HAVE_ZLIB
+        _codec = GZIP;
+        z_stream* stream = new z_stream();
+        int retval = inflateInit2(stream, MAX_WBITS + 16);
+        assert(retval == Z_OK);
+        _stream = stream;
+#else
+        BOOST_LOG_TRIVIAL(error) << "built without zlib, cannot read " << filename;
+        _good = false;
+#endif
+    }
+}
+
+ReadBuffer::~ReadBuffer() {
+#ifdef HAVE_ZSTD
+    if (_codec == ZSTD)
+        ZSTD_freeDCtx(static_cast<ZSTD_DCtx*>(_stream));
+#endif
+#ifdef HAVE_ZLIB
+    if (_codec == GZIP) {
+        z_stream* stream = static_cast<z_stream*>(_stream);
+        inflateEnd(stream);
+        delete stream;
+    }
+#endif
+    if (_file)
+        fclose(_file);
+}
+
+bool ReadBuffer::good(void) const {
+    return _good;
+}
+
+bool ReadBuffer::compressed(void) const {
+    return _codec != PLAIN;
+}
+
+bool ReadBuffer::fill(void) {
+    if (!_file)
+        return false;
+    _inputPos = 0;
+    _inputSize = fread(_input.data(), 1, _input.size(), _file);
+    if (_inputSize < _input.size() && ferror(_file)) {
+        BOOST_LOG_TRIVIAL(error) << "read failed";
+        _good = false;
+    }
+    return _inputSize > 0;
+}
+
+size_t ReadBuffer::read(char* data, size_t size) {
+    if (!_good)
+        return 0;
+    switch (_codec) {
+        case GZIP:
+            return readGzip(data, size);
+        case ZSTD:
+            return readZstd(data, size);
+        default:
+            return readPlain(data, size);
+    }
+}
+
+size_t ReadBuffer::readPlain(char* data, size_t size) {
+    size_t done = 0;
+    while (done < size && (_inputPos < _inputSize || fill())) {
+        size_t piece = std::min(size - done, _inputSize - _inputPos);
+        memcpy(data + done, _input.data() + _inputPos, piece);
+        _inputPos += piece;
+        done += piece;
+    }
+    return done;
+}
+
+size_t ReadBuffer::readGzip(char* data, size_t size) {
+#ifdef HAVE_ZLIB
+    z_stream* stream = static_cast<z_stream*>(_stream);
+    stream->next_out = reinterpret_cast<Bytef*>(data);
+    stream->avail_out = size;
+    while (stream->avail_out > 0) {
+        // at the end of the file the stream may still hold output
+        bool more = _inputPos < _inputSize || fill();
+        uInt before = stream->avail_out;
+        stream->next_in = reinterpret_cast<Bytef*>(_input.data() + _inputPos);
+        stream->avail_in = _inputSize - _inputPos;
+        size_t inputPos = _inputPos;
+        int retval = inflate(stream, Z_NO_FLUSH);
+        _inputPos = _inputSize - stream->avail_in;
+        if (retval == Z_STREAM_END) {
+            // concatenated members, e.g. of appended files
+            inflateReset(stream);
+            _complete = true;
+        } else if (retval != Z_OK && retval != Z_BUF_ERROR) {
+            BOOST_LOG_TRIVIAL(error) << "gzip: " << (stream->msg ? stream->msg : "corrupt stream");
+            _good = false;
+            break;
+        } else if (_inputPos != inputPos || stream->avail_out != before) {
+            _complete = false;
+        }
+        if (!more && stream->avail_out == before) {
+            if (!_complete) {
+                BOOST_LOG_TRIVIAL(error) << "gzip: truncated stream";
+                _good = false;
+            }
+            break;
+        }
+    }
+    return size - stream->avail_out;
+#else
+    (void)data;
+    (void)size;
+    return 0;
+#endif
+}
+
+size_t ReadBuffer::readZstd(char* data, size_t size) {
+#ifdef HAVE_ZSTD
+    ZSTD_DCtx* stream = static_cast<ZSTD_DCtx*>(_stream);
+    ZSTD_outBuffer out = {data, size, 0};
+    while (out.pos < out.size) {
+        // at the end of the file the stream may still hold output
+        bool more = _inputPos < _inputSize || fill();
+        size_t before = out.pos;
+        ZSTD_inBuffer in = {_input.data(), _inputSize, _inputPos};
+        size_t retval = ZSTD_decompressStream(stream, &out, &in);
+        if (ZSTD_isError(retval)) {
+            BOOST_LOG_TRIVIAL(error) << "zstd: " << ZSTD_getErrorName(retval);
+            _good = false;
+            break;
+        }
+        // 0 once a frame is decoded and flushed
+        if (in.pos != _inputPos || out.pos != before)
+            _complete = retval == 0;
+        _inputPos = in.pos;
+        if (!more && out.pos == before) {
+            if (!_complete) {
+                BOOST_LOG_TRIVIAL(error) << "zstd: truncated stream";
+                _good = false;
+            }
+            break;
+        }
+    }
+    return out.pos;
+#else
+    (void)data;
+    (void)size;
+    return 0;
+#endif
+}
+
+bool ReadBuffer::readAll(std::vector<char>& contents) {
+    size_t used = contents.size();
+    size_t got;
+    do {
+        contents.resize(used + BUFFER_SIZE);
+        got = read(contents.data() + used, BUFFER_SIZE);
+        used += got;
+    } while (got == BUFFER_SIZE);
+    contents.resize(used);
+    return _good;
+}
+
+bool ReadBuffer::readAll(std::string& contents) {
+    std::vector<char> buffer;
+    bool read = readAll(buffer);
+    contents.append(buffer.data(), buffer.size());
+    return read;
+}
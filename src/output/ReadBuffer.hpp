@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef READBUFFER_HPP
+#define READBUFFER_HPP
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// file read from front to back in large blocks. A file that starts with the zstd or gzip magic is decompressed while
+// it is read, so the loaders take the compressed outputs of WriteBuffer like the plain ones.
+class ReadBuffer {
+   public:
+    ReadBuffer(const std::string& filename);
+    ~ReadBuffer();
+
+    // opened, and no read or decompression error so far. A compressed file that ends inside a gzip member or zstd
+    // frame is an error once the end is read.
+    bool good(void) const;
+    bool compressed(void) const;
+
+    // up to size bytes, less only at the end of the file or after an error
+    size_t read(char* data, size_t size);
+
+    // appends the rest of the file, false on an error
+    bool readAll(std::vector<char>& contents);
+    bool readAll(std::string& contents);
+
+   private:
+    enum Codec { PLAIN, GZIP, ZSTD };
+
+    // next block of the file, false at its end
+    bool fill(void);
+    size_t readPlain(char* data, size_t size);
+    size_t readGzip(char* data, size_t size);
+    size_t readZstd(char* data, size_t size);
+
+    static constexpr size_t BUFFER_SIZE = 1 << 20;
+
+    FILE* _file;
+    bool _good;
+    Codec _codec;
+    void* _stream;   /// < z_stream or ZSTD_DCtx
+    bool _complete;  /// < the stream read so far ends with a whole gzip member or zstd frame
+
+    std::vector<char> _input;
+    size_t _inputPos;
+    size_t _inputSize;
+
+    ReadBuffer(const ReadBuffer&);
+    ReadBuffer& operator=(const ReadBuffer&);
+};
+
+#endif  // READBUFFER_HPP
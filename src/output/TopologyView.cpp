@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "TopologyView.hpp"
+
+TopologyView::TopologyView(FrozenTopology& topo) : _nodes(), _edges() {
+    NodeStore& store = topo.nodes();
+
+    std::vector<int> index(store.size(), -1);
+    for (unsigned id : topo.nodeOrder()) {
+        if (!store.node(id)->isValid())
+            continue;
+
+        index[id] = _nodes.size();
+        _nodes.push_back(Node{static_cast<int>(id), store.node(id)});
+    }
+
+    for (unsigned e = 0; e < topo.edgeCount(); ++e) {
+        int uIndex = index[topo.u(e)];
+        int vIndex = index[topo.v(e)];
+        if (uIndex < 0 || vIndex < 0)
+            continue;
+
+        _edges.push_back(Edge{static_cast<int>(topo.u(e)), static_cast<int>(topo.v(e)), static_cast<unsigned>(uIndex),
+                              static_cast<unsigned>(vIndex), topo.length(e), topo.lengthKM(e), topo.kind(e),
+                              topo.edge(e)});
+    }
+}
+
+const std::vector<TopologyView::Node>& TopologyView::nodes(void) const {
+    return _nodes;
+}
+
+const std::vector<TopologyView::Edge>& TopologyView::edges(void) const {
+    return _edges;
+}
+
+const GeographicNode_Ptr& TopologyView::u(const Edge& edge) const {
+    return _nodes[edge.uIndex].node;
+}
+
+const GeographicNode_Ptr& TopologyView::v(const Edge& edge) const {
+    return _nodes[edge.vIndex].node;
+}
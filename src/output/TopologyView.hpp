@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef TOPOLOGYVIEW_HPP
+#define TOPOLOGYVIEW_HPP
+
+#include "geo/GeographicEdge.hpp"
+#include "geo/GeographicNode.hpp"
+#include "topo/FrozenTopology.hpp"
+#include <memory>
+#include <vector>
+
+// the valid nodes of a frozen topology and the edges between them, indexed by the writers from several threads
+class TopologyView {
+   public:
+    struct Node {
+        int id;  /// < graph id
+        GeographicNode_Ptr node;
+    };
+
+    struct Edge {
+        int u;  /// < graph id
+        int v;
+        unsigned uIndex;  /// < into nodes()
+        unsigned vIndex;
+        double length;  /// < radians
+        double lengthKM;
+        GeographicEdge::Kind kind;
+        GeographicEdge_Ptr edge;
+    };
+
+    TopologyView(FrozenTopology& topo);
+
+    const std::vector<Node>& nodes(void) const;
+    const std::vector<Edge>& edges(void) const;
+
+    const GeographicNode_Ptr& u(const Edge& edge) const;
+    const GeographicNode_Ptr& v(const Edge& edge) const;
+
+   private:
+    std::vector<Node> _nodes;
+    std::vector<Edge> _edges;
+};
+
+typedef std::shared_ptr<TopologyView> TopologyView_Ptr;
+
+#endif  // TOPOLOGYVIEW_HPP
@@ -0,0 +1,515 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "WriteBuffer.hpp"
+#include "FileSink.hpp"
+#include "config/Config.hpp"
+#include "config/Defines.hpp"
+#include <boost/log/trivial.hpp>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace {
+
+// little endian fields of the zip headers
+void putLE(std::vector<unsigned char>& out, uint32_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i)
+        out.push_back((value >> (8 * i)) & 0xff);
+}
+
+// 1980-01-01 00:00, the earliest DOS date
+const uint16_t ZIP_TIME = 0;
+const uint16_t ZIP_DATE = (1 << 5) | 1;
+
+// version 2.0, bit 3: sizes and crc follow the data, method 8: deflate
+void putEntryFields(std::vector<unsigned char>& out) {
+    putLE(out, 20, 2);
+    putLE(out, 1 << 3, 2);
+    putLE(out, 8, 2);
+    putLE(out, ZIP_TIME, 2);
+    putLE(out, ZIP_DATE, 2);
+}
+
+const double POWERS_OF_TEN[] = {1e0, 1e1, 1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15};
+
+// integers up to here are exact doubles
+const double MAX_EXACT_INTEGER = 9007199254740992.0;
+
+// decimal digits of value in front of end, returns the first one
+char* formatDigits(uint64_t value, char* end) {
+    do {
+        *--end = '0' + value % 10;
+        value /= 10;
+    } while (value != 0);
+    return end;
+}
+
+bool endsWith(const std::string& str, const std::string& suffix) {
+    return str.size() >= suffix.size() && str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+}  // namespace
+
+Compression Compression::fromConfig(void) {
+    Config config;
+    Compression compression;
+    compression.codec = config.get<bool>("output.compression.enable")
+                            ? config.get<std::string>("output.compression.codec")
+                            : std::string();
+    compression.level = config.get<int>("output.compression.level");
+    compression.threads = config.get<unsigned int>("output.compression.threads");
+
+    std::string requested = compression.codec;
+#ifndef HAVE_ZSTD
+    if (compression.codec == "zstd")
+        compression.codec = "gzip";
+#endif
+#ifndef HAVE_ZLIB
+    if (compression.codec == "gzip")
+        compression.codec.clear();
+#endif
+    if (!compression.codec.empty() && compression.codec != "zstd" && compression.codec != "gzip")
+        compression.codec.clear();
+
+    static std::once_flag warned;
+    if (compression.codec != requested)
+        std::call_once(warned, [&] {
+            BOOST_LOG_TRIVIAL(warning) << "output compression " << requested << " is not available, using "
+                                       << (compression.codec.empty() ? "none" : compression.codec);
+        });
+    return compression;
+}
+
+std::string Compression::suffix(void) const {
+    if (codec == "zstd")
+        return ".zst";
+    if (codec == "gzip")
+        return ".gz";
+    return "";
+}
+
+WriteBuffer::WriteBuffer()
+    : _buffer(MEMORY_BUFFER_SIZE),
+      _used(0),
+      _inMemory(true),
+      _sink(),
+      _good(true),
+      _zipEntry(),
+      _compressed(),
+      _compressedUsed(0),
+      _deflate(nullptr),
+      _zstd(nullptr),
+      _crc(0),
+      _compressedSize(0),
+      _uncompressedSize(0) {
+}
+
+WriteBuffer::WriteBuffer(const std::string& filename, const std::string& zipEntry)
+    : _buffer(),
+      _used(0),
+      _inMemory(false),
+      _sink(),
+      _good(false),
+      _zipEntry(zipEntry),
+      _compressed(),
+      _compressedUsed(0),
+      _deflate(nullptr),
+      _zstd(nullptr),
+      _crc(0),
+      _compressedSize(0),
+      _uncompressedSize(0) {
+    FileSink::Settings settings(FileSink::Settings::fromConfig());
+    _buffer.resize(settings.bufferSize);
+    _sink.reset(new FileSink(filename, settings));
+    _good = _sink->isOpen();
+    if (!_good)
+        return;
+    if (_zipEntry.empty()) {
+        openStream(filename, settings.bufferSize);
+        return;
+    }
+
+#ifdef HAVE_ZLIB
+    // raw deflate stream, the zip headers replace the zlib header
+    _compressed.resize(settings.bufferSize);
+    z_stream* stream = new z_stream();
+    int retval = deflateInit2(stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+    assert(retval == Z_OK);
+    _deflate = stream;
+    _crc = crc32(0L, Z_NULL, 0);
+
+    // local file header
+    std::vector<unsigned char> header;
+    putLE(header, 0x04034b50, 4);
+    putEntryFields(header);
+    putLE(header, 0, 4);  // crc, compressed and uncompressed size are in the data descriptor
+    putLE(header, 0, 4);
+    putLE(header, 0, 4);
+    putLE(header, _zipEntry.size(), 2);
+    putLE(header, 0, 2);
+    header.insert(header.end(), _zipEntry.begin(), _zipEntry.end());
+    writeCompressed(header.data(), header.size());
+#else
+    BOOST_LOG_TRIVIAL(warning) << "built without zlib, writing " << filename << " uncompressed";
+    _zipEntry.clear();
+#endif
+}
+
+void WriteBuffer::openStream(const std::string& filename, size_t bufferSize) {
+    const bool zstd = endsWith(filename, ".zst");
+    const bool gzip = endsWith(filename, ".gz");
+    if (!zstd && !gzip)
+        return;
+
+    Compression compression(Compression::fromConfig());
+    if (zstd) {
+#ifdef HAVE_ZSTD
+        ZSTD_CCtx* stream = ZSTD_createCCtx();
+        assert(stream);
+        ZSTD_CCtx_setParameter(stream, ZSTD_c_compressionLevel, compression.level);
+        // libzstd without thread support rejects the workers and compresses on this thread
+        if (compression.threads > 0)
+            ZSTD_CCtx_setParameter(stream, ZSTD_c_nbWorkers, compression.threads);
+        _zstd = stream;
+        _compressed.resize(bufferSize);
+#else
+        BOOST_LOG_TRIVIAL(warning) << "built without zstd, writing " << filename << " uncompressed";
+#endif
+        return;
+    }
+
+#ifdef HAVE_ZLIB
+    // gzip header and trailer around the deflate stream, zlib has the levels -1 (its default) to 9 only
+    z_stream* stream = new z_stream();
+    int retval = deflateInit2(stream, std::max(-1, std::min(compression.level, 9)), Z_DEFLATED, MAX_WBITS + 16, 8,
+                              Z_DEFAULT_STRATEGY);
+    assert(retval == Z_OK);
+    _deflate = stream;
+    _compressed.resize(bufferSize);
+#else
+    (void)bufferSize;
+    BOOST_LOG_TRIVIAL(warning) << "built without zlib, writing " << filename << " uncompressed";
+#endif
+}
+
+WriteBuffer::~WriteBuffer() {
+    close();
+}
+
+// makes room for size bytes, a buffer in memory grows, a file buffer is flushed
+void WriteBuffer::reserve(size_t size) {
+    if (size <= _buffer.size() - _used)
+        return;
+
+    if (!_inMemory)
+        flush();
+    else
+        _buffer.resize(std::max(2 * _buffer.size(), _used + size));
+}
+
+void WriteBuffer::write(const char* data, size_t size) {
+    // a file buffer is filled and flushed in turns, larger data in pieces
+    while (!_inMemory && size > _buffer.size() - _used) {
+        size_t piece = _buffer.size() - _used;
+        memcpy(_buffer.data() + _used, data, piece);
+        _used += piece;
+        data += piece;
+        size -= piece;
+        flush();
+    }
+
+    reserve(size);
+    memcpy(_buffer.data() + _used, data, size);
+    _used += size;
+}
+
+void WriteBuffer::append(const WriteBuffer& other) {
+    write(other.data(), other.size());
+}
+
+const char* WriteBuffer::data(void) const {
+    return _buffer.data();
+}
+
+size_t WriteBuffer::size(void) const {
+    return _used;
+}
+
+WriteBuffer& WriteBuffer::operator<<(const char* str) {
+    write(str, strlen(str));
+    return *this;
+}
+
+WriteBuffer& WriteBuffer::operator<<(const std::string& str) {
+    write(str.data(), str.size());
+    return *this;
+}
+
+WriteBuffer& WriteBuffer::operator<<(char c) {
+    reserve(1);
+    _buffer[_used++] = c;
+    return *this;
+}
+
+WriteBuffer& WriteBuffer::operator<<(int value) {
+    char str[16];
+    char* end = str + sizeof(str);
+    char* begin = formatDigits(value < 0 ? -static_cast<int64_t>(value) : value, end);
+    if (value < 0)
+        *--begin = '-';
+    write(begin, end - begin);
+    return *this;
+}
+
+WriteBuffer& WriteBuffer::operator<<(double value) {
+    char str[32];
+    int length = snprintf(str, sizeof(str), "%g", value);
+    write(str, length);
+    return *this;
+}
+
+WriteBuffer& WriteBuffer::operator<<(Shortest shortest) {
+    const double value = shortest.value;
+    const double magnitude = std::fabs(value);
+
+    // the digits of the value scaled by 10^decimals as an integer, the fewest decimals that read back exactly as
+    // value are the shortest fixed notation. Integer over power of ten is rounded like reading the decimal.
+    if (magnitude >= 1e-4 && magnitude < POWERS_OF_TEN[15]) {
+        for (int decimals = 0; decimals < 16; ++decimals) {
+            double scaled = magnitude * POWERS_OF_TEN[decimals];
+            if (scaled >= MAX_EXACT_INTEGER)
+                break;
+            uint64_t digits = std::llround(scaled);
+            if (static_cast<double>(digits) / POWERS_OF_TEN[decimals] != magnitude)
+                continue;
+
+            char str[40];
+            char* end = str + sizeof(str);
+            char* begin = formatDigits(digits, end);
+            while (end - begin < decimals + 1)
+                *--begin = '0';
+            if (decimals > 0) {
+                memmove(begin - 1, begin, end - begin - decimals);
+                --begin;
+                end[-decimals - 1] = '.';
+            }
+            if (value < 0)
+                *--begin = '-';
+            write(begin, end - begin);
+            return *this;
+        }
+    }
+
+    // exponent notation for very small and large values
+    char str[32];
+    int length = 0;
+    for (int precision = 15; precision <= 17; ++precision) {
+        length = snprintf(str, sizeof(str), "%.*g", precision, value);
+        if (strtod(str, nullptr) == value)
+            break;
+    }
+    write(str, length);
+    return *this;
+}
+
+void WriteBuffer::flush(void) {
+    if (!_sink || _used == 0)
+        return;
+
+    if (_zstd)
+        compressBuffer(_buffer.data(), _used, false);
+    else if (_deflate)
+        deflateBuffer(_buffer.data(), _used, false);
+    else
+        _sink->submit(_buffer, _used);
+    _used = 0;
+}
+
+void WriteBuffer::deflateBuffer(const char* data, size_t size, bool finish) {
+#ifdef HAVE_ZLIB
+    z_stream* stream = static_cast<z_stream*>(_deflate);
+    if (size > 0) {
+        _crc = crc32(_crc, reinterpret_cast<const Bytef*>(data), size);
+        _uncompressedSize += size;
+    }
+
+    // straight into the archive buffer
+    stream->next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+    stream->avail_in = size;
+    int retval;
+    do {
+        if (_compressedUsed == _compressed.size())
+            flushCompressed();
+        size_t space = _compressed.size() - _compressedUsed;
+        stream->next_out = reinterpret_cast<Bytef*>(_compressed.data() + _compressedUsed);
+        stream->avail_out = space;
+        retval = deflate(stream, finish ? Z_FINISH : Z_NO_FLUSH);
+        size_t produced = space - stream->avail_out;
+        _compressedUsed += produced;
+        _compressedSize += produced;
+    } while (finish ? retval == Z_OK : stream->avail_out == 0);
+    assert(!finish || retval == Z_STREAM_END);
+#else
+    (void)data;
+    (void)size;
+    (void)finish;
+#endif
+}
+
+void WriteBuffer::compressBuffer(const char* data, size_t size, bool finish) {
+#ifdef HAVE_ZSTD
+    ZSTD_CCtx* stream = static_cast<ZSTD_CCtx*>(_zstd);
+    ZSTD_inBuffer in = {data, size, 0};
+    bool done;
+    do {
+        if (_compressedUsed == _compressed.size())
+            flushCompressed();
+        ZSTD_outBuffer out = {_compressed.data() + _compressedUsed, _compressed.size() - _compressedUsed, 0};
+        size_t remaining = ZSTD_compressStream2(stream, &out, &in, finish ? ZSTD_e_end : ZSTD_e_continue);
+        if (ZSTD_isError(remaining)) {
+            BOOST_LOG_TRIVIAL(error) << "zstd: " << ZSTD_getErrorName(remaining);
+            _good = false;
+            return;
+        }
+        _compressedUsed += out.pos;
+        done = finish ? remaining == 0 : in.pos == in.size;
+    } while (!done);
+#else
+    (void)data;
+    (void)size;
+    (void)finish;
+#endif
+}
+
+void WriteBuffer::writeCompressed(const unsigned char* data, size_t size) {
+    while (size > 0) {
+        if (_compressedUsed == _compressed.size())
+            flushCompressed();
+        size_t piece = std::min(size, _compressed.size() - _compressedUsed);
+        memcpy(_compressed.data() + _compressedUsed, data, piece);
+        _compressedUsed += piece;
+        data += piece;
+        size -= piece;
+    }
+}
+
+void WriteBuffer::flushCompressed(void) {
+    _sink->submit(_compressed, _compressedUsed);
+    _compressedUsed = 0;
+}
+
+bool WriteBuffer::close(void) {
+    if (_inMemory || !_sink)
+        return _good;
+
+    flush();
+
+#ifdef HAVE_ZSTD
+    if (_zstd) {
+        compressBuffer(nullptr, 0, true);
+        ZSTD_freeCCtx(static_cast<ZSTD_CCtx*>(_zstd));
+        _zstd = nullptr;
+    }
+#endif
+
+#ifdef HAVE_ZLIB
+    if (_deflate) {
+        deflateBuffer(nullptr, 0, true);
+        z_stream* stream = static_cast<z_stream*>(_deflate);
+        deflateEnd(stream);
+        delete stream;
+        _deflate = nullptr;
+    }
+
+    if (!_zipEntry.empty()) {
+        // the archive uses 32 bit sizes
+        assert(_uncompressedSize < 0xffffffffull && _compressedSize < 0xffffffffull);
+        uint32_t headerSize = 30 + _zipEntry.size();
+        uint32_t directoryOffset = headerSize + _compressedSize + 16;
+
+        std::vector<unsigned char> trailer;
+
+        // data descriptor
+        putLE(trailer, 0x08074b50, 4);
+        putLE(trailer, _crc, 4);
+        putLE(trailer, _compressedSize, 4);
+        putLE(trailer, _uncompressedSize, 4);
+
+        // central directory with one entry
+        size_t directoryStart = trailer.size();
+        putLE(trailer, 0x02014b50, 4);
+        putLE(trailer, 20, 2);
+        putEntryFields(trailer);
+        putLE(trailer, _crc, 4);
+        putLE(trailer, _compressedSize, 4);
+        putLE(trailer, _uncompressedSize, 4);
+        putLE(trailer, _zipEntry.size(), 2);
+        putLE(trailer, 0, 2);  // extra field
+        putLE(trailer, 0, 2);  // comment
+        putLE(trailer, 0, 2);  // disk
+        putLE(trailer, 0, 2);  // internal attributes
+        putLE(trailer, 0, 4);  // external attributes
+        putLE(trailer, 0, 4);  // offset of the local header
+        trailer.insert(trailer.end(), _zipEntry.begin(), _zipEntry.end());
+        uint32_t directorySize = trailer.size() - directoryStart;
+
+        // end of central directory
+        putLE(trailer, 0x06054b50, 4);
+        putLE(trailer, 0, 2);
+        putLE(trailer, 0, 2);
+        putLE(trailer, 1, 2);
+        putLE(trailer, 1, 2);
+        putLE(trailer, directorySize, 4);
+        putLE(trailer, directoryOffset, 4);
+        putLE(trailer, 0, 2);
+
+        writeCompressed(trailer.data(), trailer.size());
+    }
+#endif
+
+    if (!_compressed.empty())
+        flushCompressed();
+
+    _good = _sink->close() && _good;
+    _sink.reset();
+    return _good;
+}
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef WRITEBUFFER_HPP
+#define WRITEBUFFER_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+class FileSink;
+
+// a double written with the fewest digits that read back as the same double, in fixed notation where that is short
+struct Shortest {
+    explicit Shortest(double v) : value(v) {}
+    double value;
+};
+
+// output.compression: files are written as one stream of the codec, zstd or gzip, and ChunkedOutput appends the
+// suffix of the codec to their names. A codec missing in the build falls back to gzip, or to no compression.
+struct Compression {
+    std::string codec;     /// < zstd, gzip or empty without compression
+    int level;
+    unsigned int threads;  /// < zstd workers per file, 0 compresses on the writing thread
+
+    static Compression fromConfig(void);
+
+    // .zst, .gz or empty
+    std::string suffix(void) const;
+};
+
+// large output buffer in front of a file, formats numbers like an std::ostream with default flags but without its
+// locale and sentry overhead. Full buffers go to a FileSink, which writes them in the background with output.async.
+class WriteBuffer {
+   public:
+    // growing buffer in memory, e.g. for one chunk of a ChunkedOutput
+    WriteBuffer();
+
+    // with a zipEntry the file becomes a zip archive holding one deflated file of that name (e.g. doc.kml for KMZ),
+    // builds without zlib write the file uncompressed. Otherwise a filename ending in .zst or .gz is written as a zstd
+    // or gzip stream at the level of output.compression.
+    WriteBuffer(const std::string& filename, const std::string& zipEntry = "");
+    ~WriteBuffer();
+
+    void write(const char* data, size_t size);
+    void append(const WriteBuffer& other);
+
+    // content of a buffer in memory
+    const char* data(void) const;
+    size_t size(void) const;
+
+    WriteBuffer& operator<<(const char* str);
+    WriteBuffer& operator<<(const std::string& str);
+    WriteBuffer& operator<<(char c);
+    WriteBuffer& operator<<(int value);
+    WriteBuffer& operator<<(double value);  /// < %g, as operator<< with precision 6
+    WriteBuffer& operator<<(Shortest value);
+
+    // flushes and finishes the archive, false if anything could not be written
+    bool close(void);
+
+   private:
+    void reserve(size_t size);
+    void flush(void);
+    // compressed stream for a filename ending in .zst or .gz
+    void openStream(const std::string& filename, size_t bufferSize);
+    // deflates until the input is consumed, or with finish until the stream ends
+    void deflateBuffer(const char* data, size_t size, bool finish);
+    void compressBuffer(const char* data, size_t size, bool finish);  /// < zstd
+    // bytes of the archive around the deflated data
+    void writeCompressed(const unsigned char* data, size_t size);
+    void flushCompressed(void);
+
+    static constexpr size_t MEMORY_BUFFER_SIZE = 1 << 16;
+
+    std::vector<char> _buffer;
+    size_t _used;
+    bool _inMemory;
+    std::unique_ptr<FileSink> _sink;
+    bool _good;
+
+    // zip archive or compressed stream state, the output is collected in _compressed for the sink
+    std::string _zipEntry;
+    std::vector<char> _compressed;
+    size_t _compressedUsed;
+    void* _deflate;  /// < raw deflate of the zip archive or gzip stream
+    void* _zstd;
+    uint32_t _crc;
+    uint64_t _compressedSize;
+    uint64_t _uncompressedSize;
+
+    WriteBuffer(const WriteBuffer&);
+    WriteBuffer& operator=(const WriteBuffer&);
+};
+
+#endif  // WRITEBUFFER_HPP
@@ -0,0 +1,460 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "FailureAnalysis.hpp"
+
+#include "output/ReadBuffer.hpp"
+#include "util/ThreadPool.hpp"
+#include <algorithm>
+#include <boost/log/trivial.hpp>
+#include <cassert>
+#include <map>
+#include <numeric>
+
+constexpr unsigned FailureAnalysis::NO_EDGE;
+constexpr unsigned FailureAnalysis::NO_COMPONENT;
+
+namespace {
+
+const unsigned UNVISITED = std::numeric_limits<unsigned>::max();
+
+uint64_t pairs(uint64_t n) {
+    return n * (n - 1) / 2;
+}
+
+// union-find with the node count of each set at its root
+class Units {
+   public:
+    Units(size_t n) : _parent(n), _size(n, 0) { std::iota(_parent.begin(), _parent.end(), 0); }
+
+    unsigned find(unsigned i) {
+        while (_parent[i] != i) {
+            _parent[i] = _parent[_parent[i]];
+            i = _parent[i];
+        }
+        return i;
+    }
+
+    void join(unsigned a, unsigned b) {
+        a = find(a);
+        b = find(b);
+        if (a == b)
+            return;
+        if (_size[a] < _size[b])
+            std::swap(a, b);
+        _parent[b] = a;
+        _size[a] += _size[b];
+    }
+
+    uint64_t& size(unsigned i) { return _size[i]; }
+    bool isRoot(unsigned i) const { return _parent[i] == i; }
+
+   private:
+    std::vector<unsigned> _parent;
+    std::vector<uint64_t> _size;
+};
+
+}  // namespace
+
+FailureAnalysis::FailureAnalysis(FrozenTopology_Ptr topo) : _topo(topo), _pairs(0) {
+    findBridges();
+    labelComponents();
+    buildBridgeForest();
+    BOOST_LOG_TRIVIAL(info) << "FailureAnalysis: " << _bridges.size() << " bridges, " << _componentSize.size()
+                            << " 2-edge-connected components";
+}
+
+void FailureAnalysis::findBridges(void) {
+    const size_t n = _topo->nodes().size();
+    _bridge.assign(_topo->edgeCount(), false);
+    std::vector<unsigned> enter(n, UNVISITED);
+    std::vector<unsigned> low(n);
+
+    struct Frame {
+        unsigned node;
+        unsigned parentEdge;
+        const FrozenTopology::Adjacency* next;
+    };
+    std::vector<Frame> stack;
+    unsigned time = 0;
+    for (unsigned root : _topo->nodeOrder()) {
+        if (enter[root] != UNVISITED)
+            continue;
+        enter[root] = low[root] = time++;
+        stack.push_back({root, NO_EDGE, _topo->adjacencyBegin(root)});
+        while (!stack.empty()) {
+            Frame& frame = stack.back();
+            if (frame.next != _topo->adjacencyEnd(frame.node)) {
+                const FrozenTopology::Adjacency a = *frame.next++;
+                // only the edge to the parent is skipped, a parallel edge to it closes a cycle
+                if (a.edge == frame.parentEdge)
+                    continue;
+                if (enter[a.target] == UNVISITED) {
+                    enter[a.target] = low[a.target] = time++;
+                    stack.push_back({a.target, a.edge, _topo->adjacencyBegin(a.target)});
+                } else {
+                    low[frame.node] = std::min(low[frame.node], enter[a.target]);
+                }
+                continue;
+            }
+
+            const Frame done = frame;
+            stack.pop_back();
+            if (stack.empty())
+                break;
+            unsigned parent = stack.back().node;
+            low[parent] = std::min(low[parent], low[done.node]);
+            if (low[done.node] > enter[parent]) {
+                _bridge[done.parentEdge] = true;
+                _bridges.push_back(done.parentEdge);
+            }
+        }
+    }
+    std::sort(_bridges.begin(), _bridges.end());
+}
+
+void FailureAnalysis::labelComponents(void) {
+    NodeStore& nodes = _topo->nodes();
+    _component.assign(nodes.size(), NO_COMPONENT);
+    std::vector<unsigned> queue;
+    for (unsigned root : _topo->nodeOrder()) {
+        if (_component[root] != NO_COMPONENT)
+            continue;
+        unsigned c = _componentSize.size();
+        _memberOffsets.push_back(_members.size());
+        _component[root] = c;
+        queue.assign(1, root);
+        for (size_t head = 0; head < queue.size(); ++head) {
+            unsigned i = queue[head];
+            _members.push_back(i);
+            for (const FrozenTopology::Adjacency* a = _topo->adjacencyBegin(i); a != _topo->adjacencyEnd(i); ++a) {
+                if (_bridge[a->edge] || _component[a->target] != NO_COMPONENT)
+                    continue;
+                _component[a->target] = c;
+                queue.push_back(a->target);
+            }
+        }
+        _componentSize.push_back(queue.size());
+    }
+    _memberOffsets.push_back(_members.size());
+}
+
+void FailureAnalysis::buildBridgeForest(void) {
+    const size_t components = _componentSize.size();
+    _tree.assign(components, NO_COMPONENT);
+    _enter.assign(components, 0);
+    _leave.assign(components, 0);
+    _subtree.assign(components, 0);
+    _child.assign(_topo->edgeCount(), NO_COMPONENT);
+
+    // bridges by component
+    std::vector<unsigned> offsets(components + 1, 0);
+    for (unsigned e : _bridges) {
+        ++offsets[_component[_topo->u(e)] + 1];
+        ++offsets[_component[_topo->v(e)] + 1];
+    }
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+    std::vector<unsigned> incident(offsets.back());
+    std::vector<unsigned> fill(offsets.begin(), offsets.end() - 1);
+    for (unsigned e : _bridges) {
+        incident[fill[_component[_topo->u(e)]]++] = e;
+        incident[fill[_component[_topo->v(e)]]++] = e;
+    }
+
+    struct Frame {
+        unsigned component;
+        unsigned next;  /// < into incident
+    };
+    std::vector<Frame> stack;
+    unsigned time = 0;
+    for (unsigned root = 0; root < components; ++root) {
+        if (_tree[root] != NO_COMPONENT)
+            continue;
+        unsigned tree = _treeSize.size();
+        _tree[root] = tree;
+        _enter[root] = time++;
+        stack.push_back({root, offsets[root]});
+        while (!stack.empty()) {
+            Frame& frame = stack.back();
+            if (frame.next != offsets[frame.component + 1]) {
+                unsigned e = incident[frame.next++];
+                unsigned cu = _component[_topo->u(e)];
+                unsigned other = cu == frame.component ? _component[_topo->v(e)] : cu;
+                if (_tree[other] != NO_COMPONENT)
+                    continue;
+                _tree[other] = tree;
+                _enter[other] = time++;
+                _child[e] = other;
+                stack.push_back({other, offsets[other]});
+                continue;
+            }
+
+            unsigned c = frame.component;
+            stack.pop_back();
+            _leave[c] = time++;
+            _subtree[c] += _componentSize[c];
+            if (!stack.empty())
+                _subtree[stack.back().component] += _subtree[c];
+        }
+        _treeSize.push_back(_subtree[root]);
+        _pairs += pairs(_subtree[root]);
+    }
+}
+
+unsigned FailureAnalysis::findEdge(unsigned u, unsigned v) const {
+    if (u >= _component.size() || v >= _component.size() || _component[u] == NO_COMPONENT)
+        return NO_EDGE;
+    for (const FrozenTopology::Adjacency* a = _topo->adjacencyBegin(u); a != _topo->adjacencyEnd(u); ++a)
+        if (a->target == v)
+            return a->edge;
+    return NO_EDGE;
+}
+
+FailureAnalysis::Result FailureAnalysis::analyze(const Scenario& scenario, bool stretch, bool useForest) const {
+    std::vector<unsigned> failed(scenario.edges);
+    std::sort(failed.begin(), failed.end());
+    failed.erase(std::unique(failed.begin(), failed.end()), failed.end());
+
+    Result result;
+    result.failed = failed.size();
+    result.bridges = 0;
+
+    // the forest suffices while no component loses two of its inner edges, one inner edge leaves it connected
+    std::vector<unsigned> failedBridges;
+    std::map<unsigned, unsigned> innerFailures;
+    bool forest = useForest;
+    for (unsigned e : failed) {
+        assert(e < _topo->edgeCount());
+        if (_bridge[e])
+            failedBridges.push_back(e);
+        else if (++innerFailures[_component[_topo->u(e)]] > 1)
+            forest = false;
+    }
+    result.bridges = failedBridges.size();
+    result.bridgeTree = forest;
+
+    std::vector<char> mask(_topo->edgeCount(), false);
+    for (unsigned e : failed)
+        mask[e] = true;
+
+    if (forest)
+        fromBridgeForest(failedBridges, result);
+    else
+        recount(failed, mask, result);
+
+    if (stretch) {
+        result.stretch.reserve(failed.size());
+        for (unsigned e : failed) {
+            double detour = _topo->shortestDistance(_topo->u(e), _topo->v(e), mask);
+            double length = _topo->length(e);
+            result.stretch.push_back(detour < 0.0 ? -1.0 : (length > 0.0 ? detour / length : 1.0));
+        }
+    }
+    return result;
+}
+
+std::vector<FailureAnalysis::Result> FailureAnalysis::analyze(const std::vector<Scenario>& scenarios,
+                                                              bool stretch) const {
+    std::vector<Result> results(scenarios.size());
+    ThreadPool::fromConfig()->forEach(scenarios.size(),
+                                      [&](size_t i) { results[i] = analyze(scenarios[i], stretch); });
+    return results;
+}
+
+void FailureAnalysis::fromBridgeForest(const std::vector<unsigned>& failedBridges, Result& result) const {
+    // every cut bridge splits off the subtree below it, less the subtrees split off further down
+    std::vector<unsigned> children;
+    children.reserve(failedBridges.size());
+    for (unsigned e : failedBridges)
+        children.push_back(_child[e]);
+    std::sort(children.begin(), children.end(), [this](unsigned a, unsigned b) { return _enter[a] < _enter[b]; });
+
+    std::vector<uint64_t> part(children.size());
+    std::map<unsigned, uint64_t> rootPart;  /// < nodes left at the root of each hit tree
+    std::vector<unsigned> stack;
+    for (size_t i = 0; i < children.size(); ++i) {
+        unsigned c = children[i];
+        part[i] = _subtree[c];
+        while (!stack.empty() && _leave[children[stack.back()]] < _enter[c])
+            stack.pop_back();
+        if (stack.empty()) {
+            auto root = rootPart.insert(std::make_pair(_tree[c], _treeSize[_tree[c]])).first;
+            root->second -= _subtree[c];
+        } else {
+            part[stack.back()] -= _subtree[c];
+        }
+        stack.push_back(i);
+    }
+
+    uint64_t disconnected = 0;
+    for (const auto& root : rootPart)
+        disconnected += pairs(_treeSize[root.first]) - pairs(root.second);
+    for (uint64_t p : part)
+        disconnected -= pairs(p);
+    result.components = components() + failedBridges.size();
+    result.disconnectedPairs = disconnected;
+}
+
+void FailureAnalysis::recount(const std::vector<unsigned>& failed,
+                              const std::vector<char>& mask,
+                              Result& result) const {
+    // units 0 to components - 1 for the untouched components, then one per node id of the hit components
+    const unsigned offset = _componentSize.size();
+    std::vector<char> hit(_componentSize.size(), false);
+    std::vector<unsigned> hitComponents;
+    for (unsigned e : failed) {
+        unsigned c = _component[_topo->u(e)];
+        if (!_bridge[e] && !hit[c]) {
+            hit[c] = true;
+            hitComponents.push_back(c);
+        }
+    }
+    auto unit = [&](unsigned node) {
+        unsigned c = _component[node];
+        return hit[c] ? offset + node : c;
+    };
+
+    Units units(offset + _component.size());
+    for (unsigned c = 0; c < offset; ++c)
+        if (!hit[c])
+            units.size(c) = _componentSize[c];
+    for (unsigned c : hitComponents) {
+        for (unsigned m = _memberOffsets[c]; m < _memberOffsets[c + 1]; ++m)
+            units.size(offset + _members[m]) = 1;
+    }
+
+    for (unsigned e : _bridges)
+        if (!mask[e])
+            units.join(unit(_topo->u(e)), unit(_topo->v(e)));
+    for (unsigned c : hitComponents) {
+        for (unsigned m = _memberOffsets[c]; m < _memberOffsets[c + 1]; ++m) {
+            unsigned i = _members[m];
+            for (const FrozenTopology::Adjacency* a = _topo->adjacencyBegin(i); a != _topo->adjacencyEnd(i); ++a)
+                if (!mask[a->edge] && !_bridge[a->edge] && i < a->target)
+                    units.join(offset + i, offset + a->target);
+        }
+    }
+
+    result.components = 0;
+    uint64_t connected = 0;
+    for (unsigned i = 0; i < offset + _component.size(); ++i) {
+        if (!units.isRoot(i) || units.size(i) == 0)
+            continue;
+        ++result.components;
+        connected += pairs(units.size(i));
+    }
+    result.disconnectedPairs = _pairs - connected;
+}
+
+std::vector<FailureAnalysis::Scenario> FailureAnalysis::readScenarios(const std::string& filename) const {
+    std::vector<Scenario> scenarios;
+    // compressed like the outputs or plain
+    ReadBuffer file(filename);
+    std::string contents;
+    Json::Value root;
+    std::string errors;
+    Json::CharReaderBuilder builder;
+    std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+    if (!file.readAll(contents) ||
+        !reader->parse(contents.data(), contents.data() + contents.size(), &root, &errors) || !root.isObject()) {
+        BOOST_LOG_TRIVIAL(error) << "FailureAnalysis: could not read scenarios from " << filename << " " << errors;
+        return scenarios;
+    }
+
+    Json::StreamWriterBuilder oneLine;
+    oneLine["indentation"] = "";
+    for (const Json::Value& entry : root["scenarios"]) {
+        Scenario scenario;
+        scenario.name = entry.get("name", "scenario " + std::to_string(scenarios.size())).asString();
+        for (const Json::Value& pair : entry["edges"]) {
+            unsigned e = NO_EDGE;
+            if (pair.isArray() && pair.size() == 2 && pair[0].isUInt() && pair[1].isUInt())
+                e = findEdge(pair[0].asUInt(), pair[1].asUInt());
+            if (e == NO_EDGE) {
+                BOOST_LOG_TRIVIAL(warning) << "FailureAnalysis: scenario " << scenario.name << " skips unknown edge "
+                                           << Json::writeString(oneLine, pair);
+                continue;
+            }
+            scenario.edges.push_back(e);
+        }
+        scenarios.push_back(scenario);
+    }
+    return scenarios;
+}
+
+std::vector<FailureAnalysis::Scenario> FailureAnalysis::seacableScenarios(void) const {
+    std::vector<Scenario> scenarios;
+    for (unsigned e = 0; e < _topo->edgeCount(); ++e) {
+        if (_topo->kind(e) != GeographicEdge::SEACABLE_EDGE)
+            continue;
+        Scenario scenario;
+        scenario.name = "seacable " + std::to_string(_topo->u(e)) + " " + std::to_string(_topo->v(e));
+        scenario.edges.push_back(e);
+        scenarios.push_back(scenario);
+    }
+    return scenarios;
+}
+
+void FailureAnalysis::addTo(ChunkedOutput& output,
+                            const std::string& filename,
+                            const std::vector<Scenario>& scenarios,
+                            const std::vector<Result>& results) {
+    assert(scenarios.size() == results.size());
+    auto json = std::make_shared<Json::Value>(Json::objectValue);
+    (*json)["nodes"] = Json::UInt64(_members.size());
+    (*json)["edges"] = Json::UInt64(_topo->edgeCount());
+    (*json)["components"] = Json::UInt64(components());
+    (*json)["bridges"] = Json::UInt64(bridgeCount());
+    (*json)["twoEdgeComponents"] = Json::UInt64(twoEdgeComponentCount());
+    Json::Value& list = (*json)["scenarios"] = Json::Value(Json::arrayValue);
+    for (size_t i = 0; i < scenarios.size(); ++i)
+        list.append(toJSON(scenarios[i], results[i]));
+
+    output.addFile(filename);
+    output.addChunk([json](WriteBuffer& out) {
+        Json::StyledWriter writer;
+        out << writer.write(*json);
+    });
+}
+
+Json::Value FailureAnalysis::toJSON(const Scenario& scenario, const Result& result) const {
+    Json::Value entry(Json::objectValue);
+    entry["name"] = scenario.name;
+    entry["failed"] = Json::UInt64(result.failed);
+    entry["bridges"] = Json::UInt64(result.bridges);
+    entry["components"] = Json::UInt64(result.components);
+    entry["disconnectedPairs"] = Json::UInt64(result.disconnectedPairs);
+    if (!result.stretch.empty()) {
+        // null for an edge whose endpoints are cut off from each other
+        Json::Value& stretch = entry["stretch"] = Json::Value(Json::arrayValue);
+        for (double s : result.stretch)
+            stretch.append(s < 0.0 ? Json::Value() : Json::Value(s));
+    }
+    return entry;
+}
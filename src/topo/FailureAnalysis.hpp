@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef FAILUREANALYSIS_HPP
+#define FAILUREANALYSIS_HPP
+
+#include "output/ChunkedOutput.hpp"
+#include "topo/FrozenTopology.hpp"
+#include <json/json.h>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+class FailureAnalysis;
+typedef std::shared_ptr<FailureAnalysis> FailureAnalysis_Ptr;
+
+// resilience of a frozen topology against edge failures. The bridges and the 2-edge-connected components are found
+// once, the bridge forest between the components answers a scenario that only cuts bridges, or at most one edge per
+// component, from the Euler tour of the forest. Any other scenario joins the untouched components as single units
+// and only walks the nodes of the components it hits. Batches of scenarios run in parallel on the thread pool.
+class FailureAnalysis {
+   public:
+    struct Scenario {
+        std::string name;
+        std::vector<unsigned> edges;  /// < edge indices of the frozen topology
+    };
+
+    struct Result {
+        size_t failed;               /// < distinct failed edges
+        size_t bridges;              /// < failed edges that are bridges
+        size_t components;           /// < connected components after the failures
+        uint64_t disconnectedPairs;  /// < node pairs connected before and not after the failures
+        bool bridgeTree;             /// < answered from the bridge forest alone
+        std::vector<double> stretch;  /// < per failed edge the detour over its length, negative if it is cut off
+    };
+
+    FailureAnalysis(FrozenTopology_Ptr topo);
+
+    size_t components(void) const { return _treeSize.size(); }
+    size_t bridgeCount(void) const { return _bridges.size(); }
+    size_t twoEdgeComponentCount(void) const { return _componentSize.size(); }
+    bool isBridge(unsigned e) const { return _bridge[e]; }
+    unsigned twoEdgeComponent(unsigned node) const { return _component[node]; }
+
+    // index of an edge between the node ids u and v, NO_EDGE if there is none
+    unsigned findEdge(unsigned u, unsigned v) const;
+
+    // stretch false leaves Result::stretch empty. useForest false counts over the hit components even where the bridge
+    // forest would answer, the reference that BM_FailureAnalysis of the benchmarks compares with.
+    Result analyze(const Scenario& scenario, bool stretch, bool useForest = true) const;
+    std::vector<Result> analyze(const std::vector<Scenario>& scenarios, bool stretch) const;
+
+    // {"scenarios" : [{"name" : ..., "edges" : [[u, v], ...]}, ...]} with the node ids of the graph outputs,
+    // unknown edges are skipped with a warning
+    std::vector<Scenario> readScenarios(const std::string& filename) const;
+
+    // every seacable edge on its own
+    std::vector<Scenario> seacableScenarios(void) const;
+
+    void addTo(ChunkedOutput& output,
+               const std::string& filename,
+               const std::vector<Scenario>& scenarios,
+               const std::vector<Result>& results);
+
+    static constexpr unsigned NO_EDGE = std::numeric_limits<unsigned>::max();
+    static constexpr unsigned NO_COMPONENT = std::numeric_limits<unsigned>::max();
+
+   private:
+    // iterative Tarjan lowlink, parallel edges are never bridges
+    void findBridges(void);
+    void labelComponents(void);
+    // roots every tree of the forest at its first component, Euler tour and subtree sizes
+    void buildBridgeForest(void);
+
+    void fromBridgeForest(const std::vector<unsigned>& failedBridges, Result& result) const;
+    void recount(const std::vector<unsigned>& failed, const std::vector<char>& mask, Result& result) const;
+
+    Json::Value toJSON(const Scenario& scenario, const Result& result) const;
+
+    FrozenTopology_Ptr _topo;
+
+    std::vector<char> _bridge;      /// < by edge index
+    std::vector<unsigned> _bridges;  /// < edge indices of the bridges
+
+    std::vector<unsigned> _component;       /// < 2-edge-connected component by node id, NO_COMPONENT without a node
+    std::vector<unsigned> _componentSize;   /// < nodes by component
+    std::vector<unsigned> _memberOffsets;   /// < nodes of component c are [_memberOffsets[c], _memberOffsets[c + 1])
+    std::vector<unsigned> _members;         /// < node ids, grouped by component
+
+    // bridge forest: the components as vertices, the bridges as edges
+    std::vector<unsigned> _tree;      /// < tree by component
+    std::vector<uint64_t> _treeSize;  /// < nodes by tree
+    std::vector<unsigned> _enter;     /// < Euler tour times by component
+    std::vector<unsigned> _leave;
+    std::vector<uint64_t> _subtree;   /// < nodes in the subtree by component
+    std::vector<unsigned> _child;     /// < lower component by bridge edge index
+
+    uint64_t _pairs;  /// < connected node pairs without failures
+};
+
+#endif  // FAILUREANALYSIS_HPP
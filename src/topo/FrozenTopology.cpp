@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "FrozenTopology.hpp"
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <utility>
+
+constexpr unsigned FrozenTopology::NO_NODE;
+
+FrozenTopology::FrozenTopology(BaseTopology& topo)
+    : _nodes(topo),
+      _nodeOrder(),
+      _edgeU(),
+      _edgeV(),
+      _edgeLength(),
+      _edgeLengthKM(),
+      _edgeKind(),
+      _edges(),
+      _offsets(),
+      _adjacency() {
+    Graph& graph = *topo.getGraph();
+    EdgeMap& edgeMap = *topo.getEdgeMap();
+    // the edges added since the last filter, e.g. the cable edges, on the thread pool
+    topo.computeEdgeGeometry();
+
+    for (Graph::NodeIt n(graph); n != lemon::INVALID; ++n)
+        _nodeOrder.push_back(graph.id(n));
+
+    _offsets.assign(_nodes.size() + 1, 0);
+    for (Graph::EdgeIt e(graph); e != lemon::INVALID; ++e) {
+        unsigned u = graph.id(graph.u(e));
+        unsigned v = graph.id(graph.v(e));
+        _edgeU.push_back(u);
+        _edgeV.push_back(v);
+        const EdgeGeometry& geometry = topo.edgeGeometry(e);
+        _edgeLength.push_back(geometry.length);
+        _edgeLengthKM.push_back(geometry.lengthKM);
+        _edgeKind.push_back(geometry.kind);
+        _edges.push_back(edgeMap[e]);
+        ++_offsets[u + 1];
+        ++_offsets[v + 1];
+    }
+
+    for (size_t i = 1; i < _offsets.size(); ++i)
+        _offsets[i] += _offsets[i - 1];
+
+    _adjacency.resize(2 * _edgeU.size());
+    std::vector<unsigned> fill(_offsets.begin(), _offsets.end() - 1);
+    for (unsigned e = 0; e < _edgeU.size(); ++e) {
+        _adjacency[fill[_edgeU[e]]++] = Adjacency{_edgeV[e], e};
+        _adjacency[fill[_edgeV[e]]++] = Adjacency{_edgeU[e], e};
+    }
+}
+
+NodeStore& FrozenTopology::nodes(void) {
+    return _nodes;
+}
+
+const std::vector<unsigned>& FrozenTopology::nodeOrder(void) const {
+    return _nodeOrder;
+}
+
+size_t FrozenTopology::edgeCount(void) const {
+    return _edgeU.size();
+}
+
+void FrozenTopology::dijkstra(unsigned source,
+                              unsigned target,
+                              std::vector<double>& dist,
+                              std::vector<unsigned>& pred,
+                              std::vector<unsigned>* order,
+                              const std::vector<char>* failed,
+                              Weight weight) const {
+    const std::vector<double>& length = weight == LENGTH_KM ? _edgeLengthKM : _edgeLength;
+    dist.assign(_nodes.size(), std::numeric_limits<double>::infinity());
+    pred.assign(_nodes.size(), NO_NODE);
+    if (order)
+        order->clear();
+
+    typedef std::pair<double, unsigned> Entry;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+
+    dist[source] = 0.0;
+    queue.push(Entry(0.0, source));
+    while (!queue.empty()) {
+        Entry top = queue.top();
+        queue.pop();
+        unsigned i = top.second;
+        if (top.first > dist[i])
+            continue;  // < outdated entry
+        if (order)
+            order->push_back(i);
+        if (i == target)
+            break;
+
+        for (const Adjacency* a = adjacencyBegin(i); a != adjacencyEnd(i); ++a) {
+            if (failed && (*failed)[a->edge])
+                continue;
+            double d = top.first + length[a->edge];
+            if (d < dist[a->target]) {
+                dist[a->target] = d;
+                pred[a->target] = i;
+                queue.push(Entry(d, a->target));
+            }
+        }
+    }
+}
+
+double FrozenTopology::shortestPath(unsigned source, unsigned target, std::vector<unsigned>& path) const {
+    std::vector<double> dist;
+    std::vector<unsigned> pred;
+    dijkstra(source, target, dist, pred, nullptr);
+
+    path.clear();
+    if (dist[target] == std::numeric_limits<double>::infinity())
+        return -1.0;
+
+    for (unsigned i = target; i != NO_NODE; i = pred[i])
+        path.push_back(i);
+    std::reverse(path.begin(), path.end());
+    return dist[target];
+}
+
+double FrozenTopology::shortestDistance(unsigned source, unsigned target, const std::vector<char>& failed) const {
+    std::vector<double> dist;
+    std::vector<unsigned> pred;
+    dijkstra(source, target, dist, pred, nullptr, &failed);
+    return dist[target] == std::numeric_limits<double>::infinity() ? -1.0 : dist[target];
+}
+
+void FrozenTopology::shortestPathTree(unsigned source,
+                                      std::vector<double>& dist,
+                                      std::vector<unsigned>& pred,
+                                      std::vector<unsigned>& order,
+                                      Weight weight,
+                                      const std::vector<char>* failed) const {
+    dijkstra(source, NO_NODE, dist, pred, &order, failed, weight);
+}
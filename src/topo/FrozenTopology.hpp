@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef FROZENTOPOLOGY_HPP
+#define FROZENTOPOLOGY_HPP
+
+#include "geo/GeographicEdge.hpp"
+#include "topo/NodeStore.hpp"
+#include "topo/base_topo/BaseTopology.hpp"
+#include <limits>
+#include <memory>
+#include <vector>
+
+// read-only compressed sparse row copy of a BaseTopology. Nodes are indexed by graph id like a NodeStore, edges in
+// lemon iteration order with their kind and length from BaseTopology::edgeGeometry. The copy does not follow later
+// changes of the topology.
+class FrozenTopology {
+   public:
+    struct Adjacency {
+        unsigned target;  /// < node id
+        unsigned edge;    /// < edge index
+    };
+
+    FrozenTopology(BaseTopology& topo);
+
+    // node attributes by graph id
+    NodeStore& nodes(void);
+
+    // ids of the nodes in lemon iteration order
+    const std::vector<unsigned>& nodeOrder(void) const;
+
+    size_t edgeCount(void) const;
+    unsigned u(unsigned e) const { return _edgeU[e]; }
+    unsigned v(unsigned e) const { return _edgeV[e]; }
+    double length(unsigned e) const { return _edgeLength[e]; }  /// < radians, as GeometricHelpers::sphericalDist
+    double lengthKM(unsigned e) const { return _edgeLengthKM[e]; }
+    GeographicEdge::Kind kind(unsigned e) const { return _edgeKind[e]; }
+    GeographicEdge_Ptr& edge(unsigned e) { return _edges[e]; }
+
+    // neighbours of node id i are [adjacencyBegin(i), adjacencyEnd(i)), in edge order
+    const Adjacency* adjacencyBegin(unsigned i) const { return _adjacency.data() + _offsets[i]; }
+    const Adjacency* adjacencyEnd(unsigned i) const { return _adjacency.data() + _offsets[i + 1]; }
+    unsigned degree(unsigned i) const { return _offsets[i + 1] - _offsets[i]; }
+
+    // dijkstra on the edge lengths, path holds the node ids from source to target. Returns a negative distance if
+    // target is not reachable.
+    double shortestPath(unsigned source, unsigned target, std::vector<unsigned>& path) const;
+
+    // the edge lengths dijkstra adds up
+    enum Weight { LENGTH, LENGTH_KM };
+
+    // dijkstra to all nodes: dist and pred by node id (infinity and NO_NODE if unreachable), order holds the reached
+    // nodes as they were settled, so every node comes after its predecessor. Skips the edges e with (*failed)[e].
+    void shortestPathTree(unsigned source,
+                          std::vector<double>& dist,
+                          std::vector<unsigned>& pred,
+                          std::vector<unsigned>& order,
+                          Weight weight = LENGTH,
+                          const std::vector<char>* failed = nullptr) const;
+
+    // dijkstra distance from source to target without the edges e with failed[e], negative if target is not
+    // reachable then
+    double shortestDistance(unsigned source, unsigned target, const std::vector<char>& failed) const;
+
+    static constexpr unsigned NO_NODE = std::numeric_limits<unsigned>::max();
+
+   private:
+    // stops once target is settled, unless target is NO_NODE. Skips the edges e with (*failed)[e].
+    void dijkstra(unsigned source,
+                  unsigned target,
+                  std::vector<double>& dist,
+                  std::vector<unsigned>& pred,
+                  std::vector<unsigned>* order,
+                  const std::vector<char>* failed = nullptr,
+                  Weight weight = LENGTH) const;
+
+    NodeStore _nodes;
+    std::vector<unsigned> _nodeOrder;
+
+    std::vector<unsigned> _edgeU;
+    std::vector<unsigned> _edgeV;
+    std::vector<double> _edgeLength;
+    std::vector<double> _edgeLengthKM;
+    std::vector<GeographicEdge::Kind> _edgeKind;
+    std::vector<GeographicEdge_Ptr> _edges;
+
+    std::vector<unsigned> _offsets;
+    std::vector<Adjacency> _adjacency;
+};
+
+#endif  // FROZENTOPOLOGY_HPP
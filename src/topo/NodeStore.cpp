@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "NodeStore.hpp"
+#include "geo/CityNode.hpp"
+#include "geo/GeometricHelpers.hpp"
+#include "geo/SeaCableLandingPoint.hpp"
+#include "geo/SeaCableNode.hpp"
+#include "geo/SimulationNode.hpp"
+#include "util/Profiler.hpp"
+#include <cassert>
+#include <cmath>
+
+constexpr unsigned NodeStore::NO_CITY;
+
+NodeStore::NodeStore()
+    : _lat(),
+      _lon(),
+      _cosLat(),
+      _x(),
+      _y(),
+      _z(),
+      _kind(),
+      _cityIndex(),
+      _nodes(),
+      _cityNode(),
+      _cityPopulation(),
+      _cityCountryId() {
+}
+
+NodeStore::NodeStore(Locations& locations) : NodeStore() {
+    for (GeographicNode_Ptr& node : locations)
+        add(node);
+}
+
+NodeStore::NodeStore(BaseTopology& topo) : NodeStore() {
+    Graph& graph = *topo.getGraph();
+    NodeMap& nodeMap = *topo.getNodeMap();
+
+    for (int id = 0; id <= graph.maxNodeId(); ++id)
+        addEmpty();
+
+    for (Graph::NodeIt it(graph); it != lemon::INVALID; ++it) {
+        assert(nodeMap[it]);
+        set(graph.id(it), nodeMap[it]);
+    }
+}
+
+void NodeStore::addEmpty() {
+    _lat.push_back(0.0);
+    _lon.push_back(0.0);
+    _cosLat.push_back(1.0);
+    _x.push_back(1.0);
+    _y.push_back(0.0);
+    _z.push_back(0.0);
+    _kind.push_back(NO_NODE);
+    _cityIndex.push_back(NO_CITY);
+    _nodes.push_back(nullptr);
+}
+
+unsigned NodeStore::add(GeographicNode_Ptr node) {
+    unsigned i = _kind.size();
+    addEmpty();
+    set(i, node);
+    return i;
+}
+
+void NodeStore::set(unsigned i, GeographicNode_Ptr& node) {
+    double lat = node->lat();
+    double lon = node->lon();
+    double latRad = lat * GeometricHelpers::DEG_TO_RAD;
+    double lonRad = lon * GeometricHelpers::DEG_TO_RAD;
+    _lat[i] = lat;
+    _lon[i] = lon;
+    _cosLat[i] = cos(latRad);
+    _x[i] = _cosLat[i] * cos(lonRad);
+    _y[i] = _cosLat[i] * sin(lonRad);
+    _z[i] = sin(latRad);
+    _kind[i] = kindOf(node.get());
+    _nodes[i] = node;
+
+    if (_kind[i] == CITY_NODE) {
+        CityNode* city = static_cast<CityNode*>(node.get());
+        _cityIndex[i] = _cityNode.size();
+        _cityNode.push_back(i);
+        _cityPopulation.push_back(city->population());
+        _cityCountryId.push_back(city->countryId());
+    }
+}
+
+NodeStore::Kind NodeStore::kindOf(GeographicNode* node) {
+    return static_cast<Kind>(node->kind());
+}
+
+double NodeStore::sphericalDist(unsigned i, GeographicPosition& p) const {
+    Profiler::count(Profiler::DISTANCE_EVALUATIONS);
+    double latitudeArc = (_lat[i] - p.lat()) * GeometricHelpers::DEG_TO_RAD;
+    double longitudeArc = (_lon[i] - p.lon()) * GeometricHelpers::DEG_TO_RAD;
+    double latitudeH = sin(latitudeArc * 0.5);
+    latitudeH *= latitudeH;
+    double lontitudeH = sin(longitudeArc * 0.5);
+    lontitudeH *= lontitudeH;
+    double tmp = _cosLat[i] * cos(p.lat() * GeometricHelpers::DEG_TO_RAD);
+    return 2.0 * asin(sqrt(latitudeH + tmp * lontitudeH));
+}
+
+double NodeStore::sphericalDist(unsigned i, unsigned j) const {
+    Profiler::count(Profiler::DISTANCE_EVALUATIONS);
+    double latitudeArc = (_lat[i] - _lat[j]) * GeometricHelpers::DEG_TO_RAD;
+    double longitudeArc = (_lon[i] - _lon[j]) * GeometricHelpers::DEG_TO_RAD;
+    double latitudeH = sin(latitudeArc * 0.5);
+    latitudeH *= latitudeH;
+    double lontitudeH = sin(longitudeArc * 0.5);
+    lontitudeH *= lontitudeH;
+    double tmp = _cosLat[i] * _cosLat[j];
+    return 2.0 * asin(sqrt(latitudeH + tmp * lontitudeH));
+}
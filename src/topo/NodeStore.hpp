@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef NODESTORE_HPP
+#define NODESTORE_HPP
+
+#include "geo/GeographicNode.hpp"
+#include "geo/GeographicPosition.hpp"
+#include "geo/GeometricHelpers.hpp"
+#include "topo/base_topo/BaseTopology.hpp"
+#include <limits>
+#include <memory>
+#include <vector>
+
+class NodeStore;
+typedef std::shared_ptr<NodeStore> NodeStore_Ptr;
+
+// flat snapshot of a set of nodes: positions in contiguous arrays, node type as a one byte tag
+// and city metadata in side tables. The snapshot does not follow later changes of its source.
+class NodeStore {
+   public:
+    // GeographicNode::Kind with NO_NODE for ids without a node
+    enum Kind : unsigned char {
+        NO_NODE,
+        GEOGRAPHIC_NODE = GeographicNode::GEOGRAPHIC_NODE,
+        CITY_NODE = GeographicNode::CITY_NODE,
+        SEACABLE_LANDINGPOINT = GeographicNode::SEACABLE_LANDINGPOINT,
+        SEACABLE_NODE = GeographicNode::SEACABLE_NODE,
+        SIMULATION_NODE = GeographicNode::SIMULATION_NODE
+    };
+
+    static constexpr unsigned NO_CITY = std::numeric_limits<unsigned>::max();
+
+    NodeStore();
+
+    // index i is the position in locations
+    NodeStore(Locations& locations);
+
+    // index i is the graph node id, ids without a node get kind NO_NODE
+    NodeStore(BaseTopology& topo);
+
+    unsigned add(GeographicNode_Ptr node);
+
+    size_t size() const { return _kind.size(); }
+
+    double lat(unsigned i) const { return _lat[i]; }
+    double lon(unsigned i) const { return _lon[i]; }
+
+    // unit vector of the position
+    double x(unsigned i) const { return _x[i]; }
+    double y(unsigned i) const { return _y[i]; }
+    double z(unsigned i) const { return _z[i]; }
+    GeometricHelpers::UnitVector unitVector(unsigned i) const { return {_x[i], _y[i], _z[i]}; }
+
+    Kind kind(unsigned i) const { return _kind[i]; }
+    bool isCity(unsigned i) const { return _kind[i] == CITY_NODE; }
+    GeographicNode_Ptr& node(unsigned i) { return _nodes[i]; }
+
+    // cities in insertion order, cityNode(k) is the index of the k-th city
+    size_t cityCount() const { return _cityNode.size(); }
+    unsigned cityNode(unsigned k) const { return _cityNode[k]; }
+
+    // city side table, only valid if isCity(i)
+    double population(unsigned i) const { return _cityPopulation[_cityIndex[i]]; }
+    unsigned countryId(unsigned i) const { return _cityCountryId[_cityIndex[i]]; }
+
+    // same result as GeometricHelpers::sphericalDist, with the cosine of the stored latitude precomputed
+    double sphericalDist(unsigned i, GeographicPosition& p) const;
+    double sphericalDist(unsigned i, unsigned j) const;
+
+    static Kind kindOf(GeographicNode* node);
+
+   private:
+    void addEmpty();
+    void set(unsigned i, GeographicNode_Ptr& node);
+
+    std::vector<double> _lat;
+    std::vector<double> _lon;
+    std::vector<double> _cosLat;
+    std::vector<double> _x;
+    std::vector<double> _y;
+    std::vector<double> _z;
+    std::vector<Kind> _kind;
+    std::vector<unsigned> _cityIndex;
+    Locations _nodes;
+
+    std::vector<unsigned> _cityNode;
+    std::vector<double> _cityPopulation;
+    std::vector<unsigned> _cityCountryId;
+};
+
+#endif
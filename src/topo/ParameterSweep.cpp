@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ParameterSweep.hpp"
+#include <boost/log/trivial.hpp>
+#include <cassert>
+#include <cmath>
+#include <fstream>
+
+ParameterSweep::ParameterSweep(const std::string& fileName) {
+    Json::Value root;
+    std::ifstream file(fileName);
+    assert(file.good());
+    file >> root;
+    assert(root.isObject());
+
+    for (const std::string& path : root.getMemberNames()) {
+        Level level;
+        if (path.compare(0, 13, "betaSkeleton.") == 0) {
+            level = BETA_SKELETON;
+        } else if (path.compare(0, 13, "lengthFilter.") == 0) {
+            level = LENGTH_FILTER;
+        } else {
+            BOOST_LOG_TRIVIAL(error) << "sweep parameter " << path << " is not one of betaSkeleton or lengthFilter";
+            assert(false);
+            continue;
+        }
+
+        std::vector<Json::Value> values;
+        const Json::Value& spec = root[path];
+        if (spec.isArray()) {
+            for (const Json::Value& value : spec)
+                values.push_back(value);
+        } else {
+            addRange(spec, values);
+        }
+        assert(!values.empty());
+        _parameters[level].push_back(std::make_pair(path, values));
+    }
+}
+
+void ParameterSweep::addRange(const Json::Value& range, std::vector<Json::Value>& values) {
+    double from = range["from"].asDouble();
+    double to = range["to"].asDouble();
+    double step = range["step"].asDouble();
+    assert(step > 0.0 && from <= to);
+
+    // from + i * step instead of summing up the steps, the end is included despite rounding
+    long count = static_cast<long>(std::floor((to - from) / step + 1e-9)) + 1;
+    for (long i = 0; i < count; ++i)
+        values.push_back(Json::Value(from + i * step));
+}
+
+std::vector<Json::Value> ParameterSweep::combinations(Level level) const {
+    std::vector<Json::Value> combinations(1, Json::Value(Json::objectValue));
+
+    // the first parameter changes slowest
+    for (const auto& parameter : _parameters[level]) {
+        size_t dot = parameter.first.find('.');
+        std::string section = parameter.first.substr(0, dot);
+        std::string name = parameter.first.substr(dot + 1);
+
+        std::vector<Json::Value> next;
+        for (const Json::Value& combination : combinations)
+            for (const Json::Value& value : parameter.second) {
+                next.push_back(combination);
+                next.back()[section][name] = value;
+            }
+        combinations.swap(next);
+    }
+    return combinations;
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PARAMETERSWEEP_HPP
+#define PARAMETERSWEEP_HPP
+
+#include <json/json.h>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+class ParameterSweep;
+typedef std::shared_ptr<ParameterSweep> ParameterSweep_Ptr;
+
+// Grid of config values for Pipeline::sweep, read from a JSON object of config paths and their values, e.g.
+//   {"betaSkeleton.maxBeta" : [1.1, 1.2], "lengthFilter.minLength" : {"from" : 400, "to" : 800, "step" : 100}}
+// Lists give the values, objects a range of numbers including both ends. Only the parameters of the stages after
+// the triangulation, betaSkeleton and lengthFilter, can be swept.
+class ParameterSweep {
+   public:
+    // the stages a sweep branches at, in pipeline order
+    enum Level { BETA_SKELETON, LENGTH_FILTER, LEVELS };
+
+    ParameterSweep(const std::string& fileName);
+
+    // every combination of the values of a level as config overrides, one empty override without parameters
+    std::vector<Json::Value> combinations(Level level) const;
+
+   private:
+    static void addRange(const Json::Value& range, std::vector<Json::Value>& values);
+
+    // per level the parameter paths and their values
+    std::vector<std::pair<std::string, std::vector<Json::Value>>> _parameters[LEVELS];
+};
+
+#endif  // PARAMETERSWEEP_HPP
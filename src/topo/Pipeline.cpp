@@ -0,0 +1,674 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Pipeline.hpp"
+#include "config/PredefinedValues.hpp"
+#include "db/SimulationNodeReader.hpp"
+#include "geo/GeoRegion.hpp"
+#include "geo/GeometricHelpers.hpp"
+#include "output/BinaryOutput.hpp"
+#include "output/ChunkedOutput.hpp"
+#include "output/GraphOutput.hpp"
+#include "output/JSONOutput.hpp"
+#include "output/KMLWriter.hpp"
+#include "output/LandmarkOutput.hpp"
+#include "output/GraphMetrics.hpp"
+#include "output/METISOutput.hpp"
+#include "output/TopologyView.hpp"
+#include "topo/FailureAnalysis.hpp"
+#include "topo/base_topo/BetaSkeletonFilter.hpp"
+#include "topo/base_topo/DelaunayGraphCreator.hpp"
+#include "topo/base_topo/OPTICSFilter.hpp"
+#include "topo/base_topo/PopulationDensityFilter.hpp"
+#include "util/Profiler.hpp"
+#include "util/ThreadPool.hpp"
+#include "util/Util.hpp"
+#include <boost/log/trivial.hpp>
+#include <cassert>
+#include <fstream>
+#include <memory>
+
+namespace {
+
+void addKMLGraph(ChunkedOutput& output, TopologyView_Ptr view, Config_Ptr kmlConfig, std::string outFileName) {
+    // http://www.colourlovers.com/palette/2757956/)
+    std::string pincolor = kmlConfig->get<std::string>("pins.color");
+    double pinAlpha = kmlConfig->get<double>("pins.alpha");
+    std::string edgecolor = kmlConfig->get<std::string>("edges.color");
+    double edgeAlpha = kmlConfig->get<double>("edges.alpha");
+    std::string seacablecolor = kmlConfig->get<std::string>("seacable.color");
+    double seacableAlpha = kmlConfig->get<double>("seacable.alpha");
+    std::string seacablePinColor = kmlConfig->get<std::string>("seacablepins.color");
+    double seacablePinAlpha = kmlConfig->get<double>("seacablepins.alpha");
+
+    KMLWriter_Ptr kmlw(new KMLWriter(view));
+    kmlw->setEdgeColor(edgecolor, edgeAlpha);
+    kmlw->setPinColor(pincolor, pinAlpha);
+    kmlw->setSeacableColor(seacablecolor, seacableAlpha);
+    kmlw->setSeacablePinColor(seacablePinColor, seacablePinAlpha);
+    if (!kmlConfig->get<bool>("seacablepins.enabled"))
+        kmlw->disableSeacablePins();
+    if (!kmlConfig->get<bool>("pins.enabled"))
+        kmlw->disableLocationsPins();
+    if (kmlConfig->get<bool>("regions.enable"))
+        kmlw->setRegions(kmlConfig->get<int>("regions.tileFeatures"), kmlConfig->get<int>("regions.maxLevel"));
+    kmlw->addTo(output, outFileName);
+}
+
+void addSimpleGraph(ChunkedOutput& output,
+                    TopologyView_Ptr view,
+                    Config_Ptr simpleGraphConfig,
+                    std::string outputPrefix) {
+    std::string nodeFileName = outputPrefix + simpleGraphConfig->get<std::string>("nodeFile");
+    std::string edgeFileName = outputPrefix + simpleGraphConfig->get<std::string>("edgeFile");
+
+    GraphOutput_Ptr graphWriter(new GraphOutput(view));
+    graphWriter->addTo(output, nodeFileName, edgeFileName);
+}
+
+void addJSONGraph(ChunkedOutput& output,
+                  TopologyView_Ptr view,
+                  Config_Ptr config,
+                  std::string jsonFileNameCLI,
+                  std::string outputPrefix) {
+    JSONOutput_Ptr jsonWriter(new JSONOutput(view));
+
+    Config_Ptr jsonGraphConfig(config->subConfig("json_graph_output"));
+
+    std::string jsonFileNameConfig = jsonGraphConfig->get<std::string>("filename");
+
+    // json command line arg has precedence over json config parameter
+    std::string jsonFileName;
+
+    if (jsonFileNameCLI.length() > 0) {
+        jsonFileName = jsonFileNameCLI;
+    } else {
+        jsonFileName = jsonFileNameConfig;
+    }
+    jsonFileName = outputPrefix + jsonFileName;
+
+    jsonWriter->addTo(output, jsonFileName, jsonGraphConfig->get<bool>("pretty_print"));
+}
+
+void addBinaryGraph(ChunkedOutput& output,
+                    TopologyView_Ptr view,
+                    Config_Ptr binaryGraphConfig,
+                    std::string outputPrefix) {
+    std::string fileName = outputPrefix + binaryGraphConfig->get<std::string>("filename");
+
+    BinaryOutput_Ptr binaryWriter(new BinaryOutput(view));
+    binaryWriter->addTo(output, fileName);
+}
+
+void addLandmarks(ChunkedOutput& output,
+                  FrozenTopology_Ptr frozen,
+                  TopologyView_Ptr view,
+                  Config_Ptr landmarkConfig,
+                  std::string outputPrefix) {
+    std::string fileName = outputPrefix + landmarkConfig->get<std::string>("filename");
+
+    LandmarkOutput_Ptr landmarkWriter(new LandmarkOutput(frozen, view, landmarkConfig->get<int>("count")));
+    landmarkWriter->addTo(output, fileName);
+}
+
+void addMETISGraph(ChunkedOutput& output,
+                   TopologyView_Ptr view,
+                   Config_Ptr metisConfig,
+                   std::string outputPrefix,
+                   const Pipeline::Run& run) {
+    GraphPartition_Ptr graph(new GraphPartition(view));
+    METISOutput_Ptr metisWriter(new METISOutput(graph));
+    metisWriter->addTo(output, outputPrefix + metisConfig->get<std::string>("graphFile"),
+                       outputPrefix + metisConfig->get<std::string>("edgeListFile"));
+
+    // partitions of balanced node counts for distributed simulators
+    Config_Ptr partitionConfig(metisConfig->subConfig("partition"));
+    if (partitionConfig->get<bool>("enable")) {
+        run.stage("partition");
+        graph->partition(partitionConfig->get<unsigned int>("parts"), partitionConfig->get<double>("imbalance"));
+        metisWriter->addPartitionTo(output, outputPrefix + metisConfig->get<std::string>("partitionFile"));
+        run.stage("output");
+    }
+}
+
+void addMetrics(ChunkedOutput& output,
+                TopologyView_Ptr view,
+                Config_Ptr metricsConfig,
+                std::string outputPrefix,
+                const Pipeline::Run& run) {
+    run.stage("metrics");
+    GraphMetrics_Ptr metrics(new GraphMetrics(view, run.seed));
+    metrics->compute(metricsConfig->get<unsigned int>("sources"),
+                     metricsConfig->get<unsigned int>("betweennessSamples"),
+                     metricsConfig->get<unsigned int>("top"));
+    metrics->addTo(output, outputPrefix + metricsConfig->get<std::string>("filename"));
+    run.stage("output");
+}
+
+void addFailureAnalysis(ChunkedOutput& output,
+                        FrozenTopology_Ptr frozen,
+                        Config_Ptr failuresConfig,
+                        std::string outputPrefix,
+                        const Pipeline::Run& run) {
+    run.stage("failures");
+    FailureAnalysis_Ptr analysis(new FailureAnalysis(frozen));
+    std::vector<FailureAnalysis::Scenario> scenarios;
+    if (failuresConfig->get<bool>("singleSeacableFailures"))
+        scenarios = analysis->seacableScenarios();
+    std::string scenarioFile = failuresConfig->get<std::string>("scenarioFile");
+    if (scenarioFile.length() > 0) {
+        std::vector<FailureAnalysis::Scenario> read = analysis->readScenarios(scenarioFile);
+        scenarios.insert(scenarios.end(), read.begin(), read.end());
+    }
+    std::vector<FailureAnalysis::Result> results = analysis->analyze(scenarios, failuresConfig->get<bool>("stretch"));
+    analysis->addTo(output, outputPrefix + failuresConfig->get<std::string>("filename"), scenarios, results);
+    run.stage("output");
+}
+
+}  // namespace
+
+Pipeline::Outputs::Outputs()
+    : kml(false),
+      graph(false),
+      json(false),
+      binary(false),
+      landmarks(false),
+      metis(false),
+      metrics(false),
+      failures(false),
+      jsonFile(),
+      simNodesJSONFile() {
+}
+
+Pipeline::Run::Run()
+    : seed(),
+      outputPrefix(),
+      profileStages(true),
+      nodeImport(),
+      locations(),
+      baseTopo(),
+      simTopo(),
+      cache(),
+      snapshot(),
+      cached(StageCache::NO_STAGE),
+      previous(),
+      previousStage(StageCache::NO_STAGE),
+      changedNodes() {
+}
+
+void Pipeline::Run::stage(const char* name) const {
+    if (profileStages)
+        Profiler::stage(name);
+}
+
+Pipeline::Pipeline(Config_Ptr config, const Outputs& outputs)
+    : Pipeline(config, outputs, InternetUsageStatistics_Ptr(new InternetUsageStatistics(PredefinedValues::dbFilePath())),
+               ImportedData_Ptr()) {
+}
+
+Pipeline::Pipeline(Config_Ptr config,
+                   const Outputs& outputs,
+                   InternetUsageStatistics_Ptr inetStat,
+                   ImportedData_Ptr importedData)
+    : _config(config),
+      _outputs(outputs),
+      _inetStat(inetStat),
+      _importedData(importedData),
+      _memoryBounded(config->get<bool>("memory.bounded")) {
+}
+
+Config_Ptr Pipeline::config(void) {
+    return _config;
+}
+
+InternetUsageStatistics_Ptr Pipeline::internetUsage(void) {
+    return _inetStat;
+}
+
+// the tables themselves are read on first access, see ImportedData
+ImportedData_Ptr Pipeline::importedData(void) {
+    if (!_importedData)
+        _importedData = std::make_shared<ImportedData>(PredefinedValues::dbFilePath(), GeoRegion::fromConfig(_config));
+    return _importedData;
+}
+
+BaseTopology_Ptr Pipeline::generate(const std::string& seed, const std::string& outputPrefix, bool profileStages) {
+    Run run(begin(seed, outputPrefix, profileStages));
+    generate(run, false);
+    return run.baseTopo;
+}
+
+void Pipeline::generateBatch(const std::vector<std::string>& seeds) {
+    // the runs only read the shared data
+    importedData()->load();
+
+    ThreadPool_Ptr pool(ThreadPool::fromConfig());
+    BOOST_LOG_TRIVIAL(info) << "generating " << seeds.size() << " topologies on " << pool->size() << " threads";
+
+    pool->forEach(seeds.size(), [&](size_t i) {
+        Run run(begin(seeds[i], seeds[i] + "_", false));
+        generate(run, true);
+    });
+}
+
+void Pipeline::generate(Run& run, bool batch) {
+    importCities(run);
+    clusterLocations(run);
+    triangulate(run);
+    writeTriangulation(run);
+    filterBetaSkeleton(run);
+    filterLength(run);
+    addSubmarineCables(run);
+    // imported again by the next run, the runs of a batch share it
+    if (_memoryBounded && !batch)
+        _importedData.reset();
+    prune(run);
+    addSimulationNodes(run);
+    write(run);
+}
+
+void Pipeline::sweep(const std::string& seed, const ParameterSweep& sweep) {
+    std::vector<Json::Value> skeletons = sweep.combinations(ParameterSweep::BETA_SKELETON);
+    std::vector<Json::Value> lengths = sweep.combinations(ParameterSweep::LENGTH_FILTER);
+    BOOST_LOG_TRIVIAL(info) << "sweeping " << skeletons.size() << " beta skeletons with " << lengths.size()
+                            << " length filters each";
+
+    // the shared prefix, the triangulation is restored from the cache and not the beta skeleton of this config
+    Run prefix(begin(seed, seed + "_", true, StageCache::DELAUNAY));
+    importCities(prefix);
+    clusterLocations(prefix);
+    triangulate(prefix);
+    writeTriangulation(prefix);
+    importedData()->load();
+
+    // the branches only read the nodes of the prefix
+    Profiler::stage("sweep (beta skeleton)");
+    ThreadPool_Ptr pool(ThreadPool::fromConfig());
+    std::vector<std::vector<EdgeEdit>> skeletonEdits(skeletons.size());
+    pool->forEach(skeletons.size(), [&](size_t b) {
+        Pipeline pipeline(std::make_shared<Config>(*_config, skeletons[b]), _outputs, _inetStat, _importedData);
+        StageCache cache(pipeline._config, seed, _inetStat);
+        StageCache::Snapshot cached;
+        if (cache.load(StageCache::BETA_SKELETON, cached) == StageCache::BETA_SKELETON) {
+            skeletonEdits[b] = cached.edgeEdits;
+            return;
+        }
+
+        Run run(pipeline.branch(prefix, prefix.baseTopo->edgeEdits(), StageCache::DELAUNAY, "", false));
+        pipeline.filterBetaSkeleton(run);
+        skeletonEdits[b] = run.baseTopo->edgeEdits();
+    });
+
+    // prune renumbers the nodes, so every leaf works on copies
+    Profiler::stage("sweep (leaves)");
+    Json::Value index(Json::arrayValue);
+    for (size_t i = 0; i < skeletons.size() * lengths.size(); ++i) {
+        Json::Value entry(skeletons[i / lengths.size()]);
+        for (const std::string& section : lengths[i % lengths.size()].getMemberNames())
+            entry[section] = lengths[i % lengths.size()][section];
+        entry["outputPrefix"] = seed + "_" + std::to_string(i) + "_";
+        index.append(entry);
+    }
+    pool->forEach(index.size(), [&](size_t i) {
+        Json::Value overrides(index[static_cast<Json::ArrayIndex>(i)]);
+        std::string outputPrefix = overrides["outputPrefix"].asString();
+        overrides.removeMember("outputPrefix");
+
+        Pipeline pipeline(std::make_shared<Config>(*_config, overrides), _outputs, _inetStat, _importedData);
+        Run run(pipeline.branch(
+            prefix, skeletonEdits[i / lengths.size()], StageCache::BETA_SKELETON, outputPrefix, true));
+        pipeline.filterLength(run);
+        pipeline.addSubmarineCables(run);
+        pipeline.prune(run);
+        pipeline.addSimulationNodes(run);
+        pipeline.write(run);
+    });
+
+    std::ofstream indexFile(seed + "_sweep.json");
+    Json::StyledWriter writer;
+    indexFile << writer.write(index);
+}
+
+Pipeline::Run Pipeline::branch(const Run& from,
+                               const std::vector<EdgeEdit>& edits,
+                               StageCache::Stage stage,
+                               const std::string& outputPrefix,
+                               bool copyNodes) {
+    Run run;
+    run.seed = from.seed;
+    run.outputPrefix = outputPrefix;
+    run.profileStages = false;
+    run.nodeImport = copyNodes ? from.nodeImport->copy() : from.nodeImport;
+    run.locations = run.nodeImport->getLocations();
+    run.cache = std::make_shared<StageCache>(_config, run.seed, _inetStat);
+    run.cached = stage;
+
+    // same node order as DelaunayGraphCreator, the edits then reproduce all edge ids
+    run.baseTopo = BaseTopology_Ptr(new BaseTopology);
+    for (GeographicNode_Ptr& node : *run.locations)
+        run.baseTopo->addNode(node);
+    run.baseTopo->replay(edits);
+    return run;
+}
+
+Pipeline::Run Pipeline::begin(const std::string& seed, const std::string& outputPrefix, bool profileStages) {
+    // the delaunay KML is written from the triangulation, so it can not be skipped with KML output
+    return begin(seed, outputPrefix, profileStages, _outputs.kml ? StageCache::DELAUNAY : StageCache::BETA_SKELETON);
+}
+
+Pipeline::Run Pipeline::begin(const std::string& seed,
+                              const std::string& outputPrefix,
+                              bool profileStages,
+                              StageCache::Stage last) {
+    Run run;
+    run.seed = seed;
+    run.outputPrefix = outputPrefix;
+    run.profileStages = profileStages;
+    run.nodeImport = std::make_shared<NodeImporter>(_inetStat, importedData(), _config);
+    run.locations = run.nodeImport->getLocations();
+
+    run.cache = std::make_shared<StageCache>(_config, seed, _inetStat);
+    run.cached = run.cache->load(last, run.snapshot);
+    if (run.cached != StageCache::NO_STAGE)
+        run.nodeImport->restore(*run.snapshot.locations, run.snapshot.nodeNumber, run.snapshot.fallbackProjection);
+
+    return run;
+}
+
+void Pipeline::storeStage(Run& run, StageCache::Stage stage, bool withTopology) {
+    if (!run.cache->enabled())
+        return;
+    StageCache::Snapshot current;
+    current.locations = run.nodeImport->getLocations();
+    current.nodeNumber = run.nodeImport->nodeNumber();
+    current.fallbackProjection = run.nodeImport->fallbackProjection();
+    if (withTopology)
+        current.edgeEdits = run.baseTopo->edgeEdits();
+    run.cache->store(stage, current);
+}
+
+void Pipeline::releaseMemory(void) {
+    if (_memoryBounded)
+        Util::releaseFreeMemory();
+}
+
+/*
+  READ CITY POSITIONS ON EARTH SURFACE
+*/
+void Pipeline::importCities(Run& run) {
+    if (run.cached >= StageCache::CITIES)
+        return;
+
+    run.stage("import");
+
+    if (_config->get<bool>("debug.enable") == false) {
+        run.nodeImport->importCities(run.seed);
+    } else {
+        run.nodeImport->importCitiesFromFile();
+    }
+
+    BOOST_LOG_TRIVIAL(info) << "imported " << run.locations->size() << " locations";
+    storeStage(run, StageCache::CITIES, false);
+}
+
+/*
+ *  FILTER LOCATIONS WITH OPTICS
+ */
+void Pipeline::clusterLocations(Run& run) {
+    if (run.cached >= StageCache::OPTICS)
+        return;
+
+    unsigned int neighbourCluster_minPts = _config->get<unsigned int>("neighbourCluster.minPts");
+    assert(neighbourCluster_minPts > 0);
+
+    double neighbourCluster_maxClusterDistance = _config->get<double>("neighbourCluster.maxClusterDistance");
+    assert(neighbourCluster_maxClusterDistance > 0.0);
+
+    run.stage("optics (neighbors)");
+    double neighbourCluster_eps = neighbourCluster_maxClusterDistance / GeometricHelpers::EARTH_RADIUS_KM;
+    std::unique_ptr<OPTICSFilter> neighbourCluster_optics(
+        new OPTICSFilter(run.locations, neighbourCluster_eps, neighbourCluster_minPts, 0.8 * neighbourCluster_eps));
+    neighbourCluster_optics->filter(run.seed);
+    neighbourCluster_optics.reset();
+
+    BOOST_LOG_TRIVIAL(info) << run.locations->size() << " locations after OPTICS (neighbors)";
+
+    unsigned int metropolisCluster_minPts = _config->get<unsigned int>("metropolisCluster.minPts");
+    assert(metropolisCluster_minPts > 0);
+
+    double metropolisCluster_maxClusterDistance = _config->get<double>("metropolisCluster.maxClusterDistance");
+    assert(metropolisCluster_maxClusterDistance > 0.0);
+
+    run.stage("optics (metropolis)");
+    double metropolisCluster_eps = metropolisCluster_maxClusterDistance / GeometricHelpers::EARTH_RADIUS_KM;
+    std::unique_ptr<OPTICSFilter> metropolisCluster_optics(new OPTICSFilter(
+        run.locations, metropolisCluster_eps, metropolisCluster_minPts, 0.8 * metropolisCluster_eps));
+    metropolisCluster_optics->filter(run.seed);
+
+    BOOST_LOG_TRIVIAL(info) << run.locations->size() << " locations after OPTICS (metropolis)";
+    storeStage(run, StageCache::OPTICS, false);
+}
+
+void Pipeline::triangulate(Run& run) {
+    if (run.cached < StageCache::DELAUNAY) {
+        run.previousStage = run.cache->loadPrevious(StageCache::BETA_SKELETON, run.previous);
+
+        // add all nodes to kdtree for node merging
+        run.stage("landing points");
+        run.nodeImport->importSeacableLandingPoints();
+        BOOST_LOG_TRIVIAL(info) << run.locations->size() << " locations after importing landingpoints";
+
+        run.stage("waypoints");
+        run.nodeImport->importSubmarineCableEdgesWaypoints();
+        BOOST_LOG_TRIVIAL(info) << run.locations->size() << " locations after importing seacable waypoints";
+
+        // spatially coherent node ids for the triangulation and everything after it
+        if (_config->get<bool>("locality.hilbertOrder"))
+            run.nodeImport->sortLocations();
+
+        // reset nodeIDs of all imported nodes, corresponding ids in lemon graphs go from 0 to numNodes-1
+        run.nodeImport->assignNodeIds();
+
+        /*
+          CREATE DELAUNAY TRIANGULATION
+        */
+        run.stage("delaunay");
+
+        DelaunayGraphCreator delGen(*run.locations, _config);
+        if (run.previousStage >= StageCache::DELAUNAY)
+            delGen.update(*run.previous.locations, run.previous.edgeEdits);
+        else
+            delGen.create();
+        run.baseTopo = delGen.getTopology();
+        run.changedNodes = delGen.changedNodes();
+        storeStage(run, StageCache::DELAUNAY, true);
+    } else {
+        // same node order as DelaunayGraphCreator, the edits then reproduce all edge ids
+        run.stage("restore");
+        run.baseTopo = BaseTopology_Ptr(new BaseTopology);
+        for (GeographicNode_Ptr& node : *run.locations)
+            run.baseTopo->addNode(node);
+        run.baseTopo->replay(run.snapshot.edgeEdits);
+    }
+    if (_memoryBounded)
+        run.snapshot = StageCache::Snapshot();
+    releaseMemory();
+}
+
+//  KML OUTPUT DELAUNAY
+void Pipeline::writeTriangulation(Run& run) {
+    if (!_outputs.kml)
+        return;
+
+    Config_Ptr kmlConfig(_config->subConfig("kml_graph_output"));
+    std::string delaunayFile = run.outputPrefix + kmlConfig->get<std::string>("delaunayFile");
+
+    run.stage("output (delaunay)");
+    ThreadPool_Ptr pool(ThreadPool::fromConfig());
+    ChunkedOutput output(pool);
+    addKMLGraph(output, TopologyView_Ptr(new TopologyView(*run.baseTopo->freeze())), kmlConfig, delaunayFile);
+    bool written = output.write();
+    assert(written);
+}
+
+/*
+  CREATE BETA SKELETON FROM DELAUNAY TRIANGULATION
+*/
+void Pipeline::filterBetaSkeleton(Run& run) {
+    if (run.cached < StageCache::BETA_SKELETON) {
+        run.stage("beta skeleton");
+        std::unique_ptr<BetaSkeletonFilter> betaGraph(new BetaSkeletonFilter(run.baseTopo, _inetStat, _config));
+        if (run.previousStage == StageCache::BETA_SKELETON)
+            betaGraph->reuse(*run.previous.locations, run.previous.edgeEdits, run.changedNodes);
+        betaGraph->filterBetaSkeletonEdges();
+        storeStage(run, StageCache::BETA_SKELETON, true);
+    }
+    if (_memoryBounded) {
+        run.previous = StageCache::Snapshot();
+        std::vector<bool>().swap(run.changedNodes);
+    }
+    releaseMemory();
+}
+
+/*
+ APPLY DENSITY FILTER
+*/
+void Pipeline::filterLength(Run& run) {
+    const bool enableLengthFilter = _config->get<bool>("lengthFilter.enable");
+    if (enableLengthFilter == true) {
+        run.stage("length filter");
+        PopulationDensityFilter_Ptr densFilter(new PopulationDensityFilter(run.baseTopo, _inetStat, _config));
+        densFilter->filterByLength();
+    }
+    releaseMemory();
+}
+
+/*
+ IMPORT SUBMARINE CABLES
+*/
+void Pipeline::addSubmarineCables(Run& run) {
+    run.stage("cable edges");
+    run.nodeImport->importSubmarineCableEdges(run.baseTopo);
+    if (_memoryBounded) {
+        // the last use of the importer and the locations, the graph holds the nodes it needs
+        run.nodeImport.reset();
+        run.locations.reset();
+    }
+}
+
+// only use greatest component of baseTopo
+void Pipeline::prune(Run& run) {
+    run.stage("prune");
+    run.baseTopo->prune();
+    releaseMemory();
+}
+
+/*
+  DEAL WITH SIMULATION NODES
+*/
+void Pipeline::addSimulationNodes(Run& run) {
+    // create simulation topology
+    run.stage("simulation nodes");
+    run.simTopo = SimulationTopology_Ptr(new SimulationTopology(run.baseTopo));
+
+    if (_outputs.simNodesJSONFile.empty())
+        return;
+
+    BOOST_LOG_TRIVIAL(info) << "read simulation nodes from " << _outputs.simNodesJSONFile;
+
+    // insert all nodes at once
+    SimulationNodeReader reader(_outputs.simNodesJSONFile);
+    std::vector<SimulationNode_Ptr> simNodes;
+    while (reader.hasNext())
+        simNodes.push_back(reader.getNext());
+    run.simTopo->addNodes(simNodes);
+
+    BOOST_LOG_TRIVIAL(info) << "inserted " << simNodes.size() << " simulation nodes";
+}
+
+/*
+  OUTPUT, ALL FILES ARE FORMATTED IN PARALLEL FROM ONE VIEW OF THE FROZEN TOPOLOGY
+*/
+void Pipeline::write(Run& run) {
+    run.stage("output");
+    FrozenTopology_Ptr frozen(run.baseTopo->freeze());
+    TopologyView_Ptr view(new TopologyView(*frozen));
+    if (_memoryBounded) {
+        if (!_outputs.failures && !_outputs.landmarks)
+            frozen.reset();
+        run.simTopo.reset();
+        run.baseTopo.reset();
+        releaseMemory();
+    }
+    ThreadPool_Ptr pool(ThreadPool::fromConfig());
+    ChunkedOutput output(pool);
+
+    // KML OUTPUT BETA SKELETON
+    if (_outputs.kml) {
+        Config_Ptr kmlConfig(_config->subConfig("kml_graph_output"));
+        addKMLGraph(output, view, kmlConfig, run.outputPrefix + kmlConfig->get<std::string>("gabrielFile"));
+    }
+
+    // GRAPH OUTPUT
+    if (_outputs.graph) {
+        Config_Ptr simpleGraphConfig(_config->subConfig("simple_graph_output"));
+        addSimpleGraph(output, view, simpleGraphConfig, run.outputPrefix);
+    }
+
+    // GRAPH OUTPUT (JSON)
+    if (_outputs.json)
+        addJSONGraph(output, view, _config, _outputs.jsonFile, run.outputPrefix);
+
+    // GRAPH OUTPUT (BINARY)
+    if (_outputs.binary) {
+        Config_Ptr binaryGraphConfig(_config->subConfig("binary_graph_output"));
+        addBinaryGraph(output, view, binaryGraphConfig, run.outputPrefix);
+    }
+
+    // ALT LANDMARKS FOR THE BINARY GRAPH
+    if (_outputs.landmarks) {
+        Config_Ptr landmarkConfig(_config->subConfig("landmark_output"));
+        addLandmarks(output, frozen, view, landmarkConfig, run.outputPrefix);
+    }
+
+    // WEIGHTED GRAPH FOR PARTITIONER TOOLS
+    if (_outputs.metis)
+        addMETISGraph(output, view, _config->subConfig("metis_output"), run.outputPrefix, run);
+
+    // QUALITY METRICS
+    if (_outputs.metrics)
+        addMetrics(output, view, _config->subConfig("metrics"), run.outputPrefix, run);
+
+    // EDGE FAILURE SCENARIOS
+    if (_outputs.failures)
+        addFailureAnalysis(output, frozen, _config->subConfig("failures"), run.outputPrefix, run);
+
+    bool written = output.write();
+    assert(written);
+}
@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PIPELINE_HPP
+#define PIPELINE_HPP
+
+#include "config/Config.hpp"
+#include "db/ImportedData.hpp"
+#include "db/InternetUsageStatistics.hpp"
+#include "geo/GeographicNode.hpp"
+#include "topo/ParameterSweep.hpp"
+#include "topo/StageCache.hpp"
+#include "topo/base_topo/BaseTopology.hpp"
+#include "topo/base_topo/NodeImporter.hpp"
+#include "topo/sim_topo/SimulationTopology.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+
+class Pipeline;
+typedef std::shared_ptr<Pipeline> Pipeline_Ptr;
+
+// The stages of topoGen from the city import to the output files. A pipeline keeps what all of its runs share, the
+// config, the Internet usage statistics and the imported database tables, so that many topologies can be generated
+// in one process without importing again. generate runs all steps in order, the steps can also be called one by one
+// on a Run, e.g. to stop after the beta skeleton or to look at the topology in between. Every step starts after the
+// stages restored from the stage cache.
+class Pipeline {
+   public:
+    // the files a run writes, as selected on the command line of topoGen
+    struct Outputs {
+        bool kml;
+        bool graph;
+        bool json;
+        bool binary;
+        bool landmarks;
+        bool metis;                    /// < METIS graph and edge list, with metis_output.partition the parts
+        bool metrics;                  /// < degrees, paths, betweenness and seacable share as JSON
+        bool failures;                 /// < bridges and the edge failure scenarios as JSON
+        std::string jsonFile;          /// < instead of json_graph_output.filename if not empty
+        std::string simNodesJSONFile;  /// < simulation nodes to add, none if empty
+
+        Outputs();
+    };
+
+    // one topology on its way through the steps
+    struct Run {
+        std::string seed;
+        std::string outputPrefix;  /// < prepended to all output file names
+        bool profileStages;        /// < parallel runs of a batch are profiled as a whole
+
+        NodeImporter_Ptr nodeImport;
+        Locations_Ptr locations;
+        BaseTopology_Ptr baseTopo;
+        SimulationTopology_Ptr simTopo;
+
+        std::shared_ptr<StageCache> cache;
+        StageCache::Snapshot snapshot;
+        StageCache::Stage cached;  /// < latest stage restored from the cache
+
+        // a previous topology of the same lineage, to update instead of starting over
+        StageCache::Snapshot previous;
+        StageCache::Stage previousStage;
+        std::vector<bool> changedNodes;  /// < by node id, since previous
+
+        Run();
+        void stage(const char* name) const;
+    };
+
+    // the statistics are read here, the database tables on first use
+    Pipeline(Config_Ptr config, const Outputs& outputs);
+
+    // shares the data of another pipeline, e.g. one with a different config
+    Pipeline(Config_Ptr config,
+             const Outputs& outputs,
+             InternetUsageStatistics_Ptr inetStat,
+             ImportedData_Ptr importedData);
+
+    Config_Ptr config(void);
+    InternetUsageStatistics_Ptr internetUsage(void);
+    ImportedData_Ptr importedData(void);
+
+    // all steps for one seed, returns the pruned topology or nullptr with memory.bounded, which drops it after the
+    // outputs are written
+    BaseTopology_Ptr generate(const std::string& seed,
+                              const std::string& outputPrefix = "",
+                              bool profileStages = true);
+
+    // one topology per seed in parallel on the thread pool, the files of each are prefixed with its seed and "_"
+    void generateBatch(const std::vector<std::string>& seeds);
+
+    // one topology per combination of the sweep. The import, the clustering and the triangulation run once, every
+    // beta skeleton combination once on a replay of the triangulation and the leaves, one per combination of all
+    // parameters, in parallel on replays of their beta skeleton. The files of combination i are prefixed with seed,
+    // "_", i and "_", <seed>_sweep.json lists the parameters of each.
+    void sweep(const std::string& seed, const ParameterSweep& sweep);
+
+    // the steps in pipeline order, begin restores the run from the stage cache
+    Run begin(const std::string& seed, const std::string& outputPrefix = "", bool profileStages = true);
+    void importCities(Run& run);
+    void clusterLocations(Run& run);
+    void triangulate(Run& run);
+    void writeTriangulation(Run& run);  /// < the delaunay KML, with Outputs::kml
+    void filterBetaSkeleton(Run& run);
+    void filterLength(Run& run);
+    void addSubmarineCables(Run& run);
+    void prune(Run& run);
+    void addSimulationNodes(Run& run);
+    void write(Run& run);
+
+   private:
+    void generate(Run& run, bool batch);
+    Run begin(const std::string& seed, const std::string& outputPrefix, bool profileStages, StageCache::Stage last);
+
+    // a run continuing after stage of from, on a replay of edits and on copies of the nodes of from if copyNodes
+    Run branch(const Run& from,
+               const std::vector<EdgeEdit>& edits,
+               StageCache::Stage stage,
+               const std::string& outputPrefix,
+               bool copyNodes);
+
+    void storeStage(Run& run, StageCache::Stage stage, bool withTopology);
+    void releaseMemory(void);
+
+    Config_Ptr _config;
+    Outputs _outputs;
+    InternetUsageStatistics_Ptr _inetStat;
+    ImportedData_Ptr _importedData;
+
+    // memory.bounded drops the data of every stage as soon as the following stages do not need it
+    bool _memoryBounded;
+};
+
+#endif  // PIPELINE_HPP
@@ -0,0 +1,357 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "PipelineServer.hpp"
+#include "config/PredefinedValues.hpp"
+#include "geo/GeoRegion.hpp"
+#include "output/WriteBuffer.hpp"
+#include "util/BoundedQueue.hpp"
+#include "util/ThreadPool.hpp"
+#include <boost/log/trivial.hpp>
+#include <cassert>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+// longest request line
+const size_t MAX_REQUEST = 1 << 20;
+
+// one line up to '\n' or the end of the stream
+bool readLine(int connection, std::string& line) {
+    char buffer[4096];
+    for (;;) {
+        ssize_t n = recv(connection, buffer, sizeof(buffer), 0);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return !line.empty();
+        line.append(buffer, n);
+        size_t end = line.find('\n');
+        if (end != std::string::npos) {
+            line.resize(end);
+            return true;
+        }
+        if (line.size() > MAX_REQUEST)
+            return false;
+    }
+}
+
+// the client may have gone away, which must not raise SIGPIPE
+bool sendAll(int connection, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = send(connection, data, size, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        data += n;
+        size -= n;
+    }
+    return true;
+}
+
+bool sendJSON(int connection, const Json::Value& value) {
+    Json::FastWriter writer;
+    std::string line = writer.write(value);
+    return sendAll(connection, line.data(), line.size());
+}
+
+void sendError(int connection, const std::string& message) {
+    Json::Value answer;
+    answer["status"] = "error";
+    answer["message"] = message;
+    sendJSON(connection, answer);
+}
+
+// the output files and the directories decide where the server writes and removes files
+bool isPath(const std::string& name) {
+    for (const std::string suffix : {"filename", "File", "Path", "directory"})
+        if (name.size() >= suffix.size() && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0)
+            return true;
+    return false;
+}
+
+// the first property of overrides naming a file or directory, empty if there is none
+std::string pathOverride(const Json::Value& overrides, const std::string& path) {
+    for (const std::string& name : overrides.getMemberNames()) {
+        std::string member = path.empty() ? name : path + "." + name;
+        if (isPath(name))
+            return member;
+        if (overrides[name].isObject()) {
+            std::string found = pathOverride(overrides[name], member);
+            if (!found.empty())
+                return found;
+        }
+    }
+    return "";
+}
+
+// the stages assert on these values, a request must not abort the server
+std::string outOfRange(const Config& config) {
+    for (const char* property :
+         {"neighbourCluster.minPts", "neighbourCluster.maxClusterDistance", "metropolisCluster.minPts",
+          "metropolisCluster.maxClusterDistance", "betaSkeleton.minBeta", "betaSkeleton.maxBeta", "lengthFilter.beta",
+          "lengthFilter.rasterCellFactor"})
+        if (!(config.get<double>(property) > 0.0))
+            return property;
+    if (!(config.get<double>("betaSkeleton.maxBeta") < 2.0))
+        return "betaSkeleton.maxBeta";
+    if (!(config.get<double>("lengthFilter.beta") <= 1.0))
+        return "lengthFilter.beta";
+    double margin = config.get<double>("delaunay.shardMargin");
+    if (!(margin >= 0.0 && margin < 45.0))
+        return "delaunay.shardMargin";
+    if (config.get<bool>("region.enable") &&
+        !(config.get<double>("region.minLatitude") <= config.get<double>("region.maxLatitude")))
+        return "region.minLatitude";
+    return "";
+}
+
+// removes the output of a request however it ends
+struct RequestDirectory {
+    std::string directory;
+    std::string path;
+
+    ~RequestDirectory() {
+        if (!path.empty())
+            remove(path.c_str());
+        if (!directory.empty())
+            rmdir(directory.c_str());
+    }
+};
+
+}  // namespace
+
+PipelineServer::PipelineServer(Config_Ptr config)
+    : _config(config),
+      _inetStat(new InternetUsageStatistics(PredefinedValues::dbFilePath())),
+      _mutex(),
+      _importedData(),
+      _socket(-1),
+      _stopping(false) {
+}
+
+void PipelineServer::serve(const std::string& socketPath) {
+    _socket = socket(AF_UNIX, SOCK_STREAM, 0);
+    assert(_socket >= 0);
+
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    assert(socketPath.size() < sizeof(address.sun_path));
+    strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+    // a socket file left by a previous server
+    unlink(socketPath.c_str());
+    if (bind(_socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(_socket, 64) != 0) {
+        BOOST_LOG_TRIVIAL(error) << "can not listen on " << socketPath << ": " << strerror(errno);
+        close(_socket);
+        return;
+    }
+
+    // resident before the first request
+    importedData(_config)->load();
+
+    // the workers run on the pool like the runs of a batch, so the stages of a request stay on its thread
+    ThreadPool_Ptr pool(new ThreadPool(_config->get<unsigned int>("serve.workers")));
+    BoundedQueue<int> connections(pool->size());
+    std::thread workers([&]() {
+        pool->forEach(pool->size(), [&](size_t) {
+            int connection;
+            while (connections.pop(connection)) {
+                handle(connection);
+                close(connection);
+            }
+        });
+    });
+    BOOST_LOG_TRIVIAL(info) << "serving on " << socketPath << " with " << pool->size() << " workers";
+
+    while (!_stopping) {
+        int connection = accept(_socket, nullptr, nullptr);
+        if (connection >= 0)
+            connections.push(connection);
+        else if (errno != EINTR && errno != ECONNABORTED)
+            break;
+    }
+
+    connections.close();
+    workers.join();
+    close(_socket);
+    unlink(socketPath.c_str());
+    BOOST_LOG_TRIVIAL(info) << "server stopped";
+}
+
+void PipelineServer::handle(int connection) {
+    std::string line;
+    if (!readLine(connection, line)) {
+        sendError(connection, "no request");
+        return;
+    }
+
+    Json::Value request;
+    std::string errors;
+    Json::CharReaderBuilder builder;
+    std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+    if (!reader->parse(line.data(), line.data() + line.size(), &request, &errors) || !request.isObject()) {
+        sendError(connection, "invalid request: " + errors);
+        return;
+    }
+
+    if (request["command"].asString() == "shutdown") {
+        Json::Value answer;
+        answer["status"] = "ok";
+        sendJSON(connection, answer);
+
+        // wakes up accept, the queued requests are still served
+        _stopping = true;
+        shutdown(_socket, SHUT_RDWR);
+        return;
+    }
+
+    // a failing request is answered, the server keeps running
+    try {
+        generate(connection, request);
+    } catch (const std::exception& e) {
+        BOOST_LOG_TRIVIAL(error) << "request failed: " << e.what();
+        sendError(connection, std::string("request failed: ") + e.what());
+    }
+}
+
+void PipelineServer::generate(int connection, const Json::Value& request) {
+    if (!request.get("seed", "").isString() || !request.get("output", "").isString()) {
+        sendError(connection, "seed and output have to be strings");
+        return;
+    }
+    std::string seed = request.get("seed", "run1").asString();
+    std::string output = request.get("output", "json").asString();
+    const Json::Value& overrides = request["config"];
+    if (output != "json" && output != "binary") {
+        sendError(connection, "unknown output " + output);
+        return;
+    }
+    if (!overrides.isNull() && !overrides.isObject()) {
+        sendError(connection, "config is no object");
+        return;
+    }
+    // the city import reads the threshold from the config file, the server decides where files are written
+    for (const char* fixed : {"cityfilter", "serve", "cache"}) {
+        if (overrides.isMember(fixed)) {
+            sendError(connection, std::string(fixed) + " can not be overridden");
+            return;
+        }
+    }
+    std::string property = overrides.isNull() ? "" : pathOverride(overrides, "");
+    if (!property.empty()) {
+        sendError(connection, property + " can not be overridden");
+        return;
+    }
+    property = overrides.isNull() ? "" : _config->mismatch(overrides);
+    if (!property.empty()) {
+        sendError(connection, "unknown property or wrong type: " + property);
+        return;
+    }
+
+    Config_Ptr config = overrides.isNull() ? _config : std::make_shared<Config>(*_config, overrides);
+    property = outOfRange(*config);
+    if (!property.empty()) {
+        sendError(connection, "value out of range: " + property);
+        return;
+    }
+
+    Pipeline::Outputs outputs;
+    std::string fileName;
+    if (output == "json") {
+        outputs.json = true;
+        fileName = config->get<std::string>("json_graph_output.filename");
+    } else {
+        outputs.binary = true;
+        fileName = config->get<std::string>("binary_graph_output.filename");
+    }
+    fileName += Compression::fromConfig().suffix();
+
+    // every request writes into a directory of its own
+    std::string pattern = _config->get<std::string>("serve.directory") + "/topoGen-XXXXXX";
+    std::vector<char> name(pattern.begin(), pattern.end());
+    name.push_back('\0');
+    if (!mkdtemp(name.data())) {
+        sendError(connection, std::string("can not create output directory: ") + strerror(errno));
+        return;
+    }
+    RequestDirectory files = {name.data(), std::string(name.data()) + "/" + fileName};
+    const std::string& directory = files.directory;
+    const std::string& path = files.path;
+
+    BOOST_LOG_TRIVIAL(info) << "request for seed " << seed << " (" << output << ")";
+    Pipeline pipeline(config, outputs, _inetStat, importedData(config));
+    pipeline.generate(seed, directory + "/", false);
+
+    std::ifstream file(path.c_str(), std::ios::binary | std::ios::ate);
+    if (file.good()) {
+        Json::Value answer;
+        answer["status"] = "ok";
+        answer["seed"] = seed;
+        answer["output"] = output;
+        answer["size"] = Json::UInt64(file.tellg());
+        file.seekg(0);
+
+        bool sent = sendJSON(connection, answer);
+        std::vector<char> buffer(1 << 16);
+        while (sent && file.read(buffer.data(), buffer.size()).gcount() > 0)
+            sent = sendAll(connection, buffer.data(), file.gcount());
+        if (!sent)
+            BOOST_LOG_TRIVIAL(warning) << "client of seed " << seed << " went away";
+    } else {
+        sendError(connection, "no output written");
+    }
+}
+
+ImportedData_Ptr PipelineServer::importedData(Config_Ptr config) {
+    ImportedData_Ptr data;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        ImportedData_Ptr& entry = _importedData[config->serialize("region")];
+        if (!entry)
+            entry = std::make_shared<ImportedData>(PredefinedValues::dbFilePath(), GeoRegion::fromConfig(config));
+        data = entry;
+    }
+
+    // the tables are read once, requests for the same region wait for the first one
+    data->load();
+    return data;
+}
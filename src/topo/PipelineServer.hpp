@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PIPELINESERVER_HPP
+#define PIPELINESERVER_HPP
+
+#include "config/Config.hpp"
+#include "db/ImportedData.hpp"
+#include "db/InternetUsageStatistics.hpp"
+#include "topo/Pipeline.hpp"
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+
+// Generation server of topoGen --serve. The config, the Internet usage statistics and the imported database tables
+// stay resident between requests. Every connection to the unix socket sends one request as a line of JSON
+//   {"seed" : "run1", "output" : "json", "config" : {"lengthFilter" : {"minLength" : 500.0}}}
+// with "output" json or binary and "config" overriding values of the config of the server by values of the same type.
+// File names, directories, cityfilter, serve and cache can not be overridden. The answer is a line of JSON,
+// {"status" : "ok", "size" : <bytes>} followed by the bytes of the output file or {"status" : "error", "message" : ...}
+// for invalid and failed requests. {"command" : "shutdown"} stops the server after the running requests. The requests
+// are served concurrently by serve.workers threads, each request on one thread like the runs of a batch.
+class PipelineServer {
+   public:
+    PipelineServer(Config_Ptr config);
+
+    // returns after a shutdown request
+    void serve(const std::string& socketPath);
+
+   private:
+    void handle(int connection);
+    void generate(int connection, const Json::Value& request);
+
+    // the imported data of the region of config, shared by all requests for it
+    ImportedData_Ptr importedData(Config_Ptr config);
+
+    Config_Ptr _config;
+    InternetUsageStatistics_Ptr _inetStat;
+
+    std::mutex _mutex;
+    std::map<std::string, ImportedData_Ptr> _importedData;  /// < by serialized region
+
+    int _socket;
+    std::atomic<bool> _stopping;
+};
+
+#endif  // PIPELINESERVER_HPP
@@ -0,0 +1,396 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "StageCache.hpp"
+#include "config/PredefinedValues.hpp"
+#include "geo/CityNode.hpp"
+#include "geo/SeaCableEdge.hpp"
+#include "geo/SeaCableLandingPoint.hpp"
+#include "geo/SeaCableNode.hpp"
+#include "geo/SimulationEdge.hpp"
+#include "geo/TriangulationEdge.hpp"
+#include "topo/NodeStore.hpp"
+#include <boost/log/trivial.hpp>
+#include <cassert>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <sys/stat.h>
+#include <thread>
+
+constexpr uint32_t StageCache::FORMAT_VERSION;
+
+namespace {
+
+const char MAGIC[8] = {'t', 'o', 'p', 'o', 'G', 'e', 'n', 'C'};
+
+// FNV-1a, the keys only have to be stable between runs
+uint64_t hashString(uint64_t hash, const std::string& str) {
+    for (unsigned char c : str) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    // separator, so that "ab" + "c" and "a" + "bc" differ
+    hash ^= 0xff;
+    hash *= 1099511628211ull;
+    return hash;
+}
+
+std::string hex(uint64_t value) {
+    char str[17];
+    snprintf(str, sizeof(str), "%016llx", static_cast<unsigned long long>(value));
+    return str;
+}
+
+std::string databaseStamp(void) {
+    struct stat st;
+    if (stat(PredefinedValues::dbFilePath().c_str(), &st) != 0)
+        return "";
+
+    std::stringstream ss;
+    ss << st.st_size << ":" << st.st_mtime;
+    return ss.str();
+}
+
+template <class T>
+void put(std::ostream& out, T value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void putString(std::ostream& out, const std::string& str) {
+    put<uint32_t>(out, str.size());
+    out.write(str.data(), str.size());
+}
+
+template <class T>
+T get(std::istream& in) {
+    T value = T();
+    in.read(reinterpret_cast<char*>(&value), sizeof(T));
+    return value;
+}
+
+std::string getString(std::istream& in) {
+    std::string str(get<uint32_t>(in), '\0');
+    in.read(&str[0], str.size());
+    return str;
+}
+
+// edges are stored as their GeographicEdge::Kind, triangulation edges with their opposite vertices
+void putEdge(std::ostream& out, const GeographicEdge_Ptr& edge) {
+    put<unsigned char>(out, edgeKind(edge));
+    if (TriangulationEdge* triangulationEdge = edgeCast<TriangulationEdge>(edge.get())) {
+        put<int32_t>(out, triangulationEdge->opposite(0));
+        put<int32_t>(out, triangulationEdge->opposite(1));
+    }
+}
+
+GeographicEdge_Ptr getEdge(std::istream& in) {
+    switch (get<unsigned char>(in)) {
+        case GeographicEdge::TRIANGULATION_EDGE: {
+            int first = get<int32_t>(in);
+            int second = get<int32_t>(in);
+            return GeographicEdge_Ptr(new TriangulationEdge(first, second));
+        }
+        case GeographicEdge::SEACABLE_EDGE:
+            return GeographicEdge_Ptr(new SeaCableEdge);
+        case GeographicEdge::SIMULATION_EDGE:
+            return GeographicEdge_Ptr(new SimulationEdge);
+        case GeographicEdge::GEOGRAPHIC_EDGE:
+            return GeographicEdge_Ptr(new GeographicEdge);
+        default:
+            return GeographicEdge_Ptr();
+    }
+}
+
+void putNode(std::ostream& out, GeographicNode_Ptr& node) {
+    NodeStore::Kind kind = NodeStore::kindOf(node.get());
+    assert(kind != NodeStore::SIMULATION_NODE);
+
+    put<unsigned char>(out, kind);
+    put<int32_t>(out, node->id());
+    put<double>(out, node->lat());
+    put<double>(out, node->lon());
+
+    if (kind == NodeStore::CITY_NODE) {
+        CityNode* city = static_cast<CityNode*>(node.get());
+        putString(out, city->name());
+        put<double>(out, city->population());
+        putString(out, city->country());
+        putString(out, city->continent());
+        put<unsigned char>(out, city->isSeaCableLandingPoint());
+    } else if (kind == NodeStore::SEACABLE_LANDINGPOINT) {
+        putString(out, static_cast<SeaCableLandingPoint*>(node.get())->name());
+    }
+}
+
+GeographicNode_Ptr getNode(std::istream& in) {
+    unsigned char kind = get<unsigned char>(in);
+    int id = get<int32_t>(in);
+    double lat = get<double>(in);
+    double lon = get<double>(in);
+
+    switch (kind) {
+        case NodeStore::CITY_NODE: {
+            std::string name = getString(in);
+            double population = get<double>(in);
+            std::string country = getString(in);
+            std::string continent = getString(in);
+            CityNode* city = new CityNode(id, name, lat, lon, population, country, continent);
+            if (get<unsigned char>(in))
+                city->setSeaCableLandingPoint();
+            return GeographicNode_Ptr(city);
+        }
+        case NodeStore::SEACABLE_LANDINGPOINT:
+            return GeographicNode_Ptr(new SeaCableLandingPoint(id, lat, lon, getString(in)));
+        case NodeStore::SEACABLE_NODE:
+            return GeographicNode_Ptr(new SeaCableNode(id, lat, lon));
+        case NodeStore::GEOGRAPHIC_NODE:
+            return GeographicNode_Ptr(new GeographicNode(id, lat, lon));
+        default:
+            return GeographicNode_Ptr();
+    }
+}
+
+}  // namespace
+
+StageCache::StageCache(Config_Ptr config, const std::string& seed, InternetUsageStatistics_Ptr inetStat)
+    : _enabled(config->get<bool>("cache.enable") && !config->get<bool>("debug.enable")),
+      _incremental(config->get<bool>("cache.incremental")),
+      _directory(config->get<std::string>("cache.directory")),
+      _keys(),
+      _lineage(0) {
+    std::stringstream version;
+    version << FORMAT_VERSION;
+
+    uint64_t key = 14695981039346656037ull;
+    key = hashString(key, version.str());
+    key = hashString(key, seed);
+    key = hashString(key, databaseStamp());
+    key = hashString(key, config->serialize("cityfilter"));
+    key = hashString(key, config->serialize("region"));
+    _keys.push_back(key);
+
+    key = hashString(key, config->serialize("neighbourCluster"));
+    key = hashString(key, config->serialize("metropolisCluster"));
+    _keys.push_back(key);
+
+    // landing points, waypoints and the triangulation only depend on the node order
+    key = hashString(key, stageName(DELAUNAY));
+    key = hashString(key, config->serialize("locality"));
+    _keys.push_back(key);
+
+    key = hashString(key, config->serialize("betaSkeleton"));
+    _keys.push_back(key);
+
+    // the beta skeleton of unchanged nodes only depends on these
+    _lineage = 14695981039346656037ull;
+    _lineage = hashString(_lineage, version.str());
+    _lineage = hashString(_lineage, seed);
+    _lineage = hashString(_lineage, config->serialize("betaSkeleton"));
+    _lineage = hashString(_lineage, inetStat->serialize());
+}
+
+bool StageCache::enabled(void) {
+    return _enabled;
+}
+
+const char* StageCache::stageName(Stage stage) {
+    switch (stage) {
+        case CITIES:
+            return "cities";
+        case OPTICS:
+            return "optics";
+        case DELAUNAY:
+            return "delaunay";
+        case BETA_SKELETON:
+            return "beta";
+        default:
+            assert(false);
+            return "";
+    }
+}
+
+std::string StageCache::fileName(Stage stage, uint64_t key) {
+    return _directory + "/" + stageName(stage) + "-" + hex(key) + ".bin";
+}
+
+// holds the key of the latest entry of the lineage
+std::string StageCache::latestName(Stage stage) {
+    return _directory + "/" + stageName(stage) + "-" + hex(_lineage) + ".latest";
+}
+
+StageCache::Stage StageCache::load(Stage last, Snapshot& snapshot) {
+    if (!_enabled)
+        return NO_STAGE;
+
+    for (int stage = last; stage > NO_STAGE; --stage) {
+        Snapshot candidate;
+        if (read(static_cast<Stage>(stage), _keys[stage], candidate)) {
+            snapshot = candidate;
+            BOOST_LOG_TRIVIAL(info) << "StageCache: restored " << snapshot.locations->size() << " locations after "
+                                    << stageName(static_cast<Stage>(stage)) << " from "
+                                    << fileName(static_cast<Stage>(stage), _keys[stage]);
+            return static_cast<Stage>(stage);
+        }
+    }
+
+    return NO_STAGE;
+}
+
+StageCache::Stage StageCache::loadPrevious(Stage last, Snapshot& snapshot) {
+    if (!_enabled || !_incremental)
+        return NO_STAGE;
+
+    for (int stage = last; stage > NO_STAGE; --stage) {
+        std::ifstream latest(latestName(static_cast<Stage>(stage)).c_str());
+        std::string keyString;
+        if (!(latest >> keyString))
+            continue;
+        uint64_t key = strtoull(keyString.c_str(), nullptr, 16);
+
+        Snapshot candidate;
+        if (read(static_cast<Stage>(stage), key, candidate)) {
+            snapshot = candidate;
+            BOOST_LOG_TRIVIAL(info) << "StageCache: previous " << stageName(static_cast<Stage>(stage)) << " with "
+                                    << snapshot.locations->size() << " locations from "
+                                    << fileName(static_cast<Stage>(stage), key);
+            return static_cast<Stage>(stage);
+        }
+    }
+
+    return NO_STAGE;
+}
+
+bool StageCache::read(Stage stage, uint64_t key, Snapshot& snapshot) {
+    std::ifstream in(fileName(stage, key).c_str(), std::ifstream::binary);
+    if (!in.good())
+        return false;
+
+    char magic[sizeof(MAGIC)];
+    in.read(magic, sizeof(magic));
+    if (!in.good() || !std::equal(magic, magic + sizeof(MAGIC), MAGIC))
+        return false;
+    if (get<uint32_t>(in) != FORMAT_VERSION || get<int32_t>(in) != stage || get<uint64_t>(in) != key)
+        return false;
+
+    snapshot.nodeNumber = get<int32_t>(in);
+
+    uint64_t numLocations = get<uint64_t>(in);
+    for (uint64_t i = 0; i < numLocations && in.good(); ++i) {
+        GeographicNode_Ptr node = getNode(in);
+        if (!node)
+            return false;
+        snapshot.locations->push_back(node);
+    }
+
+    uint64_t numProjections = get<uint64_t>(in);
+    for (uint64_t i = 0; i < numProjections && in.good(); ++i) {
+        FallbackProjection::Entry entry;
+        entry.lat = get<int64_t>(in);
+        entry.lon = get<int64_t>(in);
+        entry.node = get<int32_t>(in);
+        snapshot.fallbackProjection.insert(entry);
+    }
+
+    uint64_t numEdits = get<uint64_t>(in);
+    for (uint64_t i = 0; i < numEdits && in.good(); ++i) {
+        EdgeEdit edit;
+        edit.erased = get<unsigned char>(in);
+        edit.u = get<int32_t>(in);
+        edit.v = get<int32_t>(in);
+        edit.edge = get<int32_t>(in);
+        edit.geoEdge = getEdge(in);
+        snapshot.edgeEdits.push_back(edit);
+    }
+
+    return in.good();
+}
+
+void StageCache::store(Stage stage, const Snapshot& snapshot) {
+    if (!_enabled)
+        return;
+
+    if (mkdir(_directory.c_str(), 0755) != 0 && errno != EEXIST) {
+        BOOST_LOG_TRIVIAL(warning) << "StageCache: cannot create " << _directory;
+        return;
+    }
+
+    // runs of a batch may store the same entry, the rename makes the last one win
+    std::stringstream tmpName;
+    tmpName << fileName(stage, _keys[stage]) << ".tmp" << std::hash<std::thread::id>()(std::this_thread::get_id());
+
+    {
+        std::ofstream out(tmpName.str().c_str(), std::ofstream::binary);
+        out.write(MAGIC, sizeof(MAGIC));
+        put<uint32_t>(out, FORMAT_VERSION);
+        put<int32_t>(out, stage);
+        put<uint64_t>(out, _keys[stage]);
+        put<int32_t>(out, snapshot.nodeNumber);
+
+        put<uint64_t>(out, snapshot.locations->size());
+        for (GeographicNode_Ptr& node : *snapshot.locations)
+            putNode(out, node);
+
+        put<uint64_t>(out, snapshot.fallbackProjection.size());
+        for (const FallbackProjection::Entry& entry : snapshot.fallbackProjection.entries()) {
+            put<int64_t>(out, entry.lat);
+            put<int64_t>(out, entry.lon);
+            put<int32_t>(out, entry.node);
+        }
+
+        put<uint64_t>(out, snapshot.edgeEdits.size());
+        for (const EdgeEdit& edit : snapshot.edgeEdits) {
+            put<unsigned char>(out, edit.erased);
+            put<int32_t>(out, edit.u);
+            put<int32_t>(out, edit.v);
+            put<int32_t>(out, edit.edge);
+            putEdge(out, edit.geoEdge);
+        }
+
+        if (!out.good()) {
+            BOOST_LOG_TRIVIAL(warning) << "StageCache: writing " << tmpName.str() << " failed";
+            remove(tmpName.str().c_str());
+            return;
+        }
+    }
+
+    rename(tmpName.str().c_str(), fileName(stage, _keys[stage]).c_str());
+    BOOST_LOG_TRIVIAL(info) << "StageCache: stored " << stageName(stage) << " in " << fileName(stage, _keys[stage]);
+
+    if (_incremental) {
+        std::string tmpLatest = tmpName.str() + ".latest";
+        {
+            std::ofstream latest(tmpLatest.c_str());
+            latest << hex(_keys[stage]) << std::endl;
+        }
+        rename(tmpLatest.c_str(), latestName(stage).c_str());
+    }
+}
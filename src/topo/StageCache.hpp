@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef STAGECACHE_HPP
+#define STAGECACHE_HPP
+
+#include "config/Config.hpp"
+#include "db/InternetUsageStatistics.hpp"
+#include "geo/GeographicNode.hpp"
+#include "topo/base_topo/BaseTopology.hpp"
+#include "topo/base_topo/NodeImporter.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// On-disk snapshots of the pipeline after its expensive stages. Every entry is keyed by a hash of the seed, the
+// database file and the config subtrees read up to that stage, and the key of a stage includes the key of the stage
+// before. A run restarts after the latest stage with an entry, entries of changed inputs are never found again.
+// With cache.incremental the latest entry of every stage is also found by its lineage, the seed and the parameters
+// of the filters, so that a run with changed cities or cables can start from the previous topology.
+class StageCache {
+   public:
+    enum Stage { NO_STAGE = -1, CITIES, OPTICS, DELAUNAY, BETA_SKELETON };
+
+    struct Snapshot {
+        Locations_Ptr locations;
+        int nodeNumber;  /// < next id of the NodeImporter
+        FallbackProjection fallbackProjection;
+        std::vector<EdgeEdit> edgeEdits;  /// < empty before DELAUNAY
+
+        Snapshot() : locations(new Locations), nodeNumber(0), fallbackProjection(), edgeEdits() {}
+    };
+
+    // the cache is enabled by cache.enable, runs with debug.enable read their cities from a file and are not cached
+    StageCache(Config_Ptr config, const std::string& seed, InternetUsageStatistics_Ptr inetStat);
+
+    bool enabled(void);
+
+    // loads the latest stage up to last, returns NO_STAGE if there is no entry
+    Stage load(Stage last, Snapshot& snapshot);
+
+    // loads the latest stage up to last stored by any run of the same lineage, NO_STAGE without cache.incremental
+    Stage loadPrevious(Stage last, Snapshot& snapshot);
+
+    void store(Stage stage, const Snapshot& snapshot);
+
+   private:
+    static const char* stageName(Stage stage);
+    std::string fileName(Stage stage, uint64_t key);
+    std::string latestName(Stage stage);
+    bool read(Stage stage, uint64_t key, Snapshot& snapshot);
+
+    static constexpr uint32_t FORMAT_VERSION = 5;
+
+    bool _enabled;
+    bool _incremental;  /// < cache.incremental
+    std::string _directory;
+    std::vector<uint64_t> _keys;  /// < by stage
+    uint64_t _lineage;
+};
+
+#endif  // STAGECACHE_HPP
@@ -29,20 +29,31 @@
 
 #include "BaseTopology.hpp"
 #include "geo/CityNode.hpp"
+#include "geo/GeometricHelpers.hpp"
 #include "lemon/maps.h"
 #include "lemon/connectivity.h"
+#include "topo/FrozenTopology.hpp"
+#include "util/Profiler.hpp"
+#include "util/ThreadPool.hpp"
 #include <boost/log/trivial.hpp>
+#include <algorithm>
+#include <cassert>
+#include <queue>
 
 BaseTopology::BaseTopology()
     : _graph(new Graph),
       _nodeGeoNodeMap(new NodeMap(*_graph)),
+      _nodeKindMap(new NodeKindMap(*_graph)),
       _edgeGeoMap(new EdgeMap(*_graph)),
-      _geoNodeMap(new GeoNodeMap) {
+      _edgeGeometryMap(new EdgeGeometryMap(*_graph)),
+      _geoNodeMap(new GeoNodeMap),
+      _edgeEdits() {
 }
 
 Graph::Node BaseTopology::addNode(GeographicNode_Ptr& gNode) {
     Graph::Node nd = _graph->addNode();
     (*_nodeGeoNodeMap)[nd] = gNode;
+    (*_nodeKindMap)[nd] = gNode->kind();
     (*_geoNodeMap)[gNode->id()] = nd;
     return nd;
 }
@@ -51,6 +62,10 @@ NodeMap_Ptr BaseTopology::getNodeMap() {
     return _nodeGeoNodeMap;
 }
 
+NodeKindMap_Ptr BaseTopology::getNodeKindMap() {
+    return _nodeKindMap;
+}
+
 Graph_Ptr BaseTopology::getGraph() {
     return _graph;
 }
@@ -62,45 +77,210 @@ GeoNodeMap_Ptr BaseTopology::getGeoNodeMap() {
 Graph::Edge BaseTopology::addEdge(Graph::Node& u, Graph::Node& v, GeographicEdge_Ptr& e) {
     Graph::Edge edge = _graph->addEdge(u, v);
     (*_edgeGeoMap)[edge] = e;
+    (*_edgeGeometryMap)[edge].valid = false;  // < lemon reuses the ids of erased edges
+    Profiler::count(Profiler::EDGES_ADDED);
+
+    EdgeEdit edit = {false, _graph->id(u), _graph->id(v), _graph->id(edge), e};
+    _edgeEdits.push_back(edit);
     return edge;
 }
 
+void BaseTopology::eraseEdge(Graph::Edge e) {
+    EdgeEdit edit = {true, -1, -1, _graph->id(e), GeographicEdge_Ptr()};
+    _edgeEdits.push_back(edit);
+
+    _graph->erase(e);
+    Profiler::count(Profiler::EDGES_ERASED);
+}
+
+EdgeList BaseTopology::selectEdges(const std::function<bool(const Graph::Edge&)>& test) {
+    const size_t BLOCK_SIZE = 64;
+
+    std::vector<Graph::Edge> edges;
+    for (Graph::EdgeIt it(*_graph); it != lemon::INVALID; ++it)
+        edges.push_back(it);
+
+    size_t blocks = (edges.size() + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    std::vector<EdgeList> selected(blocks);
+
+    ThreadPool_Ptr pool(ThreadPool::fromConfig());
+    pool->forEach(blocks, [&](size_t block) {
+        size_t end = std::min(edges.size(), (block + 1) * BLOCK_SIZE);
+        for (size_t i = block * BLOCK_SIZE; i < end; ++i)
+            if (test(edges[i]))
+                selected[block].push_back(edges[i]);
+    });
+
+    EdgeList result;
+    for (EdgeList& list : selected)
+        result.splice(result.end(), list);
+    return result;
+}
+
+const std::vector<EdgeEdit>& BaseTopology::edgeEdits(void) {
+    return _edgeEdits;
+}
+
+void BaseTopology::replay(const std::vector<EdgeEdit>& edits) {
+    for (const EdgeEdit& edit : edits) {
+        if (edit.erased) {
+            eraseEdge(_graph->edgeFromId(edit.edge));
+        } else {
+            Graph::Node u = _graph->nodeFromId(edit.u);
+            Graph::Node v = _graph->nodeFromId(edit.v);
+            GeographicEdge_Ptr geoEdge = edit.geoEdge;
+            Graph::Edge edge = addEdge(u, v, geoEdge);
+            assert(_graph->id(edge) == edit.edge);
+        }
+    }
+}
+
 EdgeMap_Ptr BaseTopology::getEdgeMap() {
     return _edgeGeoMap;
 }
 
+const EdgeGeometry& BaseTopology::edgeGeometry(const Graph::Edge& e) {
+    EdgeGeometry& geometry = (*_edgeGeometryMap)[e];
+    if (!geometry.valid) {
+        GeographicNode_Ptr& n1 = (*_nodeGeoNodeMap)[_graph->u(e)];
+        GeographicNode_Ptr& n2 = (*_nodeGeoNodeMap)[_graph->v(e)];
+        GeographicPosition p1(n1->lat(), n1->lon());
+        GeographicPosition p2(n2->lat(), n2->lon());
+
+        geometry.kind = edgeKind((*_edgeGeoMap)[e]);
+        geometry.length = GeometricHelpers::sphericalDist(p1, p2);
+        geometry.lengthKM = GeometricHelpers::sphericalDistToKM(geometry.length);
+        geometry.midPoint = GeometricHelpers::getMidPointCoordinates(p1, p2);
+        geometry.valid = true;
+    }
+    return geometry;
+}
+
+void BaseTopology::computeEdgeGeometry(void) {
+    std::vector<Graph::Edge> edges;
+    for (Graph::EdgeIt it(*_graph); it != lemon::INVALID; ++it)
+        if (!(*_edgeGeometryMap)[it].valid)
+            edges.push_back(it);
+
+    // every edge is written by one worker only
+    ThreadPool_Ptr pool(ThreadPool::fromConfig());
+    pool->forEach(edges.size(), [&](size_t i) { edgeGeometry(edges[i]); });
+}
+
 void BaseTopology::prune() {
     // extract the biggest connected component and prune the rest
     Graph_Ptr graph = getGraph();
     Graph::NodeMap<int> nodeMap(*graph);
     int numConnectedComponents = lemon::connectedComponents(*graph, nodeMap);
     BOOST_LOG_TRIVIAL(info) << "Graph has " << numConnectedComponents << " components!";
+    if (numConnectedComponents == 0)
+        return;
 
-    // count members of first component
-    std::map<int, int> componentCounter;
+    // count members of each component, the first of the largest ones is kept
+    std::vector<int> componentSize(numConnectedComponents, 0);
+    for (Graph::NodeIt it(*graph); it != lemon::INVALID; ++it)
+        ++componentSize[nodeMap[it]];
+    int maxComponent = std::max_element(componentSize.begin(), componentSize.end()) - componentSize.begin();
+
+    // ListGraph puts every added node and edge in front of its lists. Adding the surviving nodes in reverse iteration
+    // order and every edge before the edges preceding it at its end nodes keeps all iteration orders of the graph.
+    std::vector<Graph::Node> kept;
+    int numNodes = 0;
     for (Graph::NodeIt it(*graph); it != lemon::INVALID; ++it) {
-        componentCounter[nodeMap[it]]++;
+        ++numNodes;
+        if (nodeMap[it] == maxComponent)
+            kept.push_back(it);
+    }
+    std::vector<int> newId(graph->maxNodeId() + 1, -1);
+    std::vector<GeographicNode_Ptr> nodes(kept.size());
+    for (unsigned i = 0; i < kept.size(); ++i) {
+        newId[graph->id(kept[i])] = kept.size() - 1 - i;
+        nodes[kept.size() - 1 - i] = (*_nodeGeoNodeMap)[kept[i]];
     }
 
-    int maxComponent = 0;
-    int maxNum = 0;
-    for (auto p : componentCounter) {
-        if (p.second > maxNum) {
-            maxNum = p.second;
-            maxComponent = p.first;
+    struct KeptEdge {
+        int u;
+        int v;
+        GeographicEdge_Ptr edge;
+        EdgeGeometry geometry;
+    };
+    std::vector<KeptEdge> edges;
+    std::vector<int> edgeIndex(graph->maxEdgeId() + 1, -1);
+    int numEdges = 0;
+    for (int id = 0; id <= graph->maxEdgeId(); ++id) {
+        Graph::Edge e = graph->edgeFromId(id);
+        if (!graph->valid(e))
+            continue;
+        ++numEdges;
+        int u = newId[graph->id(graph->u(e))];
+        int v = newId[graph->id(graph->v(e))];
+        if (u >= 0) {
+            assert(v >= 0);
+            edgeIndex[id] = edges.size();
+            KeptEdge keptEdge = {u, v, (*_edgeGeoMap)[e], (*_edgeGeometryMap)[e]};
+            edges.push_back(keptEdge);
         }
     }
 
-    std::list<int> nodesToDelete;
-    for (Graph::NodeIt it(*graph); it != lemon::INVALID; ++it) {
-        if (nodeMap[it] != maxComponent)
-            nodesToDelete.push_back(graph->id(it));
+    // (a, b): edge a has to be added before edge b, the edges are added by increasing old id where that is free
+    std::vector<std::pair<int, int>> before;
+    for (const Graph::Node& nd : kept) {
+        int previous = -1;
+        for (Graph::IncEdgeIt it(*graph, nd); it != lemon::INVALID; ++it) {
+            int current = edgeIndex[graph->id(it)];
+            if (previous >= 0 && previous != current)
+                before.push_back(std::make_pair(current, previous));
+            previous = current;
+        }
+    }
+    std::sort(before.begin(), before.end());
+    std::vector<int> waiting(edges.size(), 0);
+    for (const std::pair<int, int>& constraint : before)
+        ++waiting[constraint.second];
+    std::priority_queue<int, std::vector<int>, std::greater<int>> ready;
+    for (unsigned i = 0; i < edges.size(); ++i)
+        if (waiting[i] == 0)
+            ready.push(i);
+    std::vector<int> edgeOrder;
+    edgeOrder.reserve(edges.size());
+    while (!ready.empty()) {
+        int i = ready.top();
+        ready.pop();
+        edgeOrder.push_back(i);
+        auto it = std::lower_bound(before.begin(), before.end(), std::make_pair(i, -1));
+        for (; it != before.end() && it->first == i; ++it)
+            if (--waiting[it->second] == 0)
+                ready.push(it->second);
     }
+    assert(edgeOrder.size() == edges.size());
 
-    for (auto id : nodesToDelete) {
-        graph->erase(graph->nodeFromId(id));
-        _geoNodeMap->erase(id);
+    // one rebuild instead of erasing node by node
+    graph->clear();
+    _geoNodeMap->clear();
+    _edgeEdits.clear();
+    graph->reserveNode(nodes.size());
+    graph->reserveEdge(edges.size());
+
+    std::vector<Graph::Node> graphNodes;
+    graphNodes.reserve(nodes.size());
+    for (unsigned i = 0; i < nodes.size(); ++i) {
+        nodes[i]->setId(i);
+        graphNodes.push_back(addNode(nodes[i]));
+        assert(graph->id(graphNodes.back()) == static_cast<int>(i));
     }
+
+    for (int i : edgeOrder) {
+        Graph::Edge e = graph->addEdge(graphNodes[edges[i].u], graphNodes[edges[i].v]);
+        (*_edgeGeoMap)[e] = edges[i].edge;
+        (*_edgeGeometryMap)[e] = edges[i].geometry;
+    }
+
+    Profiler::count(Profiler::NODES_ERASED, numNodes - kept.size());
+    Profiler::count(Profiler::EDGES_ERASED, numEdges - edges.size());
+}
+
+FrozenTopology_Ptr BaseTopology::freeze(void) {
+    return FrozenTopology_Ptr(new FrozenTopology(*this));
 }
 
 std::vector<GeographicPositionTuple> BaseTopology::getHighestDegreeNodes(unsigned int amount, bool USonly) {
@@ -113,13 +293,14 @@ std::vector<GeographicPositionTuple> BaseTopology::getHighestDegreeNodes(unsigne
         Graph::Node nd(it);
         int arcs = lemon::countOutArcs(*graph, nd);
         GeographicNode_Ptr& gNode = (*_nodeGeoNodeMap)[nd];
-        if (dynamic_cast<CityNode*>(gNode.get()) != NULL) {
+        if ((*_nodeKindMap)[nd] == CityNode::KIND) {
             if (USonly == false || static_cast<CityNode*>(gNode.get())->country() == "United States") {
                 degreeMap.insert(std::make_pair(arcs, gNode->coord()));
             }
         }
     }
-    for (unsigned int i = 0; i < amount; ++i) {
+    // a region may have fewer cities than asked for
+    for (unsigned int i = 0; i < amount && !degreeMap.empty(); ++i) {
         toReturn.push_back(degreeMap.rbegin()->second);
         degreeMap.erase(std::prev(degreeMap.end()));
     }
@@ -34,30 +34,85 @@
 #include "geo/GeographicNode.hpp"
 #include "geo/GeographicPosition.hpp"
 #include "topo/Graph.hpp"
+#include <functional>
 #include <memory>
 #include <list>
 #include <map>
+#include <vector>
 
 typedef Graph::NodeMap<GeographicNode_Ptr> NodeMap;
 typedef std::shared_ptr<NodeMap> NodeMap_Ptr;
 
+// GeographicNode::Kind of every node, to classify nodes without loading them
+typedef Graph::NodeMap<uint8_t> NodeKindMap;
+typedef std::shared_ptr<NodeKindMap> NodeKindMap_Ptr;
+
 typedef std::map<unsigned int, Graph::Node> GeoNodeMap;
 typedef std::shared_ptr<GeoNodeMap> GeoNodeMap_Ptr;
 
 typedef Graph::EdgeMap<GeographicEdge_Ptr> EdgeMap;
 typedef std::shared_ptr<EdgeMap> EdgeMap_Ptr;
 
+// great circle between the end nodes of an edge, from u to v, and the kind of its geographic edge
+struct EdgeGeometry {
+    bool valid;
+    GeographicEdge::Kind kind;
+    double length;  /// < radians
+    double lengthKM;
+    GeographicPositionTuple midPoint;
+};
+typedef Graph::EdgeMap<EdgeGeometry> EdgeGeometryMap;
+typedef std::shared_ptr<EdgeGeometryMap> EdgeGeometryMap_Ptr;
+
+// one change of the edge set of a BaseTopology
+struct EdgeEdit {
+    bool erased;
+    int u;  /// < node ids of an added edge
+    int v;
+    int edge;  /// < id of the added or erased edge
+    GeographicEdge_Ptr geoEdge;
+};
+
+class FrozenTopology;
+typedef std::shared_ptr<FrozenTopology> FrozenTopology_Ptr;
+
 class BaseTopology {
    public:
     BaseTopology();
     Graph::Node addNode(GeographicNode_Ptr& node);
     Graph::Edge addEdge(Graph::Node& u, Graph::Node& v, GeographicEdge_Ptr& e);
+    void eraseEdge(Graph::Edge e);
+
+    // tests a snapshot of all edges in blocks on the thread pool and returns the selected ones in edge order for any
+    // thread count. The test must only read the topology.
+    EdgeList selectEdges(const std::function<bool(const Graph::Edge&)>& test);
+
+    // all addEdge and eraseEdge calls in order. lemon reuses the ids of erased edges, so replaying them on the same
+    // nodes is the only way to rebuild a graph with the same ids and iteration order. Node erasure is not recorded,
+    // prune starts a new log.
+    const std::vector<EdgeEdit>& edgeEdits(void);
+    void replay(const std::vector<EdgeEdit>& edits);
+
     NodeMap_Ptr getNodeMap();
+    NodeKindMap_Ptr getNodeKindMap();
     GeoNodeMap_Ptr getGeoNodeMap();
     EdgeMap_Ptr getEdgeMap();
+
+    // geometry and kind of e, computed on first use and taken over by freeze for the writers. Nodes do not move, so
+    // only addEdge invalidates it.
+    const EdgeGeometry& edgeGeometry(const Graph::Edge& e);
+    // computes the geometry of all edges, afterwards edgeGeometry only reads and is safe to call from workers
+    void computeEdgeGeometry(void);
+
     Graph_Ptr getGraph();
+
+    // keeps only the largest connected component. The graph is rebuilt with contiguous node and edge ids and its
+    // iteration orders unchanged, the geographic nodes get their new graph ids and the edit log starts over.
     void prune();
 
+    // CSR copy for the phases that only read the graph, e.g. after prune
+    FrozenTopology_Ptr freeze(void);
+
     // debug
     std::vector<GeographicPositionTuple> getHighestDegreeNodes(unsigned int amount = 2, bool USonly = false);
 
@@ -65,8 +120,11 @@ class BaseTopology {
    private:
     Graph_Ptr _graph;
     NodeMap_Ptr _nodeGeoNodeMap;
+    NodeKindMap_Ptr _nodeKindMap;
     EdgeMap_Ptr _edgeGeoMap;
+    EdgeGeometryMap_Ptr _edgeGeometryMap;
     GeoNodeMap_Ptr _geoNodeMap;
+    std::vector<EdgeEdit> _edgeEdits;
 };
 
 typedef std::shared_ptr<BaseTopology> BaseTopology_Ptr;
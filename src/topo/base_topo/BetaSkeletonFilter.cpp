@@ -37,102 +37,238 @@
 #include "geo/GeometricHelpers.hpp"
 #include "geo/SeaCableLandingPoint.hpp"
 #include "geo/SeaCableNode.hpp"
+#include "geo/TriangulationEdge.hpp"
 #include "topo/Graph.hpp"
+#include "util/StringInterner.hpp"
+#include "util/ThreadPool.hpp"
+#include "util/Trace.hpp"
 #include "util/Util.hpp"
+#include <algorithm>
+#include <boost/log/trivial.hpp>
 #include <cassert>
 #include <cmath>
 #include <cstdlib>
+#include <initializer_list>
 #include <iostream>
-#include <lemon/bfs.h>
+#include <lemon/connectivity.h>
 #include <lemon/core.h>
 #include <list>
+#include <iterator>
+#include <map>
 #include <set>
 
 using GeometricHelpers::deg2rad;
 using GeometricHelpers::rad2deg;
 using GeometricHelpers::sphericalDist;
 
-BetaSkeletonFilter::BetaSkeletonFilter(BaseTopology_Ptr baseTopo)
-    : _baseTopo(baseTopo), _graph(_baseTopo->getGraph()), _nodeGeoNodeMap(_baseTopo->getNodeMap()) {
+// widens the candidate caps of isBetaSkeletonEdgeSmallerThanOne against rounding
+static constexpr double CAP_SLACK = 1e-7;
+
+constexpr BetaSkeletonFilter::BetaThreshold BetaSkeletonFilter::GABRIEL;
+
+BetaSkeletonFilter::BetaThreshold BetaSkeletonFilter::BetaThreshold::of(double beta) {
+    double theta = beta >= 1.0 ? asin(1.0 / beta) : M_PI - asin(beta);
+    return BetaThreshold{beta, theta, cos(theta)};
+}
+
+BetaSkeletonFilter::BetaSkeletonFilter(BaseTopology_Ptr baseTopo,
+                                       InternetUsageStatistics_Ptr inetStat,
+                                       Config_Ptr config)
+    : _baseTopo(baseTopo),
+      _graph(_baseTopo->getGraph()),
+      _nodeGeoNodeMap(_baseTopo->getNodeMap()),
+      _inetStat(inetStat),
+      _minBeta(config->get<double>("betaSkeleton.minBeta")),
+      _maxBeta(config->get<double>("betaSkeleton.maxBeta")),
+      _triangleNeighbors(config->get<bool>("betaSkeleton.triangleNeighbors")),
+      _countryEdges(config->get<bool>("betaSkeleton.countryEdges")),
+      _store(new NodeStore(*_baseTopo)),
+      _positionInCountry(),
+      _componentOf(),
+      _components(),
+      _nodeIndex(),
+      _indexedNodes(),
+      _known() {
+    assert(_minBeta > 0.0);
+    assert(_maxBeta > 0.0);
+    assert(_maxBeta < 2.0);
 }
 
 BetaSkeletonFilter::~BetaSkeletonFilter() {
 }
 
 void BetaSkeletonFilter::generalGabrielFilter() {
-    using namespace lemon;
-    EdgeList edges_to_delete;
+    EdgeMap& edgeMap = *_baseTopo->getEdgeMap();
 
-    for (Graph::EdgeIt edge(*_graph); edge != lemon::INVALID; ++edge) {
-        if (edge != INVALID && !isBetaSkeletonEdgeGreaterEqualThanOne(edge, 1.0))
-            edges_to_delete.push_back(edge);
-    }
+    // the edges are tested against the unmodified graph, deletion is deferred
+    _baseTopo->computeEdgeGeometry();
+    EdgeList edges_to_delete = _baseTopo->selectEdges([&](const Graph::Edge& edge) -> bool {
+        // erased edges may have passed this filter, only the kept ones are known
+        if (size_t(_graph->id(edge)) < _known.size() && _known[_graph->id(edge)] == KEPT)
+            return false;
+
+        TriangulationEdge* triangulationEdge = edgeCast<TriangulationEdge>(edgeMap[edge].get());
+        if (_triangleNeighbors && triangulationEdge && triangulationEdge->hasOpposite())
+            return !isGabrielEdge(edge, *triangulationEdge);
+        return !isBetaSkeletonEdgeGreaterEqualThanOne(edge, GABRIEL);
+    });
 
     for (EdgeList::iterator edge = edges_to_delete.begin(); edge != edges_to_delete.end(); ++edge)
-        _graph->erase(*edge);
+        _baseTopo->eraseEdge(*edge);
 }
 
 void BetaSkeletonFilter::perCountryBetaFilter() {
     using namespace lemon;
 
-    // create list of cities per country
-    typedef std::pair<Graph::Node, CityNode*> Node;
-    std::map<std::string, std::vector<Node>> countries;
+    // create list of cities per country, indexed by interned country id
+    std::vector<std::vector<CountryNode>> countries;
 
     for (ListGraph::NodeIt it(*_graph); it != INVALID; ++it) {
         Graph::Node nd(it);
         GeographicNode_Ptr n1 = (*_nodeGeoNodeMap)[nd];
 
-        CityNode* cnp = dynamic_cast<CityNode*>(n1.get());
-        if (cnp)
-            countries[cnp->country()].push_back(std::make_pair(nd, cnp));
+        CityNode* cnp = nodeCast<CityNode>(n1.get());
+        if (cnp) {
+            if (cnp->countryId() >= countries.size())
+                countries.resize(cnp->countryId() + 1);
+            countries[cnp->countryId()].push_back(std::make_pair(nd, cnp));
+        }
     }
 
-    // create work items
-    EdgeList edges_to_delete;
-    std::list<std::pair<Graph::Node, Graph::Node>> edges_to_add;
-
-    std::unique_ptr<Config> config(new Config);
-    double minBeta = config->get<double>("betaSkeleton.minBeta");
-    assert(minBeta > 0.0);
-    double maxBeta = config->get<double>("betaSkeleton.maxBeta");
-    assert(maxBeta > 0.0);
-    assert(maxBeta < 2.0);
-
-    std::unique_ptr<InternetUsageStatistics> stat(new InternetUsageStatistics(PredefinedValues::dbFilePath()));
-
-    // fill work queue
-    for (auto country : countries) {
-        std::string countryName = country.first;
-        double percentInetUsers = (*stat)[countryName] / 100.0;
-        double beta = percentInetUsers * minBeta + (1.0 - percentInetUsers) * maxBeta;
-
-        for (Node& nd1 : country.second)
-            for (Node& nd2 : country.second) {
-                if (nd1.second == nd2.second || nd1.second->id() > nd2.second->id())
-                    continue;
-
-                if (beta >= 1.0) {
-                    Graph::Edge edge = findEdge(*_graph, nd1.first, nd2.first);
-                    if (edge != INVALID && !isBetaSkeletonEdgeGreaterEqualThanOne(edge, beta))
-                        edges_to_delete.push_back(edge);
-                } else if (isBetaSkeletonEdgeSmallerThanOne(nd1.first, nd2.first, beta))
-                    edges_to_add.push_back(std::make_pair(nd1.first, nd2.first));
-                else {
-                    Graph::Edge edge = findEdge(*_graph, nd1.first, nd2.first);
-                    if (edge != INVALID)
-                        edges_to_delete.push_back(edge);
-                }
-            }
+    _positionInCountry.assign(_graph->maxNodeId() + 1, -1);
+    for (std::vector<CountryNode>& cities : countries)
+        for (unsigned i = 0; i < cities.size(); ++i)
+            _positionInCountry[_graph->id(cities[i].first)] = i;
+
+    // one work item per country in name order, the results are applied in this order for any thread count
+    std::vector<unsigned> countryIds;
+    for (unsigned countryId : Interned::countries().sortedIds())
+        if (countryId < countries.size() && !countries[countryId].empty())
+            countryIds.push_back(countryId);
+
+    // largest countries first, so that they do not end up last on a single thread
+    std::vector<unsigned> schedule(countryIds.size());
+    for (unsigned i = 0; i < schedule.size(); ++i)
+        schedule[i] = i;
+    std::stable_sort(schedule.begin(), schedule.end(), [&countries, &countryIds](unsigned a, unsigned b) {
+        return countries[countryIds[a]].size() > countries[countryIds[b]].size();
+    });
+
+    // the workers only read the graph
+    indexNodes();
+    _baseTopo->computeEdgeGeometry();
+
+    // beta and angle per work item, from the share of Internet users of the country
+    std::vector<BetaThreshold> thresholds;
+    for (unsigned countryId : countryIds) {
+        double percentInetUsers = (*_inetStat)[countryId] / 100.0;
+        thresholds.push_back(BetaThreshold::of(percentInetUsers * _minBeta + (1.0 - percentInetUsers) * _maxBeta));
     }
 
-    // add edges
-    for (auto pair : edges_to_add)
-        _graph->addEdge(pair.first, pair.second);
+    std::vector<EdgeList> edges_to_delete(countryIds.size());
+    std::vector<NodePairList> edges_to_add(countryIds.size());
+
+    ThreadPool_Ptr pool(ThreadPool::fromConfig());
+    pool->forEach(schedule.size(), [&](size_t s) {
+        unsigned item = schedule[s];
+        TRACE_SCOPE_ARG("beta skeleton country", "cities", countries[countryIds[item]].size());
+        filterCountry(countries[countryIds[item]], thresholds[item], edges_to_delete[item], edges_to_add[item]);
+    });
+
+    // add edges, they have no geographic edge
+    GeographicEdge_Ptr noEdge;
+    for (NodePairList& pairs : edges_to_add)
+        for (auto pair : pairs)
+            _baseTopo->addEdge(pair.first, pair.second, noEdge);
 
     // erase edges
-    for (EdgeList::iterator edge = edges_to_delete.begin(); edge != edges_to_delete.end(); ++edge)
-        _graph->erase(*edge);
+    for (EdgeList& edges : edges_to_delete)
+        for (EdgeList::iterator edge = edges.begin(); edge != edges.end(); ++edge)
+            _baseTopo->eraseEdge(*edge);
+}
+
+void BetaSkeletonFilter::filterCountry(std::vector<CountryNode>& cities,
+                                       const BetaThreshold& threshold,
+                                       EdgeList& edges_to_delete,
+                                       NodePairList& edges_to_add) {
+    using namespace lemon;
+
+    if (threshold.beta >= 1.0 && _countryEdges) {
+        filterCountryEdges(cities, threshold, edges_to_delete);
+        return;
+    }
+
+    for (CountryNode& nd1 : cities)
+        for (CountryNode& nd2 : cities) {
+            if (nd1.second == nd2.second || nd1.second->id() > nd2.second->id())
+                continue;
+
+            if (threshold.beta >= 1.0) {
+                Graph::Edge edge = findEdge(*_graph, nd1.first, nd2.first);
+                if (edge != INVALID && !keepEdge(edge, threshold))
+                    edges_to_delete.push_back(edge);
+            } else if (isBetaSkeletonEdgeSmallerThanOne(nd1.first, nd2.first, threshold))
+                edges_to_add.push_back(std::make_pair(nd1.first, nd2.first));
+            else {
+                Graph::Edge edge = findEdge(*_graph, nd1.first, nd2.first);
+                if (edge != INVALID)
+                    edges_to_delete.push_back(edge);
+            }
+        }
+}
+
+// same result as the pair loop of filterCountry for beta >= 1, which can only remove existing edges
+void BetaSkeletonFilter::filterCountryEdges(std::vector<CountryNode>& cities,
+                                            const BetaThreshold& threshold,
+                                            EdgeList& edges_to_delete) {
+    using namespace lemon;
+
+    // edges from nd1 to cities with a larger node id, by position of the city like the pairs
+    std::vector<std::pair<int, Graph::Edge>> inside;
+    for (CountryNode& nd1 : cities) {
+        inside.clear();
+        for (ListGraph::IncEdgeIt it(*_graph, nd1.first); it != INVALID; ++it) {
+            Graph::Node other = _graph->oppositeNode(nd1.first, it);
+            int position = _positionInCountry[_graph->id(other)];
+            // the position may belong to a city of another country
+            if (position < 0 || size_t(position) >= cities.size() || cities[position].first != other ||
+                nd1.second->id() >= cities[position].second->id())
+                continue;
+            inside.push_back(std::make_pair(position, Graph::Edge(it)));
+        }
+        std::stable_sort(inside.begin(), inside.end(),
+                         [](const std::pair<int, Graph::Edge>& a, const std::pair<int, Graph::Edge>& b) {
+                             return a.first < b.first;
+                         });
+
+        for (size_t i = 0; i < inside.size(); ++i) {
+            // findEdge only returns the first of parallel edges
+            if (i > 0 && inside[i].first == inside[i - 1].first)
+                continue;
+            if (!keepEdge(inside[i].second, threshold))
+                edges_to_delete.push_back(inside[i].second);
+        }
+    }
+}
+
+// lemon::Bfs allocates graph maps, which is not thread safe, so the nodes reachable from u are looked up here
+void BetaSkeletonFilter::indexNodes() {
+    Graph::NodeMap<int> componentMap(*_graph);
+    int count = lemon::connectedComponents(*_graph, componentMap);
+
+    _componentOf.assign(_graph->maxNodeId() + 1, -1);
+    _components.assign(count, std::vector<Graph::Node>());
+    _indexedNodes.clear();
+    _nodeIndex = SphericalKDTree_Ptr(new SphericalKDTree);
+
+    for (Graph::NodeIt it(*_graph); it != lemon::INVALID; ++it) {
+        _componentOf[_graph->id(it)] = componentMap[it];
+        _components[componentMap[it]].push_back(it);
+
+        GeographicPosition pos(_store->lat(_graph->id(it)), _store->lon(_graph->id(it)));
+        _nodeIndex->insert(pos);
+        _indexedNodes.push_back(it);
+    }
 }
 
 void BetaSkeletonFilter::filterBetaSkeletonEdges() {
@@ -143,6 +279,55 @@ void BetaSkeletonFilter::filterBetaSkeletonEdges() {
     perCountryBetaFilter();
 }
 
+void BetaSkeletonFilter::reuse(Locations& previousLocations,
+                               const std::vector<EdgeEdit>& previousEdits,
+                               const std::vector<bool>& changedNodes) {
+    _known.clear();
+    if (_minBeta < 1.0 || _maxBeta < 1.0)
+        return;
+
+    // the edges left by the previous edits, lemon reuses erased ids like the replay
+    std::map<int, std::pair<int, int>> previousEdges;
+    for (const EdgeEdit& edit : previousEdits) {
+        if (edit.erased)
+            previousEdges.erase(edit.edge);
+        else
+            previousEdges[edit.edge] = std::make_pair(edit.u, edit.v);
+    }
+
+    std::set<std::pair<GeographicPositionTuple, GeographicPositionTuple>> kept;
+    for (auto& edge : previousEdges) {
+        GeographicPositionTuple first = previousLocations[edge.second.first]->coord();
+        GeographicPositionTuple second = previousLocations[edge.second.second]->coord();
+        kept.insert(std::make_pair(std::min(first, second), std::max(first, second)));
+    }
+
+    size_t reused = 0;
+    _known.assign(_graph->maxEdgeId() + 1, UNKNOWN);
+    for (Graph::EdgeIt it(*_graph); it != lemon::INVALID; ++it) {
+        int u = _graph->id(_graph->u(it));
+        int v = _graph->id(_graph->v(it));
+        if (changedNodes[u] || changedNodes[v])
+            continue;
+
+        GeographicPositionTuple first = (*_nodeGeoNodeMap)[_graph->u(it)]->coord();
+        GeographicPositionTuple second = (*_nodeGeoNodeMap)[_graph->v(it)]->coord();
+        bool wasKept = kept.count(std::make_pair(std::min(first, second), std::max(first, second))) > 0;
+        _known[_graph->id(it)] = wasKept ? KEPT : ERASED;
+        ++reused;
+    }
+
+    BOOST_LOG_TRIVIAL(info) << "beta skeleton: reusing the previous decisions for " << reused << " of "
+                            << lemon::countEdges(*_graph) << " edges";
+}
+
+bool BetaSkeletonFilter::keepEdge(const Graph::Edge& edge, const BetaThreshold& threshold) {
+    int id = _graph->id(edge);
+    if (size_t(id) < _known.size() && _known[id] != UNKNOWN)
+        return _known[id] == KEPT;
+    return isBetaSkeletonEdgeGreaterEqualThanOne(edge, threshold);
+}
+
 Graph_Ptr BetaSkeletonFilter::getGraph(void) {
     return _graph;
 }
@@ -151,7 +336,8 @@ NodeMap_Ptr BetaSkeletonFilter::getNodeMap(void) {
     return _nodeGeoNodeMap;
 }
 
-bool BetaSkeletonFilter::isBetaSkeletonEdgeGreaterEqualThanOne(Graph::Edge& edge, double beta) {
+bool BetaSkeletonFilter::isBetaSkeletonEdgeGreaterEqualThanOne(const Graph::Edge& edge,
+                                                               const BetaThreshold& threshold) {
     // get all other points adjacent to node endpoints
     using namespace lemon;
     typedef ListGraph::Node Node;
@@ -159,46 +345,60 @@ bool BetaSkeletonFilter::isBetaSkeletonEdgeGreaterEqualThanOne(Graph::Edge& edge
     Node u = _graph->u(edge);
     Node v = _graph->v(edge);
 
-    // determine circle center
-    GeographicNode_Ptr n1 = (*_nodeGeoNodeMap)[u];
-    GeographicNode_Ptr n2 = (*_nodeGeoNodeMap)[v];
-
-    if (dynamic_cast<SeaCableNode*>(n1.get()) || dynamic_cast<SeaCableNode*>(n2.get()))
+    if (isSeaCableNode(u) || isSeaCableNode(v))
         return false;
 
-    assert(beta >= 1.0);
-
-    double theta = asin(1.0 / beta);
+    assert(threshold.beta >= 1.0);
+
+    // intersection of adjacent nodes of u and v has to be tested, the node degrees are small
+    std::vector<Node> adjacentNodesU;
+    std::vector<Node> adjacentNodesV;
+    for (ListGraph::IncEdgeIt it(*_graph, u); it != INVALID; ++it)
+        adjacentNodesU.push_back(_graph->oppositeNode(u, it));
+    for (ListGraph::IncEdgeIt it(*_graph, v); it != INVALID; ++it)
+        adjacentNodesV.push_back(_graph->oppositeNode(v, it));
+    std::sort(adjacentNodesU.begin(), adjacentNodesU.end());
+    std::sort(adjacentNodesV.begin(), adjacentNodesV.end());
+
+    std::vector<Node> nodesToTest;
+    std::set_intersection(adjacentNodesU.begin(),
+                          adjacentNodesU.end(),
+                          adjacentNodesV.begin(),
+                          adjacentNodesV.end(),
+                          std::back_inserter(nodesToTest));
+
+    // u and v are not adjacent to themselves, parallel edges are not created
+    for (std::vector<Node>::iterator n = nodesToTest.begin(); n != nodesToTest.end(); ++n) {
+        bool isSeacable = isSeaCableNode(*n);
+
+        if (!angleBelow(u, *n, v, threshold) && !isSeacable)
+            return false;
+    }
 
-    typedef std::set<Node> NodeSet;
-    NodeSet adjacentNodesU;
-    NodeSet nodesToTest;
+    return true;
+}
 
-    for (ListGraph::IncEdgeIt it(*_graph, u); it != INVALID; ++it) {
-        Node oppositeNode = _graph->oppositeNode(u, it);
-        if (oppositeNode != v)
-            adjacentNodesU.insert(oppositeNode);
-    }
+// only the third vertices of the two triangles at a delaunay edge can lie inside its diametral circle
+bool BetaSkeletonFilter::isGabrielEdge(const Graph::Edge& edge, const TriangulationEdge& triangulationEdge) {
+    Graph::Node u = _graph->u(edge);
+    Graph::Node v = _graph->v(edge);
 
-    // intersection of adjacent nodes of u and v has to be tested
-    for (ListGraph::IncEdgeIt it(*_graph, v); it != INVALID; ++it) {
-        Node oppositeNode = _graph->oppositeNode(v, it);
-        if (oppositeNode != u && adjacentNodesU.find(oppositeNode) != adjacentNodesU.end())
-            nodesToTest.insert(oppositeNode);
-    }
+    if (isSeaCableNode(u) || isSeaCableNode(v))
+        return false;
 
-    for (NodeSet::iterator n = nodesToTest.begin(); n != nodesToTest.end(); ++n) {
-        GeographicNode_Ptr n3 = (*_nodeGeoNodeMap)[*n];
-        bool isSeacable = dynamic_cast<SeaCableNode*>(n3.get()) != nullptr;
+    for (int k = 0; k < 2; ++k) {
+        Graph::Node opposite = _graph->nodeFromId(triangulationEdge.opposite(k));
 
-        if (!testTheta(n1, n3, n2, theta) && !isSeacable)
+        if (!angleBelow(u, opposite, v, GABRIEL) && !isSeaCableNode(opposite))
             return false;
     }
 
     return true;
 }
 
-bool BetaSkeletonFilter::isBetaSkeletonEdgeSmallerThanOne(Graph::Node& u, Graph::Node& v, double beta) {
+bool BetaSkeletonFilter::isBetaSkeletonEdgeSmallerThanOne(Graph::Node& u,
+                                                          Graph::Node& v,
+                                                          const BetaThreshold& threshold) {
     // get all other points adjacent to node endpoints
     using namespace lemon;
     typedef ListGraph::Node Node;
@@ -207,36 +407,71 @@ bool BetaSkeletonFilter::isBetaSkeletonEdgeSmallerThanOne(Graph::Node& u, Graph:
     GeographicNode_Ptr& n1 = (*_nodeGeoNodeMap)[u];
     GeographicNode_Ptr& n2 = (*_nodeGeoNodeMap)[v];
 
-    if (dynamic_cast<SeaCableNode*>(n1.get()) || dynamic_cast<SeaCableNode*>(n2.get()))
+    if (isSeaCableNode(u) || isSeaCableNode(v))
         return false;
 
-    double theta = M_PI - asin(beta);
-
-    Bfs<Graph> bfs(*_graph);
-    bfs.init();
-    bfs.addSource(u);
-    assert(bfs.processNextNode() == u);
+    assert(threshold.beta < 1.0);
+    int component = _componentOf[_graph->id(u)];
+    assert(component >= 0);
+
+    // Every node r reachable from u has to pass the test. Only nodes with an angle of at least theta > pi / 2 at r
+    // can fail it, and by the spherical law of cosines those satisfy cos(c) <= cos(a) cos(b). For c < pi / 2 this
+    // leaves the caps of radius c around u and around its antipode, all other nodes pass.
+    std::vector<Node> candidates;
+    double c = sphericalDist(n1, n2);
+    if (c < 0.5 * M_PI) {
+        GeographicPosition center(n1->lat(), n1->lon());
+        GeographicPosition antipode(-n1->lat(), n1->lon() > 0.0 ? n1->lon() - 180.0 : n1->lon() + 180.0);
+
+        std::vector<SphericalKDTree::Neighbor> neighbors;
+        for (GeographicPosition* cap : {&center, &antipode}) {
+            _nodeIndex->radiusSearch(*cap, c + CAP_SLACK, neighbors);
+            for (SphericalKDTree::Neighbor& neighbor : neighbors) {
+                Node next = _indexedNodes[neighbor.index];
+                if (_componentOf[_graph->id(next)] == component)
+                    candidates.push_back(next);
+            }
+        }
+    } else
+        candidates = _components[component];
 
-    while (!bfs.emptyQueue()) {
-        Node next = bfs.processNextNode();
+    for (Node next : candidates) {
         if (next == u || next == v)
             continue;
-        GeographicNode_Ptr& n3 = (*_nodeGeoNodeMap)[next];
 
-        bool isSeacable = dynamic_cast<SeaCableNode*>(n3.get()) != nullptr;
+        bool isSeacable = isSeaCableNode(next);
 
-        if (!testTheta(n1, n3, n2, theta) && !isSeacable)
+        if (!angleBelow(u, next, v, threshold) && !isSeacable)
             return false;
     }
 
     return true;
 }
 
+bool BetaSkeletonFilter::isSeaCableNode(Graph::Node n) {
+    return _store->kind(_graph->id(n)) == NodeStore::SEACABLE_NODE;
+}
+
+bool BetaSkeletonFilter::angleBelow(Graph::Node p, Graph::Node r, Graph::Node q, const BetaThreshold& threshold) {
+    int pId = _graph->id(p);
+    int rId = _graph->id(r);
+    int qId = _graph->id(q);
+    return GeometricHelpers::angleBelow(_store->unitVector(pId), _store->unitVector(rId), _store->unitVector(qId),
+                                        threshold.cosTheta);
+}
+
 // test angle prq
 bool BetaSkeletonFilter::testTheta(GeographicNode_Ptr& p, GeographicNode_Ptr& r, GeographicNode_Ptr& q, double theta) {
+    return testTheta(p, r, q, sphericalDist(p, q), theta);
+}
+
+bool BetaSkeletonFilter::testTheta(GeographicNode_Ptr& p,
+                                   GeographicNode_Ptr& r,
+                                   GeographicNode_Ptr& q,
+                                   double c,
+                                   double theta) {
     double a = sphericalDist(p, r);
     double b = sphericalDist(q, r);
-    double c = sphericalDist(p, q);
     double C = Util::ihs((Util::hs(c) - Util::hs(a - b)) / (sin(a) * sin(b)));
 
     if (C >= theta)
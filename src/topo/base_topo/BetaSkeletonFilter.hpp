@@ -32,21 +32,35 @@
 
 #include "BaseTopology.hpp"
 #include "CGALPrimitives.hpp"
+#include "config/Config.hpp"
+#include "db/InternetUsageStatistics.hpp"
 #include "geo/CityNode.hpp"
 #include "geo/GeographicNode.hpp"
+#include "geo/SphericalKDTree.hpp"
+#include "geo/TriangulationEdge.hpp"
 #include "topo/Graph.hpp"
+#include "topo/NodeStore.hpp"
 #include <lemon/list_graph.h>
+#include <list>
 #include <map>
 #include <utility>
+#include <vector>
 
 class BetaSkeletonFilter {
    public:
-    BetaSkeletonFilter(BaseTopology_Ptr baseTopo);
+    BetaSkeletonFilter(BaseTopology_Ptr baseTopo, InternetUsageStatistics_Ptr inetStat, Config_Ptr config);
 
     virtual ~BetaSkeletonFilter();
 
     void filterBetaSkeletonEdges();
 
+    // takes over the decisions of the previous beta skeleton of previousLocations for edges between unchanged nodes,
+    // see DelaunayGraphCreator::changedNodes. Only the gabriel graph and beta >= 1 remove edges depending on the
+    // neighbours of their nodes alone, so nothing is reused if a beta is below 1.
+    void reuse(Locations& previousLocations,
+               const std::vector<EdgeEdit>& previousEdits,
+               const std::vector<bool>& changedNodes);
+
     Graph_Ptr getGraph(void);
 
     NodeMap_Ptr getNodeMap(void);
@@ -55,14 +69,75 @@ class BetaSkeletonFilter {
 
     void perCountryBetaFilter();
 
+    // true if the angle prq is smaller than theta, the reference for the vector test of the filters
+    static bool testTheta(GeographicNode_Ptr& p, GeographicNode_Ptr& r, GeographicNode_Ptr& q, double theta);
+    // c is the known length of pq
+    static bool testTheta(GeographicNode_Ptr& p, GeographicNode_Ptr& r, GeographicNode_Ptr& q, double c, double theta);
+
    private:
-    bool isBetaSkeletonEdgeGreaterEqualThanOne(Graph::Edge& edge, double beta);
-    bool isBetaSkeletonEdgeSmallerThanOne(Graph::Node& u, Graph::Node& v, double beta);
-    bool testTheta(GeographicNode_Ptr& p, GeographicNode_Ptr& r, GeographicNode_Ptr& q, double theta);
+    // the angle a third node must not reach for a beta, computed once per country instead of per test
+    struct BetaThreshold {
+        double beta;
+        double theta;  /// < asin(1 / beta) for beta >= 1, pi - asin(beta) below
+        double cosTheta;
+
+        static BetaThreshold of(double beta);
+    };
+
+    // beta = 1, the angle of the diametral circle
+    static constexpr BetaThreshold GABRIEL{1.0, 0.5 * M_PI, 0.0};
+
+    typedef std::pair<Graph::Node, CityNode*> CountryNode;
+    typedef std::list<std::pair<Graph::Node, Graph::Node>> NodePairList;
+
+    void filterCountry(std::vector<CountryNode>& cities,
+                       const BetaThreshold& threshold,
+                       EdgeList& edges_to_delete,
+                       NodePairList& edges_to_add);
+    void filterCountryEdges(std::vector<CountryNode>& cities,
+                            const BetaThreshold& threshold,
+                            EdgeList& edges_to_delete);
+    void indexNodes();
+    bool isBetaSkeletonEdgeGreaterEqualThanOne(const Graph::Edge& edge, const BetaThreshold& threshold);
+    bool isGabrielEdge(const Graph::Edge& edge, const TriangulationEdge& triangulationEdge);
+    bool isBetaSkeletonEdgeSmallerThanOne(Graph::Node& u, Graph::Node& v, const BetaThreshold& threshold);
+    bool isSeaCableNode(Graph::Node n);
+
+    // testTheta from the unit vectors of the store, see GeometricHelpers::angleBelow. BM_AngleBelow of the benchmarks
+    // compares both.
+    bool angleBelow(Graph::Node p, Graph::Node r, Graph::Node q, const BetaThreshold& threshold);
+
+    // the previous decision if there is one, otherwise isBetaSkeletonEdgeGreaterEqualThanOne
+    bool keepEdge(const Graph::Edge& edge, const BetaThreshold& threshold);
 
     BaseTopology_Ptr _baseTopo;
     Graph_Ptr _graph;
     NodeMap_Ptr _nodeGeoNodeMap;
+    InternetUsageStatistics_Ptr _inetStat;
+
+    // betaSkeleton parameters
+    double _minBeta;
+    double _maxBeta;
+    bool _triangleNeighbors;
+    bool _countryEdges;  /// < beta >= 1 visits the edges inside a country instead of all city pairs
+
+    // node kinds by graph node id, the filters only remove and add edges
+    NodeStore_Ptr _store;
+
+    // position of each city in the list of its country, by graph node id, -1 for other nodes
+    std::vector<int> _positionInCountry;
+
+    // connected components of the graph, by graph node id
+    std::vector<int> _componentOf;
+    std::vector<std::vector<Graph::Node>> _components;
+
+    // positions of all graph nodes, _indexedNodes maps index positions to nodes
+    SphericalKDTree_Ptr _nodeIndex;
+    std::vector<Graph::Node> _indexedNodes;
+
+    // previous decisions by edge id
+    enum Decision : unsigned char { UNKNOWN, KEPT, ERASED };
+    std::vector<Decision> _known;
 };
 
 #endif  // BETASKELETONFILTER_HPP
@@ -31,18 +31,13 @@
 #define CGALPRIMITIVES_HPP
 
 #include <CGAL/Exact_predicates_inexact_constructions_kernel.h>
-#include <CGAL/Polyhedron_3.h>
 #include "geo/GeographicNode.hpp"
 #include <memory>
 
 typedef CGAL::Exact_predicates_inexact_constructions_kernel Kernel3;
-typedef CGAL::Polyhedron_3<Kernel3> Polyhedron_3;
 typedef Kernel3::Segment_3 Segment_3;
 typedef Kernel3::Point_3 Point_3;
 
-typedef std::map<Point_3, GeographicNode_Ptr> CityMap;
-typedef std::shared_ptr<CityMap> CityMap_Ptr;
-
 namespace CGALPrimitives {
 Point_3 createPoint(double lat, double lon);
 };
@@ -28,30 +28,34 @@
  */
 
 #include "DelaunayGraphCreator.hpp"
+#include "ShardedDelaunay.hpp"
+#include "SphericalDelaunay.hpp"
 #include "geo/CityNode.hpp"
 #include "geo/GeometricHelpers.hpp"
+#include "topo/NodeStore.hpp"
+#include <boost/log/trivial.hpp>
+#include <algorithm>
+#include <utility>
 #include <vector>
 #include <cassert>
 #include "geo/TriangulationEdge.hpp"
 
-DelaunayGraphCreator::DelaunayGraphCreator(Locations& cities)
+DelaunayGraphCreator::DelaunayGraphCreator(Locations& cities, Config_Ptr config)
     : _baseTopo(new BaseTopology),
       _graph(_baseTopo->getGraph()),
-      _nodeIDmap(new NodeIdMap),
-      _nodeGeoNodeMap(_baseTopo->getNodeMap()),
-      _sphereLocationMap(new LocationMap),
-      _cities(new CityMap),
-      _points(new PointVector) {
+      _sharded(config->get<bool>("delaunay.sharded")),
+      _shardMargin(config->get<double>("delaunay.shardMargin")),
+      _nodes(),
+      _points(new PointVector),
+      _changed() {
     using CGALPrimitives::createPoint;
 
-    for (Locations::iterator city = cities.begin(); city != cities.end(); ++city) {
-        Point_3 city_loc = createPoint((*city)->lat() + 90.0, (*city)->lon());
-        _cities->insert(std::make_pair(city_loc, *city));
-        _sphereLocationMap->insert(std::make_pair(*city, city_loc));
+    _nodes.reserve(cities.size());
+    _points->reserve(cities.size());
 
-        _points->push_back(city_loc);
-        Graph::Node u = _baseTopo->addNode(*city);
-        (*_nodeIDmap)[(*city)->id()] = u;
+    for (Locations::iterator city = cities.begin(); city != cities.end(); ++city) {
+        _points->push_back(createPoint((*city)->lat() + 90.0, (*city)->lon()));
+        _nodes.push_back(_baseTopo->addNode(*city));
     }
 }
 
@@ -59,23 +63,110 @@ DelaunayGraphCreator::~DelaunayGraphCreator() {
 }
 
 void DelaunayGraphCreator::create(void) {
-    std::unique_ptr<Polyhedron_3> _poly(new Polyhedron_3);
-
-    // compute convex hull of non-collinear points
-    CGAL::convex_hull_3(_points->begin(), _points->end(), *_poly);
-
-    for (auto it = _poly->edges_begin(); it != _poly->edges_end(); ++it) {
-        Point_3 u = it->vertex()->point();
-        Point_3 v = it->opposite()->vertex()->point();
-        int id_u = (*_cities)[u]->id();
-        int id_v = (*_cities)[v]->id();
-
-        Graph::Node n1 = (*_nodeIDmap)[id_u];
-        Graph::Node n2 = (*_nodeIDmap)[id_v];
-        GeographicEdge_Ptr edge_ptr(new TriangulationEdge);
-        _baseTopo->addEdge(n1, n2, edge_ptr);
-        assert(id_u != id_v);
+    std::vector<std::pair<unsigned int, unsigned int>> edges;
+    std::vector<std::pair<unsigned int, unsigned int>> opposite;
+
+    bool triangulated = false;
+    if (_sharded) {
+        std::unique_ptr<ShardedDelaunay> delaunay(new ShardedDelaunay(*_points, _shardMargin));
+        triangulated = delaunay->triangulate();
+        if (triangulated)
+            delaunay->edges(edges, opposite);
+        else
+            BOOST_LOG_TRIVIAL(warning) << "sharded delaunay triangulation incomplete, triangulating all points at once";
+    }
+
+    // the convex hull of the points on the sphere is their delaunay triangulation, the edge order only depends on it
+    if (!triangulated) {
+        std::unique_ptr<SphericalDelaunay> delaunay(new SphericalDelaunay(*_points));
+        delaunay->triangulate();
+        delaunay->edges(edges, opposite);
+    }
+
+    addEdges(edges, opposite);
+    _changed.assign(_nodes.size(), true);
+}
+
+void DelaunayGraphCreator::update(Locations& previousLocations, const std::vector<EdgeEdit>& previousEdits) {
+    using CGALPrimitives::createPoint;
+
+    PointVector previousPoints;
+    previousPoints.reserve(previousLocations.size());
+    for (GeographicNode_Ptr& location : previousLocations)
+        previousPoints.push_back(createPoint(location->lat() + 90.0, location->lon()));
+
+    // both triangles at every edge, counter-clockwise from the first to the second node
+    std::vector<SphericalDelaunay::Triangle> previousTriangles;
+    std::vector<bool> triangulated(previousLocations.size(), false);
+    for (const EdgeEdit& edit : previousEdits) {
+        TriangulationEdge* triangulationEdge = edgeCast<TriangulationEdge>(edit.geoEdge.get());
+        if (edit.erased || !triangulationEdge || !triangulationEdge->hasOpposite())
+            continue;
+
+        SphericalDelaunay::Triangle first = {{unsigned(edit.u), unsigned(edit.v),
+                                              unsigned(triangulationEdge->opposite(0))},
+                                             {-1, -1, -1}};
+        SphericalDelaunay::Triangle second = {{unsigned(edit.v), unsigned(edit.u),
+                                               unsigned(triangulationEdge->opposite(1))},
+                                              {-1, -1, -1}};
+        previousTriangles.push_back(first);
+        previousTriangles.push_back(second);
+        triangulated[edit.u] = triangulated[edit.v] = true;
     }
+
+    std::unique_ptr<ShardedDelaunay> delaunay(new ShardedDelaunay(*_points, _shardMargin));
+    if (!delaunay->update(previousPoints, previousTriangles)) {
+        BOOST_LOG_TRIVIAL(warning) << "delaunay update incomplete, triangulating all points again";
+        create();
+        return;
+    }
+
+    std::vector<std::pair<unsigned int, unsigned int>> edges;
+    std::vector<std::pair<unsigned int, unsigned int>> opposite;
+    delaunay->edges(edges, opposite);
+    addEdges(edges, opposite);
+    _changed = delaunay->changedPoints();
+
+    // the filters also depend on the kind and the country of a node and of its neighbours
+    std::vector<int> current(delaunay->match(previousPoints));
+    std::vector<bool> attributesChanged(_nodes.size(), false);
+    for (size_t i = 0; i < previousLocations.size(); ++i) {
+        if (!triangulated[i] || current[i] < 0)
+            continue;
+        GeographicNode* before = previousLocations[i].get();
+        GeographicNode* after = (*_baseTopo->getNodeMap())[_nodes[current[i]]].get();
+        CityNode* cityBefore = nodeCast<CityNode>(before);
+        CityNode* cityAfter = nodeCast<CityNode>(after);
+        if (NodeStore::kindOf(before) != NodeStore::kindOf(after) ||
+            (cityBefore && cityAfter && cityBefore->countryId() != cityAfter->countryId()))
+            attributesChanged[current[i]] = true;
+    }
+    for (size_t i = 0; i < _nodes.size(); ++i) {
+        if (!attributesChanged[i])
+            continue;
+        _changed[i] = true;
+        for (Graph::IncEdgeIt it(*_graph, _nodes[i]); it != lemon::INVALID; ++it)
+            _changed[_graph->id(_graph->oppositeNode(_nodes[i], it))] = true;
+    }
+
+    size_t changed = std::count(_changed.begin(), _changed.end(), true);
+    BOOST_LOG_TRIVIAL(info) << "delaunay update: " << changed << " of " << _nodes.size() << " nodes changed";
+}
+
+// the triangle vertices at each edge are kept for the gabriel filter
+void DelaunayGraphCreator::addEdges(const std::vector<std::pair<unsigned int, unsigned int>>& edges,
+                                    const std::vector<std::pair<unsigned int, unsigned int>>& opposite) {
+    for (size_t i = 0; i < edges.size(); ++i) {
+        auto& edge = edges[i];
+        assert(edge.first != edge.second);
+        GeographicEdge_Ptr edge_ptr(
+            new TriangulationEdge(_graph->id(_nodes[opposite[i].first]), _graph->id(_nodes[opposite[i].second])));
+        _baseTopo->addEdge(_nodes[edge.first], _nodes[edge.second], edge_ptr);
+    }
+}
+
+const std::vector<bool>& DelaunayGraphCreator::changedNodes(void) {
+    return _changed;
 }
 
 BaseTopology_Ptr DelaunayGraphCreator::getTopology(void) {
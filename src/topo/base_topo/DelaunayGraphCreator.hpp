@@ -32,39 +32,47 @@
 
 #include "BaseTopology.hpp"
 #include "CGALPrimitives.hpp"
+#include "config/Config.hpp"
 #include "topo/Graph.hpp"
-#include <CGAL/algorithm.h>
-#include <CGAL/convex_hull_3.h>
 #include <memory>
+#include <vector>
 
 class DelaunayGraphCreator {
    public:
-    DelaunayGraphCreator(Locations& cities);
+    DelaunayGraphCreator(Locations& cities, Config_Ptr config);
     DelaunayGraphCreator(const DelaunayGraphCreator& orig);
     virtual ~DelaunayGraphCreator();
 
     void create(void);
+
+    // same topology as create, starting from the triangulation recorded in the edits of a previous topology of
+    // previousLocations, whose node ids are their positions
+    void update(Locations& previousLocations, const std::vector<EdgeEdit>& previousEdits);
+
+    // by graph node id, the nodes whose incident triangles or attributes differ from the previous topology. All nodes
+    // are changed after create.
+    const std::vector<bool>& changedNodes(void);
+
     BaseTopology_Ptr getTopology(void);
 
    private:
+    void addEdges(const std::vector<std::pair<unsigned int, unsigned int>>& edges,
+                  const std::vector<std::pair<unsigned int, unsigned int>>& opposite);
+
     BaseTopology_Ptr _baseTopo;
     Graph_Ptr _graph;
 
-    typedef std::map<int, Graph::Node> NodeIdMap;
-    typedef std::shared_ptr<NodeIdMap> NodeIdMap_Ptr;
-    NodeIdMap_Ptr _nodeIDmap;
+    bool _sharded;        /// < delaunay.sharded
+    double _shardMargin;  /// < delaunay.shardMargin
 
-    NodeMap_Ptr _nodeGeoNodeMap;
-
-    typedef std::map<GeographicNode_Ptr, Point_3> LocationMap;
-    typedef std::shared_ptr<LocationMap> LocationMap_Ptr;
-    LocationMap_Ptr _sphereLocationMap;
-
-    CityMap_Ptr _cities;
+    // graph node and sphere point of every city, both in the order of the cities
+    std::vector<Graph::Node> _nodes;
 
     typedef std::vector<Point_3> PointVector;
     typedef std::shared_ptr<PointVector> PointVector_Ptr;
     PointVector_Ptr _points;
+
+    std::vector<bool> _changed;
 };
 
 #endif
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "FallbackProjection.hpp"
+#include <cmath>
+
+namespace {
+
+const double QUANTA_PER_DEGREE = 1e7;
+const size_t INITIAL_SLOTS = 64;
+
+}  // namespace
+
+FallbackProjection::FallbackProjection() : _slots(INITIAL_SLOTS, Entry{0, 0, -1}), _size(0) {
+}
+
+FallbackProjection::Entry FallbackProjection::quantize(const GeographicPositionTuple& coord) {
+    return Entry{std::llround(coord.first * QUANTA_PER_DEGREE), std::llround(coord.second * QUANTA_PER_DEGREE), -1};
+}
+
+// first slot that holds the coordinates or is empty
+size_t FallbackProjection::slot(int64_t lat, int64_t lon) const {
+    uint64_t hash = static_cast<uint64_t>(lat) * 0x9E3779B97F4A7C15ull;
+    hash ^= static_cast<uint64_t>(lon) * 0xC2B2AE3D27D4EB4Full;
+    size_t mask = _slots.size() - 1;
+    for (size_t i = (hash ^ (hash >> 29)) & mask;; i = (i + 1) & mask) {
+        const Entry& entry = _slots[i];
+        if (entry.node < 0 || (entry.lat == lat && entry.lon == lon))
+            return i;
+    }
+}
+
+int FallbackProjection::find(const GeographicPositionTuple& coord) const {
+    Entry key = quantize(coord);
+    return _slots[slot(key.lat, key.lon)].node;
+}
+
+bool FallbackProjection::insert(const GeographicPositionTuple& coord, int node) {
+    Entry entry = quantize(coord);
+    entry.node = node;
+    return insert(entry);
+}
+
+bool FallbackProjection::insert(const Entry& entry) {
+    Entry& target = _slots[slot(entry.lat, entry.lon)];
+    if (target.node >= 0)
+        return false;
+
+    target = entry;
+    ++_size;
+    if (2 * _size > _slots.size())
+        grow();
+    return true;
+}
+
+void FallbackProjection::assign(const GeographicPositionTuple& coord, int node) {
+    Entry entry = quantize(coord);
+    Entry& target = _slots[slot(entry.lat, entry.lon)];
+    if (target.node >= 0) {
+        target.node = node;
+        return;
+    }
+    entry.node = node;
+    insert(entry);
+}
+
+void FallbackProjection::grow(void) {
+    std::vector<Entry> entries(this->entries());
+    _slots.assign(2 * _slots.size(), Entry{0, 0, -1});
+    for (const Entry& entry : entries)
+        _slots[slot(entry.lat, entry.lon)] = entry;
+}
+
+void FallbackProjection::renumber(const std::function<int(int)>& renumbered) {
+    for (Entry& entry : _slots)
+        if (entry.node >= 0)
+            entry.node = renumbered(entry.node);
+}
+
+std::vector<FallbackProjection::Entry> FallbackProjection::entries(void) const {
+    std::vector<Entry> entries;
+    entries.reserve(_size);
+    for (const Entry& entry : _slots)
+        if (entry.node >= 0)
+            entries.push_back(entry);
+    return entries;
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef FALLBACKPROJECTION_HPP
+#define FALLBACKPROJECTION_HPP
+
+#include "geo/GeographicPosition.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Seacable coordinates that were merged into a landing point or city, mapped to the id of that node. Open addressing
+// hash map with linear probing on coordinates quantized to 1e-7 degrees (about 1 cm), coordinates closer than that
+// are the same.
+class FallbackProjection {
+   public:
+    struct Entry {
+        int64_t lat;  /// < quantized coordinates
+        int64_t lon;
+        int32_t node;  /// < -1 for an empty slot
+    };
+
+    FallbackProjection();
+
+    // id of the node coord was merged into, -1 if it was not merged
+    int find(const GeographicPositionTuple& coord) const;
+
+    // false if coord is already mapped
+    bool insert(const GeographicPositionTuple& coord, int node);
+    bool insert(const Entry& entry);
+
+    // maps coord to node, also if it is mapped already
+    void assign(const GeographicPositionTuple& coord, int node);
+
+    // replaces every node id by renumbered(id)
+    void renumber(const std::function<int(int)>& renumbered);
+
+    size_t size(void) const { return _size; }
+
+    // the mapped entries in slot order, for the stage cache
+    std::vector<Entry> entries(void) const;
+
+   private:
+    static Entry quantize(const GeographicPositionTuple& coord);
+    size_t slot(int64_t lat, int64_t lon) const;
+    void grow(void);
+
+    std::vector<Entry> _slots;  /// < a power of two of them, at most half are used
+    size_t _size;
+};
+
+#endif  // FALLBACKPROJECTION_HPP
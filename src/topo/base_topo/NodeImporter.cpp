@@ -29,42 +29,105 @@
 
 #include "config/Config.hpp"
 #include "config/PredefinedValues.hpp"
+#include "db/ImportedData.hpp"
 #include "db/InternetUsageStatistics.hpp"
-#include "db/LandingPointReader.hpp"
-#include "db/SQLiteLocationReader.hpp"
-#include "db/SQLiteLocationReader.hpp"
 #include "db/SubmarineCable.hpp"
 #include "geo/CityNode.hpp"
 #include "geo/GeographicNode.hpp"
 #include "geo/GeometricHelpers.hpp"
+#include "geo/HilbertCurve.hpp"
 #include "geo/SeaCableLandingPoint.hpp"
 #include "geo/SeaCableNode.hpp"
 #include "NodeImporter.hpp"
+#include "util/CounterRNG.hpp"
+#include "util/StringInterner.hpp"
+#include "util/ThreadPool.hpp"
 #include "geo/SeaCableEdge.hpp"
+#include <algorithm>
+#include <cmath>
 #include <fstream>
 #include <string>
-#include <random>
+#include <unordered_map>
+#include <unordered_set>
 #include <cassert>
 #include <boost/log/trivial.hpp>
 
-NodeImporter::NodeImporter(void)
-    : _nodenumber(0), _locations(new Locations), _dbFilename(PredefinedValues::dbFilePath()), _fallbackProjection() {
+NodeImporter::NodeImporter(InternetUsageStatistics_Ptr inetStat, ImportedData_Ptr importedData, Config_Ptr config)
+    : _nodenumber(0),
+      _inputNodePath(config->get<std::string>("debug.inputNodePath")),
+      _arena(),
+      _locations(new Locations),
+      _index(),
+      _inetStat(inetStat),
+      _importedData(importedData),
+      _fallbackProjection() {
 }
 
 void NodeImporter::addNode(GeographicNode_Ptr node) {
     _locations->push_back(node);
+
+    if (_index) {
+        GeographicPosition pos(node->lat(), node->lon());
+        _index->insert(pos);
+    }
+}
+
+// (re)build the index from the current locations, which the OPTICS filter rewrites after city import
+void NodeImporter::indexLocations(void) {
+    _index = SphericalKDTree_Ptr(new SphericalKDTree(*_locations));
 }
 
 Locations_Ptr NodeImporter::getLocations(void) {
     return _locations;
 }
 
+int NodeImporter::nodeNumber(void) {
+    return _nodenumber;
+}
+
+const FallbackProjection& NodeImporter::fallbackProjection(void) {
+    return _fallbackProjection;
+}
+
+// the locations vector keeps its identity, callers may hold it from getLocations
+void NodeImporter::restore(const Locations& locations, int nodeNumber, const FallbackProjection& fallbackProjection) {
+    *_locations = locations;
+    _nodenumber = nodeNumber;
+    _fallbackProjection = fallbackProjection;
+    _index.reset();
+}
+
+NodeImporter_Ptr NodeImporter::copy(void) {
+    NodeImporter_Ptr other(new NodeImporter(*this));
+    other->_arena = NodeArena();
+    other->_locations = Locations_Ptr(new Locations);
+    other->_locations->reserve(_locations->size());
+    other->_index.reset();
+
+    for (GeographicNode_Ptr& node : *_locations) {
+        switch (node->kind()) {
+            case CityNode::KIND:
+                other->_locations->push_back(other->_arena.make<CityNode>(*nodeCast<CityNode>(node.get())));
+                break;
+            case SeaCableLandingPoint::KIND:
+                other->_locations->push_back(
+                    other->_arena.make<SeaCableLandingPoint>(*nodeCast<SeaCableLandingPoint>(node.get())));
+                break;
+            case SeaCableNode::KIND:
+                other->_locations->push_back(other->_arena.make<SeaCableNode>(*nodeCast<SeaCableNode>(node.get())));
+                break;
+            default:
+                assert(false);
+        }
+    }
+    return other;
+}
+
 void NodeImporter::importCitiesFromFile(void) {
     /*
       ASSUME TOPOVIEW MAP EXPORT FILE FORMAT [STR , LAT , LON]
     */
-    std::unique_ptr<Config> config(new Config);
-    std::ifstream inputFile((config->get<std::string>("debug.inputNodePath")).c_str());
+    std::ifstream inputFile(_inputNodePath.c_str());
     assert(inputFile.good());
 
     std::string line;
@@ -83,8 +146,7 @@ void NodeImporter::importCitiesFromFile(void) {
         // create node from scratch
         CityNode ci(_nodenumber, std::to_string(_nodenumber), lat, lon, 0.0, "United States");
         ++_nodenumber;
-        GeographicNode_Ptr np(new CityNode(ci));
-        addNode(np);
+        addNode(_arena.make<CityNode>(ci));
     }
 }
 
@@ -92,203 +154,226 @@ void NodeImporter::importCities(const std::string& seedString) {
     /*
       READ CITY POSITIONS ON EARTH SURFACE
     */
-    Config_Ptr config(new Config);
-
-    Config_Ptr cityFilterConfig(config->subConfig("cityfilter"));
-    int populationThreshold = cityFilterConfig->get<int>("citysizethreshold");
-
-    auto lr = std::make_shared<SQLiteLocationReader>(_dbFilename, populationThreshold);
-
-    typedef std::map<std::string, std::vector<CityNode>> CountryMap;
-    std::unique_ptr<CountryMap> countries(new CountryMap);
-
-    while (lr->hasNext()) {
-        CityNode next = lr->getNext();
-        (*countries)[next.country()].push_back(next);
-    }
-
-    std::unique_ptr<InternetUsageStatistics> stat(new InternetUsageStatistics(_dbFilename));
-
-    typedef std::mt19937_64 RNG;
-    std::seed_seq seed(seedString.begin(), seedString.end());
-    std::unique_ptr<RNG> randGen(new RNG);
-    randGen->seed(seed);
-    std::uniform_real_distribution<double> dist(0.0, 1.0);
-
-    // filter cities
-    for (auto country : *countries) {
-        std::string countryName = country.first;
-        auto& cityVec = country.second;
-        double percentInetUsers = (*stat)[countryName] / 100.0;
-
-        for (auto city : cityVec)
-            if (dist(*randGen) <= percentInetUsers) {
-                city.setId(_nodenumber);
+    // cities grouped by interned country id
+    const std::vector<std::vector<CityNode>>& countries = _importedData->citiesByCountry();
+
+    // countries are visited by name to keep the numbers independent of the intern order, a city draws the number
+    // of its country rank and its position in the country
+    std::vector<unsigned> countryIds;
+    for (unsigned countryId : Interned::countries().sortedIds())
+        if (countryId < countries.size())
+            countryIds.push_back(countryId);
+
+    // the keep decisions are independent of each other, the nodes are numbered in country order afterwards
+    CounterRNG rng(seedString);
+    std::vector<std::vector<char>> keep(countryIds.size());
+    ThreadPool_Ptr pool(ThreadPool::fromConfig());
+    pool->forEach(countryIds.size(), [&](size_t rank) {
+        const std::vector<CityNode>& cityVec = countries[countryIds[rank]];
+        double percentInetUsers = (*_inetStat)[countryIds[rank]] / 100.0;
+
+        keep[rank].resize(cityVec.size());
+        for (size_t i = 0; i < cityVec.size(); ++i) {
+            uint64_t entity = (static_cast<uint64_t>(rank) << 32) | i;
+            keep[rank][i] = rng.uniform(CounterRNG::CITY_SAMPLING, entity) <= percentInetUsers;
+        }
+    });
+
+    for (size_t rank = 0; rank < countryIds.size(); ++rank) {
+        const std::vector<CityNode>& cityVec = countries[countryIds[rank]];
+        for (size_t i = 0; i < cityVec.size(); ++i)
+            if (keep[rank][i]) {
+                std::shared_ptr<CityNode> np(_arena.make<CityNode>(cityVec[i]));
+                np->setId(_nodenumber);
                 ++_nodenumber;
-                GeographicNode_Ptr np(new CityNode(city));
                 addNode(np);
             }
     }
 }
 
-GeographicNode_Ptr NodeImporter::findNearest(GeographicNode_Ptr& node) {
-    GeographicNode_Ptr nearest = nullptr;
-    double currentDist = std::numeric_limits<double>::max();
-    for (auto otherNode : *_locations) {
-        double dist = GeometricHelpers::sphericalDist(node, otherNode);
-        if (dist < currentDist) {
-            nearest = otherNode;
-            currentDist = dist;
-        }
-    }
-    return nearest;
+GeographicNode_Ptr NodeImporter::findNearest(GeographicPosition& position) {
+    if (!_index)
+        indexLocations();
+    assert(_index->size() == _locations->size());
+
+    if (_locations->empty())
+        return nullptr;
+
+    return (*_locations)[_index->nearest(position).index];
 }
 
 void NodeImporter::importSeacableLandingPoints() {
-    // add submarine cable landingpoints
-    std::unique_ptr<LandingPointReader> lpr(new LandingPointReader(_dbFilename));
+    indexLocations();
 
-    while (lpr->hasNext()) {
-        SeaCableLandingPoint next = lpr->getNext();
+    // add submarine cable landingpoints
+    for (const SeaCableLandingPoint& landingPoint : _importedData->landingPoints()) {
+        SeaCableLandingPoint next(landingPoint);
         next.setId(_nodenumber);
         ++_nodenumber;
-        GeographicNode_Ptr lp(new SeaCableLandingPoint(next));
+        GeographicNode_Ptr lp(_arena.make<SeaCableLandingPoint>(next));
 
         // find nearest node
-        GeographicNode_Ptr nnP = findNearest(lp);
+        GeographicPosition position(lp->lat(), lp->lon());
+        GeographicNode_Ptr nnP = findNearest(position);
         double dist = GeometricHelpers::sphericalDist(lp, nnP);
         if (dist > NodeImporter::DIST_TRESHOLD)
             addNode(lp);
         else {
-            CityNode* cnp = dynamic_cast<CityNode*>(nnP.get());
+            CityNode* cnp = nodeCast<CityNode>(nnP.get());
             if (cnp)
                 cnp->setSeaCableLandingPoint();
         }
     }
 }
 
-void NodeImporter::importSubmarineCableEdgesWaypoints() {
-    std::unique_ptr<SubmarineCable> sc(new SubmarineCable(_dbFilename));
+void NodeImporter::importWaypoint(const GeographicPositionTuple& coord) {
+    int id = _nodenumber;
+    ++_nodenumber;
+
+    // find nearest node
+    GeographicPosition position(coord.first, coord.second);
+    GeographicNode_Ptr nearestNode = findNearest(position);
+
+    SeaCableLandingPoint* slp = nodeCast<SeaCableLandingPoint>(nearestNode.get());
+    CityNode* cnp = nodeCast<CityNode>(nearestNode.get());
+
+    GeographicPosition nearestPosition(nearestNode->lat(), nearestNode->lon());
+    double dist = GeometricHelpers::sphericalDist(position, nearestPosition);
+    if (!((slp || (cnp && cnp->isSeaCableLandingPoint())) && dist < NodeImporter::DIST_TRESHOLD)) {
+        addNode(_arena.make<SeaCableNode>(id, coord.first, coord.second));
+        // a node closer than the landing point took its place, the coordinates end in the new node from now on
+        if (_fallbackProjection.find(coord) >= 0)
+            _fallbackProjection.assign(coord, id);
+    } else {
+        _fallbackProjection.insert(coord, nearestNode->id());
+    }
+}
 
-    while (sc->hasNext()) {
-        SubmarineCableEdge edge = sc->getNext();
+void NodeImporter::importSubmarineCableEdgesWaypoints() {
+    for (const SubmarineCableEdge& edge : _importedData->submarineCableEdges()) {
         if (edge.coord1 == edge.coord2)
             continue;
 
-        GeographicNode_Ptr n1(new SeaCableNode(_nodenumber, edge.coord1.first, edge.coord1.second));
-        ++_nodenumber;
-        // find nearest node
-        GeographicNode_Ptr nearestNode = findNearest(n1);
-
-        SeaCableLandingPoint* slp = dynamic_cast<SeaCableLandingPoint*>(nearestNode.get());
-        CityNode* cnp = dynamic_cast<CityNode*>(nearestNode.get());
-
-        GeographicNode_Ptr nnP(new GeographicNode(*nearestNode));
-        double dist = GeometricHelpers::sphericalDist(n1, nnP);
-        if (!((slp || (cnp && cnp->isSeaCableLandingPoint())) && dist < NodeImporter::DIST_TRESHOLD))
-            addNode(n1);
-        else {
-            auto rtn = _fallbackProjection.insert(std::make_pair(edge.coord1, nearestNode->coord()));
-            assert(rtn.second == false || _fallbackProjection.at(edge.coord1) == nearestNode->coord());
-        }
-
-        GeographicNode_Ptr n2(new SeaCableNode(_nodenumber, edge.coord2.first, edge.coord2.second));
-        ++_nodenumber;
-        // find nearest node
-        nearestNode = findNearest(n2);
-        slp = dynamic_cast<SeaCableLandingPoint*>(nearestNode.get());
-        cnp = dynamic_cast<CityNode*>(nearestNode.get());
-        nnP = GeographicNode_Ptr(new GeographicNode(*nearestNode));
-        dist = GeometricHelpers::sphericalDist(n2, nnP);
-        if (!((slp || (cnp && cnp->isSeaCableLandingPoint())) && dist < NodeImporter::DIST_TRESHOLD))
-            addNode(n2);
-        else {
-            auto rtn = _fallbackProjection.insert(std::make_pair(edge.coord2, nearestNode->coord()));
-            assert(rtn.second == false || _fallbackProjection.at(edge.coord2) == nearestNode->coord());
-        }
+        importWaypoint(edge.coord1);
+        importWaypoint(edge.coord2);
     }
 }
 
-void NodeImporter::importSubmarineCableEdges(BaseTopology_Ptr base_topo) {
-    // add submarine cables waypoints
-    std::unique_ptr<SubmarineCable> sc(new SubmarineCable(_dbFilename));
-
-    unsigned int skipped = 0;
-
-    int lastLinkID = -1;
-    GeographicPositionTuple posFirst;
-    GeographicPositionTuple posLast;
-    std::vector<GeographicNode_Ptr> edgePositions;
-
-    while (sc->hasNext()) {
-        SubmarineCableEdge edge = sc->getNext();
+// the index refers to positions in _locations, it is rebuilt on the next query
+void NodeImporter::sortLocations(void) {
+    HilbertCurve::sort(*_locations);
+    _index.reset();
+}
 
-        if (edge.coord1 == edge.coord2) {
-            ++skipped;
-            continue;
+// pieces of a cable that the database splits at the antimeridian end in nodes less than a degree from it and a few km
+// apart. -180 and 180 are the same meridian there, so the nodes are hashed by their snapped latitude only, nodes
+// closer than the stitch distance lie in the same or in neighbouring cells.
+void NodeImporter::stitchAntimeridian(BaseTopology_Ptr base_topo, int linkID, const Locations& endpoints) {
+    const double CELL = STITCH_DISTANCE_KM / GeometricHelpers::EARTH_RADIUS_KM * 180.0 / M_PI;
+
+    std::unordered_map<long, std::vector<size_t>> cells;
+    for (size_t i = 0; i < endpoints.size(); ++i)
+        if (fabs(fabs(endpoints[i]->lon()) - 180.0) < 1.0)
+            cells[static_cast<long>(std::floor(endpoints[i]->lat() / CELL))].push_back(i);
+
+    // positions in endpoints, the node with the smaller id first
+    std::vector<std::pair<size_t, size_t>> pieces;
+    for (auto& cell : cells)
+        for (long neighbour = cell.first - 1; neighbour <= cell.first + 1; ++neighbour) {
+            auto other = cells.find(neighbour);
+            if (other == cells.end())
+                continue;
+            for (size_t i : cell.second)
+                for (size_t j : other->second) {
+                    GeographicNode_Ptr n1 = endpoints[i];
+                    GeographicNode_Ptr n2 = endpoints[j];
+                    if (n2->id() > n1->id() &&
+                        GeometricHelpers::sphericalDistToKM(GeometricHelpers::sphericalDist(n1, n2)) <
+                            STITCH_DISTANCE_KM)
+                        pieces.push_back(std::make_pair(i, j));
+                }
         }
 
-        if(edge.linkID != lastLinkID) {
-            for(GeographicNode_Ptr n1 : edgePositions) {
-                bool n1OK = fabs(fabs(n1->lon()) - 180.0) < 1.0;
+    // edges in the order of the endpoints, independent of the hashing
+    std::sort(pieces.begin(), pieces.end());
+    for (auto& piece : pieces) {
+        Graph::Node u = base_topo->getGraph()->nodeFromId(endpoints[piece.first]->id());
+        Graph::Node v = base_topo->getGraph()->nodeFromId(endpoints[piece.second]->id());
+        if (lemon::findEdge(*base_topo->getGraph(), u, v) != lemon::INVALID)
+            continue;
 
-                for(GeographicNode_Ptr n2 : edgePositions) {
-                    if(n1 == n2 || n2->id() < n1->id())
-                        continue;
+        GeographicEdge_Ptr edge_ptr(new SeaCableEdge);
+        base_topo->addEdge(u, v, edge_ptr);
+        BOOST_LOG_TRIVIAL(info) << "Add extra edge on link:" << linkID << " (" << endpoints[piece.first]->id() << ","
+                                << endpoints[piece.second]->id() << ")";
+    }
+}
 
-                    bool n2OK = fabs(fabs(n2->lon()) - 180.0) < 1.0;
+// the projection refers to the node ids before, so it is renumbered with them
+void NodeImporter::assignNodeIds(void) {
+    std::unordered_map<int, int> ids;
+    ids.reserve(_locations->size());
+    for (size_t i = 0; i < _locations->size(); ++i) {
+        GeographicNode_Ptr& node = (*_locations)[i];
+        ids[node->id()] = i;
+        node->setId(i);
+    }
+    _fallbackProjection.renumber([&ids](int id) { return ids.at(id); });
+}
 
-                    if(n1OK && n2OK && GeometricHelpers::sphericalDistToKM(GeometricHelpers::sphericalDist(n1, n2)) < 4) {
-                        Graph::Node u;
-                        Graph::Node v;
+// a node the coordinates were merged into, nearest node otherwise
+GeographicNode_Ptr NodeImporter::endpoint(const GeographicPositionTuple& coord) {
+    int projected = _fallbackProjection.find(coord);
+    if (projected >= 0) {
+        assert((*_locations)[projected]->id() == projected);
+        return (*_locations)[projected];
+    }
 
-                        u = base_topo->getGraph()->nodeFromId(n1->id());
-                        v = base_topo->getGraph()->nodeFromId(n2->id());
+    GeographicPosition position(coord.first, coord.second);
+    return findNearest(position);
+}
 
-                        if(lemon::findEdge(*base_topo->getGraph(), u, v) != lemon::INVALID)
-                            continue;
+void NodeImporter::importSubmarineCableEdges(BaseTopology_Ptr base_topo) {
+    // add submarine cables waypoints
+    unsigned int skipped = 0;
 
-                        GeographicEdge_Ptr edge_ptr(new SeaCableEdge);
-                        assert(u != v);
-                        base_topo->addEdge(u, v, edge_ptr);
-                        BOOST_LOG_TRIVIAL(info) << "Add extra edge on link:" << edge.linkID << " (" << n1->id() << "," << n2->id() << ")";
-                    }
-                }
+    const std::vector<SubmarineCableEdge>& edges = _importedData->submarineCableEdges();
+    for (const SubmarineCableSegments& cable : _importedData->submarineCables()) {
+        // the nodes the cable ends in, each once in order of appearance
+        Locations endpoints;
+        std::unordered_set<GeographicNode*> seen;
+
+        for (size_t i = cable.begin; i < cable.end; ++i) {
+            const SubmarineCableEdge& edge = edges[i];
+            if (edge.coord1 == edge.coord2) {
+                ++skipped;
+                continue;
             }
-            edgePositions.clear();
-            lastLinkID = edge.linkID;
-        }
-
-        GeographicPositionTuple c1 = std::make_pair(edge.coord1.first, edge.coord1.second);
-        GeographicPositionTuple c2 = std::make_pair(edge.coord2.first, edge.coord2.second);
-
-        if (_fallbackProjection.find(c1) != _fallbackProjection.end())
-            c1 = _fallbackProjection.at(c1);
-        if (_fallbackProjection.find(c2) != _fallbackProjection.end())
-            c2 = _fallbackProjection.at(c2);
-        if (c1 == c2) {
-            ++skipped;
-            continue;
-        }
 
-        GeographicNode_Ptr c1N(new GeographicNode(500, edge.coord1.first, edge.coord1.second));
-        GeographicNode_Ptr c2N(new GeographicNode(500, edge.coord2.first, edge.coord2.second));
+            // endpoints merged into the same node
+            GeographicNode_Ptr n1 = endpoint(edge.coord1);
+            GeographicNode_Ptr n2 = endpoint(edge.coord2);
+            if (n1 == n2) {
+                ++skipped;
+                continue;
+            }
 
-        GeographicNode_Ptr n1 = findNearest(c1N);
-        GeographicNode_Ptr n2 = findNearest(c2N);
+            if (seen.insert(n1.get()).second)
+                endpoints.push_back(n1);
+            if (seen.insert(n2.get()).second)
+                endpoints.push_back(n2);
 
-        edgePositions.push_back(n1);
-        edgePositions.push_back(n2);
+            Graph::Node u;
+            Graph::Node v;
 
-        Graph::Node u;
-        Graph::Node v;
+            u = base_topo->getGraph()->nodeFromId(n1->id());
+            v = base_topo->getGraph()->nodeFromId(n2->id());
 
-        u = base_topo->getGraph()->nodeFromId(n1->id());
-        v = base_topo->getGraph()->nodeFromId(n2->id());
+            GeographicEdge_Ptr edge_ptr(new SeaCableEdge);
+            base_topo->addEdge(u, v, edge_ptr);
+        }
 
-        GeographicEdge_Ptr edge_ptr(new SeaCableEdge);
-        assert(u != v);
-        base_topo->addEdge(u, v, edge_ptr);
+        stitchAntimeridian(base_topo, cable.linkID, endpoints);
     }
 
     BOOST_LOG_TRIVIAL(info) << "SubmarineCables: Skipped " << skipped
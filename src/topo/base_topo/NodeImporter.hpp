@@ -30,17 +30,27 @@
 #ifndef NODEIMPORTER_HPP
 #define NODEIMPORTER_HPP
 
+#include "config/Config.hpp"
+#include "db/ImportedData.hpp"
+#include "db/InternetUsageStatistics.hpp"
 #include "geo/CityNode.hpp"
 #include "geo/GeographicNode.hpp"
 #include "geo/GeographicPosition.hpp"
+#include "geo/NodeArena.hpp"
 #include "geo/SeaCableLandingPoint.hpp"
 #include "geo/SeaCableNode.hpp"
+#include "geo/SphericalKDTree.hpp"
 #include "topo/base_topo/BaseTopology.hpp"
+#include "topo/base_topo/FallbackProjection.hpp"
 #include <memory>
 
+class NodeImporter;
+typedef std::shared_ptr<NodeImporter> NodeImporter_Ptr;
+
 class NodeImporter {
    public:
-    NodeImporter(void);
+    // importedData may be shared with other importers, it is only read
+    NodeImporter(InternetUsageStatistics_Ptr inetStat, ImportedData_Ptr importedData, Config_Ptr config);
 
     void importCitiesFromFile(void);
     void importCities(const std::string& seed);
@@ -48,25 +58,51 @@ class NodeImporter {
     void importSeacableLandingPoints();
     void importSubmarineCableEdgesWaypoints();
 
+    // sorts the locations along a hilbert curve, before the node ids are assigned
+    void sortLocations(void);
+
+    // node ids 0 to n - 1 in location order, the graph ids of the triangulation and everything after it
+    void assignNodeIds(void);
+
     Locations_Ptr getLocations(void);
 
     void addNode(GeographicNode_Ptr node);
 
     void importSubmarineCableEdges(BaseTopology_Ptr base_topo);
 
+    // import state for the stage cache
+    int nodeNumber(void);
+    const FallbackProjection& fallbackProjection(void);
+    void restore(const Locations& locations, int nodeNumber, const FallbackProjection& fallbackProjection);
+
+    // an importer with copies of the imported nodes, for a run that changes them while other runs read these
+    NodeImporter_Ptr copy(void);
+
    protected:
    private:
-    GeographicNode_Ptr findNearest(GeographicNode_Ptr& node);
+    GeographicNode_Ptr findNearest(GeographicPosition& position);
+    GeographicNode_Ptr endpoint(const GeographicPositionTuple& coord);
+    void indexLocations(void);
+    void importWaypoint(const GeographicPositionTuple& coord);
+    void stitchAntimeridian(BaseTopology_Ptr base_topo, int linkID, const Locations& endpoints);
 
     int _nodenumber;
+    std::string _inputNodePath;  /// < debug.inputNodePath
+
+    // storage of the imported nodes
+    NodeArena _arena;
 
     Locations_Ptr _locations;
 
-    std::string _dbFilename;
+    // nearest neighbour index over _locations, kept up to date by addNode once built
+    SphericalKDTree_Ptr _index;
+
+    InternetUsageStatistics_Ptr _inetStat;
+    ImportedData_Ptr _importedData;
     static double constexpr DIST_TRESHOLD = 0.0005;
+    static double constexpr STITCH_DISTANCE_KM = 4.0;
 
-    std::map<GeographicPositionTuple, GeographicPositionTuple>
-        _fallbackProjection;  // quick hack: ensure correct placement of seacable nodes
+    FallbackProjection _fallbackProjection;  // quick hack: ensure correct placement of seacable nodes
 };
 
 #endif  // NODEIMPORTER_HPP
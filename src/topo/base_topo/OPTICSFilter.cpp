@@ -31,9 +31,10 @@
 
 #include "config/Config.hpp"
 #include "geo/GeometricHelpers.hpp"
+#include "util/CounterRNG.hpp"
+#include "util/ThreadPool.hpp"
 #include <algorithm>
 #include <cassert>
-#include <random>
 
 OPTICSFilter::OPTICSFilter(Locations_Ptr& locations, double eps, unsigned int minPts, double epsDBSCAN)
     : _locations(locations),
@@ -42,97 +43,138 @@ OPTICSFilter::OPTICSFilter(Locations_Ptr& locations, double eps, unsigned int mi
       _epsDBSCAN(epsDBSCAN),
       _opticsObjects(),
       _unprocessedObjects(),
-      _orderedObjects() {
+      _orderedObjects(),
+      _indexedObjects(),
+      _index(),
+      _neighborOffsets(),
+      _neighbors() {
     for (GeographicNode_Ptr& node : *_locations) {
         auto opticsObj = OPTICSObject_Ptr(new OPTICSObject(node));
         _opticsObjects.insert(std::make_pair(node->id(), opticsObj));
         _unprocessedObjects.push_back(opticsObj);
     }
+
+    // index nodes in id order, so neighbor queries report objects in the same order as _opticsObjects
+    Locations indexedNodes;
+    for (auto opticsObjectPair : _opticsObjects) {
+        opticsObjectPair.second->index = _indexedObjects.size();
+        _indexedObjects.push_back(opticsObjectPair.second);
+        indexedNodes.push_back(opticsObjectPair.second->node);
+    }
+    _index = SphericalKDTree_Ptr(new SphericalKDTree(indexedNodes));
 }
 
-OPTICSFilter::OPTICSObjectVector_Ptr OPTICSFilter::getEpsilonNeighbors(OPTICSObject_Ptr primaryObject) {
-    OPTICSObjectVector_Ptr epsilonNeighbors(new OPTICSObjectVector);
+void OPTICSFilter::computeNeighborhoods(void) {
+    assert(_minPts > 0);
+    const size_t BLOCK_SIZE = 256;
+    size_t n = _indexedObjects.size();
+    size_t blocks = (n + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+    // neighborhoods and core distances do not depend on the cluster order, each block fills its own rows
+    std::vector<std::vector<unsigned int>> blockNeighbors(blocks);
+    std::vector<unsigned int> rowSizes(n, 0);
+
+    ThreadPool_Ptr pool(ThreadPool::fromConfig());
+    pool->forEach(blocks, [&](size_t block) {
+        std::vector<SphericalKDTree::Neighbor> neighbors;
+        std::vector<double> distances;
+        size_t end = std::min(n, (block + 1) * BLOCK_SIZE);
+        for (size_t i = block * BLOCK_SIZE; i < end; ++i) {
+            OPTICSObject& obj = *_indexedObjects[i];
+            GeographicPosition center(obj.node->lat(), obj.node->lon());
+            _index->radiusSearch(center, _eps, neighbors);
+
+            distances.clear();
+            for (SphericalKDTree::Neighbor& neighbor : neighbors) {
+                if (neighbor.index == i)
+                    continue;
+                blockNeighbors[block].push_back(neighbor.index);
+                distances.push_back(neighbor.distance);
+            }
+            rowSizes[i] = distances.size();
 
-    for (auto opticsObjectPair : _opticsObjects) {
-        OPTICSObject_Ptr obj = opticsObjectPair.second;
-        if (obj->node->id() == primaryObject->node->id())
-            continue;
+            // only the _minPts-th smallest distance is needed
+            if (distances.size() >= _minPts) {
+                std::nth_element(distances.begin(), distances.begin() + (_minPts - 1), distances.end());
+                obj.coreDistance = distances[_minPts - 1];
+            }
+        }
+    });
 
-        obj->tmpDistance = GeometricHelpers::sphericalDist(primaryObject->node, obj->node);
+    _neighborOffsets.assign(n + 1, 0);
+    for (size_t i = 0; i < n; ++i)
+        _neighborOffsets[i + 1] = _neighborOffsets[i] + rowSizes[i];
 
-        if (obj->tmpDistance <= _eps)
-            epsilonNeighbors->push_back(obj);
+    _neighbors.clear();
+    _neighbors.reserve(_neighborOffsets[n]);
+    for (std::vector<unsigned int>& rows : blockNeighbors) {
+        _neighbors.insert(_neighbors.end(), rows.begin(), rows.end());
+        std::vector<unsigned int>().swap(rows);
     }
+    assert(_neighbors.size() == _neighborOffsets[n]);
+}
 
-    if (epsilonNeighbors->size() >= _minPts) {
-        std::sort(epsilonNeighbors->begin(), epsilonNeighbors->end(), OPTICSFilter::compareOPTICSObjectsTmp);
-        primaryObject->coreDistance = (*epsilonNeighbors)[_minPts - 1]->tmpDistance;
-    }
+void OPTICSFilter::updateSeeds(unsigned int centerObject, IndexedHeap& seeds) {
+    OPTICSObject_Ptr& center = _indexedObjects[centerObject];
+    double coreDistance = center->coreDistance;
+    // the index holds the objects in the same order, with the cosines of their latitudes
+    const GeometricHelpers::CachedPosition& centerPosition = _index->position(centerObject);
+    for (unsigned int k = _neighborOffsets[centerObject]; k < _neighborOffsets[centerObject + 1]; ++k) {
+        unsigned int other = _neighbors[k];
+        OPTICSObject_Ptr& otherObject = _indexedObjects[other];
+        if (otherObject->processed)
+            continue;
 
-    return epsilonNeighbors;
-}
+        assert(center->node);
+        assert(otherObject->node);
+
+        double directDistance = GeometricHelpers::sphericalDist(centerPosition, _index->position(other));
+        double newReachabilityDistance = std::max(coreDistance, directDistance);
 
-void OPTICSFilter::updateSeeds(OPTICSObjectVector_Ptr neighbors,
-                               OPTICSObject_Ptr centerObject,
-                               OPTICSObjectVector_Ptr seeds) {
-    double coreDistance = centerObject->coreDistance;
-    for (OPTICSObject_Ptr& otherObject : *neighbors) {
-        if (otherObject->processed == false) {
-            assert(centerObject->node);
-            assert(otherObject->node);
-
-            double directDistance = GeometricHelpers::sphericalDist(centerObject->node, otherObject->node);
-            double newReachabilityDistance = std::max(coreDistance, directDistance);
-
-            if (otherObject->reachabilityDistance == UNDEFINED_DISTANCE) {
-                otherObject->reachabilityDistance = newReachabilityDistance;
-                seeds->push_back(otherObject);
-            } else if (newReachabilityDistance < otherObject->reachabilityDistance)
-                otherObject->reachabilityDistance = newReachabilityDistance;
+        if (otherObject->reachabilityDistance == UNDEFINED_DISTANCE) {
+            otherObject->reachabilityDistance = newReachabilityDistance;
+            seeds.push(other, newReachabilityDistance);
+        } else if (newReachabilityDistance < otherObject->reachabilityDistance) {
+            otherObject->reachabilityDistance = newReachabilityDistance;
+            seeds.decrease(other, newReachabilityDistance);
         }
     }
-    std::sort(seeds->begin(), seeds->end(), OPTICSFilter::compareOPTICSObjects);
 }
 
-void OPTICSFilter::expandClusterOrder(OPTICSObject_Ptr node) {
-    OPTICSObjectVector_Ptr epsilonNeighbors = getEpsilonNeighbors(node);
+void OPTICSFilter::expandClusterOrder(unsigned int object, IndexedHeap& seeds) {
+    assert(seeds.empty());
+    OPTICSObject_Ptr& node = _indexedObjects[object];
     node->processed = true;
 
     // output p to the ordered list
     _orderedObjects.push_back(node);
 
-    OPTICSObjectVector_Ptr seeds(new OPTICSObjectVector);
-    if (node->coreDistance != UNDEFINED_DISTANCE) {
-        updateSeeds(epsilonNeighbors, node, seeds);
+    if (node->coreDistance == UNDEFINED_DISTANCE)
+        return;
 
-        while (!seeds->empty()) {
-            OPTICSObject_Ptr currentObject = seeds->back();
-            seeds->pop_back();
+    // every object enters the seeds once and leaves them unprocessed, as objects seen by an earlier expansion
+    // were processed when their seeds ran empty
+    updateSeeds(object, seeds);
 
-            OPTICSObjectVector_Ptr currentObjectEpsilonNeighbors = getEpsilonNeighbors(currentObject);
+    while (!seeds.empty()) {
+        unsigned int current = seeds.pop();
+        OPTICSObject_Ptr& currentObject = _indexedObjects[current];
+        assert(!currentObject->processed);
 
-            // output q to the ordered list
-            if (currentObject->processed == false) {
-                _orderedObjects.push_back(currentObject);
-                currentObject->processed = true;
-            } else
-                continue;
+        // output q to the ordered list
+        _orderedObjects.push_back(currentObject);
+        currentObject->processed = true;
 
-            if (currentObject->coreDistance != UNDEFINED_DISTANCE) {
-                updateSeeds(currentObjectEpsilonNeighbors, currentObject, seeds);
-            }
-        }
+        if (currentObject->coreDistance != UNDEFINED_DISTANCE)
+            updateSeeds(current, seeds);
     }
 }
 
 void OPTICSFilter::extractDBSCANClustering(const std::string& seedString) {
     std::vector<OPTICSObject_Ptr> currentCluster;
 
-    // needed for use of uniform dist
-    typedef std::mt19937_64 RNG;
-    std::seed_seq seed(seedString.begin(), seedString.end());
-    std::unique_ptr<RNG> randGen(new RNG);
-    randGen->seed(seed);
+    // the representative of a cluster only depends on the cluster id
+    CounterRNG rng(seedString);
 
     // we start with cluster 1 and use 0 as noise
     int clusterID = 1;
@@ -141,8 +183,8 @@ void OPTICSFilter::extractDBSCANClustering(const std::string& seedString) {
             if (obj->coreDistance <= _epsDBSCAN) {
                 // get random obj from currentCluster and append to locations
                 if (currentCluster.empty() == false) {
-                    std::uniform_int_distribution<int> elemDist(0, currentCluster.size() - 1);
-                    OPTICSObject_Ptr randObj = currentCluster.at(elemDist(*randGen));
+                    uint64_t element = rng.below(CounterRNG::CLUSTER_REPRESENTATIVE, clusterID, currentCluster.size());
+                    OPTICSObject_Ptr randObj = currentCluster.at(element);
                     _locations->push_back(randObj->node);
                 }
                 currentCluster.clear();
@@ -161,17 +203,14 @@ void OPTICSFilter::extractDBSCANClustering(const std::string& seedString) {
 }
 
 void OPTICSFilter::filter(const std::string& seedString) {
-    auto it = _unprocessedObjects.begin();
-    while (_unprocessedObjects.empty() == false) {
-        OPTICSObject_Ptr node = *it;
-
-        if (node->processed) {
-            it = _unprocessedObjects.erase(it);
-            continue;
-        }
-
-        expandClusterOrder(node);
-    }
+    computeNeighborhoods();
+
+    // shared by all expansions, it is empty after each of them
+    IndexedHeap seeds(_indexedObjects.size());
+    for (OPTICSObject_Ptr& node : _unprocessedObjects)
+        if (!node->processed)
+            expandClusterOrder(node->index, seeds);
+    _unprocessedObjects.clear();
 
     assert(_orderedObjects.size() == _opticsObjects.size());
 
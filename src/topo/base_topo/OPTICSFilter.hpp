@@ -31,10 +31,13 @@
 #define OPTICSFILTER_HPP
 
 #include "geo/GeographicNode.hpp"
+#include "geo/SphericalKDTree.hpp"
+#include "util/IndexedHeap.hpp"
 #include <limits>
 #include <list>
 #include <map>
 #include <memory>
+#include <vector>
 
 class OPTICSFilter;
 typedef std::shared_ptr<OPTICSFilter> OPTICSFilter_Ptr;
@@ -50,42 +53,34 @@ class OPTICSFilter {
    private:
     struct OPTICSObject {
         unsigned int id;
+        unsigned int index;  /// < position in _indexedObjects and row of the neighbor table
         GeographicNode_Ptr node;
 
         double reachabilityDistance;
         double coreDistance;
-        double tmpDistance;
         bool processed;
         unsigned int clusterId;  /// < 0 for NOISE
 
         OPTICSObject(GeographicNode_Ptr& node)
             : id(node->id()),
+              index(0),
               node(node),
               reachabilityDistance(UNDEFINED_DISTANCE),
               coreDistance(UNDEFINED_DISTANCE),
-              tmpDistance(UNDEFINED_DISTANCE),
               processed(false),
               clusterId(0) {}
     };
 
     typedef std::shared_ptr<OPTICSObject> OPTICSObject_Ptr;
     typedef std::vector<OPTICSObject_Ptr> OPTICSObjectVector;
-    typedef std::shared_ptr<OPTICSObjectVector> OPTICSObjectVector_Ptr;
     static constexpr double UNDEFINED_DISTANCE = std::numeric_limits<double>::infinity();
 
-    OPTICSObjectVector_Ptr getEpsilonNeighbors(OPTICSObject_Ptr node);
-    void updateSeeds(OPTICSObjectVector_Ptr neighbors, OPTICSObject_Ptr centerObject, OPTICSObjectVector_Ptr seeds);
-    void expandClusterOrder(OPTICSObject_Ptr node);
+    void computeNeighborhoods(void);
+    // seeds and objects are addressed by their position in _indexedObjects
+    void updateSeeds(unsigned int centerObject, IndexedHeap& seeds);
+    void expandClusterOrder(unsigned int object, IndexedHeap& seeds);
     void extractDBSCANClustering(const std::string& seedString);
 
-    static bool compareOPTICSObjects(const OPTICSObject_Ptr& a, const OPTICSObject_Ptr& b) {
-        return a->reachabilityDistance > b->reachabilityDistance;
-    }
-
-    static bool compareOPTICSObjectsTmp(const OPTICSObject_Ptr& a, const OPTICSObject_Ptr& b) {
-        return a->tmpDistance < b->tmpDistance;
-    }
-
     Locations_Ptr _locations;
     double _eps;
     unsigned int _minPts;
@@ -95,6 +90,15 @@ class OPTICSFilter {
     OPTICSObjectVector _unprocessedObjects;
 
     std::vector<OPTICSObject_Ptr> _orderedObjects;
+
+    // objects in id order, positions match the indices of _index
+    OPTICSObjectVector _indexedObjects;
+    SphericalKDTree_Ptr _index;
+
+    // epsilon neighborhoods of all objects without the objects themselves, row i of object i spans
+    // _neighbors[_neighborOffsets[i]] up to _neighbors[_neighborOffsets[i + 1]]
+    std::vector<unsigned int> _neighborOffsets;
+    std::vector<unsigned int> _neighbors;
 };
 
 #endif
@@ -32,67 +32,153 @@
 #include <boost/log/trivial.hpp>
 #include "config/Config.hpp"
 #include "config/PredefinedValues.hpp"
+#include "db/AreaPopulationIndex.hpp"
 #include "db/InternetUsageStatistics.hpp"
+#include "db/PopulationDensityReader.hpp"
+#include "db/PopulationIntegral.hpp"
 #include "db/SQLiteAreaPopulationReader.hpp"
 #include "geo/CityNode.hpp"
 #include "geo/GeometricHelpers.hpp"
 #include "geo/GeographicPosition.hpp"
 #include "geo/SeaCableLandingPoint.hpp"
 #include "topo/Graph.hpp"
-#include "util/Util.hpp"
+#include "topo/NodeStore.hpp"
+#include "util/Trace.hpp"
 #include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <numeric>
 
-PopulationDensityFilter::PopulationDensityFilter(BaseTopology_Ptr baseTopo)
-    : _dbFilename(PredefinedValues::dbFilePath()), _baseTopo(baseTopo) {
+typedef std::shared_ptr<ResultIterator<PopulatedPosition>> PopulatedPositionIterator_Ptr;
+
+// mean of the distance weight 1 - dist(midpoint) / (0.5 c) over the lune of an edge of length c, sampled on a grid in
+// the plane with c = 1
+static double meanLuneWeight(double beta) {
+    const int SAMPLES = 200;
+    double r = 0.5 / beta;
+    double d = sqrt(std::max(0.0, r * r - 0.25));
+    double halfWidth = r - d;
+
+    double weight = 0.0;
+    int inside = 0;
+    for (int i = 0; i < SAMPLES; ++i) {
+        for (int j = 0; j < SAMPLES; ++j) {
+            double x = -0.5 + (i + 0.5) / SAMPLES;
+            double y = halfWidth * (-1.0 + 2.0 * (j + 0.5) / SAMPLES);
+            if (x * x + (y - d) * (y - d) > r * r || x * x + (y + d) * (y + d) > r * r)
+                continue;
+            weight += 1.0 - sqrt(x * x + y * y) / 0.5;
+            ++inside;
+        }
+    }
+    return inside > 0 ? weight / inside : 0.0;
+}
+
+PopulationDensityFilter::PopulationDensityFilter(BaseTopology_Ptr baseTopo,
+                                                 InternetUsageStatistics_Ptr inetStat,
+                                                 Config_Ptr config)
+    : _dbFilename(PredefinedValues::dbFilePath()),
+      _baseTopo(baseTopo),
+      _inetStat(inetStat),
+      _minLength(config->get<double>("lengthFilter.minLength")),
+      _populationThreshold(config->get<double>("lengthFilter.populationThreshold")),
+      _beta(config->get<double>("lengthFilter.beta")),
+      _batchedPopulationQueries(config->get<bool>("lengthFilter.batchedPopulationQueries")),
+      _rasterPopulation(config->get<bool>("lengthFilter.rasterPopulation")),
+      _rasterCellFactor(config->get<int>("lengthFilter.rasterCellFactor")) {
 }
 
 void PopulationDensityFilter::filter(void) {
     using namespace lemon;
-    std::unique_ptr<InternetUsageStatistics> inetStat(new InternetUsageStatistics(PredefinedValues::dbFilePath()));
+    const InternetUsageStatistics& inetStat = *_inetStat;
 
     // crucial parameters
-    std::unique_ptr<Config> config(new Config);
-    const double MIN_LENGTH = config->get<double>("lengthFilter.minLength");
-    const double POPULATION_THRESHOLD = config->get<double>("lengthFilter.populationThreshold");
-    const double BETA = config->get<double>("lengthFilter.beta");
+    const double MIN_LENGTH = _minLength;
+    const double POPULATION_THRESHOLD = _populationThreshold;
+    const double BETA = _beta;
+    const double cosTheta = cos(M_PI - asin(BETA));
+
+    // batched mode answers all bounding box queries from one in-memory copy of the populated positions
+    AreaPopulationIndex_Ptr areaIndex;
+    if (_batchedPopulationQueries)
+        areaIndex = AreaPopulationIndex_Ptr(new AreaPopulationIndex(_dbFilename));
+
+    // raster mode scores each edge in constant time from the people of the density raster inside its lune, weighted
+    // by the mean distance weight and the Internet usage of its cities
+    PopulationIntegral_Ptr integral;
+    double luneWeight = 0.0;
+    if (_rasterPopulation) {
+        PopulationDensityReader reader;
+        integral = PopulationIntegral_Ptr(new PopulationIntegral(reader, _rasterCellFactor));
+        luneWeight = meanLuneWeight(BETA);
+    }
 
     // iterate over edges
     Graph& graph = *_baseTopo->getGraph();
     auto& nodeGeoNodeMap = *_baseTopo->getNodeMap();
-    EdgeList edges_to_delete;
+    auto& nodeKindMap = *_baseTopo->getNodeKindMap();
 
-    auto isValidNode = [](GeographicNode_Ptr& ptr) -> bool {
-        CityNode* n1 = dynamic_cast<CityNode*>(ptr.get());
-        SeaCableLandingPoint* n2 = dynamic_cast<SeaCableLandingPoint*>(ptr.get());
-        return n1 != nullptr || n2 != nullptr;
+    // seacable nodes are skipped without loading the node
+    auto isValidNode = [&](const Graph::Node& nd) -> bool {
+        uint8_t kind = nodeKindMap[nd];
+        return kind == CityNode::KIND || kind == SeaCableLandingPoint::KIND;
     };
 
-    for (ListGraph::EdgeIt it(graph); it != INVALID; ++it) {
+    // the edges are tested independently, the readers are opened per query or only read
+    _baseTopo->computeEdgeGeometry();
+    EdgeList edges_to_delete = _baseTopo->selectEdges([&](const Graph::Edge& it) -> bool {
         Graph::Node u = graph.u(it);
         Graph::Node v = graph.v(it);
 
-        GeographicNode_Ptr nd1 = nodeGeoNodeMap[u];
-        GeographicNode_Ptr nd2 = nodeGeoNodeMap[v];
+        if (isValidNode(u) && isValidNode(v)) {
+            TRACE_SCOPE_ARG("population density edge", "edge", graph.id(it));
+            const GeographicNode_Ptr& nd1 = nodeGeoNodeMap[u];
+            const GeographicNode_Ptr& nd2 = nodeGeoNodeMap[v];
 
-        if (isValidNode(nd1) && isValidNode(nd2)) {
             GeographicPosition p1(nd1->lat(), nd1->lon());
             GeographicPosition p2(nd2->lat(), nd2->lon());
 
             // escape edges below specific length treshold
-            double c = GeometricHelpers::sphericalDist(p1, p2);
-            double c_km = GeometricHelpers::sphericalDistToKM(c);
+            const EdgeGeometry& geometry = _baseTopo->edgeGeometry(it);
+            double c = geometry.length;
+            double c_km = geometry.lengthKM;
             if (c_km < MIN_LENGTH) {
-                continue;
+                return false;
+            }
+
+            if (integral) {
+                CityNode* city1 = nodeCast<CityNode>(nd1.get());
+                CityNode* city2 = nodeCast<CityNode>(nd2.get());
+                if (!city1 && !city2)
+                    return false;  // < no country to weight with, edges between landing points stay
+
+                double amountInetUsers = 0.0;
+                if (city1)
+                    amountInetUsers += inetStat[city1->countryId()] / 100.0;
+                if (city2)
+                    amountInetUsers += inetStat[city2->countryId()] / 100.0;
+                if (city1 && city2)
+                    amountInetUsers /= 2.0;
+
+                double accPopulation = luneWeight * integral->lune(p1, p2, BETA) * pow(amountInetUsers, 2) *
+                                       pow((MIN_LENGTH / c_km), 2);
+                return accPopulation <= POPULATION_THRESHOLD;
             }
 
+            // the lune of the edge, the angle at a point inside is at least theta
+            GeometricHelpers::UnitVector u1 = GeometricHelpers::unitVector(p1);
+            GeometricHelpers::UnitVector u2 = GeometricHelpers::unitVector(p2);
+
             // INIT Bounding box reader
-            GeographicPositionTuple midPoint = GeometricHelpers::getMidPointCoordinates(p1, p2);
-            GeographicPosition midPointPos(midPoint.first, midPoint.second);
-            SQLiteAreaPopulationReader_Ptr areaReader(new SQLiteAreaPopulationReader(
-                _dbFilename, midPoint.first, midPoint.second, GeometricHelpers::rad2deg(c)));
+            const GeographicPositionTuple& midPoint = geometry.midPoint;
+            GeometricHelpers::CachedPosition midPointPos =
+                GeometricHelpers::cachedPosition(midPoint.first, midPoint.second);
+            PopulatedPositionIterator_Ptr areaReader;
+            if (areaIndex)
+                areaReader = areaIndex->query(midPoint.first, midPoint.second, GeometricHelpers::rad2deg(c));
+            else
+                areaReader = SQLiteAreaPopulationReader_Ptr(new SQLiteAreaPopulationReader(
+                    _dbFilename, midPoint.first, midPoint.second, GeometricHelpers::rad2deg(c)));
 
             double accPopulation = 0.0;
             while (areaReader->hasNext() && accPopulation <= POPULATION_THRESHOLD) {
@@ -106,97 +192,89 @@ void PopulationDensityFilter::filter(void) {
 
                 // test if the populated position is within a more sophisticated area (derived from a beta-skeleton
                 // shape parameter)
-                GeographicPosition toTest(next._lat, next._lon);
-                double a = GeometricHelpers::sphericalDist(p1, toTest);
-                double b = GeometricHelpers::sphericalDist(p2, toTest);
-                double C = Util::ihs((Util::hs(c) - Util::hs(a - b)) / (sin(a) * sin(b)));
-
-                // Point is out of area, skip
-                const double theta = M_PI - asin(BETA);
-                if (C < theta) {
+                GeometricHelpers::CachedPosition toTest = GeometricHelpers::cachedPosition(next._lat, next._lon);
+
+                // Point is out of area, skip. A point on an edge end has no angle and is counted.
+                if (GeometricHelpers::angleBelow(u1, toTest.unit, u2, cosTheta, false)) {
                     continue;
                 }
 
                 // Weight by technology factor and additional weight
-                double amountInetUsers = (*inetStat)[next._country] / 100.0;
+                double amountInetUsers = inetStat[next._country] / 100.0;
                 double popWeight = 1.0 - (GeometricHelpers::sphericalDist(toTest, midPointPos) /
                                           (0.5 * c));  // simply weight by distance to midpoint coordinate
                 accPopulation += popWeight * next._population * pow(amountInetUsers, 2) * pow((MIN_LENGTH / c_km), 2);
             }
 
             if (accPopulation <= POPULATION_THRESHOLD) {
-                edges_to_delete.push_back(it);
+                return true;
             }
         }
-    }
+        return false;
+    });
 
     BOOST_LOG_TRIVIAL(info) << edges_to_delete.size() << " edges deleted by population density filter";
 
     for (EdgeList::iterator edge = edges_to_delete.begin(); edge != edges_to_delete.end(); ++edge)
-        graph.erase(*edge);
+        _baseTopo->eraseEdge(*edge);
 }
 
 void PopulationDensityFilter::filterByLength(void) {
     using namespace lemon;
-    std::unique_ptr<InternetUsageStatistics> inetStat(new InternetUsageStatistics(PredefinedValues::dbFilePath()));
+    const InternetUsageStatistics& inetStat = *_inetStat;
 
     // crucial parameters
-    std::unique_ptr<Config> config(new Config);
-    const double MIN_LENGTH = config->get<double>("lengthFilter.minLength");
+    const double MIN_LENGTH = _minLength;
 
     // iterate over edges
     Graph& graph = *_baseTopo->getGraph();
     auto& nodeGeoNodeMap = *_baseTopo->getNodeMap();
-    EdgeList edges_to_delete;
 
-    auto isValidNode = [](GeographicNode_Ptr& ptr) -> bool {
-        CityNode* n1 = dynamic_cast<CityNode*>(ptr.get());
-        SeaCableLandingPoint* n2 = dynamic_cast<SeaCableLandingPoint*>(ptr.get());
-        return n1 != nullptr || n2 != nullptr;
-    };
+    // node kinds and countries by graph node id
+    NodeStore store(*_baseTopo);
 
-    auto isCityNode = [](GeographicNode_Ptr& ptr) -> bool {
-        CityNode* n1 = dynamic_cast<CityNode*>(ptr.get());
-        return n1 != nullptr;
+    auto isValidNode = [&store](unsigned id) -> bool {
+        return store.kind(id) == NodeStore::CITY_NODE || store.kind(id) == NodeStore::SEACABLE_LANDINGPOINT;
     };
 
-    for (ListGraph::EdgeIt it(graph); it != INVALID; ++it) {
+    auto isCityNode = [&store](unsigned id) -> bool { return store.isCity(id); };
+
+    // the edges are tested independently, the node store is only read
+    EdgeList edges_to_delete = _baseTopo->selectEdges([&](const Graph::Edge& it) -> bool {
         Graph::Node u = graph.u(it);
         Graph::Node v = graph.v(it);
+        unsigned id1 = graph.id(u);
+        unsigned id2 = graph.id(v);
 
-        GeographicNode_Ptr nd1 = nodeGeoNodeMap[u];
-        GeographicNode_Ptr nd2 = nodeGeoNodeMap[v];
-
-        if (isValidNode(nd1) && isValidNode(nd2)) {
+        if (isValidNode(id1) && isValidNode(id2)) {
+            TRACE_SCOPE_ARG("population density edge", "edge", graph.id(it));
+            GeographicNode_Ptr& nd1 = nodeGeoNodeMap[u];
             GeographicPosition p1(nd1->lat(), nd1->lon());
             GeographicPosition p2(nd1->lat(), nd1->lon());
 
             double amountInetUsers = 0.0;
-            if (isCityNode(nd1) && isCityNode(nd2)) {
-                std::string nd1c = static_cast<CityNode*>(nd1.get())->country();
-                std::string nd2c = static_cast<CityNode*>(nd2.get())->country();
-                amountInetUsers += (*inetStat)[nd1c] / 100.0;
-                amountInetUsers += (*inetStat)[nd2c] / 100.0;
+            if (isCityNode(id1) && isCityNode(id2)) {
+                amountInetUsers += inetStat[store.countryId(id1)] / 100.0;
+                amountInetUsers += inetStat[store.countryId(id2)] / 100.0;
                 amountInetUsers /= 2.0;
-            } else if (isCityNode(nd1)) {
-                std::string nd1c = static_cast<CityNode*>(nd1.get())->country();
-                amountInetUsers += (*inetStat)[nd1c] / 100.0;
-            } else if (isCityNode(nd2)) {
-                std::string nd2c = static_cast<CityNode*>(nd2.get())->country();
-                amountInetUsers += (*inetStat)[nd2c] / 100.0;
+            } else if (isCityNode(id1)) {
+                amountInetUsers += inetStat[store.countryId(id1)] / 100.0;
+            } else if (isCityNode(id2)) {
+                amountInetUsers += inetStat[store.countryId(id2)] / 100.0;
             } else
-                continue;  // < skip, we won't filter edges between landing points
+                return false;  // < skip, we won't filter edges between landing points
 
             // escape edges below specific length treshold
             assert(amountInetUsers < 1.0);
             double c = GeometricHelpers::sphericalDist(p1, p2);
             double c_km = GeometricHelpers::sphericalDistToKM(c);
             if (c_km > MIN_LENGTH * (1.0 + amountInetUsers)) {
-                edges_to_delete.push_back(it);
+                return true;
             }
         }
-    }
+        return false;
+    });
     // erase edges
     for (EdgeList::iterator edge = edges_to_delete.begin(); edge != edges_to_delete.end(); ++edge)
-        graph.erase(*edge);
+        _baseTopo->eraseEdge(*edge);
 }
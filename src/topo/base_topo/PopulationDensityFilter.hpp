@@ -30,6 +30,8 @@
 #ifndef POPULATIONDENSITYFILTER_HPP
 #define POPULATIONDENSITYFILTER_HPP
 
+#include "config/Config.hpp"
+#include "db/InternetUsageStatistics.hpp"
 #include "topo/base_topo/BaseTopology.hpp"
 #include <memory>
 
@@ -38,7 +40,7 @@ typedef std::shared_ptr<PopulationDensityFilter> PopulationDensityFilter_Ptr;
 
 class PopulationDensityFilter {
    public:
-    PopulationDensityFilter(BaseTopology_Ptr baseTopo);
+    PopulationDensityFilter(BaseTopology_Ptr baseTopo, InternetUsageStatistics_Ptr inetStat, Config_Ptr config);
 
     // somewhat complex filter algorithm involving bounding box reader and population estimation
     void filter();
@@ -50,6 +52,15 @@ class PopulationDensityFilter {
    private:
     std::string _dbFilename;
     BaseTopology_Ptr _baseTopo;
+    InternetUsageStatistics_Ptr _inetStat;
+
+    // lengthFilter parameters
+    double _minLength;
+    double _populationThreshold;
+    double _beta;
+    bool _batchedPopulationQueries;
+    bool _rasterPopulation;
+    int _rasterCellFactor;
 };
 
 #endif
@@ -0,0 +1,329 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ShardedDelaunay.hpp"
+#include "geo/GeometricHelpers.hpp"
+#include "util/ThreadPool.hpp"
+#include <boost/log/trivial.hpp>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iterator>
+#include <sstream>
+#include <tuple>
+
+constexpr int ShardedDelaunay::SHARDS;
+
+namespace {
+// direction of a point as geographic position, in the frame of the points
+GeographicPosition direction(double x, double y, double z) {
+    using GeometricHelpers::RAD_TO_DEG;
+    double norm = sqrt(x * x + y * y + z * z);
+    double lat = std::max(-90.0, std::min(90.0, asin(z / norm) * RAD_TO_DEG));
+    double lon = std::max(-180.0, std::min(180.0, atan2(y, x) * RAD_TO_DEG));
+    return GeographicPosition(lat, lon);
+}
+
+std::vector<GeographicPosition> directions(const std::vector<Point_3>& points) {
+    std::vector<GeographicPosition> result;
+    result.reserve(points.size());
+    for (const Point_3& p : points)
+        result.push_back(direction(p.x(), p.y(), p.z()));
+    return result;
+}
+
+double coordinate(const Point_3& p, int axis) {
+    return axis == 0 ? p.x() : (axis == 1 ? p.y() : p.z());
+}
+
+bool sameTriangle(const SphericalDelaunay::Triangle& t, const SphericalDelaunay::Triangle& u) {
+    return t.vertex[0] == u.vertex[0] && t.vertex[1] == u.vertex[1] && t.vertex[2] == u.vertex[2];
+}
+
+bool triangleLess(const SphericalDelaunay::Triangle& t, const SphericalDelaunay::Triangle& u) {
+    return std::tie(t.vertex[0], t.vertex[1], t.vertex[2]) < std::tie(u.vertex[0], u.vertex[1], u.vertex[2]);
+}
+
+// angular slack of the candidate search, far above the rounding of the cap and the tree distances
+const double SEARCH_SLACK = 1e-6;
+}  // namespace
+
+ShardedDelaunay::ShardedDelaunay(const std::vector<Point_3>& points, double margin)
+    : _points(points), _marginLimit(0.0), _distinct(), _index(), _triangles(), _changed() {
+    assert(margin >= 0.0 && margin < 45.0);
+    _marginLimit = tan((45.0 + margin) * GeometricHelpers::DEG_TO_RAD);
+
+    std::vector<unsigned int> order;
+    SphericalDelaunay::insertionOrder(points.size(), order);
+    std::vector<unsigned int> rank(points.size());
+    for (unsigned int i = 0; i < order.size(); ++i)
+        rank[order[i]] = i;
+
+    // coinciding points sort next to each other, the first inserted one ahead
+    std::vector<unsigned int> byPosition(order);
+    std::sort(byPosition.begin(), byPosition.end(), [&points, &rank](unsigned int i, unsigned int j) {
+        return std::make_tuple(points[i].x(), points[i].y(), points[i].z(), rank[i]) <
+               std::make_tuple(points[j].x(), points[j].y(), points[j].z(), rank[j]);
+    });
+    for (size_t k = 0; k < byPosition.size(); ++k)
+        if (k == 0 || points[byPosition[k]] != points[byPosition[k - 1]])
+            _distinct.push_back(byPosition[k]);
+    std::sort(_distinct.begin(), _distinct.end());
+
+    std::vector<Point_3> distinctPoints;
+    distinctPoints.reserve(_distinct.size());
+    for (unsigned int point : _distinct)
+        distinctPoints.push_back(points[point]);
+    std::vector<GeographicPosition> positions(directions(distinctPoints));
+    _index = SphericalKDTree(positions);
+}
+
+// shard 2 * axis + 1 is the face in negative direction of axis
+bool ShardedDelaunay::inShard(int shard, const Point_3& p) const {
+    int axis = shard / 2;
+    double height = shard % 2 == 0 ? coordinate(p, axis) : -coordinate(p, axis);
+    if (height <= 0.0)
+        return false;
+
+    double limit = _marginLimit * height;
+    return fabs(coordinate(p, (axis + 1) % 3)) <= limit && fabs(coordinate(p, (axis + 2) % 3)) <= limit;
+}
+
+bool ShardedDelaunay::isDelaunay(const SphericalDelaunay::Triangle& triangle) {
+    const Point_3& a = _points[triangle.vertex[0]];
+    const Point_3& b = _points[triangle.vertex[1]];
+    const Point_3& c = _points[triangle.vertex[2]];
+
+    // the cap beyond the plane of the triangle, its center is the outer normal
+    double ux = b.x() - a.x(), uy = b.y() - a.y(), uz = b.z() - a.z();
+    double vx = c.x() - a.x(), vy = c.y() - a.y(), vz = c.z() - a.z();
+    double nx = uy * vz - uz * vy;
+    double ny = uz * vx - ux * vz;
+    double nz = ux * vy - uy * vx;
+    double norm = sqrt(nx * nx + ny * ny + nz * nz);
+    double aNorm = sqrt(a.x() * a.x() + a.y() * a.y() + a.z() * a.z());
+    if (norm == 0.0 || aNorm == 0.0)
+        return false;
+
+    double cosRadius = (nx * a.x() + ny * a.y() + nz * a.z()) / (norm * aNorm);
+    double radius = acos(std::max(-1.0, std::min(1.0, cosRadius)));
+    GeographicPosition center(direction(nx, ny, nz));
+
+    auto isInside = [&](unsigned int point) {
+        return CGAL::orientation(a, b, c, _points[point]) == CGAL::NEGATIVE;
+    };
+    // tree positions to points
+    auto point = [this](const SphericalKDTree::Neighbor& neighbor) { return _distinct[neighbor.index]; };
+    auto isVertex = [&triangle](unsigned int point) {
+        return point == triangle.vertex[0] || point == triangle.vertex[1] || point == triangle.vertex[2];
+    };
+
+    // most other triangles of a shard have a point close to the center of their cap
+    SphericalKDTree::Neighbor nearest = _index.nearest(center);
+    if (nearest.distance < radius - SEARCH_SLACK && !isVertex(point(nearest)) && !isInside(point(nearest)))
+        return false;
+
+    // points on the plane make the triangulation depend on the insertion order, they are rejected as well
+    std::vector<SphericalKDTree::Neighbor> candidates;
+    _index.radiusSearch(center, radius + SEARCH_SLACK, candidates);
+    for (const SphericalKDTree::Neighbor& candidate : candidates)
+        if (!isVertex(point(candidate)) && !isInside(point(candidate)))
+            return false;
+    return true;
+}
+
+void ShardedDelaunay::triangulateShard(const std::vector<unsigned int>& members,
+                                       std::vector<SphericalDelaunay::Triangle>& result) {
+    if (members.size() < 4)
+        return;
+
+    std::vector<Point_3> points;
+    points.reserve(members.size());
+    for (unsigned int member : members)
+        points.push_back(_points[member]);
+
+    SphericalDelaunay delaunay(points);
+    delaunay.triangulate();
+    std::vector<SphericalDelaunay::Triangle> triangles;
+    delaunay.triangles(triangles);
+
+    for (SphericalDelaunay::Triangle& triangle : triangles) {
+        for (int k = 0; k < 3; ++k)
+            triangle.vertex[k] = members[triangle.vertex[k]];
+        if (isDelaunay(triangle))
+            result.push_back(triangle);
+    }
+}
+
+void ShardedDelaunay::mergeTriangles(std::vector<SphericalDelaunay::Triangle>& triangles) {
+    for (SphericalDelaunay::Triangle& triangle : triangles) {
+        unsigned int* first = std::min_element(triangle.vertex, triangle.vertex + 3);
+        std::rotate(triangle.vertex, first, triangle.vertex + 3);
+        triangle.neighbor[0] = triangle.neighbor[1] = triangle.neighbor[2] = -1;
+    }
+    std::sort(triangles.begin(), triangles.end(), triangleLess);
+    triangles.erase(std::unique(triangles.begin(), triangles.end(), sameTriangle), triangles.end());
+}
+
+bool ShardedDelaunay::triangulate(void) {
+    std::vector<std::vector<SphericalDelaunay::Triangle>> shardTriangles(SHARDS);
+    ThreadPool::fromConfig()->forEach(SHARDS, [this, &shardTriangles](size_t shard) {
+        std::vector<unsigned int> members;
+        for (unsigned int i : _distinct)
+            if (inShard(shard, _points[i]))
+                members.push_back(i);
+        triangulateShard(members, shardTriangles[shard]);
+    });
+
+    _triangles.clear();
+    for (auto& triangles : shardTriangles)
+        _triangles.insert(_triangles.end(), triangles.begin(), triangles.end());
+
+    std::stringstream source;
+    source << SHARDS << " shards";
+    return stitch(source.str());
+}
+
+std::vector<int> ShardedDelaunay::match(const std::vector<Point_3>& points) {
+    auto positionLess = [](const Point_3& p, const Point_3& q) {
+        return std::make_tuple(p.x(), p.y(), p.z()) < std::make_tuple(q.x(), q.y(), q.z());
+    };
+
+    std::vector<std::pair<Point_3, unsigned int>> byPosition;
+    byPosition.reserve(_distinct.size());
+    for (unsigned int point : _distinct)
+        byPosition.push_back(std::make_pair(_points[point], point));
+    std::sort(byPosition.begin(), byPosition.end(),
+              [&positionLess](const std::pair<Point_3, unsigned int>& a, const std::pair<Point_3, unsigned int>& b) {
+                  return positionLess(a.first, b.first);
+              });
+
+    std::vector<int> result(points.size(), -1);
+    for (size_t i = 0; i < points.size(); ++i) {
+        auto found = std::lower_bound(byPosition.begin(), byPosition.end(), points[i],
+                                      [&positionLess](const std::pair<Point_3, unsigned int>& a, const Point_3& p) {
+                                          return positionLess(a.first, p);
+                                      });
+        if (found != byPosition.end() && found->first == points[i])
+            result[i] = found->second;
+    }
+    return result;
+}
+
+bool ShardedDelaunay::update(const std::vector<Point_3>& previousPoints,
+                             const std::vector<SphericalDelaunay::Triangle>& previousTriangles) {
+    std::vector<int> current(match(previousPoints));
+    _changed.assign(_points.size(), false);
+
+    // previous triangles with a removed vertex are gone, the others are kept if they are still delaunay triangles
+    std::vector<SphericalDelaunay::Triangle> previous;
+    previous.reserve(previousTriangles.size());
+    for (const SphericalDelaunay::Triangle& triangle : previousTriangles) {
+        int vertex[3] = {current[triangle.vertex[0]], current[triangle.vertex[1]], current[triangle.vertex[2]]};
+        if (vertex[0] >= 0 && vertex[1] >= 0 && vertex[2] >= 0) {
+            SphericalDelaunay::Triangle mapped(triangle);
+            std::copy(vertex, vertex + 3, mapped.vertex);
+            previous.push_back(mapped);
+        } else
+            for (int k = 0; k < 3; ++k)
+                if (vertex[k] >= 0)
+                    _changed[vertex[k]] = true;
+    }
+    mergeTriangles(previous);
+
+    _triangles.clear();
+    for (const SphericalDelaunay::Triangle& triangle : previous)
+        if (isDelaunay(triangle))
+            _triangles.push_back(triangle);
+
+    bool closed = stitch("the previous triangulation");
+
+    std::vector<SphericalDelaunay::Triangle> difference;
+    std::set_symmetric_difference(previous.begin(), previous.end(), _triangles.begin(), _triangles.end(),
+                                  std::back_inserter(difference), triangleLess);
+    for (const SphericalDelaunay::Triangle& triangle : difference)
+        for (int k = 0; k < 3; ++k)
+            _changed[triangle.vertex[k]] = true;
+    return closed;
+}
+
+const std::vector<bool>& ShardedDelaunay::changedPoints(void) {
+    return _changed;
+}
+
+bool ShardedDelaunay::stitch(const std::string& source) {
+    mergeTriangles(_triangles);
+
+    // the vertices of the missing triangles are the ends of edges with one kept triangle and the points without any
+    std::vector<std::pair<unsigned int, unsigned int>> halfEdges;
+    halfEdges.reserve(3 * _triangles.size());
+    std::vector<bool> covered(_points.size(), false);
+    for (const SphericalDelaunay::Triangle& triangle : _triangles)
+        for (int k = 0; k < 3; ++k) {
+            unsigned int a = triangle.vertex[k];
+            unsigned int b = triangle.vertex[(k + 1) % 3];
+            halfEdges.push_back(std::make_pair(std::min(a, b), std::max(a, b)));
+            covered[a] = true;
+        }
+    std::sort(halfEdges.begin(), halfEdges.end());
+
+    std::vector<bool> inSeam(_points.size(), false);
+    for (unsigned int i : _distinct)
+        inSeam[i] = !covered[i];
+    for (size_t i = 0; i < halfEdges.size(); ++i) {
+        bool paired = (i > 0 && halfEdges[i - 1] == halfEdges[i]) ||
+                      (i + 1 < halfEdges.size() && halfEdges[i + 1] == halfEdges[i]);
+        if (!paired)
+            inSeam[halfEdges[i].first] = inSeam[halfEdges[i].second] = true;
+    }
+
+    std::vector<unsigned int> seam;
+    for (unsigned int i = 0; i < _points.size(); ++i)
+        if (inSeam[i])
+            seam.push_back(i);
+
+    size_t kept = _triangles.size();
+    if (!seam.empty()) {
+        triangulateShard(seam, _triangles);
+        mergeTriangles(_triangles);
+    }
+
+    std::vector<std::pair<unsigned int, unsigned int>> edges, opposite;
+    bool closed = SphericalDelaunay::edges(_triangles, edges, opposite);
+    BOOST_LOG_TRIVIAL(info) << "sharded delaunay: " << kept << " triangles from " << source << ", "
+                            << _triangles.size() - kept << " from a seam of " << seam.size() << " points"
+                            << (closed ? "" : ", not closed");
+    return closed;
+}
+
+void ShardedDelaunay::edges(std::vector<std::pair<unsigned int, unsigned int>>& result,
+                            std::vector<std::pair<unsigned int, unsigned int>>& opposite) {
+    bool closed = SphericalDelaunay::edges(_triangles, result, opposite);
+    assert(closed);
+}
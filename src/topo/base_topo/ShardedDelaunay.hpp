@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SHARDEDDELAUNAY_HPP
+#define SHARDEDDELAUNAY_HPP
+
+#include "CGALPrimitives.hpp"
+#include "SphericalDelaunay.hpp"
+#include "geo/SphericalKDTree.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+
+class ShardedDelaunay;
+typedef std::shared_ptr<ShardedDelaunay> ShardedDelaunay_Ptr;
+
+// Delaunay triangulation of points on a sphere from independent triangulations of overlapping shards, one per face
+// of the cube around the sphere, widened by a margin, or from the triangulation of a previous point set. A shard or
+// previous triangle is kept if no point at all lies outside or on its plane, then it is a triangle of the whole
+// triangulation. The points at the holes left between the kept triangles are triangulated again as seam. The result
+// equals the one of SphericalDelaunay if the kept triangles close the sphere, otherwise triangulate fails and
+// SphericalDelaunay has to be used, e.g. for four points on a common circle, where the triangulation depends on the
+// insertion order. Of coinciding points only the one SphericalDelaunay inserts first is triangulated.
+class ShardedDelaunay {
+   public:
+    // margin in degrees, below 45
+    ShardedDelaunay(const std::vector<Point_3>& points, double margin);
+
+    bool triangulate(void);
+
+    // starts from the triangulation of previousPoints instead of the shards, so that only the surroundings of added
+    // and removed points are triangulated again
+    bool update(const std::vector<Point_3>& previousPoints,
+                const std::vector<SphericalDelaunay::Triangle>& previousTriangles);
+
+    // by point index, the points whose triangles differ from the previous triangulation after update
+    const std::vector<bool>& changedPoints(void);
+
+    // for each of points the triangulated point at the same position, -1 if there is none
+    std::vector<int> match(const std::vector<Point_3>& points);
+
+    // as SphericalDelaunay::edges, only valid after triangulate or update succeeded
+    void edges(std::vector<std::pair<unsigned int, unsigned int>>& result,
+               std::vector<std::pair<unsigned int, unsigned int>>& opposite);
+
+   protected:
+   private:
+    static constexpr int SHARDS = 6;
+
+    bool inShard(int shard, const Point_3& p) const;
+
+    // triangulates the given points and appends the triangles that are part of the whole triangulation
+    void triangulateShard(const std::vector<unsigned int>& members,
+                          std::vector<SphericalDelaunay::Triangle>& result);
+
+    // no point outside or on the plane of the triangle
+    bool isDelaunay(const SphericalDelaunay::Triangle& triangle);
+
+    // sorted and without duplicates, every triangle starts at its smallest vertex
+    void mergeTriangles(std::vector<SphericalDelaunay::Triangle>& triangles);
+
+    // fills the holes between the kept _triangles with a seam triangulation, false if they remain open
+    bool stitch(const std::string& source);
+
+    const std::vector<Point_3>& _points;
+    double _marginLimit;  /// < tangent of 45 degrees plus margin, the face coordinate bound of a shard
+
+    // the points without the later ones of coinciding points, in index order
+    std::vector<unsigned int> _distinct;
+    SphericalKDTree _index;  /// < over _distinct
+    std::vector<SphericalDelaunay::Triangle> _triangles;
+    std::vector<bool> _changed;
+};
+
+#endif  // SHARDEDDELAUNAY_HPP
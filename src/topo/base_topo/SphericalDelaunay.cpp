@@ -0,0 +1,320 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "SphericalDelaunay.hpp"
+#include <algorithm>
+#include <cassert>
+#include <random>
+#include <tuple>
+
+constexpr int SphericalDelaunay::NO_FACE;
+
+SphericalDelaunay::SphericalDelaunay(const std::vector<Point_3>& points)
+    : _points(points),
+      _faces(),
+      _outsidePoints(),
+      _conflict(points.size(), NO_FACE),
+      _center(),
+      _visitStamp(),
+      _horizonStart(points.size(), NO_FACE),
+      _horizonEnd(points.size(), NO_FACE),
+      _stamp(0) {
+}
+
+void SphericalDelaunay::insertionOrder(size_t size, std::vector<unsigned int>& order) {
+    // fixed pseudo random insertion order keeps the expected running time at O(n log n) for sorted input
+    order.resize(size);
+    for (unsigned int i = 0; i < order.size(); ++i)
+        order[i] = i;
+
+    std::mt19937 rng(5489u);
+    for (unsigned int i = order.size(); i > 1; --i)
+        std::swap(order[i - 1], order[rng() % i]);
+}
+
+void SphericalDelaunay::triangulate(void) {
+    std::vector<unsigned int> order;
+    insertionOrder(_points.size(), order);
+
+    if (!initSimplex(order))
+        return;
+
+    for (unsigned int point : order)
+        if (_conflict[point] != NO_FACE)
+            insert(point);
+}
+
+void SphericalDelaunay::edges(std::vector<std::pair<unsigned int, unsigned int>>& result) {
+    std::vector<std::pair<unsigned int, unsigned int>> opposite;
+    edges(result, opposite);
+}
+
+void SphericalDelaunay::edges(std::vector<std::pair<unsigned int, unsigned int>>& result,
+                              std::vector<std::pair<unsigned int, unsigned int>>& opposite) {
+    std::vector<Triangle> faces;
+    triangles(faces);
+    bool closed = edges(faces, result, opposite);
+    assert(closed || faces.empty());
+}
+
+bool SphericalDelaunay::edges(const std::vector<Triangle>& triangles,
+                              std::vector<std::pair<unsigned int, unsigned int>>& result,
+                              std::vector<std::pair<unsigned int, unsigned int>>& opposite) {
+    result.clear();
+    opposite.clear();
+
+    // both directions of an edge sort next to each other, the run from the smaller index first
+    struct HalfEdge {
+        unsigned int low;
+        unsigned int high;
+        bool reversed;
+        unsigned int third;
+
+        bool operator<(const HalfEdge& other) const {
+            return std::tie(low, high, reversed) < std::tie(other.low, other.high, other.reversed);
+        }
+    };
+
+    std::vector<HalfEdge> halfEdges;
+    halfEdges.reserve(3 * triangles.size());
+    for (const Triangle& t : triangles)
+        for (int k = 0; k < 3; ++k) {
+            unsigned int a = t.vertex[k];
+            unsigned int b = t.vertex[(k + 1) % 3];
+            HalfEdge h = {std::min(a, b), std::max(a, b), b < a, t.vertex[(k + 2) % 3]};
+            halfEdges.push_back(h);
+        }
+    std::sort(halfEdges.begin(), halfEdges.end());
+
+    result.reserve(halfEdges.size() / 2);
+    opposite.reserve(halfEdges.size() / 2);
+    for (size_t i = 0; i + 1 < halfEdges.size(); i += 2) {
+        const HalfEdge& h = halfEdges[i];
+        const HalfEdge& g = halfEdges[i + 1];
+        if (h.low != g.low || h.high != g.high || h.reversed || !g.reversed ||
+            (i + 2 < halfEdges.size() && halfEdges[i + 2].low == h.low && halfEdges[i + 2].high == h.high))
+            return false;
+        result.push_back(std::make_pair(h.low, h.high));
+        opposite.push_back(std::make_pair(h.third, g.third));
+    }
+    return halfEdges.size() % 2 == 0;
+}
+
+void SphericalDelaunay::triangles(std::vector<Triangle>& result) {
+    result.clear();
+
+    std::vector<int> position(_faces.size(), NO_FACE);
+    for (unsigned int f = 0; f < _faces.size(); ++f)
+        if (_faces[f].alive) {
+            position[f] = result.size();
+            Triangle t;
+            for (int k = 0; k < 3; ++k) {
+                t.vertex[k] = _faces[f].vertex[k];
+                t.neighbor[k] = _faces[f].neighbor[k];
+            }
+            result.push_back(t);
+        }
+
+    for (Triangle& t : result)
+        for (int k = 0; k < 3; ++k)
+            t.neighbor[k] = position[t.neighbor[k]];
+}
+
+bool SphericalDelaunay::initSimplex(std::vector<unsigned int>& order) {
+    const unsigned int NONE = _points.size();
+    if (order.size() < 4)
+        return false;
+
+    unsigned int i0 = order[0];
+    unsigned int i1 = NONE;
+    unsigned int i2 = NONE;
+    unsigned int i3 = NONE;
+
+    for (unsigned int i : order)
+        if (i1 == NONE && _points[i] != _points[i0])
+            i1 = i;
+    if (i1 == NONE)
+        return false;
+
+    for (unsigned int i : order)
+        if (i2 == NONE && !CGAL::collinear(_points[i0], _points[i1], _points[i]))
+            i2 = i;
+    if (i2 == NONE)
+        return false;
+
+    for (unsigned int i : order)
+        if (i3 == NONE && CGAL::orientation(_points[i0], _points[i1], _points[i2], _points[i]) != CGAL::COPLANAR)
+            i3 = i;
+    if (i3 == NONE)
+        return false;
+
+    // the fourth point has to lie behind the first facet
+    if (CGAL::orientation(_points[i0], _points[i1], _points[i2], _points[i3]) == CGAL::POSITIVE)
+        std::swap(i1, i2);
+
+    _center = Point_3((_points[i0].x() + _points[i1].x() + _points[i2].x() + _points[i3].x()) / 4.0,
+                      (_points[i0].y() + _points[i1].y() + _points[i2].y() + _points[i3].y()) / 4.0,
+                      (_points[i0].z() + _points[i1].z() + _points[i2].z() + _points[i3].z()) / 4.0);
+
+    std::vector<int> simplex;
+    simplex.push_back(addFace(i0, i1, i2));
+    simplex.push_back(addFace(i0, i3, i1));
+    simplex.push_back(addFace(i1, i3, i2));
+    simplex.push_back(addFace(i2, i3, i0));
+
+    // link facets sharing an edge in opposite direction
+    for (int f : simplex)
+        for (int k = 0; k < 3; ++k)
+            for (int g : simplex)
+                for (int m = 0; m < 3; ++m)
+                    if (_faces[g].vertex[m] == _faces[f].vertex[(k + 1) % 3] &&
+                        _faces[g].vertex[(m + 1) % 3] == _faces[f].vertex[k])
+                        _faces[f].neighbor[k] = g;
+
+    for (int f : simplex) {
+        assert(CGAL::orientation(_points[_faces[f].vertex[0]], _points[_faces[f].vertex[1]],
+                                 _points[_faces[f].vertex[2]], _center) == CGAL::NEGATIVE);
+        for (int k = 0; k < 3; ++k)
+            assert(_faces[f].neighbor[k] != NO_FACE);
+    }
+
+    for (unsigned int i : order)
+        if (i != i0 && i != i1 && i != i2 && i != i3)
+            assignConflict(i, simplex);
+
+    return true;
+}
+
+int SphericalDelaunay::addFace(unsigned int a, unsigned int b, unsigned int c) {
+    Face face;
+    face.vertex[0] = a;
+    face.vertex[1] = b;
+    face.vertex[2] = c;
+    face.neighbor[0] = face.neighbor[1] = face.neighbor[2] = NO_FACE;
+    face.alive = true;
+
+    _faces.push_back(face);
+    _outsidePoints.push_back(std::vector<unsigned int>());
+    _visitStamp.push_back(0);
+    return _faces.size() - 1;
+}
+
+bool SphericalDelaunay::isVisible(int face, unsigned int point) {
+    const Face& f = _faces[face];
+    return CGAL::orientation(_points[f.vertex[0]], _points[f.vertex[1]], _points[f.vertex[2]], _points[point]) ==
+           CGAL::POSITIVE;
+}
+
+// the ray from _center through point leaves the hull through this facet
+bool SphericalDelaunay::isBehind(int face, unsigned int point) {
+    const Face& f = _faces[face];
+    for (int k = 0; k < 3; ++k)
+        if (CGAL::orientation(_center, _points[f.vertex[k]], _points[f.vertex[(k + 1) % 3]], _points[point]) ==
+            CGAL::NEGATIVE)
+            return false;
+    return true;
+}
+
+// points inside the hull are dropped for good, the hull only grows
+void SphericalDelaunay::assignConflict(unsigned int point, std::vector<int>& candidates) {
+    _conflict[point] = NO_FACE;
+    for (int face : candidates)
+        if (isBehind(face, point)) {
+            if (isVisible(face, point)) {
+                _conflict[point] = face;
+                _outsidePoints[face].push_back(point);
+            }
+            return;
+        }
+    assert(false);
+}
+
+void SphericalDelaunay::insert(unsigned int point) {
+    ++_stamp;
+
+    // collect visible facets, the horizon consists of their edges to invisible facets
+    std::vector<int> visible;
+    std::vector<int> stack(1, _conflict[point]);
+    std::vector<std::pair<unsigned int, int>> horizon;  // < visible facet and edge
+    _visitStamp[_conflict[point]] = _stamp;
+
+    while (!stack.empty()) {
+        int f = stack.back();
+        stack.pop_back();
+        visible.push_back(f);
+
+        for (int k = 0; k < 3; ++k) {
+            int g = _faces[f].neighbor[k];
+            if (_visitStamp[g] == _stamp)
+                continue;
+
+            if (isVisible(g, point)) {
+                _visitStamp[g] = _stamp;
+                stack.push_back(g);
+            } else
+                horizon.push_back(std::make_pair(f, k));
+        }
+    }
+
+    // cone of new facets from the horizon to point
+    std::vector<int> created;
+    for (auto& edge : horizon) {
+        const Face& f = _faces[edge.first];
+        unsigned int a = f.vertex[edge.second];
+        unsigned int b = f.vertex[(edge.second + 1) % 3];
+        int outside = f.neighbor[edge.second];
+
+        int id = addFace(a, b, point);
+        _faces[id].neighbor[0] = outside;
+        for (int m = 0; m < 3; ++m)
+            if (_faces[outside].vertex[m] == b && _faces[outside].vertex[(m + 1) % 3] == a)
+                _faces[outside].neighbor[m] = id;
+
+        _horizonStart[a] = id;
+        _horizonEnd[b] = id;
+        created.push_back(id);
+    }
+
+    for (int id : created) {
+        Face& face = _faces[id];
+        face.neighbor[1] = _horizonStart[face.vertex[1]];
+        face.neighbor[2] = _horizonEnd[face.vertex[0]];
+    }
+
+    _conflict[point] = NO_FACE;
+    for (int f : visible) {
+        _faces[f].alive = false;
+
+        std::vector<unsigned int> outside;
+        outside.swap(_outsidePoints[f]);
+        for (unsigned int other : outside)
+            if (other != point)
+                assignConflict(other, created);
+    }
+}
@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SPHERICALDELAUNAY_HPP
+#define SPHERICALDELAUNAY_HPP
+
+#include "CGALPrimitives.hpp"
+#include <memory>
+#include <utility>
+#include <vector>
+
+class SphericalDelaunay;
+typedef std::shared_ptr<SphericalDelaunay> SphericalDelaunay_Ptr;
+
+// Delaunay triangulation of points on a sphere, computed as their convex hull with an incremental
+// algorithm. All results refer to positions in the input vector. Like CGAL::convex_hull_3, points that
+// coincide with another point or lie exactly on the plane of a hull facet are not part of the result.
+class SphericalDelaunay {
+   public:
+    struct Triangle {
+        unsigned int vertex[3];  /// < counter-clockwise seen from outside
+        int neighbor[3];         /// < triangle across the edge (vertex[k], vertex[k + 1])
+    };
+
+    SphericalDelaunay(const std::vector<Point_3>& points);
+
+    void triangulate(void);
+
+    // the pseudo random insertion order of triangulate, of all coinciding points only the first one is triangulated
+    static void insertionOrder(size_t size, std::vector<unsigned int>& order);
+
+    // every edge once as pair of point indices, see the static edges
+    void edges(std::vector<std::pair<unsigned int, unsigned int>>& result);
+    void edges(std::vector<std::pair<unsigned int, unsigned int>>& result,
+               std::vector<std::pair<unsigned int, unsigned int>>& opposite);
+
+    // neighbor indices refer to positions in result
+    void triangles(std::vector<Triangle>& result);
+
+    // Every edge of triangles once, with the smaller index first and sorted, so that the result only depends on the
+    // set of triangles. opposite.first is the third vertex of the triangle the edge runs from first to second in,
+    // opposite.second the one of the other triangle. The neighbors of the triangles are not used. False unless every
+    // edge is shared by exactly two triangles.
+    static bool edges(const std::vector<Triangle>& triangles,
+                      std::vector<std::pair<unsigned int, unsigned int>>& result,
+                      std::vector<std::pair<unsigned int, unsigned int>>& opposite);
+
+   protected:
+   private:
+    struct Face {
+        unsigned int vertex[3];
+        int neighbor[3];
+        bool alive;
+    };
+
+    static constexpr int NO_FACE = -1;
+
+    bool initSimplex(std::vector<unsigned int>& order);
+    int addFace(unsigned int a, unsigned int b, unsigned int c);
+    bool isVisible(int face, unsigned int point);
+    bool isBehind(int face, unsigned int point);
+    void assignConflict(unsigned int point, std::vector<int>& candidates);
+    void insert(unsigned int point);
+
+    const std::vector<Point_3>& _points;
+    std::vector<Face> _faces;
+
+    // points outside the hull are stored at the facet that the ray from _center through them leaves the hull, that
+    // facet is always visible from the point and is replaced by exactly one of the new facets when removed
+    std::vector<std::vector<unsigned int>> _outsidePoints;
+    std::vector<int> _conflict;
+    Point_3 _center;
+
+    // scratch space of insert
+    std::vector<int> _visitStamp;
+    std::vector<int> _horizonStart;
+    std::vector<int> _horizonEnd;
+    int _stamp;
+};
+
+#endif  // SPHERICALDELAUNAY_HPP
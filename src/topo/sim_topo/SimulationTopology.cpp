@@ -30,45 +30,50 @@
 #include "SimulationTopology.hpp"
 #include "geo/SimulationEdge.hpp"
 #include "geo/CityNode.hpp"
-#include <lemon/dijkstra.h>
-#include <lemon/path.h>
+#include "topo/FrozenTopology.hpp"
 #include "geo/GeometricHelpers.hpp"
+#include "util/ThreadPool.hpp"
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <limits>
 
-SimulationTopology::SimulationTopology(BaseTopology_Ptr& baseTopo) : _baseTopo(baseTopo) {
+constexpr int RoutingTable::NO_HOP;
+
+SimulationTopology::SimulationTopology(BaseTopology_Ptr& baseTopo)
+    : _baseTopo(baseTopo), _store(), _cityIndex(), _frozen(), _nodes() {
+}
+
+void SimulationTopology::indexCities(void) {
+    // simulation nodes added later are never candidates, so the snapshot stays valid
+    if (_cityIndex)
+        return;
+
+    _store = NodeStore_Ptr(new NodeStore(*_baseTopo));
+    Locations cities;
+    cities.reserve(_store->cityCount());
+    for (unsigned k = 0; k < _store->cityCount(); ++k)
+        cities.push_back(_store->node(_store->cityNode(k)));
+    _cityIndex = SphericalKDTree_Ptr(new SphericalKDTree(cities));
 }
 
 GeographicNode_Ptr SimulationTopology::findNearest(GeographicNode_Ptr& node) {
-    GeographicNode_Ptr nearest = nullptr;
-    double currentDist = std::numeric_limits<double>::max();
-
-    NodeMap_Ptr nodeMap = _baseTopo->getNodeMap();
-    for (Graph::NodeIt it(*_baseTopo->getGraph()); it != lemon::INVALID; ++it) {
-        GeographicNode_Ptr otherNode = (*nodeMap)[it];
-
-        CityNode* cityNode = dynamic_cast<CityNode*>(otherNode.get());
-        if (cityNode != nullptr) {
-            double dist = GeometricHelpers::sphericalDist(node, otherNode);
-            if (dist < currentDist) {
-                nearest = otherNode;
-                currentDist = dist;
-            }
-        }
-    }
+    indexCities();
+    if (_store->cityCount() == 0)
+        return nullptr;
 
-    return nearest;
+    // ties go to the first city, like a scan in city order
+    GeographicPosition pos(node->lat(), node->lon());
+    return _store->node(_store->cityNode(_cityIndex->nearest(pos).index));
 }
 
-void SimulationTopology::addNode(SimulationNode_Ptr node) {
-    // get nearest node
-    NodeMap_Ptr nodeMap = _baseTopo->getNodeMap();
-
-    GeographicNode_Ptr castedNode = std::static_pointer_cast<GeographicNode>(node);
-    GeographicNode_Ptr nearestNode = findNearest(castedNode);
+void SimulationTopology::attach(SimulationNode_Ptr& node, GeographicNode_Ptr& nearestNode) {
     assert(static_cast<bool>(nearestNode));
     int id = nearestNode->id();
 
     // add node to topo
+    _frozen.reset();
+    GeographicNode_Ptr castedNode = std::static_pointer_cast<GeographicNode>(node);
     Graph::Node newNode = _baseTopo->addNode(castedNode);
     int newId = _baseTopo->getGraph()->id(newNode);
     node->setId(newId);
@@ -77,41 +82,92 @@ void SimulationTopology::addNode(SimulationNode_Ptr node) {
     SimulationEdge_Ptr simEdge(new SimulationEdge);
     GeographicEdge_Ptr castedEdge = std::static_pointer_cast<GeographicEdge>(simEdge);
     _baseTopo->addEdge(newNode, otherNode, castedEdge);
+    _nodes.push_back(node);
 }
 
-std::pair<Locations_Ptr, double> SimulationTopology::pathBetweenNodes(SimulationNode_Ptr n1, SimulationNode_Ptr n2) {
-    auto graph = _baseTopo->getGraph();
-
-    // make graph nodes
-    Graph::Node u = graph->nodeFromId(n1->id());
-    Graph::Node v = graph->nodeFromId(n2->id());
-
-    // set lengths for all edges
-    Graph::EdgeMap<double> lengthMap(*_baseTopo->getGraph());
-    auto _nodeInfos = _baseTopo->getNodeMap();
-    for (Graph::EdgeIt edge(*graph); edge != lemon::INVALID; ++edge) {
-        GeographicNode_Ptr n1 = (*_nodeInfos)[graph->u(edge)];
-        GeographicNode_Ptr n2 = (*_nodeInfos)[graph->v(edge)];
-        lengthMap[edge] = GeometricHelpers::sphericalDist(n1, n2);
+void SimulationTopology::addNode(SimulationNode_Ptr node) {
+    // get nearest node
+    GeographicNode_Ptr castedNode = std::static_pointer_cast<GeographicNode>(node);
+    GeographicNode_Ptr nearestNode = findNearest(castedNode);
+    attach(node, nearestNode);
+}
+
+void SimulationTopology::addNodes(const std::vector<SimulationNode_Ptr>& nodes) {
+    indexCities();
+
+    // the queries only read the index, the graph is changed afterwards in input order
+    std::vector<GeographicNode_Ptr> nearest(nodes.size());
+    ThreadPool_Ptr pool(ThreadPool::fromConfig());
+    pool->forEach(nodes.size(), [&](size_t i) {
+        GeographicNode_Ptr castedNode = std::static_pointer_cast<GeographicNode>(nodes[i]);
+        nearest[i] = findNearest(castedNode);
+    });
+
+    _nodes.reserve(_nodes.size() + nodes.size());
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        SimulationNode_Ptr node = nodes[i];
+        attach(node, nearest[i]);
     }
+}
 
-    typedef lemon::Path<Graph> GraphPath;
-    GraphPath path;
-    double dist;
+FrozenTopology& SimulationTopology::frozen(void) {
+    // the simulation topology is complete once paths are asked for
+    if (!_frozen)
+        _frozen = _baseTopo->freeze();
+    return *_frozen;
+}
 
-    bool reached = dijkstra(*graph, lengthMap).path(path).dist(dist).run(u, v);
-    assert(reached);
+std::pair<Locations_Ptr, double> SimulationTopology::pathBetweenNodes(SimulationNode_Ptr n1, SimulationNode_Ptr n2) {
+    std::vector<unsigned> path;
+    double dist = frozen().shortestPath(n1->id(), n2->id(), path);
+    assert(dist >= 0.0);
 
     Locations_Ptr ret(new Locations);
 
     // append path nodes to path
-    typedef lemon::PathNodeIt<GraphPath> PathNodeIt;
-    for (PathNodeIt it(*graph, path); it != lemon::INVALID; ++it) {
-        Graph::Node u = PathNodeIt::Node(it);
-        GeographicNode_Ptr node = (*_nodeInfos)[u];
-        ret->push_back(node);
-    }
+    for (unsigned id : path)
+        ret->push_back(frozen().nodes().node(id));
 
     // return stuff
     return std::make_pair(ret, dist);
 }
+
+RoutingTable_Ptr SimulationTopology::routingTable(const std::vector<SimulationNode_Ptr>& nodes) {
+    const FrozenTopology& topo = frozen();
+    RoutingTable_Ptr table(new RoutingTable);
+    const size_t n = nodes.size();
+    table->_nodes = nodes;
+    table->_distance.assign(n * n, -1.0);
+    table->_nextHop.assign(n * n, RoutingTable::NO_HOP);
+
+    // each source fills its own row, the tree of one source answers all targets
+    ThreadPool_Ptr pool(ThreadPool::fromConfig());
+    pool->forEach(n, [&](size_t i) {
+        unsigned source = nodes[i]->id();
+        std::vector<double> dist;
+        std::vector<unsigned> pred;
+        std::vector<unsigned> order;
+        topo.shortestPathTree(source, dist, pred, order);
+
+        // predecessors are settled first, so the first hop of a node is known before its successors need it
+        std::vector<int> firstHop(dist.size(), RoutingTable::NO_HOP);
+        for (unsigned v : order) {
+            if (v != source)
+                firstHop[v] = pred[v] == source ? static_cast<int>(v) : firstHop[pred[v]];
+        }
+
+        for (size_t j = 0; j < n; ++j) {
+            unsigned target = nodes[j]->id();
+            if (pred[target] == FrozenTopology::NO_NODE && target != source)
+                continue;  // < unreachable
+            table->_distance[i * n + j] = dist[target];
+            table->_nextHop[i * n + j] = firstHop[target];
+        }
+    });
+
+    return table;
+}
+
+RoutingTable_Ptr SimulationTopology::routingTable(void) {
+    return routingTable(_nodes);
+}
@@ -32,21 +32,66 @@
 
 #include "topo/base_topo/BaseTopology.hpp"
 #include "geo/SimulationNode.hpp"
+#include "geo/SphericalKDTree.hpp"
+#include "topo/NodeStore.hpp"
 #include <memory>
 #include <map>
 #include <utility>
+#include <vector>
+
+// shortest paths between a set of simulation nodes, row i holds the paths from node i
+struct RoutingTable {
+    static constexpr int NO_HOP = -1;
+
+    size_t size(void) const { return _nodes.size(); }
+
+    // distance in radians, negative if unreachable
+    double distance(size_t i, size_t j) const { return _distance[i * _nodes.size() + j]; }
+
+    // graph node id of the first node after node i on the path to node j, NO_HOP for i == j or if unreachable
+    int nextHop(size_t i, size_t j) const { return _nextHop[i * _nodes.size() + j]; }
+
+    std::vector<SimulationNode_Ptr> _nodes;
+    std::vector<double> _distance;
+    std::vector<int> _nextHop;
+};
+
+typedef std::shared_ptr<RoutingTable> RoutingTable_Ptr;
 
 class SimulationTopology {
    public:
     SimulationTopology(BaseTopology_Ptr& baseTopo);
     void addNode(SimulationNode_Ptr node);
+
+    // same topology as addNode for each node in order, the nearest cities are searched in parallel
+    void addNodes(const std::vector<SimulationNode_Ptr>& nodes);
     std::pair<Locations_Ptr, double> pathBetweenNodes(SimulationNode_Ptr n1, SimulationNode_Ptr n2);
 
+    // paths between all pairs of nodes, one dijkstra per source on the thread pool
+    RoutingTable_Ptr routingTable(const std::vector<SimulationNode_Ptr>& nodes);
+
+    // routing table between all nodes added so far
+    RoutingTable_Ptr routingTable(void);
+
    protected:
    private:
     GeographicNode_Ptr findNearest(GeographicNode_Ptr& node);
+    void indexCities(void);
+    void attach(SimulationNode_Ptr& node, GeographicNode_Ptr& nearestNode);
+    FrozenTopology& frozen(void);
 
     BaseTopology_Ptr _baseTopo;
+
+    // snapshot of the base topology, built on the first lookup
+    NodeStore_Ptr _store;
+
+    // nearest neighbour index over the cities in _store, in city order
+    SphericalKDTree_Ptr _cityIndex;
+
+    // CSR copy for path queries, dropped by addNode
+    FrozenTopology_Ptr _frozen;
+
+    std::vector<SimulationNode_Ptr> _nodes;
 };
 
 typedef std::shared_ptr<SimulationTopology> SimulationTopology_Ptr;
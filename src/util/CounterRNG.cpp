@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "CounterRNG.hpp"
+#include <algorithm>
+
+namespace {
+
+constexpr uint32_t PHILOX_M0 = 0xD2511F53;
+constexpr uint32_t PHILOX_M1 = 0xCD9E8D57;
+constexpr uint32_t PHILOX_W0 = 0x9E3779B9;
+constexpr uint32_t PHILOX_W1 = 0xBB67AE85;
+constexpr int PHILOX_ROUNDS = 10;
+
+// FNV-1a, the key must not depend on the standard library like std::hash
+uint64_t hashSeed(const std::string& seed) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : seed) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+}  // namespace
+
+CounterRNG::CounterRNG(const std::string& seed) : _key() {
+    uint64_t hash = hashSeed(seed);
+    _key[0] = static_cast<uint32_t>(hash);
+    _key[1] = static_cast<uint32_t>(hash >> 32);
+}
+
+std::array<uint32_t, 4> CounterRNG::block(Stream stream, uint64_t entity, uint32_t draw) const {
+    std::array<uint32_t, 4> counter = {{static_cast<uint32_t>(entity), static_cast<uint32_t>(entity >> 32), stream,
+                                        draw}};
+    std::array<uint32_t, 2> key = _key;
+
+    for (int round = 0; round < PHILOX_ROUNDS; ++round) {
+        uint64_t product0 = static_cast<uint64_t>(PHILOX_M0) * counter[0];
+        uint64_t product1 = static_cast<uint64_t>(PHILOX_M1) * counter[2];
+        counter = {{static_cast<uint32_t>(product1 >> 32) ^ counter[1] ^ key[0], static_cast<uint32_t>(product1),
+                    static_cast<uint32_t>(product0 >> 32) ^ counter[3] ^ key[1], static_cast<uint32_t>(product0)}};
+        key[0] += PHILOX_W0;
+        key[1] += PHILOX_W1;
+    }
+
+    return counter;
+}
+
+double CounterRNG::uniform(Stream stream, uint64_t entity, uint32_t draw) const {
+    std::array<uint32_t, 4> bits = block(stream, entity, draw);
+    // 53 random bits, every double in [0, 1) with a spacing of 2^-53
+    uint64_t mantissa = (static_cast<uint64_t>(bits[0]) << 21) ^ (bits[1] >> 11);
+    return mantissa * (1.0 / 9007199254740992.0);
+}
+
+uint64_t CounterRNG::below(Stream stream, uint64_t entity, uint64_t n, uint32_t draw) const {
+    uint64_t value = static_cast<uint64_t>(uniform(stream, entity, draw) * n);
+    return std::min(value, n - 1);
+}
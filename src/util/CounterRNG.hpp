@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef COUNTERRNG_HPP
+#define COUNTERRNG_HPP
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+// counter based random numbers, Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3"). A
+// number is a function of the seed, the stream and the entity it is drawn for, not of the numbers drawn before, so
+// entities can be decided in any order and on any thread with the same result.
+class CounterRNG {
+   public:
+    // one stream per stage that draws numbers
+    enum Stream : uint32_t { CITY_SAMPLING = 1, CLUSTER_REPRESENTATIVE = 2, METRICS_SOURCES = 3 };
+
+    explicit CounterRNG(const std::string& seed);
+
+    // uniform in [0, 1), draw numbers further values for the same entity
+    double uniform(Stream stream, uint64_t entity, uint32_t draw = 0) const;
+
+    // uniform in [0, n)
+    uint64_t below(Stream stream, uint64_t entity, uint64_t n, uint32_t draw = 0) const;
+
+   private:
+    std::array<uint32_t, 4> block(Stream stream, uint64_t entity, uint32_t draw) const;
+
+    std::array<uint32_t, 2> _key;
+};
+
+#endif  // COUNTERRNG_HPP
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "IndexedHeap.hpp"
+
+#include <cassert>
+
+const unsigned int IndexedHeap::NOT_IN_HEAP;
+
+IndexedHeap::IndexedHeap(size_t n) : _heap(), _position(n, NOT_IN_HEAP), _key(n, 0.0) {
+}
+
+void IndexedHeap::push(unsigned int item, double key) {
+    assert(!contains(item));
+    _key[item] = key;
+    _heap.push_back(item);
+    _position[item] = _heap.size() - 1;
+    siftUp(_heap.size() - 1);
+}
+
+void IndexedHeap::decrease(unsigned int item, double key) {
+    assert(contains(item));
+    assert(key <= _key[item]);
+    _key[item] = key;
+    siftUp(_position[item]);
+}
+
+unsigned int IndexedHeap::pop(void) {
+    assert(!empty());
+    unsigned int top = _heap.front();
+    _position[top] = NOT_IN_HEAP;
+
+    unsigned int last = _heap.back();
+    _heap.pop_back();
+    if (!_heap.empty()) {
+        place(0, last);
+        siftDown(0);
+    }
+    return top;
+}
+
+bool IndexedHeap::less(unsigned int a, unsigned int b) const {
+    return _key[a] < _key[b] || (_key[a] == _key[b] && a < b);
+}
+
+void IndexedHeap::place(size_t slot, unsigned int item) {
+    _heap[slot] = item;
+    _position[item] = slot;
+}
+
+void IndexedHeap::siftUp(size_t slot) {
+    unsigned int item = _heap[slot];
+    while (slot > 0) {
+        size_t parent = (slot - 1) / 2;
+        if (!less(item, _heap[parent]))
+            break;
+        place(slot, _heap[parent]);
+        slot = parent;
+    }
+    place(slot, item);
+}
+
+void IndexedHeap::siftDown(size_t slot) {
+    unsigned int item = _heap[slot];
+    size_t n = _heap.size();
+    while (2 * slot + 1 < n) {
+        size_t child = 2 * slot + 1;
+        if (child + 1 < n && less(_heap[child + 1], _heap[child]))
+            ++child;
+        if (!less(_heap[child], item))
+            break;
+        place(slot, _heap[child]);
+        slot = child;
+    }
+    place(slot, item);
+}
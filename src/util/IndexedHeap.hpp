@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INDEXEDHEAP_HPP
+#define INDEXEDHEAP_HPP
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+// binary min heap over the items 0..n-1 with a position table for decrease-key. Equal keys pop the smaller item
+// first, so the order does not depend on the insertion history.
+class IndexedHeap {
+   public:
+    IndexedHeap(size_t n);
+
+    bool empty(void) const { return _heap.empty(); }
+    size_t size(void) const { return _heap.size(); }
+    bool contains(unsigned int item) const { return _position[item] != NOT_IN_HEAP; }
+
+    void push(unsigned int item, double key);
+    // key must not be larger than the current key of item
+    void decrease(unsigned int item, double key);
+    unsigned int pop(void);
+
+   private:
+    static const unsigned int NOT_IN_HEAP = std::numeric_limits<unsigned int>::max();
+
+    bool less(unsigned int a, unsigned int b) const;
+    void place(size_t slot, unsigned int item);
+    void siftUp(size_t slot);
+    void siftDown(size_t slot);
+
+    std::vector<unsigned int> _heap;      /// < items in heap order
+    std::vector<unsigned int> _position;  /// < slot in _heap per item
+    std::vector<double> _key;
+};
+
+#endif
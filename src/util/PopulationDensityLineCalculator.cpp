@@ -29,8 +29,8 @@
 
 #include "PopulationDensityLineCalculator.hpp"
 #include "geo/GeometricHelpers.hpp"
+#include <algorithm>
 #include <cmath>
-#include <iostream>
 
 PopulationDensityLineCalculator::PopulationDensityLineCalculator(PopulationDensityReader_Ptr reader) : _reader(reader) {
 }
@@ -38,54 +38,115 @@ PopulationDensityLineCalculator::PopulationDensityLineCalculator(PopulationDensi
 PopulationDensityLineCalculator::~PopulationDensityLineCalculator() {
 }
 
-GeographicPosition PopulationDensityLineCalculator::getIntermediatePointAt(GeographicPosition& p1,
-                                                                           GeographicPosition& p2,
-                                                                           double distance,
-                                                                           double percent) {
+size_t PopulationDensityLineCalculator::sampleCount(double distance, unsigned level) {
+    if (distance == 0.0)
+        return 1;
+    double increment = GeometricHelpers::deg2rad(_reader->cellsize(level)) / distance;
+    return static_cast<size_t>(floor(1.0 / increment)) + 1;
+}
+
+unsigned PopulationDensityLineCalculator::levelFor(double distance, size_t maxSamples) {
+    unsigned level = 0;
+    while (maxSamples > 0 && level + 1 < _reader->levels() && sampleCount(distance, level) > maxSamples)
+        ++level;
+    return level;
+}
+
+// Aviation Formulas
+// Intermediate Points on a great circle
+// http://williams.best.vwh.net/avform.htm#Crs
+//
+// The points are equally spaced, so every point follows from the two before it by a rotation:
+// p[k + 1] = 2 cos(step) p[k] - p[k - 1]. Each sample then only costs the conversion back to a raster cell.
+template <class Sink>
+void PopulationDensityLineCalculator::sampleLine(GeographicPosition& p1,
+                                                 GeographicPosition& p2,
+                                                 unsigned level,
+                                                 Sink sink) {
     using namespace GeometricHelpers;
+    assert(Util::checkBounds(p1));
+    assert(Util::checkBounds(p2));
+
+    const FileHeader& header = _reader->header();
+    const double minLat = header.yllcorner;
+    const double minLon = header.xllcorner;
+    const double maxLat = minLat + header.cellsize * header.nrows;
+    const double maxLon = minLon + header.cellsize * header.ncols;
+
+    double distance = sphericalDist(p1, p2);
+    size_t count = sampleCount(distance, level);
 
-    double A = sin((1 - percent) * distance) / sin(distance);
-    double B = sin(percent * distance) / sin(distance);
     double lat1 = deg2rad(p1.lat());
     double lon1 = deg2rad(p1.lon());
-
     double lat2 = deg2rad(p2.lat());
     double lon2 = deg2rad(p2.lon());
-    double x = A * cos(lat1) * cos(lon1) + B * cos(lat2) * cos(lon2);
-    double y = A * cos(lat1) * sin(lon1) + B * cos(lat2) * sin(lon2);
-    double z = A * sin(lat1) + B * sin(lat2);
+    double x1 = cos(lat1) * cos(lon1);
+    double y1 = cos(lat1) * sin(lon1);
+    double z1 = sin(lat1);
 
-    GeographicPosition p(rad2deg(atan2(z, sqrt(x * x + y * y))), rad2deg(atan2(y, x)));
+    // current point and the one a step before it
+    double x = x1;
+    double y = y1;
+    double z = z1;
+    double prevX = x1;
+    double prevY = y1;
+    double prevZ = z1;
+    double twoCos = 2.0;
+    if (count > 1) {
+        double step = deg2rad(_reader->cellsize(level));
+        double A = sin(distance + step) / sin(distance);
+        double B = -sin(step) / sin(distance);
+        prevX = A * x1 + B * cos(lat2) * cos(lon2);
+        prevY = A * y1 + B * cos(lat2) * sin(lon2);
+        prevZ = A * z1 + B * sin(lat2);
+        twoCos = 2.0 * cos(step);
+    }
 
-    return p;
+    for (size_t k = 0; k < count; ++k) {
+        double lat = rad2deg(atan2(z, sqrt(x * x + y * y)));
+        double lon = rad2deg(atan2(y, x));
+
+        double density = header.NODATA_value;
+        if (lat >= minLat && lat <= maxLat && lon >= minLon && lon <= maxLon) {
+            int row = header.nrows - 1 - static_cast<int>((lat - minLat) / header.cellsize);
+            int col = static_cast<int>((lon - minLon) / header.cellsize);
+            row = std::max(0, row);  // < the upper and right borders belong to the last cell
+            col = std::min(header.ncols - 1, col);
+            density = _reader->cell(row >> level, col >> level, level);
+        }
+        sink(density < 0.0 ? 0.0 : density);
+
+        double nextX = twoCos * x - prevX;
+        double nextY = twoCos * y - prevY;
+        double nextZ = twoCos * z - prevZ;
+        prevX = x;
+        prevY = y;
+        prevZ = z;
+        x = nextX;
+        y = nextY;
+        z = nextZ;
+    }
 }
 
 DensityVector_Ptr PopulationDensityLineCalculator::getDensityLineBetween(GeographicPosition& p1,
-                                                                         GeographicPosition& p2) {
-    using namespace GeometricHelpers;
-    assert(Util::checkBounds(p1));
-    assert(Util::checkBounds(p2));
+                                                                         GeographicPosition& p2,
+                                                                         size_t maxSamples) {
+    double distance = GeometricHelpers::sphericalDist(p1, p2);
+    unsigned level = levelFor(distance, maxSamples);
 
     DensityVector_Ptr result(new DensityVector);
+    result->reserve(sampleCount(distance, level));
 
-    // Aviation Formulas
-    // Intermediate Points on a great circle
-    // http://williams.best.vwh.net/avform.htm#Crs
-    double distance = sphericalDist(p1, p2);
-    double increment = deg2rad(_reader->cellsize()) / distance;
-
-    for (double percent = 0.0; percent <= 1.0; percent += increment) {
-        GeographicPosition p = getIntermediatePointAt(p1, p2, distance, percent);
-        appendLinePoint(result, p);
-    }
-
+    DensityVector& line = *result;
+    sampleLine(p1, p2, level, [&line](double density) { line.push_back(density); });
     return result;
 }
 
-void PopulationDensityLineCalculator::appendLinePoint(DensityVector_Ptr result, GeographicPosition& p) {
-    // get raster points on array
-    double density_val = _reader->valueAt(p.lat(), p.lon());
-    if (density_val < 0.0)
-        density_val = 0.0;
-    result->push_back(density_val);
+double PopulationDensityLineCalculator::getDensitySumBetween(GeographicPosition& p1,
+                                                             GeographicPosition& p2,
+                                                             size_t maxSamples) {
+    double sum = 0.0;
+    sampleLine(p1, p2, levelFor(GeometricHelpers::sphericalDist(p1, p2), maxSamples),
+               [&sum](double density) { sum += density; });
+    return sum;
 }
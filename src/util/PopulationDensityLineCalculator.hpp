@@ -49,18 +49,20 @@ class PopulationDensityLineCalculator {
 
     ~PopulationDensityLineCalculator();
 
-    DensityVector_Ptr getDensityLineBetween(GeographicPosition& p1, GeographicPosition& p2);
+    // densities every cellsize along the great circle from p1 to p2, values below zero count as zero. With
+    // maxSamples, the line is sampled on the finest level of a tiled reader that needs at most that many samples.
+    DensityVector_Ptr getDensityLineBetween(GeographicPosition& p1, GeographicPosition& p2, size_t maxSamples = 0);
+
+    // sum of getDensityLineBetween without building the vector
+    double getDensitySumBetween(GeographicPosition& p1, GeographicPosition& p2, size_t maxSamples = 0);
 
    protected:
    private:
-    double calcDist(GeographicPosition& p1, GeographicPosition& p2);
-
-    GeographicPosition getIntermediatePointAt(GeographicPosition& p1,
-                                              GeographicPosition& p2,
-                                              double distance,
-                                              double percent);
+    size_t sampleCount(double distance, unsigned level);
+    unsigned levelFor(double distance, size_t maxSamples);
 
-    void appendLinePoint(DensityVector_Ptr result, GeographicPosition& p);
+    template <class Sink>
+    void sampleLine(GeographicPosition& p1, GeographicPosition& p2, unsigned level, Sink sink);
 
     PopulationDensityReader_Ptr _reader;
 };
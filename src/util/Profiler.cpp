@@ -0,0 +1,282 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Profiler.hpp"
+#include "Trace.hpp"
+#include <algorithm>
+#include <atomic>
+#include <boost/log/trivial.hpp>
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <json/json.h>
+#include <mutex>
+#include <sys/resource.h>
+
+namespace {
+
+// counters of one thread, only written by their owner and summed up under the mutex
+struct CounterBin {
+    std::array<std::atomic<uint64_t>, Profiler::NUM_COUNTERS> values;
+};
+
+struct ProfilerState {
+    std::mutex mutex;
+    std::vector<CounterBin*> bins;
+    Profiler::Counters retired;  /// < counts of threads that already exited
+
+    bool running;
+    Profiler::Stage current;
+    std::chrono::steady_clock::time_point wallStart;
+    double cpuStart;
+    Profiler::Counters countersStart;
+
+    std::vector<Profiler::Stage> stages;
+
+    ProfilerState() : running(false), cpuStart(0.0) { retired.fill(0); }
+};
+
+ProfilerState& state() {
+    static ProfilerState s;
+    return s;
+}
+
+struct ThreadBin {
+    CounterBin bin;
+
+    ThreadBin() {
+        for (auto& value : bin.values)
+            value.store(0, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(state().mutex);
+        state().bins.push_back(&bin);
+    }
+
+    ~ThreadBin() {
+        ProfilerState& s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        for (unsigned i = 0; i < Profiler::NUM_COUNTERS; ++i)
+            s.retired[i] += bin.values[i].load(std::memory_order_relaxed);
+        s.bins.erase(std::find(s.bins.begin(), s.bins.end(), &bin));
+    }
+};
+
+thread_local ThreadBin threadBin;
+
+// expects the mutex to be held
+Profiler::Counters snapshot(ProfilerState& s) {
+    Profiler::Counters total = s.retired;
+    for (CounterBin* bin : s.bins)
+        for (unsigned i = 0; i < Profiler::NUM_COUNTERS; ++i)
+            total[i] += bin->values[i].load(std::memory_order_relaxed);
+    return total;
+}
+
+double cpuSeconds(const rusage& usage) {
+    return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec * 1e-6 + usage.ru_stime.tv_sec +
+           usage.ru_stime.tv_usec * 1e-6;
+}
+
+rusage resourceUsage() {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage;
+}
+
+// VmHWM and VmRSS of /proc/self/status in kB, false if it is not available
+bool residentSetSize(long& peakKB, long& currentKB) {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    int found = 0;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0) {
+            peakKB = atol(line.c_str() + 6);
+            ++found;
+        } else if (line.compare(0, 6, "VmRSS:") == 0) {
+            currentKB = atol(line.c_str() + 6);
+            ++found;
+        }
+    }
+    return found == 2;
+}
+
+// lowers the high-water mark to the current resident set, see proc(5) clear_refs
+void resetPeakRSS() {
+    std::ofstream clearRefs("/proc/self/clear_refs");
+    clearRefs << "5";
+}
+
+// expects the mutex to be held
+void closeStage(ProfilerState& s) {
+    if (!s.running)
+        return;
+
+    rusage usage = resourceUsage();
+    Profiler::Counters now = snapshot(s);
+
+    Profiler::Stage& st = s.current;
+    st.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - s.wallStart).count();
+    st.cpuSeconds = cpuSeconds(usage) - s.cpuStart;
+    st.peakRSSKB = usage.ru_maxrss;
+    st.rssKB = usage.ru_maxrss;
+    residentSetSize(st.peakRSSKB, st.rssKB);
+    for (unsigned i = 0; i < Profiler::NUM_COUNTERS; ++i)
+        st.counters[i] = now[i] - s.countersStart[i];
+
+    s.stages.push_back(st);
+    s.running = false;
+}
+
+}  // namespace
+
+void Profiler::count(Counter counter, uint64_t n) {
+    std::atomic<uint64_t>& value = threadBin.bin.values[counter];
+    value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+void Profiler::stage(const std::string& name) {
+    Trace::stage(name);
+
+    // make sure the calling thread is registered before the snapshot
+    count(DISTANCE_EVALUATIONS, 0);
+
+    ProfilerState& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    closeStage(s);
+
+    s.current.name = name;
+    resetPeakRSS();
+    s.countersStart = snapshot(s);
+    s.cpuStart = cpuSeconds(resourceUsage());
+    s.wallStart = std::chrono::steady_clock::now();
+    s.running = true;
+}
+
+void Profiler::finish(void) {
+    Trace::stage("");
+
+    ProfilerState& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    closeStage(s);
+}
+
+std::vector<Profiler::Stage> Profiler::stages(void) {
+    ProfilerState& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    return s.stages;
+}
+
+const char* Profiler::counterName(Counter counter) {
+    switch (counter) {
+        case DISTANCE_EVALUATIONS:
+            return "distanceEvaluations";
+        case SQLITE_ROWS:
+            return "sqliteRows";
+        case EDGES_ADDED:
+            return "edgesAdded";
+        case EDGES_ERASED:
+            return "edgesErased";
+        case NODES_ERASED:
+            return "nodesErased";
+        default:
+            assert(false);
+            return "";
+    }
+}
+
+void Profiler::logSummary(void) {
+    std::vector<Stage> all = stages();
+    if (all.empty())
+        return;
+
+    char line[256];
+    snprintf(line, sizeof(line), "%-20s %9s %9s %10s %10s %14s %10s %10s %10s %10s", "stage", "wall[s]", "cpu[s]",
+             "peak[MB]", "rss[MB]", "distances", "rows", "+edges", "-edges", "-nodes");
+    BOOST_LOG_TRIVIAL(info) << line;
+
+    Stage total;
+    total.name = "total";
+    total.wallSeconds = 0.0;
+    total.cpuSeconds = 0.0;
+    total.peakRSSKB = 0;
+    total.rssKB = 0;
+    total.counters.fill(0);
+
+    auto logStage = [&line](const Stage& st) {
+        snprintf(line, sizeof(line), "%-20s %9.3f %9.3f %10.1f %10.1f %14llu %10llu %10llu %10llu %10llu",
+                 st.name.c_str(), st.wallSeconds, st.cpuSeconds, st.peakRSSKB / 1024.0, st.rssKB / 1024.0,
+                 static_cast<unsigned long long>(st.counters[DISTANCE_EVALUATIONS]),
+                 static_cast<unsigned long long>(st.counters[SQLITE_ROWS]),
+                 static_cast<unsigned long long>(st.counters[EDGES_ADDED]),
+                 static_cast<unsigned long long>(st.counters[EDGES_ERASED]),
+                 static_cast<unsigned long long>(st.counters[NODES_ERASED]));
+        BOOST_LOG_TRIVIAL(info) << line;
+    };
+
+    for (const Stage& st : all) {
+        logStage(st);
+        total.wallSeconds += st.wallSeconds;
+        total.cpuSeconds += st.cpuSeconds;
+        total.peakRSSKB = std::max(total.peakRSSKB, st.peakRSSKB);
+        total.rssKB = st.rssKB;
+        for (unsigned i = 0; i < NUM_COUNTERS; ++i)
+            total.counters[i] += st.counters[i];
+    }
+    logStage(total);
+}
+
+void Profiler::writeJSON(const std::string& filename) {
+    Json::Value root;
+    Json::Value stageList(Json::arrayValue);
+
+    for (const Stage& st : stages()) {
+        Json::Value entry;
+        entry["name"] = st.name;
+        entry["wallSeconds"] = st.wallSeconds;
+        entry["cpuSeconds"] = st.cpuSeconds;
+        entry["peakRSSKB"] = static_cast<Json::Int64>(st.peakRSSKB);
+        entry["rssKB"] = static_cast<Json::Int64>(st.rssKB);
+
+        Json::Value counters;
+        for (unsigned i = 0; i < NUM_COUNTERS; ++i)
+            counters[counterName(static_cast<Counter>(i))] = static_cast<Json::UInt64>(st.counters[i]);
+        entry["counters"] = counters;
+
+        stageList.append(entry);
+    }
+    root["stages"] = stageList;
+
+    std::ofstream out(filename.c_str());
+    assert(out.good());
+    Json::StyledWriter writer;
+    out << writer.write(root);
+
+    BOOST_LOG_TRIVIAL(info) << "wrote profile to " << filename;
+}
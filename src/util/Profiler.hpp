@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Per-stage wall time, CPU time, peak RSS and event counters of a topoGen run. The pipeline is a sequence of
+// stages, each call of stage() closes the running stage and opens the next one.
+class Profiler {
+   public:
+    enum Counter { DISTANCE_EVALUATIONS, SQLITE_ROWS, EDGES_ADDED, EDGES_ERASED, NODES_ERASED, NUM_COUNTERS };
+
+    typedef std::array<uint64_t, NUM_COUNTERS> Counters;
+
+    struct Stage {
+        std::string name;
+        double wallSeconds;
+        double cpuSeconds;  /// < user and system time of all threads
+        long peakRSSKB;     /// < high-water mark during the stage, of the whole run if it can not be reset
+        long rssKB;         /// < resident at the end of the stage
+        Counters counters;
+    };
+
+    // adds n events to the counter, cheap enough for inner loops and safe to call from worker threads
+    static void count(Counter counter, uint64_t n = 1);
+
+    static void stage(const std::string& name);
+    static void finish(void);
+
+    static std::vector<Stage> stages(void);
+    static const char* counterName(Counter counter);
+
+    static void logSummary(void);
+    static void writeJSON(const std::string& filename);
+
+   private:
+    Profiler() = delete;
+};
+
+#endif  // PROFILER_HPP
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "StringInterner.hpp"
+#include <algorithm>
+#include <cassert>
+
+StringInterner::StringInterner() : _mutex(), _ids(), _strings() {
+}
+
+unsigned StringInterner::intern(const std::string& str) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _ids.find(str);
+    if (it != _ids.end())
+        return it->second;
+
+    unsigned id = _strings.size();
+    _ids.insert(std::make_pair(str, id));
+    _strings.push_back(str);
+    return id;
+}
+
+bool StringInterner::find(const std::string& str, unsigned& id) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _ids.find(str);
+    if (it == _ids.end())
+        return false;
+
+    id = it->second;
+    return true;
+}
+
+const std::string& StringInterner::str(unsigned id) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    assert(id < _strings.size());
+    return _strings[id];
+}
+
+size_t StringInterner::size() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _strings.size();
+}
+
+std::vector<unsigned> StringInterner::sortedIds() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::vector<unsigned> ids(_strings.size());
+    for (unsigned i = 0; i < ids.size(); ++i)
+        ids[i] = i;
+
+    std::sort(ids.begin(), ids.end(), [this](unsigned a, unsigned b) { return _strings[a] < _strings[b]; });
+    return ids;
+}
+
+StringInterner& Interned::countries(void) {
+    static StringInterner table;
+    return table;
+}
+
+StringInterner& Interned::continents(void) {
+    static StringInterner table;
+    return table;
+}
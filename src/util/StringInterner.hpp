@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef STRINGINTERNER_HPP
+#define STRINGINTERNER_HPP
+
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// maps strings to dense ids 0..size()-1, ids and references stay valid for the lifetime of the table. All methods
+// may be called concurrently, topologies of a batch are generated in parallel.
+class StringInterner {
+   public:
+    StringInterner();
+
+    unsigned intern(const std::string& str);
+
+    // returns false and leaves id untouched if str was never interned
+    bool find(const std::string& str, unsigned& id) const;
+
+    const std::string& str(unsigned id) const;
+
+    size_t size() const;
+
+    // all ids ordered by their string, for iteration in the order of a std::map<std::string, ...>
+    std::vector<unsigned> sortedIds() const;
+
+   private:
+    mutable std::mutex _mutex;
+    std::unordered_map<std::string, unsigned> _ids;
+    std::deque<std::string> _strings;
+};
+
+namespace Interned {
+// global table of country names
+StringInterner& countries(void);
+
+// global table of continent names
+StringInterner& continents(void);
+};
+
+#endif
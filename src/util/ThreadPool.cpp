@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ThreadPool.hpp"
+#include "config/Config.hpp"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace {
+// set while the thread executes tasks of a parallel forEach
+thread_local bool insideTask = false;
+}  // namespace
+
+ThreadPool::ThreadPool(unsigned int threads) : _threads(threads) {
+    if (_threads == 0)
+        _threads = std::max(1u, std::thread::hardware_concurrency());
+}
+
+ThreadPool_Ptr ThreadPool::fromConfig(void) {
+    std::unique_ptr<Config> config(new Config);
+    return ThreadPool_Ptr(new ThreadPool(config->get<unsigned int>("parallel.threads")));
+}
+
+unsigned int ThreadPool::size(void) const {
+    return _threads;
+}
+
+void ThreadPool::forEach(size_t n, const std::function<void(size_t)>& task) {
+    if (_threads == 1 || n <= 1 || insideTask) {
+        for (size_t i = 0; i < n; ++i)
+            task(i);
+        return;
+    }
+
+    std::atomic<size_t> next(0);
+    auto work = [&next, n, &task]() {
+        insideTask = true;
+        for (size_t i = next++; i < n; i = next++)
+            task(i);
+        insideTask = false;
+    };
+
+    std::vector<std::thread> workers;
+    unsigned int count = std::min<size_t>(_threads, n);
+    for (unsigned int t = 1; t < count; ++t)
+        workers.push_back(std::thread(work));
+
+    work();
+    for (std::thread& worker : workers)
+        worker.join();
+}
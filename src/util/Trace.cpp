@@ -0,0 +1,203 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Trace.hpp"
+#include <boost/log/trivial.hpp>
+#include <cassert>
+#include <deque>
+#include <fstream>
+#include <json/json.h>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+std::atomic<bool> Trace::_enabled(false);
+std::chrono::steady_clock::time_point Trace::_epoch(std::chrono::steady_clock::now());
+constexpr size_t Trace::DEFAULT_RING_EVENTS;
+
+namespace {
+
+struct Event {
+    const char* name;
+    const char* argName;
+    int64_t arg;
+    int64_t begin;
+    int64_t end;
+};
+
+// ring of one thread at a time, the pool threads are short lived and hand their lane on to the next thread, so
+// there are as many lanes as threads ran at once and each is one row of the timeline
+struct Lane {
+    unsigned id;
+    std::vector<Event> events;
+    uint64_t written;  /// < events[written % size] is the oldest once the ring is full
+
+    Lane(unsigned laneId, size_t ringEvents) : id(laneId), events(ringEvents), written(0) {}
+};
+
+struct TraceState {
+    std::mutex mutex;
+    size_t ringEvents;
+    std::vector<std::unique_ptr<Lane>> lanes;
+    std::vector<Lane*> freeLanes;
+
+    // stage spans with their names, the deque keeps the names in place
+    std::deque<std::string> stageNames;
+    std::vector<Event> stages;
+    bool stageRunning;
+
+    TraceState()
+        : mutex(), ringEvents(0), lanes(), freeLanes(), stageNames(), stages(), stageRunning(false) {}
+};
+
+TraceState& state() {
+    static TraceState s;
+    return s;
+}
+
+struct LaneHandle {
+    Lane* lane;
+
+    LaneHandle() : lane(nullptr) {}
+    LaneHandle(const LaneHandle&) = delete;
+    LaneHandle& operator=(const LaneHandle&) = delete;
+
+    ~LaneHandle() {
+        if (!lane)
+            return;
+        TraceState& s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.freeLanes.push_back(lane);
+    }
+
+    Lane& get() {
+        if (lane)
+            return *lane;
+        TraceState& s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        if (!s.freeLanes.empty()) {
+            lane = s.freeLanes.back();
+            s.freeLanes.pop_back();
+        } else {
+            s.lanes.emplace_back(new Lane(s.lanes.size() + 1, s.ringEvents));
+            lane = s.lanes.back().get();
+        }
+        return *lane;
+    }
+};
+
+thread_local LaneHandle laneHandle;
+
+void writeEvent(std::ostream& out, const Event& event, unsigned tid, bool& first) {
+    out << (first ? "\n" : ",\n") << "{\"name\":" << Json::valueToQuotedString(event.name)
+        << ",\"cat\":\"topoGen\",\"ph\":\"X\",\"pid\":1,\"tid\":" << tid << ",\"ts\":" << event.begin / 1000.0
+        << ",\"dur\":" << (event.end - event.begin) / 1000.0;
+    if (event.argName)
+        out << ",\"args\":{" << Json::valueToQuotedString(event.argName) << ":" << event.arg << "}";
+    out << "}";
+    first = false;
+}
+
+void writeThreadName(std::ostream& out, unsigned tid, const std::string& name, bool& first) {
+    out << (first ? "\n" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tid
+        << ",\"args\":{\"name\":" << Json::valueToQuotedString(name.c_str()) << "}}";
+    first = false;
+}
+
+}  // namespace
+
+void Trace::enable(size_t ringEvents) {
+    assert(ringEvents > 0);
+#ifndef TOPOGEN_TRACE
+    BOOST_LOG_TRIVIAL(warning) << "built without TOPOGEN_TRACE, the trace only holds the pipeline stages";
+#endif
+    TraceState& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    if (_enabled.load(std::memory_order_relaxed))
+        return;
+    s.ringEvents = ringEvents;
+    _epoch = std::chrono::steady_clock::now();
+    _enabled.store(true, std::memory_order_relaxed);
+}
+
+void Trace::stage(const std::string& name) {
+    if (!enabled())
+        return;
+
+    int64_t timestamp = now();
+    TraceState& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    if (s.stageRunning)
+        s.stages.back().end = timestamp;
+    s.stageRunning = !name.empty();
+    if (s.stageRunning) {
+        s.stageNames.push_back(name);
+        s.stages.push_back(Event{s.stageNames.back().c_str(), nullptr, 0, timestamp, timestamp});
+    }
+}
+
+void Trace::record(const char* name, const char* argName, int64_t arg, int64_t beginNS, int64_t endNS) {
+    Lane& lane = laneHandle.get();
+    lane.events[lane.written % lane.events.size()] = Event{name, argName, arg, beginNS, endNS};
+    ++lane.written;
+}
+
+void Trace::writeJSON(const std::string& filename) {
+    stage("");
+
+    TraceState& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+
+    std::ofstream out(filename.c_str());
+    assert(out.good());
+    out.precision(15);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    bool first = true;
+    writeThreadName(out, 0, "stages", first);
+    for (const Event& event : s.stages)
+        writeEvent(out, event, 0, first);
+
+    uint64_t dropped = 0;
+    size_t events = s.stages.size();
+    for (const std::unique_ptr<Lane>& lane : s.lanes) {
+        writeThreadName(out, lane->id, "lane " + std::to_string(lane->id), first);
+        size_t size = lane->events.size();
+        uint64_t begin = lane->written > size ? lane->written - size : 0;
+        for (uint64_t i = begin; i < lane->written; ++i)
+            writeEvent(out, lane->events[i % size], lane->id, first);
+        dropped += begin;
+        events += lane->written - begin;
+    }
+    out << "\n],\"otherData\":{\"droppedEvents\":" << dropped << "}}\n";
+
+    if (dropped > 0)
+        BOOST_LOG_TRIVIAL(warning) << "trace: dropped the " << dropped << " oldest spans of full rings";
+    BOOST_LOG_TRIVIAL(info) << "wrote " << events << " trace events to " << filename;
+}
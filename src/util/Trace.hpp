@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include "config/Defines.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Scoped spans of the hot loops for a timeline view, written in the Chrome trace event format (chrome://tracing,
+// https://ui.perfetto.dev). The spans are recorded per thread into fixed size rings that keep the latest events,
+// a scope costs one relaxed load while tracing is off and the TRACE_SCOPE macros are empty without TOPOGEN_TRACE.
+//
+//     TRACE_SCOPE_ARG("beta skeleton country", "cities", cities.size());
+class Trace {
+   public:
+    // starts recording, every thread keeps up to ringEvents of its latest spans
+    static void enable(size_t ringEvents = DEFAULT_RING_EVENTS);
+    static bool enabled(void) { return _enabled.load(std::memory_order_relaxed); }
+
+    // span of a pipeline stage on a row of its own, an empty name only closes the running stage
+    static void stage(const std::string& name);
+
+    // name and argName have to outlive the trace, e.g. string literals
+    static void record(const char* name, const char* argName, int64_t arg, int64_t beginNS, int64_t endNS);
+
+    // nanoseconds since enable
+    static int64_t now(void) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _epoch)
+            .count();
+    }
+
+    // the recorded spans of all threads, expects the traced threads to be finished or idle
+    static void writeJSON(const std::string& filename);
+
+    class Scope {
+       public:
+        explicit Scope(const char* name, const char* argName = nullptr, int64_t arg = 0)
+            : _name(name), _argName(argName), _arg(arg), _begin(enabled() ? now() : -1) {}
+        ~Scope() {
+            if (_begin >= 0)
+                record(_name, _argName, _arg, _begin, now());
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+       private:
+        const char* _name;
+        const char* _argName;
+        int64_t _arg;
+        int64_t _begin;  /// < -1 if tracing was off when the scope was entered
+    };
+
+    static constexpr size_t DEFAULT_RING_EVENTS = 1 << 16;
+
+   private:
+    Trace() = delete;
+
+    static std::atomic<bool> _enabled;
+    static std::chrono::steady_clock::time_point _epoch;
+};
+
+#ifdef TOPOGEN_TRACE
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SCOPE(name) Trace::Scope TRACE_CONCAT(traceScope, __LINE__)(name)
+#define TRACE_SCOPE_ARG(name, argName, arg) \
+    Trace::Scope TRACE_CONCAT(traceScope, __LINE__)(name, argName, static_cast<int64_t>(arg))
+#else
+#define TRACE_SCOPE(name)
+#define TRACE_SCOPE_ARG(name, argName, arg)
+#endif
+
+#endif  // TRACE_HPP
@@ -31,6 +31,9 @@
 #include <cmath>
 #include <cassert>
 #include "geo/GeographicPosition.hpp"
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
 
 double Util::hs(double theta) {
     double t = sin(theta / 2.0);
@@ -51,3 +54,9 @@ bool Util::checkBounds(double lat, double lon) {
 bool Util::checkBounds(GeographicPosition& p) {
     return checkBounds(p.lat(), p.lon());
 }
+
+void Util::releaseFreeMemory(void) {
+#ifdef __GLIBC__
+    malloc_trim(0);
+#endif
+}
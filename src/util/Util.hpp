@@ -37,6 +37,9 @@ double hs(double theta);
 double ihs(double theta);
 bool checkBounds(double lat, double lon);
 bool checkBounds(GeographicPosition& p);
+
+// returns freed heap memory to the system where the allocator supports it
+void releaseFreeMemory(void);
 };
 
 #endif
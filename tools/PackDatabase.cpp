@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2013-2015, Michael Grey and Markus Theil
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// topoGen-pack: converts the tables topoGen imports from topoGen.db into the snapshot read by ImportedData, see
+// src/db/DatabaseSnapshot.hpp. Writes topoGen.snapshot next to topoGen.db unless a file name is given. All cities are
+// packed unless a population threshold is given as second argument.
+
+#include "config/PredefinedValues.hpp"
+#include "db/DatabaseSnapshot.hpp"
+#include <boost/log/trivial.hpp>
+#include <cstdlib>
+#include <string>
+
+int main(int argc, char** argv) {
+    std::string filename = argc > 1 ? argv[1] : PredefinedValues::dbSnapshotFilePath();
+    int populationThreshold = argc > 2 ? std::atoi(argv[2]) : 0;
+
+    BOOST_LOG_TRIVIAL(info) << "packing " << PredefinedValues::dbFilePath() << " into " << filename;
+    return DatabaseSnapshot::write(PredefinedValues::dbFilePath(), filename, populationThreshold) ? 0 : 1;
+}